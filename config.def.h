@@ -1351,6 +1351,11 @@
 #define DEFAULT_SAVESTATE_FILE_COMPRESSION true
 #endif
 
+/* Compress save and save state files with zstd
+ * instead of zlib (when available) - faster, but
+ * such files cannot be read by older versions */
+#define DEFAULT_FILE_COMPRESSION_ZSTD false
+
 /* Slowmotion ratio. */
 #define DEFAULT_SLOWMOTION_RATIO 3.0f
 
@@ -26,6 +26,9 @@
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
+#ifdef HAVE_ZLIB
+#include <streams/rzip_stream.h>
+#endif
 #include <array/rhmap.h>
 
 #ifdef HAVE_CONFIG_H
@@ -1715,6 +1718,7 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("savestate_thumbnail_enable",    &settings->bools.savestate_thumbnail_enable, true, DEFAULT_SAVESTATE_THUMBNAIL_ENABLE, false);
    SETTING_BOOL("save_file_compression",         &settings->bools.save_file_compression, true, DEFAULT_SAVE_FILE_COMPRESSION, false);
    SETTING_BOOL("savestate_file_compression",    &settings->bools.savestate_file_compression, true, DEFAULT_SAVESTATE_FILE_COMPRESSION, false);
+   SETTING_BOOL("file_compression_zstd",         &settings->bools.file_compression_zstd, true, DEFAULT_FILE_COMPRESSION_ZSTD, false);
    SETTING_BOOL("game_specific_options",         &settings->bools.game_specific_options, true, DEFAULT_GAME_SPECIFIC_OPTIONS, false);
    SETTING_BOOL("auto_overrides_enable",         &settings->bools.auto_overrides_enable, true, DEFAULT_AUTO_OVERRIDES_ENABLE, false);
    SETTING_BOOL("auto_remaps_enable",            &settings->bools.auto_remaps_enable, true, DEFAULT_AUTO_REMAPS_ENABLE, false);
@@ -2533,6 +2537,7 @@ static struct config_size_setting *populate_settings_size(
       return NULL;
 
    SETTING_SIZE("rewind_buffer_size",            &settings->sizes.rewind_buffer_size, true, DEFAULT_REWIND_BUFFER_SIZE, false);
+   SETTING_SIZE("vfs_read_cache_size",           &settings->sizes.vfs_read_cache_size, true, VFS_READ_CACHE_DEFAULT_SIZE, false);
 
    *size = count;
 
@@ -4152,6 +4157,13 @@ static bool config_load_file(global_t *global,
          settings->ints.content_favorites_size = (int)settings->uints.content_history_size;
    }
 
+   retro_vfs_file_set_read_cache_size(settings->sizes.vfs_read_cache_size);
+#ifdef HAVE_ZLIB
+   if (!rzipstream_set_codec(settings->bools.file_compression_zstd
+            ? RZIP_CODEC_ZSTD : RZIP_CODEC_ZLIB))
+      rzipstream_set_codec(RZIP_CODEC_ZLIB);
+#endif
+
    if (conf)
       config_file_free(conf);
    if (bool_settings)
@@ -94,6 +94,7 @@ typedef struct settings
    {
       size_t placeholder;
       size_t rewind_buffer_size;
+      size_t vfs_read_cache_size;
    } sizes;
 
    video_viewport_t video_viewport_custom; /* int alignment */
@@ -953,6 +954,7 @@ typedef struct settings
       bool savestate_thumbnail_enable;
       bool save_file_compression;
       bool savestate_file_compression;
+      bool file_compression_zstd;
       bool network_cmd_enable;
       bool stdin_cmd_enable;
       bool keymapper_enable;
@@ -79,7 +79,7 @@ typedef struct
 } CCJSONContext;
 
 /* Forward declarations */
-static void core_info_free(core_info_t* info);
+static void core_info_free(core_info_t* info, string_pool_t *strings);
 static uint32_t core_info_hash_string(const char *str);
 #ifdef HAVE_CORE_INFO_CACHE
 static core_info_cache_list_t *core_info_cache_list_new(void);
@@ -328,7 +328,7 @@ static bool CCJSONStartObjectHandler(void *context)
    {
       if (pCtx->core_info)
       {
-         core_info_free(pCtx->core_info);
+         core_info_free(pCtx->core_info, NULL);
          free(pCtx->core_info);
          pCtx->core_info = NULL;
       }
@@ -412,25 +412,35 @@ static bool CCJSONEndArrayHandler(void *context)
 /* JSON Handlers END */
 #endif
 
+/* System names, manufacturers, licenses, categories
+ * and databases are the same for many cores: when
+ * 'strings' is not NULL, they are stored once in it */
+static char *core_info_strdup(string_pool_t *strings, const char *str)
+{
+   char *pooled = string_pool_intern(strings, str);
+   return pooled ? pooled : strdup(str);
+}
+
 /* Note: 'dst' must be zero initialised, or memory
  * leaks will occur */
-static void core_info_copy(core_info_t *src, core_info_t *dst)
+static void core_info_copy(core_info_t *src, core_info_t *dst,
+      string_pool_t *strings)
 {
    dst->path                      = src->path                 ? strdup(src->path)                 : NULL;
    dst->display_name              = src->display_name         ? strdup(src->display_name)         : NULL;
    dst->display_version           = src->display_version      ? strdup(src->display_version)      : NULL;
    dst->core_name                 = src->core_name            ? strdup(src->core_name)            : NULL;
-   dst->system_manufacturer       = src->system_manufacturer  ? strdup(src->system_manufacturer)  : NULL;
-   dst->systemname                = src->systemname           ? strdup(src->systemname)           : NULL;
-   dst->system_id                 = src->system_id            ? strdup(src->system_id)            : NULL;
+   dst->system_manufacturer       = src->system_manufacturer  ? core_info_strdup(strings, src->system_manufacturer) : NULL;
+   dst->systemname                = src->systemname           ? core_info_strdup(strings, src->systemname) : NULL;
+   dst->system_id                 = src->system_id            ? core_info_strdup(strings, src->system_id) : NULL;
    dst->supported_extensions      = src->supported_extensions ? strdup(src->supported_extensions) : NULL;
    dst->authors                   = src->authors              ? strdup(src->authors)              : NULL;
-   dst->permissions               = src->permissions          ? strdup(src->permissions)          : NULL;
-   dst->licenses                  = src->licenses             ? strdup(src->licenses)             : NULL;
-   dst->categories                = src->categories           ? strdup(src->categories)           : NULL;
-   dst->databases                 = src->databases            ? strdup(src->databases)            : NULL;
+   dst->permissions               = src->permissions          ? core_info_strdup(strings, src->permissions) : NULL;
+   dst->licenses                  = src->licenses             ? core_info_strdup(strings, src->licenses) : NULL;
+   dst->categories                = src->categories           ? core_info_strdup(strings, src->categories) : NULL;
+   dst->databases                 = src->databases            ? core_info_strdup(strings, src->databases) : NULL;
    dst->notes                     = src->notes                ? strdup(src->notes)                : NULL;
-   dst->required_hw_api           = src->required_hw_api      ? strdup(src->required_hw_api)      : NULL;
+   dst->required_hw_api           = src->required_hw_api      ? core_info_strdup(strings, src->required_hw_api) : NULL;
    dst->description               = src->description          ? strdup(src->description)          : NULL;
 
    dst->categories_list           = src->categories_list           ? string_list_clone(src->categories_list)           : NULL;
@@ -588,7 +598,7 @@ static void core_info_cache_list_free(
    for (i = 0; i < core_info_cache_list->length; i++)
    {
       core_info_t* info = (core_info_t*)&core_info_cache_list->items[i];
-      core_info_free(info);
+      core_info_free(info, NULL);
    }
 
    free(core_info_cache_list->items);
@@ -662,7 +672,7 @@ static void core_info_cache_add(
    if (transfer)
       core_info_transfer(info, info_cache);
    else
-      core_info_copy(info, info_cache);
+      core_info_copy(info, info_cache, NULL);
 
    list->length++;
 }
@@ -782,7 +792,7 @@ static core_info_cache_list_t *core_info_cache_read(const char *info_dir)
     * a parsing error */
    if (context.core_info)
    {
-      core_info_free(context.core_info);
+      core_info_free(context.core_info, NULL);
       free(context.core_info);
    }
 
@@ -1663,6 +1673,22 @@ static config_file_t *core_info_get_config_file(
    return config_file_new_from_path_to_string(core_file_id);
 }
 
+/* Takes over the value of a config entry, or returns
+ * its copy in the string pool */
+static char *core_info_take_string(string_pool_t *strings,
+      struct config_entry_list *entry)
+{
+   char *str = string_pool_intern(strings, entry->value);
+
+   if (!str)
+   {
+      str          = entry->value;
+      entry->value = NULL;
+   }
+
+   return str;
+}
+
 static void core_info_parse_config_file(
       core_info_list_t *list, core_info_t *info,
       config_file_t *conf)
@@ -1696,24 +1722,24 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->systemname = entry->value;
-      entry->value     = NULL;
+      info->systemname = core_info_take_string(
+            list->strings, entry);
    }
 
    entry = config_get_entry(conf, "systemid");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->system_id = entry->value;
-      entry->value    = NULL;
+      info->system_id = core_info_take_string(
+            list->strings, entry);
    }
 
    entry = config_get_entry(conf, "manufacturer");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->system_manufacturer = entry->value;
-      entry->value              = NULL;
+      info->system_manufacturer = core_info_take_string(
+            list->strings, entry);
    }
 
    entry = config_get_entry(conf, "supported_extensions");
@@ -1742,8 +1768,8 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->permissions      = entry->value;
-      entry->value           = NULL;
+      info->permissions      = core_info_take_string(
+            list->strings, entry);
 
       info->permissions_list =
             string_split(info->permissions, "|");
@@ -1753,8 +1779,8 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->licenses      = entry->value;
-      entry->value        = NULL;
+      info->licenses      = core_info_take_string(
+            list->strings, entry);
 
       info->licenses_list =
             string_split(info->licenses, "|");
@@ -1764,8 +1790,8 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->categories      = entry->value;
-      entry->value          = NULL;
+      info->categories      = core_info_take_string(
+            list->strings, entry);
 
       info->categories_list =
             string_split(info->categories, "|");
@@ -1775,8 +1801,8 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->databases      = entry->value;
-      entry->value         = NULL;
+      info->databases      = core_info_take_string(
+            list->strings, entry);
 
       info->databases_list =
             string_split(info->databases, "|");
@@ -1797,8 +1823,8 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->required_hw_api      = entry->value;
-      entry->value               = NULL;
+      info->required_hw_api      = core_info_take_string(
+            list->strings, entry);
 
       info->required_hw_api_list =
             string_split(info->required_hw_api, "|");
@@ -1905,25 +1931,31 @@ static void core_info_list_resolve_all_extensions(
 #endif
 }
 
-static void core_info_free(core_info_t* info)
+static void core_info_free_string(string_pool_t *strings, char *str)
+{
+   if (!string_pool_contains(strings, str))
+      free(str);
+}
+
+static void core_info_free(core_info_t* info, string_pool_t *strings)
 {
    size_t i;
 
    free(info->path);
    free(info->core_name);
-   free(info->systemname);
-   free(info->system_id);
-   free(info->system_manufacturer);
+   core_info_free_string(strings, info->systemname);
+   core_info_free_string(strings, info->system_id);
+   core_info_free_string(strings, info->system_manufacturer);
    free(info->display_name);
    free(info->display_version);
    free(info->supported_extensions);
    free(info->authors);
-   free(info->permissions);
-   free(info->licenses);
-   free(info->categories);
-   free(info->databases);
+   core_info_free_string(strings, info->permissions);
+   core_info_free_string(strings, info->licenses);
+   core_info_free_string(strings, info->categories);
+   core_info_free_string(strings, info->databases);
    free(info->notes);
-   free(info->required_hw_api);
+   core_info_free_string(strings, info->required_hw_api);
    free(info->description);
    string_list_free(info->supported_extensions_list);
    string_list_free(info->authors_list);
@@ -1958,9 +1990,10 @@ static void core_info_list_free(core_info_list_t *core_info_list)
    for (i = 0; i < core_info_list->count; i++)
    {
       core_info_t *info = (core_info_t*)&core_info_list->list[i];
-      core_info_free(info);
+      core_info_free(info, core_info_list->strings);
    }
 
+   string_pool_free(core_info_list->strings);
    free(core_info_list->all_ext);
    free(core_info_list->list);
    free(core_info_list);
@@ -1990,6 +2023,7 @@ static core_info_list_t *core_info_list_new(const char *path,
    core_info_list->count      = 0;
    core_info_list->info_count = 0;
    core_info_list->all_ext    = NULL;
+   core_info_list->strings    = string_pool_new();
 
    if (!(core_info = (core_info_t*)calloc(path_list->core_list->size,
          sizeof(*core_info))))
@@ -2033,7 +2067,8 @@ static core_info_list_t *core_info_list_new(const char *path,
 
          if (info_cache)
          {
-            core_info_copy(info_cache, info);
+            core_info_copy(info_cache, info,
+                  core_info_list->strings);
 
             /* Core path is 'dynamic', and cannot
              * be cached (i.e. core directory may
@@ -21,6 +21,7 @@
 #include <stddef.h>
 
 #include <lists/string_list.h>
+#include <string/string_pool.h>
 #include <retro_common_api.h>
 
 RETRO_BEGIN_DECLS
@@ -126,6 +127,9 @@ typedef struct
 {
    core_info_t *list;
    char *all_ext;
+   /* System names, licenses, databases... shared
+    * by the cores of the list */
+   string_pool_t *strings;
    size_t count;
    size_t info_count;
 } core_info_list_t;
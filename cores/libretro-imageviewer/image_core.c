@@ -34,6 +34,13 @@
 #endif
 #else
 #include <formats/image.h>
+
+/* Handhelds display 16-bit colour: images are loaded as
+ * RGB565 there (PNG ones without a 32-bit intermediate),
+ * instead of having the frontend convert every frame */
+#if defined(DINGUX) || defined(MIYOO) || defined(_3DS) || defined(PSP)
+#define IMAGE_CORE_RGB565
+#endif
 #endif
 
 #include <libretro.h>
@@ -63,6 +70,14 @@ static bool      image_uploaded;
 static bool      slideshow_enable;
 static struct string_list *image_file_list;
 
+#ifdef IMAGE_CORE_RGB565
+#define IMAGE_CORE_PIXEL_FORMAT RETRO_PIXEL_FORMAT_RGB565
+#define IMAGE_CORE_PIXEL_SIZE   sizeof(uint16_t)
+#else
+#define IMAGE_CORE_PIXEL_FORMAT RETRO_PIXEL_FORMAT_XRGB8888
+#define IMAGE_CORE_PIXEL_SIZE   sizeof(uint32_t)
+#endif
+
 #if 0
 #define DUPE_TEST
 #endif
@@ -262,6 +277,12 @@ static bool imageviewer_load(const char *path, int image_index)
          &image_width, &image_height,
          &comp, 4);
    free(buf);
+#elif defined(IMAGE_CORE_RGB565)
+   if (!image_texture_load_rgb565(&image_texture, path))
+      return false;
+   image_buffer = (uint32_t*)image_texture.pixels;
+   image_width  = image_texture.width;
+   image_height = image_texture.height;
 #else
 #ifdef RARCH_INTERNAL
    image_texture.supports_rgba = video_driver_supports_rgba();
@@ -282,7 +303,7 @@ static bool imageviewer_load(const char *path, int image_index)
 
 bool IMAGE_CORE_PREFIX(retro_load_game)(const struct retro_game_info *info)
 {
-   enum retro_pixel_format fmt = RETRO_PIXEL_FORMAT_XRGB8888;
+   enum retro_pixel_format fmt = IMAGE_CORE_PIXEL_FORMAT;
    char *dir                   = strdup(info->path);
 
    slideshow_enable            = false;
@@ -297,7 +318,8 @@ bool IMAGE_CORE_PREFIX(retro_load_game)(const struct retro_game_info *info)
    if (!IMAGE_CORE_PREFIX(environ_cb)(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
    {
       if (IMAGE_CORE_PREFIX(log_cb))
-         IMAGE_CORE_PREFIX(log_cb)(RETRO_LOG_INFO, "XRGB8888 is not supported.\n");
+         IMAGE_CORE_PREFIX(log_cb)(RETRO_LOG_INFO, "%s is not supported.\n",
+               (fmt == RETRO_PIXEL_FORMAT_RGB565) ? "RGB565" : "XRGB8888");
       return false;
    }
 
@@ -483,13 +505,13 @@ void IMAGE_CORE_PREFIX(retro_run)(void)
 #ifdef DUPE_TEST
    if (!image_uploaded)
    {
-      IMAGE_CORE_PREFIX(video_cb)(image_buffer, image_width, image_height, image_width * sizeof(uint32_t));
+      IMAGE_CORE_PREFIX(video_cb)(image_buffer, image_width, image_height, image_width * IMAGE_CORE_PIXEL_SIZE);
       image_uploaded = true;
    }
    else
-      IMAGE_CORE_PREFIX(video_cb)(NULL, image_width, image_height, image_width * sizeof(uint32_t));
+      IMAGE_CORE_PREFIX(video_cb)(NULL, image_width, image_height, image_width * IMAGE_CORE_PIXEL_SIZE);
 #else
-   IMAGE_CORE_PREFIX(video_cb)(image_buffer, image_width, image_height, image_width * sizeof(uint32_t));
+   IMAGE_CORE_PREFIX(video_cb)(image_buffer, image_width, image_height, image_width * IMAGE_CORE_PIXEL_SIZE);
 #endif
    frames++;
 }
@@ -473,14 +473,12 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
    struct rmsgpack_dom_value item;
    const char* str                = NULL;
 
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
+   /* Every value needed is copied below */
+   if (libretrodb_cursor_read_item_borrowed(cur, &item) != 0)
       return -1;
 
    if (item.type != RDT_MAP)
-   {
-      rmsgpack_dom_value_free(&item);
       return 1;
-   }
 
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
@@ -688,10 +686,10 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
                db_info->crc32 = *(uint8_t*)val->val.binary.buff;
                break;
             case 2:
-               db_info->crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
+               db_info->crc32 = retro_get_unaligned_16be(val->val.binary.buff);
                break;
             case 4:
-               db_info->crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
+               db_info->crc32 = retro_get_unaligned_32be(val->val.binary.buff);
                break;
             default:
                db_info->crc32 = 0;
@@ -706,8 +704,6 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
                (uint8_t*)val->val.binary.buff, val->val.binary.len);
    }
 
-   rmsgpack_dom_value_free(&item);
-
    return 0;
 }
 
@@ -240,6 +240,9 @@ typedef struct
    struct font_atlas *atlas;
 
    video_font_raster_block_t *block;
+   font_layout_cache_t *layout_cache;
+
+   font_advance_table_t advances;
 } gl2_raster_t;
 
 #if defined(__arm__) || defined(__aarch64__)
@@ -365,6 +368,9 @@ static bool scissor_is_outside_rectangle(
 #define MALI_BUG
 #endif
 
+/* Quads waiting to be drawn by gfx_display_gl2_flush() */
+static gfx_display_batch_t gl2_display_batch;
+
 static const float *gfx_display_gl2_get_default_vertices(void)
 {
    return &gl2_vertexes[0];
@@ -402,10 +408,50 @@ static GLenum gfx_display_prim_to_gl_enum(
    return 0;
 }
 
+static void gfx_display_gl2_draw_immediate(gl2_t *gl,
+      gfx_display_ctx_draw_t *draw)
+{
+   if (!draw->coords->vertex)
+      draw->coords->vertex        = &gl2_vertexes[0];
+   if (!draw->coords->tex_coord)
+      draw->coords->tex_coord     = &gl2_tex_coords[0];
+   if (!draw->coords->lut_tex_coord)
+      draw->coords->lut_tex_coord = &gl2_tex_coords[0];
+
+   glViewport(draw->x, draw->y, draw->width, draw->height);
+   glBindTexture(GL_TEXTURE_2D, (GLuint)draw->texture);
+
+   gl->shader->set_coords(gl->shader_data, draw->coords);
+   gl->shader->set_mvp(gl->shader_data,
+         draw->matrix_data ? (math_matrix_4x4*)draw->matrix_data
+      : (math_matrix_4x4*)&gl->mvp_no_rot);
+
+
+   glDrawArrays(gfx_display_prim_to_gl_enum(
+            draw->prim_type), 0, draw->coords->vertices);
+
+   gl->coords.color     = gl->white_color_ptr;
+}
+
+/* Submits the quads queued by gfx_display_gl2_draw().
+ * Must be called before anything else touches the
+ * GL state the queued quads depend on. */
+static void gfx_display_gl2_flush(gl2_t *gl)
+{
+   gfx_display_ctx_draw_t draw;
+   struct video_coords coords;
+
+   if (gl && gfx_display_batch_prepare(&gl2_display_batch,
+            &draw, &coords))
+      gfx_display_gl2_draw_immediate(gl, &draw);
+}
+
 static void gfx_display_gl2_blend_begin(void *data)
 {
    gl2_t             *gl          = (gl2_t*)data;
 
+   gfx_display_gl2_flush(gl);
+
    glEnable(GL_BLEND);
    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -415,6 +461,7 @@ static void gfx_display_gl2_blend_begin(void *data)
 
 static void gfx_display_gl2_blend_end(void *data)
 {
+   gfx_display_gl2_flush((gl2_t*)data);
    glDisable(GL_BLEND);
 }
 
@@ -508,26 +555,21 @@ static void gfx_display_gl2_draw(gfx_display_ctx_draw_t *draw,
    }
 #endif
 
-   if (!draw->coords->vertex)
-      draw->coords->vertex        = &gl2_vertexes[0];
-   if (!draw->coords->tex_coord)
-      draw->coords->tex_coord     = &gl2_tex_coords[0];
-   if (!draw->coords->lut_tex_coord)
-      draw->coords->lut_tex_coord = &gl2_tex_coords[0];
-
-   glViewport(draw->x, draw->y, draw->width, draw->height);
-   glBindTexture(GL_TEXTURE_2D, (GLuint)draw->texture);
-
-   gl->shader->set_coords(gl->shader_data, draw->coords);
-   gl->shader->set_mvp(gl->shader_data,
-         draw->matrix_data ? (math_matrix_4x4*)draw->matrix_data
-      : (math_matrix_4x4*)&gl->mvp_no_rot);
-
-
-   glDrawArrays(gfx_display_prim_to_gl_enum(
-            draw->prim_type), 0, draw->coords->vertices);
+   /* Queue plain quads; consecutive quads sharing a
+    * texture are then drawn with a single call */
+   if (gfx_display_batch_accepts(draw, &gl->mvp_no_rot))
+   {
+      if (gfx_display_batch_needs_flush(&gl2_display_batch,
+               draw->texture, video_width, video_height))
+         gfx_display_gl2_flush(gl);
+      gfx_display_batch_append(&gl2_display_batch, draw,
+            &gl2_vertexes[0], &gl2_tex_coords[0],
+            video_width, video_height);
+      return;
+   }
 
-   gl->coords.color     = gl->white_color_ptr;
+   gfx_display_gl2_flush(gl);
+   gfx_display_gl2_draw_immediate(gl, draw);
 }
 
 static void gfx_display_gl2_draw_pipeline(
@@ -543,6 +585,8 @@ static void gfx_display_gl2_draw_pipeline(
    static float t                   = 0;
    video_coord_array_t *ca          = &p_disp->dispca;
 
+   gfx_display_gl2_flush(gl);
+
    draw->x                          = 0;
    draw->y                          = 0;
    draw->coords                     = (struct video_coords*)(&ca->coords);
@@ -617,6 +661,7 @@ static void gfx_display_gl2_scissor_begin(
       int x, int y,
       unsigned width, unsigned height)
 {
+   gfx_display_gl2_flush((gl2_t*)data);
    glScissor(x, video_height - y - height, width, height);
    glEnable(GL_SCISSOR_TEST);
 #ifdef MALI_BUG
@@ -637,6 +682,7 @@ static void gfx_display_gl2_scissor_end(
       unsigned video_width,
       unsigned video_height)
 {
+   gfx_display_gl2_flush((gl2_t*)data);
    glScissor(0, 0, video_width, video_height);
    glDisable(GL_SCISSOR_TEST);
 #ifdef MALI_BUG
@@ -657,7 +703,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_gl = {
    "gl",
    false,
    gfx_display_gl2_scissor_begin,
-   gfx_display_gl2_scissor_end
+   gfx_display_gl2_scissor_end,
+   true                                   /* batched */
 };
 
 /**
@@ -673,6 +720,8 @@ static void gl2_raster_font_free(void *data,
    if (font->font_driver && font->font_data)
       font->font_driver->free(font->font_data);
 
+   font_layout_cache_free(font->layout_cache);
+
    if (is_threaded)
    {
       if (
@@ -770,6 +819,8 @@ static void *gl2_raster_font_init(void *data,
 
    font->atlas->dirty = false;
 
+   font->layout_cache = font_layout_cache_new();
+
    if (font->gl)
       glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
 
@@ -779,33 +830,15 @@ static void *gl2_raster_font_init(void *data,
 static int gl2_raster_font_get_message_width(void *data, const char *msg,
       size_t msg_len, float scale)
 {
-   const struct font_glyph* glyph_q = NULL;
-   gl2_raster_t *font               = (gl2_raster_t*)data;
-   const char* msg_end              = msg + msg_len;
-   int delta_x                      = 0;
+   gl2_raster_t *font = (gl2_raster_t*)data;
 
    if (     !font
          || !font->font_driver
          || !font->font_data )
       return 0;
 
-   glyph_q = font->font_driver->get_glyph(font->font_data, '?');
-
-   while (msg < msg_end)
-   {
-      const struct font_glyph *glyph;
-      unsigned code                  = utf8_walk(&msg);
-
-      /* Do something smarter here ... */
-      if (!(glyph = font->font_driver->get_glyph(
-            font->font_data, code)))
-         if (!(glyph = glyph_q))
-            continue;
-
-      delta_x += glyph->advance_x;
-   }
-
-   return delta_x * scale;
+   return font_advance_table_get_width(&font->advances,
+         font->font_driver, font->font_data, msg, msg_len, scale);
 }
 
 static void gl2_raster_font_draw_vertices(gl2_t *gl,
@@ -947,6 +980,7 @@ static void gl2_raster_font_setup_viewport(
       unsigned width, unsigned height,
       bool full_screen)
 {
+   gfx_display_gl2_flush(gl);
    gl2_set_viewport(gl, width, height, full_screen, true);
 
    glEnable(GL_BLEND);
@@ -969,6 +1003,9 @@ static void gl2_raster_font_render_msg(
    GLfloat color[4];
    int drop_x, drop_y;
    GLfloat x, y, scale, drop_mod, drop_alpha;
+   font_layout_params_t layout;
+   unsigned layout_first             = 0;
+   bool cache_layout                 = false;
    enum text_alignment text_align    = TEXT_ALIGN_LEFT;
    bool full_screen                  = false ;
    gl2_raster_t                *font = (gl2_raster_t*)data;
@@ -1030,6 +1067,43 @@ static void gl2_raster_font_render_msg(
    else
       gl2_raster_font_setup_viewport(gl, font, width, height, full_screen);
 
+   /* Reuse the vertices of the last time this exact
+    * message was drawn into a block */
+   if (     font->block
+         && font->layout_cache
+         && strlen(msg) < FONT_LAYOUT_CACHE_MAX_MSG)
+   {
+      video_coords_t coords;
+
+      memset(&layout, 0, sizeof(layout));
+      layout.x                = x;
+      layout.y                = y;
+      layout.scale            = scale;
+      layout.drop_mod         = drop_mod;
+      layout.drop_alpha       = drop_alpha;
+      layout.color[0]         = color[0];
+      layout.color[1]         = color[1];
+      layout.color[2]         = color[2];
+      layout.color[3]         = color[3];
+      layout.drop_x           = drop_x;
+      layout.drop_y           = drop_y;
+      layout.viewport_width   = gl->vp.width;
+      layout.viewport_height  = gl->vp.height;
+      layout.atlas_generation = font->atlas->generation;
+      layout.text_align       = text_align;
+      layout.full_screen      = full_screen;
+
+      if (font_layout_cache_get(font->layout_cache, msg, &layout, &coords))
+      {
+         video_coord_array_append(&font->block->carr,
+               &coords, coords.vertices);
+         return;
+      }
+
+      layout_first = font->block->carr.coords.vertices;
+      cache_layout = true;
+   }
+
    if (    !string_is_empty(msg)
          && font->font_data
          && font->font_driver)
@@ -1052,6 +1126,11 @@ static void gl2_raster_font_render_msg(
             x, y, text_align);
    }
 
+   /* Glyphs evicted while laying out invalidate the result */
+   if (cache_layout && font->atlas->generation == layout.atlas_generation)
+      font_layout_cache_put(font->layout_cache, msg, &layout,
+            &font->block->carr, layout_first);
+
    if (!font->block)
    {
       /* Restore viewport */
@@ -3650,6 +3729,7 @@ static bool gl2_frame(void *data, const void *frame,
    if (gl->flags & GL2_FLAG_MENU_TEXTURE_ENABLE)
    {
       menu_driver_frame(menu_is_alive, video_info);
+      gfx_display_gl2_flush(gl);
 
       if (gl->menu_texture)
          gl2_draw_texture(gl);
@@ -3669,7 +3749,10 @@ static bool gl2_frame(void *data, const void *frame,
 
 #ifdef HAVE_GFX_WIDGETS
    if (widgets_active)
+   {
       gfx_widgets_frame(video_info);
+      gfx_display_gl2_flush(gl);
+   }
 #endif
 
    if (!string_is_empty(msg))
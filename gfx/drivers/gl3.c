@@ -89,6 +89,7 @@ static void gl3_set_viewport(gl3_t *gl,
       unsigned viewport_width,
       unsigned viewport_height,
       bool force_full, bool allow_rotate);
+static void gfx_display_gl3_flush(gl3_t *gl);
 
 /**
  * GL3 COMMON
@@ -110,6 +111,9 @@ static void gl3_bind_scratch_vbo(gl3_t *gl, const void *data, size_t size)
  * DISPLAY DRIVER
  */
 
+/* Quads waiting to be drawn by gfx_display_gl3_flush() */
+static gfx_display_batch_t gl3_display_batch;
+
 static void *gfx_display_gl3_get_default_mvp(void *data)
 {
    gl3_t *gl3 = (gl3_t*)data;
@@ -147,6 +151,8 @@ static void gfx_display_gl3_draw_pipeline(
    if (!gl || !draw)
       return;
 
+   gfx_display_gl3_flush(gl);
+
    draw->x                       = 0;
    draw->y                       = 0;
    draw->matrix_data             = NULL;
@@ -204,21 +210,17 @@ static void gfx_display_gl3_draw_pipeline(
 #endif
 }
 
-static void gfx_display_gl3_draw(gfx_display_ctx_draw_t *draw,
-      void *data, unsigned video_width, unsigned video_height)
+static void gfx_display_gl3_draw_immediate(gl3_t *gl,
+      gfx_display_ctx_draw_t *draw)
 {
    const float *vertex       = NULL;
    const float *tex_coord    = NULL;
    const float *color        = NULL;
    GLuint            texture = 0;
-   gl3_t *gl                 = (gl3_t*)data;
    const struct
       gl3_buffer_locations
       *loc                   = NULL;
 
-   if (!gl || !draw)
-      return;
-
    texture            = (GLuint)draw->texture;
    vertex             = draw->coords->vertex;
    tex_coord          = draw->coords->tex_coord;
@@ -341,10 +343,50 @@ static void gfx_display_gl3_draw(gfx_display_ctx_draw_t *draw,
    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+/* Submits the quads queued by gfx_display_gl3_draw().
+ * Must be called before anything else touches the
+ * GL state the queued quads depend on. */
+static void gfx_display_gl3_flush(gl3_t *gl)
+{
+   gfx_display_ctx_draw_t draw;
+   struct video_coords coords;
+
+   if (gl && gfx_display_batch_prepare(&gl3_display_batch,
+            &draw, &coords))
+      gfx_display_gl3_draw_immediate(gl, &draw);
+}
+
+static void gfx_display_gl3_draw(gfx_display_ctx_draw_t *draw,
+      void *data, unsigned video_width, unsigned video_height)
+{
+   gl3_t *gl                 = (gl3_t*)data;
+
+   if (!gl || !draw)
+      return;
+
+   /* Queue plain quads; consecutive quads sharing a
+    * texture are then drawn with a single call */
+   if (gfx_display_batch_accepts(draw, &gl->mvp_no_rot))
+   {
+      if (gfx_display_batch_needs_flush(&gl3_display_batch,
+               draw->texture, video_width, video_height))
+         gfx_display_gl3_flush(gl);
+      gfx_display_batch_append(&gl3_display_batch, draw,
+            &gl3_vertexes[0], &gl3_tex_coords[0],
+            video_width, video_height);
+      return;
+   }
+
+   gfx_display_gl3_flush(gl);
+   gfx_display_gl3_draw_immediate(gl, draw);
+}
+
 static void gfx_display_gl3_blend_begin(void *data)
 {
    gl3_t *gl = (gl3_t*)data;
 
+   gfx_display_gl3_flush(gl);
+
    glEnable(GL_BLEND);
    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
    glUseProgram(gl->pipelines.alpha_blend);
@@ -352,6 +394,7 @@ static void gfx_display_gl3_blend_begin(void *data)
 
 static void gfx_display_gl3_blend_end(void *data)
 {
+   gfx_display_gl3_flush((gl3_t*)data);
    glDisable(GL_BLEND);
 }
 
@@ -360,6 +403,7 @@ static void gfx_display_gl3_scissor_begin(void *data,
       unsigned video_height,
       int x, int y, unsigned width, unsigned height)
 {
+   gfx_display_gl3_flush((gl3_t*)data);
    glScissor(x, video_height - y - height, width, height);
    glEnable(GL_SCISSOR_TEST);
 }
@@ -369,6 +413,7 @@ static void gfx_display_gl3_scissor_end(
       unsigned video_width,
       unsigned video_height)
 {
+   gfx_display_gl3_flush((gl3_t*)data);
    glDisable(GL_SCISSOR_TEST);
 }
 
@@ -385,7 +430,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_gl3 = {
    "glcore",
    false,
    gfx_display_gl3_scissor_begin,
-   gfx_display_gl3_scissor_end
+   gfx_display_gl3_scissor_end,
+   true                                   /* batched */
 };
 
 /**
@@ -416,6 +462,9 @@ typedef struct
    struct font_atlas *atlas;
 
    video_font_raster_block_t *block;
+   font_layout_cache_t *layout_cache;
+
+   font_advance_table_t advances;
 } gl3_raster_t;
 
 static void gl3_raster_font_free(void *data,
@@ -428,6 +477,8 @@ static void gl3_raster_font_free(void *data,
    if (font->font_driver && font->font_data)
       font->font_driver->free(font->font_data);
 
+   font_layout_cache_free(font->layout_cache);
+
    if (is_threaded)
       if (
             font->gl &&
@@ -491,39 +542,23 @@ static void *gl3_raster_font_init(void *data,
    gl3_raster_font_upload_atlas(font);
 
    font->atlas->dirty = false;
+
+   font->layout_cache = font_layout_cache_new();
    return font;
 }
 
 static int gl3_raster_font_get_message_width(void *data, const char *msg,
       size_t msg_len, float scale)
 {
-   const struct font_glyph* glyph_q = NULL;
-   gl3_raster_t *font   = (gl3_raster_t*)data;
-   const char* msg_end = msg + msg_len;
-   int delta_x         = 0;
+   gl3_raster_t *font = (gl3_raster_t*)data;
 
    if (     !font
          || !font->font_driver
          || !font->font_data )
       return 0;
 
-   glyph_q = font->font_driver->get_glyph(font->font_data, '?');
-
-   while (msg < msg_end)
-   {
-      const struct font_glyph *glyph;
-      unsigned code                  = utf8_walk(&msg);
-
-      /* Do something smarter here ... */
-      if (!(glyph = font->font_driver->get_glyph(
-            font->font_data, code)))
-         if (!(glyph = glyph_q))
-            continue;
-
-      delta_x += glyph->advance_x;
-   }
-
-   return delta_x * scale;
+   return font_advance_table_get_width(&font->advances,
+         font->font_driver, font->font_data, msg, msg_len, scale);
 }
 
 static void gl3_raster_font_draw_vertices(gl3_t *gl,
@@ -701,6 +736,7 @@ static void gl3_raster_font_setup_viewport(
       unsigned width, unsigned height,
       gl3_raster_t *font, bool full_screen)
 {
+   gfx_display_gl3_flush(gl);
    gl3_set_viewport(gl, width, height, full_screen, false);
 
    glEnable(GL_BLEND);
@@ -718,6 +754,9 @@ static void gl3_raster_font_render_msg(
    GLfloat color[4];
    int drop_x, drop_y;
    GLfloat x, y, scale, drop_mod, drop_alpha;
+   font_layout_params_t layout;
+   unsigned layout_first            = 0;
+   bool cache_layout                = false;
    enum text_alignment text_align   = TEXT_ALIGN_LEFT;
    bool full_screen                 = false;
    gl3_raster_t           *font     = (gl3_raster_t*)data;
@@ -779,6 +818,43 @@ static void gl3_raster_font_render_msg(
    else
       gl3_raster_font_setup_viewport(gl, width, height, font, full_screen);
 
+   /* Reuse the vertices of the last time this exact
+    * message was drawn into a block */
+   if (     font->block
+         && font->layout_cache
+         && strlen(msg) < FONT_LAYOUT_CACHE_MAX_MSG)
+   {
+      video_coords_t coords;
+
+      memset(&layout, 0, sizeof(layout));
+      layout.x                = x;
+      layout.y                = y;
+      layout.scale            = scale;
+      layout.drop_mod         = drop_mod;
+      layout.drop_alpha       = drop_alpha;
+      layout.color[0]         = color[0];
+      layout.color[1]         = color[1];
+      layout.color[2]         = color[2];
+      layout.color[3]         = color[3];
+      layout.drop_x           = drop_x;
+      layout.drop_y           = drop_y;
+      layout.viewport_width   = gl->vp.width;
+      layout.viewport_height  = gl->vp.height;
+      layout.atlas_generation = font->atlas->generation;
+      layout.text_align       = text_align;
+      layout.full_screen      = full_screen;
+
+      if (font_layout_cache_get(font->layout_cache, msg, &layout, &coords))
+      {
+         video_coord_array_append(&font->block->carr,
+               &coords, coords.vertices);
+         return;
+      }
+
+      layout_first = font->block->carr.coords.vertices;
+      cache_layout = true;
+   }
+
    if (!string_is_empty(msg)
          && font->font_data  && font->font_driver)
    {
@@ -800,6 +876,11 @@ static void gl3_raster_font_render_msg(
             x, y, text_align);
    }
 
+   /* Glyphs evicted while laying out invalidate the result */
+   if (cache_layout && font->atlas->generation == layout.atlas_generation)
+      font_layout_cache_put(font->layout_cache, msg, &layout,
+            &font->block->carr, layout_first);
+
    if (!font->block)
    {
       glDisable(GL_BLEND);
@@ -2608,6 +2689,7 @@ static bool gl3_frame(void *data, const void *frame,
    if (gl->flags & GL3_FLAG_MENU_TEXTURE_ENABLE)
    {
       menu_driver_frame(menu_is_alive, video_info);
+      gfx_display_gl3_flush(gl);
       if (gl->menu_texture)
          gl3_draw_menu_texture(gl, width, height);
    }
@@ -2626,7 +2708,10 @@ static bool gl3_frame(void *data, const void *frame,
 
 #ifdef HAVE_GFX_WIDGETS
    if (widgets_active)
+   {
       gfx_widgets_frame(video_info);
+      gfx_display_gl3_flush(gl);
+   }
 #endif
 
    if (!string_is_empty(msg))
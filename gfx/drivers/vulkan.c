@@ -1046,6 +1046,11 @@ static const float vk_colors[16] = {
    1.0f, 1.0f, 1.0f, 1.0f,
 };
 
+/* Quads waiting to be recorded by gfx_display_vk_flush() */
+static gfx_display_batch_t vk_display_batch;
+
+static void gfx_display_vk_flush(vk_t *vk);
+
 static void *gfx_display_vk_get_default_mvp(void *data)
 {
    vk_t *vk = (vk_t*)data;
@@ -1102,6 +1107,8 @@ static void gfx_display_vk_draw_pipeline(
    if (!vk || !draw)
       return;
 
+   gfx_display_vk_flush(vk);
+
    draw->x                          = 0;
    draw->y                          = 0;
    draw->matrix_data                = NULL;
@@ -1159,8 +1166,8 @@ static void gfx_display_vk_draw_pipeline(
 }
 #endif
 
-static void gfx_display_vk_draw(gfx_display_ctx_draw_t *draw,
-      void *data, unsigned video_width, unsigned video_height)
+static void gfx_display_vk_draw_immediate(vk_t *vk,
+      gfx_display_ctx_draw_t *draw)
 {
    unsigned i;
    struct vk_buffer_range range;
@@ -1169,10 +1176,6 @@ static void gfx_display_vk_draw(gfx_display_ctx_draw_t *draw,
    const float *tex_coord        = NULL;
    const float *color            = NULL;
    struct vk_vertex *pv          = NULL;
-   vk_t *vk                      = (vk_t*)data;
-
-   if (!vk || !draw)
-      return;
 
    texture                        = (struct vk_texture*)draw->texture;
    vertex                         = draw->coords->vertex;
@@ -1270,12 +1273,53 @@ static void gfx_display_vk_draw(gfx_display_ctx_draw_t *draw,
    }
 }
 
+/* Records the quads queued by gfx_display_vk_draw().
+ * Must be called before anything else touches the
+ * state the queued quads depend on. */
+static void gfx_display_vk_flush(vk_t *vk)
+{
+   gfx_display_ctx_draw_t draw;
+   struct video_coords coords;
+
+   if (vk && gfx_display_batch_prepare(&vk_display_batch,
+            &draw, &coords))
+      gfx_display_vk_draw_immediate(vk, &draw);
+}
+
+static void gfx_display_vk_draw(gfx_display_ctx_draw_t *draw,
+      void *data, unsigned video_width, unsigned video_height)
+{
+   vk_t *vk                      = (vk_t*)data;
+
+   if (!vk || !draw)
+      return;
+
+   /* Queue plain quads; consecutive quads sharing a
+    * texture are then drawn with a single call */
+   if (gfx_display_batch_accepts(draw, &vk->mvp_no_rot))
+   {
+      if (gfx_display_batch_needs_flush(&vk_display_batch,
+               draw->texture, video_width, video_height))
+         gfx_display_vk_flush(vk);
+      gfx_display_batch_append(&vk_display_batch, draw,
+            &vk_vertexes[0], &vk_tex_coords[0],
+            video_width, video_height);
+      return;
+   }
+
+   gfx_display_vk_flush(vk);
+   gfx_display_vk_draw_immediate(vk, draw);
+}
+
 static void gfx_display_vk_blend_begin(void *data)
 {
    vk_t *vk = (vk_t*)data;
 
    if (vk)
+   {
+      gfx_display_vk_flush(vk);
       vk->flags |=  VK_FLAG_DISPLAY_BLEND;
+   }
 }
 
 static void gfx_display_vk_blend_end(void *data)
@@ -1283,7 +1327,10 @@ static void gfx_display_vk_blend_end(void *data)
    vk_t *vk = (vk_t*)data;
 
    if (vk)
+   {
+      gfx_display_vk_flush(vk);
       vk->flags &= ~VK_FLAG_DISPLAY_BLEND;
+   }
 }
 
 static void gfx_display_vk_scissor_begin(
@@ -1294,6 +1341,8 @@ static void gfx_display_vk_scissor_begin(
 {
    vk_t *vk                          = (vk_t*)data;
 
+   gfx_display_vk_flush(vk);
+
    vk->tracker.scissor.offset.x      = x;
    vk->tracker.scissor.offset.y      = y;
    vk->tracker.scissor.extent.width  = width;
@@ -1308,6 +1357,8 @@ static void gfx_display_vk_scissor_end(void *data,
 {
    vk_t *vk                 = (vk_t*)data;
 
+   gfx_display_vk_flush(vk);
+
    vk->flags               &= ~VK_FLAG_TRACKER_USE_SCISSOR;
    vk->tracker.dirty       |=  VULKAN_DIRTY_DYNAMIC_BIT;
 }
@@ -1329,7 +1380,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_vulkan = {
    "vulkan",
    false,
    gfx_display_vk_scissor_begin,
-   gfx_display_vk_scissor_end
+   gfx_display_vk_scissor_end,
+   true                                   /* batched */
 };
 
 /**
@@ -1673,6 +1725,8 @@ static void vulkan_font_render_msg(
    if (!font || !msg || !*msg || !vk)
       return;
 
+   gfx_display_vk_flush(vk);
+
    width          = vk->video_width;
    height         = vk->video_height;
 
@@ -4367,6 +4421,7 @@ static bool vulkan_frame(void *data, const void *frame,
       if (vk->flags & VK_FLAG_MENU_ENABLE)
       {
          menu_driver_frame(menu_is_alive, video_info);
+         gfx_display_vk_flush(vk);
 
          if (vk->menu.textures[vk->menu.last_index].image  != VK_NULL_HANDLE ||
              vk->menu.textures[vk->menu.last_index].buffer != VK_NULL_HANDLE)
@@ -4419,7 +4474,10 @@ static bool vulkan_frame(void *data, const void *frame,
 
 #ifdef HAVE_GFX_WIDGETS
       if (widgets_active)
+      {
          gfx_widgets_frame(video_info);
+         gfx_display_vk_flush(vk);
+      }
 #endif
 
       /* End the render pass. We're done rendering to backbuffer now. */
@@ -123,6 +123,9 @@ static freetype_atlas_slot_t* font_renderer_get_slot(ft_font_renderer_t *handle)
       ptr->next = handle->atlas_slots[oldest].next;
    }
 
+   /* Text laid out against the evicted glyph is stale */
+   handle->atlas.generation++;
+
    return &handle->atlas_slots[oldest];
 }
 
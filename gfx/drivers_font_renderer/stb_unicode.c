@@ -105,6 +105,9 @@ static stb_unicode_atlas_slot_t* font_renderer_stb_unicode_get_slot(stb_unicode_
       ptr->next = handle->atlas_slots[oldest].next;
    }
 
+   /* Text laid out against the evicted glyph is stale */
+   handle->atlas.generation++;
+
    return &handle->atlas_slots[oldest];
 }
 
@@ -45,25 +45,31 @@ struct SlangProcess
       TBuiltInResource Resources;
 };
 
-/* We don't use glslang from multiple threads, but to be sure.
+/* Shader passes may be compiled from several threads at once
+ * (see glslang_compile_shaders()), so the process is reference
+ * counted: it is initialized by the first compile and torn down
+ * again once the last concurrent compile has finished.
  * Initializing TLS and freeing it for glslang works around 
  * a really bizarre issue where the TLS key is suddenly 
  * corrupted *somehow*.
  */
 static std::mutex glslang_global_lock;
+static unsigned glslang_process_refcount = 0;
 
 struct SlangProcessHolder
 {
    SlangProcessHolder()
    {
-      glslang_global_lock.lock();
-      InitializeProcess();
+      std::lock_guard<std::mutex> lock(glslang_global_lock);
+      if (glslang_process_refcount++ == 0)
+         InitializeProcess();
    }
 
    ~SlangProcessHolder()
    {
-      FinalizeProcess();
-      glslang_global_lock.unlock();
+      std::lock_guard<std::mutex> lock(glslang_global_lock);
+      if (--glslang_process_refcount == 0)
+         FinalizeProcess();
    }
 };
 
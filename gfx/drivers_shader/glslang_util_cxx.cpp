@@ -17,8 +17,11 @@
 #include <string.h>
 #include <string>
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
 #include <file/file_path.h>
 #include <file/config_file.h>
 #include <streams/file_stream.h>
@@ -28,6 +31,10 @@
 #include "../../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "glslang_util.h"
 #include "glslang_util_cxx.h"
 #if defined(HAVE_GLSLANG)
@@ -250,3 +257,103 @@ error:
 
    return false;
 }
+
+struct glslang_compile_batch
+{
+   const char **shader_paths;
+   glslang_output *outputs;
+   bool *results;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   unsigned num_shaders;
+   unsigned next_shader;
+};
+
+static void glslang_compile_batch_worker(void *data)
+{
+   struct glslang_compile_batch *batch = (struct glslang_compile_batch*)data;
+
+   for (;;)
+   {
+      unsigned i;
+#ifdef HAVE_THREADS
+      slock_lock(batch->lock);
+#endif
+      i = batch->next_shader++;
+#ifdef HAVE_THREADS
+      slock_unlock(batch->lock);
+#endif
+      if (i >= batch->num_shaders)
+         break;
+
+      batch->results[i] = glslang_compile_shader(
+            batch->shader_paths[i], &batch->outputs[i]);
+   }
+}
+
+bool glslang_compile_shaders(const char **shader_paths,
+      glslang_output *outputs, unsigned num_shaders,
+      unsigned *failed_index)
+{
+   unsigned i;
+   struct glslang_compile_batch batch;
+   std::unique_ptr<bool[]> results(new bool[num_shaders]());
+#ifdef HAVE_THREADS
+   std::vector<sthread_t*> workers;
+   unsigned num_workers = cpu_features_get_core_amount();
+
+   /* The calling thread takes part in compiling as well */
+   if (num_workers > num_shaders)
+      num_workers = num_shaders;
+   if (num_workers > 0)
+      num_workers--;
+#endif
+
+   batch.shader_paths = shader_paths;
+   batch.outputs      = outputs;
+   batch.results      = results.get();
+   batch.num_shaders  = num_shaders;
+   batch.next_shader  = 0;
+
+#ifdef HAVE_THREADS
+   if (!(batch.lock = slock_new()))
+      num_workers = 0;
+
+   for (i = 0; i < num_workers; i++)
+   {
+      sthread_t *worker = sthread_create(
+            glslang_compile_batch_worker, &batch);
+      if (!worker)
+         break;
+      workers.push_back(worker);
+   }
+
+   if (!workers.empty())
+      RARCH_LOG("[slang]: Compiling %u shaders on %u threads.\n",
+            num_shaders, (unsigned)workers.size() + 1);
+#endif
+
+   glslang_compile_batch_worker(&batch);
+
+#ifdef HAVE_THREADS
+   for (i = 0; i < workers.size(); i++)
+      sthread_join(workers[i]);
+   if (batch.lock)
+      slock_free(batch.lock);
+#endif
+
+   /* Report the first failure in preset order, regardless
+    * of the order in which the workers finished. */
+   for (i = 0; i < num_shaders; i++)
+   {
+      if (!results[i])
+      {
+         if (failed_index)
+            *failed_index = i;
+         return false;
+      }
+   }
+
+   return true;
+}
@@ -55,6 +55,14 @@ struct glslang_output
 
 bool glslang_compile_shader(const char *shader_path, glslang_output *output);
 
+/* Compiles num_shaders shaders into outputs[], spreading the
+ * work over one thread per CPU core where available.
+ * Returns false if any shader failed to compile, with
+ * *failed_index set to the lowest failing index. */
+bool glslang_compile_shaders(const char **shader_paths,
+      glslang_output *outputs, unsigned num_shaders,
+      unsigned *failed_index);
+
 /* Helpers for internal use. */
 bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta);
 
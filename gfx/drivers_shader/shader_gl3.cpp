@@ -2444,6 +2444,9 @@ gl3_filter_chain_t *gl3_filter_chain_create_from_preset(
       const char *path, glslang_filter_chain_filter filter)
 {
    unsigned i;
+   unsigned failed_pass = 0;
+   std::vector<const char*> paths;
+   std::vector<glslang_output> outputs;
    std::unique_ptr<video_shader> shader{ new video_shader() };
    if (!shader)
       return nullptr;
@@ -2464,9 +2467,23 @@ gl3_filter_chain_t *gl3_filter_chain_create_from_preset(
 
    shader->num_parameters = 0;
 
+   /* Passes are independent of each other until they are
+    * linked into the chain, so compile them all up front. */
+   outputs.resize(shader->passes);
    for (i = 0; i < shader->passes; i++)
+      paths.push_back(shader->pass[i].source.path);
+
+   if (!glslang_compile_shaders(paths.data(), outputs.data(),
+            shader->passes, &failed_pass))
    {
-      glslang_output output;
+      RARCH_ERR("[GLCore]: Failed to compile shader: \"%s\".\n",
+            shader->pass[failed_pass].source.path);
+      return nullptr;
+   }
+
+   for (i = 0; i < shader->passes; i++)
+   {
+      glslang_output &output             = outputs[i];
       struct gl3_filter_chain_pass_info pass_info;
       const video_shader_pass *pass      = &shader->pass[i];
       const video_shader_pass *next_pass =
@@ -2482,13 +2499,6 @@ gl3_filter_chain_t *gl3_filter_chain_create_from_preset(
       pass_info.address       = GLSLANG_FILTER_CHAIN_ADDRESS_REPEAT;
       pass_info.max_levels    = 0;
 
-      if (!glslang_compile_shader(pass->source.path, &output))
-      {
-         RARCH_ERR("[GLCore]: Failed to compile shader: \"%s\".\n",
-               pass->source.path);
-         return nullptr;
-      }
-
       for (auto &meta_param : output.meta.parameters)
       {
          if (shader->num_parameters >= GFX_MAX_PARAMETERS)
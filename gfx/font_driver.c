@@ -15,8 +15,12 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
+#include <encodings/utf.h>
+#include <lrc_hash.h>
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
@@ -947,3 +951,163 @@ void font_driver_free_osd(void)
 
    video_font_driver = NULL;
 }
+
+int font_advance_table_get_width(font_advance_table_t *table,
+      const font_renderer_driver_t *font_driver, void *font_data,
+      const char *msg, size_t msg_len, float scale)
+{
+   const struct font_glyph *glyph_q = NULL;
+   const char *msg_end              = msg + msg_len;
+   int delta_x                      = 0;
+   bool glyph_q_init                = false;
+
+   while (msg < msg_end)
+   {
+      const struct font_glyph *glyph;
+      unsigned code = utf8_walk(&msg);
+
+      if (code < 256 && table->cached[code])
+      {
+         delta_x += table->advance[code];
+         continue;
+      }
+
+      if (!(glyph = font_driver->get_glyph(font_data, code)))
+      {
+         if (!glyph_q_init)
+         {
+            glyph_q      = font_driver->get_glyph(font_data, '?');
+            glyph_q_init = true;
+         }
+         glyph = glyph_q;
+      }
+
+      if (code < 256)
+      {
+         table->advance[code] = glyph ? glyph->advance_x : 0;
+         table->cached[code]  = true;
+      }
+
+      if (glyph)
+         delta_x += glyph->advance_x;
+   }
+
+   return delta_x * scale;
+}
+
+#define FONT_LAYOUT_CACHE_SIZE 32
+
+typedef struct font_layout_entry
+{
+   float *data; /* vertex, tex_coord, lut_tex_coord, color */
+   char *msg;
+   font_layout_params_t params;
+   uint32_t hash;
+   unsigned vertices;
+   unsigned last_used;
+} font_layout_entry_t;
+
+struct font_layout_cache
+{
+   font_layout_entry_t entries[FONT_LAYOUT_CACHE_SIZE];
+   unsigned usage_counter;
+};
+
+font_layout_cache_t *font_layout_cache_new(void)
+{
+   return (font_layout_cache_t*)calloc(1, sizeof(font_layout_cache_t));
+}
+
+void font_layout_cache_free(font_layout_cache_t *cache)
+{
+   unsigned i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < FONT_LAYOUT_CACHE_SIZE; i++)
+   {
+      free(cache->entries[i].data);
+      free(cache->entries[i].msg);
+   }
+
+   free(cache);
+}
+
+bool font_layout_cache_get(font_layout_cache_t *cache,
+      const char *msg, const font_layout_params_t *params,
+      video_coords_t *coords)
+{
+   unsigned i;
+   uint32_t hash = djb2_calculate(msg);
+
+   for (i = 0; i < FONT_LAYOUT_CACHE_SIZE; i++)
+   {
+      font_layout_entry_t *entry = &cache->entries[i];
+
+      if (     entry->msg
+            && entry->hash == hash
+            && !memcmp(&entry->params, params, sizeof(*params))
+            && !strcmp(entry->msg, msg))
+      {
+         entry->last_used        = ++cache->usage_counter;
+         coords->vertex          = entry->data;
+         coords->tex_coord       = entry->data + entry->vertices * 2;
+         coords->lut_tex_coord   = entry->data + entry->vertices * 4;
+         coords->color           = entry->data + entry->vertices * 6;
+         coords->vertices        = entry->vertices;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+void font_layout_cache_put(font_layout_cache_t *cache,
+      const char *msg, const font_layout_params_t *params,
+      const video_coord_array_t *ca, unsigned first)
+{
+   unsigned i;
+   float *data;
+   char *msg_copy;
+   const video_mut_coords_t *coords = &ca->coords;
+   unsigned count                   = coords->vertices - first;
+   font_layout_entry_t *entry       = &cache->entries[0];
+
+   if (first >= coords->vertices)
+      return;
+
+   /* Reuse the least recently used entry */
+   for (i = 1; i < FONT_LAYOUT_CACHE_SIZE && entry->msg; i++)
+      if (     !cache->entries[i].msg
+            || (cache->usage_counter - cache->entries[i].last_used) >
+               (cache->usage_counter - entry->last_used))
+         entry = &cache->entries[i];
+
+   if (!(data = (float*)malloc(count * 10 * sizeof(float))))
+      return;
+   if (!(msg_copy = strdup(msg)))
+   {
+      free(data);
+      return;
+   }
+
+   memcpy(data,             coords->vertex    + first * 2,
+         count * 2 * sizeof(float));
+   memcpy(data + count * 2, coords->tex_coord + first * 2,
+         count * 2 * sizeof(float));
+   memcpy(data + count * 4, coords->lut_tex_coord + first * 2,
+         count * 2 * sizeof(float));
+   memcpy(data + count * 6, coords->color     + first * 4,
+         count * 4 * sizeof(float));
+
+   free(entry->data);
+   free(entry->msg);
+
+   entry->data      = data;
+   entry->msg       = msg_copy;
+   entry->params    = *params;
+   entry->hash      = djb2_calculate(msg);
+   entry->vertices  = count;
+   entry->last_used = ++cache->usage_counter;
+}
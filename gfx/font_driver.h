@@ -140,6 +140,63 @@ int font_driver_get_line_ascender(font_data_t *font, float scale);
 int font_driver_get_line_descender(font_data_t *font, float scale);
 int font_driver_get_line_centre_offset(font_data_t *font, float scale);
 
+/* Advances of the Latin-1 range are resolved once per
+ * font, so measuring text does not have to go through
+ * the renderer glyph lookup for every character */
+typedef struct font_advance_table
+{
+   int advance[256];
+   bool cached[256];
+} font_advance_table_t;
+
+int font_advance_table_get_width(font_advance_table_t *table,
+      const font_renderer_driver_t *font_driver, void *font_data,
+      const char *msg, size_t msg_len, float scale);
+
+/* Everything besides the string itself that determines
+ * the vertices generated for a message. Must be zeroed
+ * before being filled in, since it is compared bytewise */
+typedef struct font_layout_params
+{
+   float x;
+   float y;
+   float scale;
+   float drop_mod;
+   float drop_alpha;
+   float color[4];
+   int drop_x;
+   int drop_y;
+   unsigned viewport_width;
+   unsigned viewport_height;
+   unsigned atlas_generation;
+   enum text_alignment text_align;
+   bool full_screen;
+} font_layout_params_t;
+
+/* Small LRU of laid out messages: menus and notifications
+ * draw the same strings every frame, so the vertices of
+ * a message are kept and appended again as long as the
+ * message, its parameters and the glyph atlas are unchanged */
+typedef struct font_layout_cache font_layout_cache_t;
+
+font_layout_cache_t *font_layout_cache_new(void);
+
+void font_layout_cache_free(font_layout_cache_t *cache);
+
+/* On a hit, 'coords' points at the cached arrays, which
+ * stay valid until the next call to font_layout_cache_put */
+bool font_layout_cache_get(font_layout_cache_t *cache,
+      const char *msg, const font_layout_params_t *params,
+      video_coords_t *coords);
+
+/* Stores the vertices appended to 'ca' from 'first' on */
+void font_layout_cache_put(font_layout_cache_t *cache,
+      const char *msg, const font_layout_params_t *params,
+      const video_coord_array_t *ca, unsigned first);
+
+/* Messages longer than this are always laid out again */
+#define FONT_LAYOUT_CACHE_MAX_MSG 256
+
 extern font_renderer_t gl2_raster_font;
 extern font_renderer_t gl3_raster_font;
 extern font_renderer_t gl1_raster_font;
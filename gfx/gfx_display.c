@@ -506,6 +506,7 @@ void gfx_display_draw_quad(
 {
    gfx_display_ctx_draw_t draw;
    struct video_coords coords;
+   float white_tex_coord[8];
    gfx_display_ctx_driver_t
       *dispctx             = p_disp->dispctx;
 
@@ -529,6 +530,22 @@ void gfx_display_draw_quad(
    draw.texture         = (texture != 0)
       ? *texture
       : gfx_white_texture;
+
+   /* Plain quads are drawn from the white block of the
+    * active atlas, so that they can be batched together
+    * with the atlas icons */
+   if (!texture && p_disp->atlas && p_disp->atlas->texture)
+   {
+      unsigned i;
+      for (i = 0; i < 4; i++)
+      {
+         white_tex_coord[i * 2 + 0] = p_disp->atlas->white_tex_coord[0];
+         white_tex_coord[i * 2 + 1] = p_disp->atlas->white_tex_coord[1];
+      }
+      coords.tex_coord  = white_tex_coord;
+      draw.texture      = p_disp->atlas->texture;
+   }
+
    draw.prim_type       = GFX_DISPLAY_PRIM_TRIANGLESTRIP;
    draw.pipeline_id     = 0;
    draw.scale_factor    = 1.0f;
@@ -542,6 +559,146 @@ void gfx_display_draw_quad(
       dispctx->blend_end(data);
 }
 
+bool gfx_display_batch_accepts(const gfx_display_ctx_draw_t *draw,
+      const void *default_mvp)
+{
+   if (     !draw
+         || !draw->coords
+         ||  draw->coords->vertices != 4
+         ||  draw->prim_type        != GFX_DISPLAY_PRIM_TRIANGLESTRIP
+         ||  draw->pipeline_id      != 0
+         ||  draw->width            == 0
+         ||  draw->height           == 0)
+      return false;
+
+   /* Vertices are transformed on the CPU, which only
+    * works with the default (untransformed) MVP */
+   if (     draw->matrix_data
+         && draw->matrix_data != default_mvp
+         && memcmp(draw->matrix_data, default_mvp,
+            sizeof(math_matrix_4x4)))
+      return false;
+
+   return true;
+}
+
+bool gfx_display_batch_needs_flush(const gfx_display_batch_t *batch,
+      uintptr_t texture, unsigned video_width, unsigned video_height)
+{
+   gfx_display_t *p_disp = &dispgfx_st;
+
+   if (batch->quads == 0)
+      return false;
+   /* Textures packed into the active atlas are drawn from it */
+   if (gfx_display_atlas_find(p_disp->atlas, texture))
+      texture = p_disp->atlas->texture;
+   return   (batch->quads        >= GFX_DISPLAY_BATCH_MAX_QUADS)
+         || (batch->texture      != texture)
+         || (batch->video_width  != video_width)
+         || (batch->video_height != video_height);
+}
+
+void gfx_display_batch_append(gfx_display_batch_t *batch,
+      const gfx_display_ctx_draw_t *draw,
+      const float *default_vertex, const float *default_tex_coord,
+      unsigned video_width, unsigned video_height)
+{
+   /* Triangle strip (0, 1, 2, 3) as a triangle list */
+   static const unsigned strip_to_list[6] = { 0, 1, 2, 2, 1, 3 };
+   unsigned i;
+   float atlas_tex_coord[8];
+   gfx_display_t *p_disp  = &dispgfx_st;
+   uintptr_t texture      = draw->texture;
+   const gfx_display_atlas_region_t *region =
+      gfx_display_atlas_find(p_disp->atlas, texture);
+   const float *vertex    = draw->coords->vertex
+      ? draw->coords->vertex    : default_vertex;
+   const float *tex_coord = draw->coords->tex_coord
+      ? draw->coords->tex_coord : default_tex_coord;
+   const float *color     = draw->coords->color;
+   float inv_width        = 1.0f / (float)video_width;
+   float inv_height       = 1.0f / (float)video_height;
+   float *out_vertex      = batch->vertex    + batch->quads * 12;
+   float *out_tex_coord   = batch->tex_coord + batch->quads * 12;
+   float *out_color       = batch->color     + batch->quads * 24;
+
+   if (region)
+   {
+      gfx_display_atlas_tex_coords(region, tex_coord, atlas_tex_coord, 4);
+      tex_coord           = atlas_tex_coord;
+      texture             = p_disp->atlas->texture;
+   }
+
+   for (i = 0; i < 6; i++)
+   {
+      unsigned j             = strip_to_list[i];
+      *out_vertex++          = (draw->x + vertex[j * 2 + 0]
+            * draw->width)  * inv_width;
+      *out_vertex++          = (draw->y + vertex[j * 2 + 1]
+            * draw->height) * inv_height;
+      *out_tex_coord++       = tex_coord[j * 2 + 0];
+      *out_tex_coord++       = tex_coord[j * 2 + 1];
+      if (color)
+      {
+         *out_color++        = color[j * 4 + 0];
+         *out_color++        = color[j * 4 + 1];
+         *out_color++        = color[j * 4 + 2];
+         *out_color++        = color[j * 4 + 3];
+      }
+      else
+      {
+         *out_color++        = 1.0f;
+         *out_color++        = 1.0f;
+         *out_color++        = 1.0f;
+         *out_color++        = 1.0f;
+      }
+   }
+
+   batch->texture            = texture;
+   batch->video_width        = video_width;
+   batch->video_height       = video_height;
+   batch->quads++;
+}
+
+/* Sets up 'draw' to submit all queued quads as one
+ * triangle list covering the whole frame, and empties
+ * the queue. The vertex data remains valid until the
+ * next call of gfx_display_batch_append(). */
+bool gfx_display_batch_prepare(gfx_display_batch_t *batch,
+      gfx_display_ctx_draw_t *draw, struct video_coords *coords)
+{
+   if (batch->quads == 0)
+      return false;
+
+   coords->vertices      = batch->quads * 6;
+   coords->vertex        = batch->vertex;
+   coords->tex_coord     = batch->tex_coord;
+   coords->lut_tex_coord = batch->tex_coord;
+   coords->color         = batch->color;
+
+   draw->color             = NULL;
+   draw->vertex            = NULL;
+   draw->tex_coord         = NULL;
+   draw->backend_data      = NULL;
+   draw->coords            = coords;
+   draw->matrix_data       = NULL;
+   draw->texture           = batch->texture;
+   draw->vertex_count      = coords->vertices;
+   draw->backend_data_size = 0;
+   draw->x                 = 0;
+   draw->y                 = 0;
+   draw->width             = batch->video_width;
+   draw->height            = batch->video_height;
+   draw->pipeline_id       = 0;
+   draw->rotation          = 0.0f;
+   draw->scale_factor      = 1.0f;
+   draw->prim_type         = GFX_DISPLAY_PRIM_TRIANGLES;
+   draw->pipeline_active   = false;
+
+   batch->quads          = 0;
+   return true;
+}
+
 /* Draw the texture split into 9 sections, without scaling the corners.
  * The middle sections will only scale in the X axis, and the side
  * sections will only scale in the Y axis. */
@@ -1092,10 +1249,11 @@ bool gfx_display_reset_textures_list_buffer(
 }
 
 /* NOTE: Reads image from file */
-bool gfx_display_reset_textures_list(
+static bool gfx_display_reset_textures_list_internal(
       const char *texture_path, const char *iconpath,
       uintptr_t *item, enum texture_filter_type filter_type,
-      unsigned *width, unsigned *height)
+      unsigned *width, unsigned *height,
+      gfx_display_atlas_t *atlas)
 {
    char texpath[PATH_MAX_LENGTH];
    struct texture_image ti;
@@ -1122,11 +1280,229 @@ bool gfx_display_reset_textures_list(
 
    video_driver_texture_load(&ti,
          filter_type, item);
+
+   if (atlas && *item)
+      gfx_display_atlas_add(atlas, &ti, *item);
+
    image_texture_free(&ti);
 
    return true;
 }
 
+bool gfx_display_reset_textures_list(
+      const char *texture_path, const char *iconpath,
+      uintptr_t *item, enum texture_filter_type filter_type,
+      unsigned *width, unsigned *height)
+{
+   return gfx_display_reset_textures_list_internal(texture_path,
+         iconpath, item, filter_type, width, height, NULL);
+}
+
+/* Same as gfx_display_reset_textures_list(), but
+ * additionally packs the image into 'atlas' */
+bool gfx_display_reset_textures_list_atlas(
+      const char *texture_path, const char *iconpath,
+      uintptr_t *item, enum texture_filter_type filter_type,
+      gfx_display_atlas_t *atlas)
+{
+   return gfx_display_reset_textures_list_internal(texture_path,
+         iconpath, item, filter_type, NULL, NULL, atlas);
+}
+
+/* Size of the white block reserved at the
+ * top-left corner of each atlas */
+#define GFX_DISPLAY_ATLAS_WHITE_SIZE 4
+
+bool gfx_display_atlas_init(gfx_display_atlas_t *atlas,
+      unsigned width, unsigned height, bool supports_rgba)
+{
+#ifndef GFX_DISPLAY_LOW_MEMORY
+   unsigned x, y;
+#endif
+
+   memset(atlas, 0, sizeof(*atlas));
+
+#ifdef GFX_DISPLAY_LOW_MEMORY
+   /* Atlased icons keep their own texture for the draws
+    * that are not batched, so the atlas costs as much
+    * video memory again, plus the staging buffer */
+   return false;
+#else
+   if (!(atlas->pixels = (uint32_t*)calloc(width * height,
+               sizeof(uint32_t))))
+      return false;
+
+   atlas->width              = width;
+   atlas->height             = height;
+   atlas->supports_rgba      = supports_rgba;
+
+   for (y = 0; y < GFX_DISPLAY_ATLAS_WHITE_SIZE; y++)
+      for (x = 0; x < GFX_DISPLAY_ATLAS_WHITE_SIZE; x++)
+         atlas->pixels[y * width + x] = 0xFFFFFFFF;
+
+   /* Sample the centre of the white block, so that
+    * linear filtering never reaches its border */
+   atlas->white_tex_coord[0] = (GFX_DISPLAY_ATLAS_WHITE_SIZE / 2)
+      / (float)width;
+   atlas->white_tex_coord[1] = (GFX_DISPLAY_ATLAS_WHITE_SIZE / 2)
+      / (float)height;
+   atlas->shelf_x            = GFX_DISPLAY_ATLAS_WHITE_SIZE;
+   atlas->shelf_height       = GFX_DISPLAY_ATLAS_WHITE_SIZE;
+
+   return true;
+#endif
+}
+
+/* Packs an image into the next free slot of the
+ * current shelf, opening a new shelf when the current
+ * one is full. Each image gets a one pixel border
+ * replicating its edges, to avoid bleeding between
+ * neighbours when filtering. */
+bool gfx_display_atlas_add(gfx_display_atlas_t *atlas,
+      const struct texture_image *ti, uintptr_t key)
+{
+   unsigned x, y;
+   unsigned slot_w, slot_h;
+   unsigned shelf_x, shelf_y, shelf_height;
+   gfx_display_atlas_region_t *region = NULL;
+
+   if (     !atlas->pixels
+         || !ti->pixels
+         ||  ti->width  == 0
+         ||  ti->height == 0
+         ||  ti->supports_rgba != atlas->supports_rgba)
+      return false;
+
+   slot_w       = ti->width  + 2;
+   slot_h       = ti->height + 2;
+   shelf_x      = atlas->shelf_x;
+   shelf_y      = atlas->shelf_y;
+   shelf_height = atlas->shelf_height;
+
+   if (shelf_x + slot_w > atlas->width)
+   {
+      shelf_x      = 0;
+      shelf_y     += shelf_height;
+      shelf_height = 0;
+   }
+
+   /* Images that do not fit leave the current shelf
+    * open for smaller ones */
+   if (     (shelf_x + slot_w > atlas->width)
+         || (shelf_y + slot_h > atlas->height))
+      return false;
+
+   atlas->shelf_x      = shelf_x;
+   atlas->shelf_y      = shelf_y;
+   atlas->shelf_height = shelf_height;
+
+   if (atlas->regions_count >= atlas->regions_size)
+   {
+      size_t new_size = atlas->regions_size ? atlas->regions_size * 2 : 16;
+      gfx_display_atlas_region_t *new_regions =
+         (gfx_display_atlas_region_t*)realloc(atlas->regions,
+               new_size * sizeof(*new_regions));
+      if (!new_regions)
+         return false;
+      atlas->regions      = new_regions;
+      atlas->regions_size = new_size;
+   }
+
+   for (y = 0; y < slot_h; y++)
+   {
+      unsigned src_y      = (y == 0) ? 0
+         : (y > ti->height) ? ti->height - 1 : y - 1;
+      const uint32_t *src = ti->pixels + src_y * ti->width;
+      uint32_t *dst       = atlas->pixels
+         + (atlas->shelf_y + y) * atlas->width + atlas->shelf_x;
+
+      dst[0]              = src[0];
+      memcpy(dst + 1, src, ti->width * sizeof(uint32_t));
+      dst[slot_w - 1]     = src[ti->width - 1];
+   }
+
+   region                 = &atlas->regions[atlas->regions_count++];
+   region->key            = key;
+   region->x              = (atlas->shelf_x + 1) / (float)atlas->width;
+   region->y              = (atlas->shelf_y + 1) / (float)atlas->height;
+   region->width          = ti->width  / (float)atlas->width;
+   region->height         = ti->height / (float)atlas->height;
+
+   atlas->shelf_x        += slot_w;
+   if (slot_h > atlas->shelf_height)
+      atlas->shelf_height = slot_h;
+
+   return true;
+}
+
+/* Uploads the packed atlas; the CPU copy of the
+ * pixels is released afterwards. No mipmaps: the
+ * one pixel border around each image cannot keep
+ * neighbours from bleeding into the smaller levels */
+bool gfx_display_atlas_upload(gfx_display_atlas_t *atlas)
+{
+   struct texture_image ti;
+
+   if (!atlas->pixels)
+      return false;
+
+   /* Only worth it if something has been packed */
+   if (atlas->regions_count > 0)
+   {
+      ti.width         = atlas->width;
+      ti.height        = atlas->height;
+      ti.pixels        = atlas->pixels;
+      ti.supports_rgba = atlas->supports_rgba;
+
+      video_driver_texture_load(&ti, TEXTURE_FILTER_LINEAR, &atlas->texture);
+   }
+
+   free(atlas->pixels);
+   atlas->pixels = NULL;
+
+   return atlas->texture != 0;
+}
+
+const gfx_display_atlas_region_t *gfx_display_atlas_find(
+      const gfx_display_atlas_t *atlas, uintptr_t key)
+{
+   size_t i;
+
+   if (!atlas || !atlas->texture || !key)
+      return NULL;
+
+   for (i = 0; i < atlas->regions_count; i++)
+      if (atlas->regions[i].key == key)
+         return &atlas->regions[i];
+
+   return NULL;
+}
+
+/* Maps texture coordinates of the original texture
+ * to the matching area of the atlas */
+void gfx_display_atlas_tex_coords(
+      const gfx_display_atlas_region_t *region,
+      const float *tex_coord, float *out, unsigned count)
+{
+   unsigned i;
+   for (i = 0; i < count; i++)
+   {
+      out[i * 2 + 0] = region->x + tex_coord[i * 2 + 0] * region->width;
+      out[i * 2 + 1] = region->y + tex_coord[i * 2 + 1] * region->height;
+   }
+}
+
+void gfx_display_atlas_free(gfx_display_atlas_t *atlas)
+{
+   if (atlas->texture)
+      video_driver_texture_unload(&atlas->texture);
+   if (atlas->pixels)
+      free(atlas->pixels);
+   if (atlas->regions)
+      free(atlas->regions);
+   memset(atlas, 0, sizeof(*atlas));
+}
+
 void gfx_display_deinit_white_texture(void)
 {
    if (gfx_white_texture)
@@ -1160,6 +1536,7 @@ void gfx_display_free(void)
    p_disp->framebuf_height     = 0;
    p_disp->framebuf_pitch      = 0;
    p_disp->dispctx             = NULL;
+   p_disp->atlas               = NULL;
 }
 
 void gfx_display_init(void)
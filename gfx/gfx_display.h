@@ -55,6 +55,16 @@
 
 #define gfx_display_set_alpha(color, alpha_value) (color[3] = color[7] = color[11] = color[15] = (alpha_value))
 
+/* Maximum number of quads merged into a single
+ * batched draw call */
+#define GFX_DISPLAY_BATCH_MAX_QUADS 128
+
+/* Handhelds, short on (video) memory: menu caches are
+ * kept small, and icons are not packed into atlases */
+#if defined(DINGUX) || defined(MIYOO) || defined(_3DS) || defined(PSP)
+#define GFX_DISPLAY_LOW_MEMORY
+#endif
+
 /* Returns true if an animation is still active or
  * when the display framebuffer still is dirty and
  * therefore it still needs to be rendered onscreen.
@@ -146,6 +156,9 @@ typedef struct gfx_display_ctx_driver
          int x, int y, unsigned width, unsigned height);
    void (*scissor_end)(void *data, unsigned video_width,
          unsigned video_height);
+   /* Set if the driver merges consecutive plain quads
+    * into batched draw calls (see gfx_display_batch_t) */
+   bool batched;
 } gfx_display_ctx_driver_t;
 
 struct gfx_display_ctx_draw
@@ -170,6 +183,52 @@ struct gfx_display_ctx_draw
    bool pipeline_active;
 };
 
+/* Queue of quads sharing the same texture, used by
+ * display drivers to submit runs of consecutive draws
+ * as a single triangle list. Vertices are stored in
+ * normalised framebuffer coordinates, so that the queue
+ * can be drawn with the default MVP and a full-frame
+ * viewport. */
+typedef struct gfx_display_batch
+{
+   float vertex[GFX_DISPLAY_BATCH_MAX_QUADS * 6 * 2];
+   float tex_coord[GFX_DISPLAY_BATCH_MAX_QUADS * 6 * 2];
+   float color[GFX_DISPLAY_BATCH_MAX_QUADS * 6 * 4];
+   uintptr_t texture;
+   unsigned video_width;
+   unsigned video_height;
+   unsigned quads;
+} gfx_display_batch_t;
+
+typedef struct gfx_display_atlas_region
+{
+   uintptr_t key;       /* Texture the region stands in for */
+   float x;             /* Normalised position and size */
+   float y;
+   float width;
+   float height;
+} gfx_display_atlas_region_t;
+
+/* Runtime texture atlas: small images (icons) are
+ * shelf-packed into a single texture so that they can
+ * be batched together with each other and with plain
+ * coloured quads (the atlas contains a white block) */
+typedef struct gfx_display_atlas
+{
+   uint32_t *pixels;
+   gfx_display_atlas_region_t *regions;
+   uintptr_t texture;
+   size_t regions_count;
+   size_t regions_size;
+   unsigned width;
+   unsigned height;
+   unsigned shelf_x;
+   unsigned shelf_y;
+   unsigned shelf_height;
+   float white_tex_coord[2];
+   bool supports_rgba;
+} gfx_display_atlas_t;
+
 typedef struct gfx_display_ctx_coord_draw
 {
    const float *ptr;
@@ -195,6 +254,8 @@ typedef struct gfx_display_ctx_powerstate
 struct gfx_display
 {
    gfx_display_ctx_driver_t *dispctx;
+   /* Atlas used for untextured quads, if any */
+   const gfx_display_atlas_t *atlas;
    video_coord_array_t dispca; /* ptr alignment */
 
    /* Width, height and pitch of the display framebuffer */
@@ -293,6 +354,13 @@ bool gfx_display_reset_textures_list(
       unsigned *width,
       unsigned *height);
 
+bool gfx_display_reset_textures_list_atlas(
+      const char *texture_path,
+      const char *iconpath,
+      uintptr_t *item,
+      enum texture_filter_type filter_type,
+      gfx_display_atlas_t *atlas);
+
 bool gfx_display_reset_textures_list_buffer(
         uintptr_t *item,
         enum texture_filter_type filter_type,
@@ -313,6 +381,37 @@ float gfx_display_get_dpi_scale(
       bool fullscreen,
       bool is_widget);
 
+bool gfx_display_batch_accepts(const gfx_display_ctx_draw_t *draw,
+      const void *default_mvp);
+
+bool gfx_display_batch_needs_flush(const gfx_display_batch_t *batch,
+      uintptr_t texture, unsigned video_width, unsigned video_height);
+
+void gfx_display_batch_append(gfx_display_batch_t *batch,
+      const gfx_display_ctx_draw_t *draw,
+      const float *default_vertex, const float *default_tex_coord,
+      unsigned video_width, unsigned video_height);
+
+bool gfx_display_batch_prepare(gfx_display_batch_t *batch,
+      gfx_display_ctx_draw_t *draw, struct video_coords *coords);
+
+bool gfx_display_atlas_init(gfx_display_atlas_t *atlas,
+      unsigned width, unsigned height, bool supports_rgba);
+
+bool gfx_display_atlas_add(gfx_display_atlas_t *atlas,
+      const struct texture_image *ti, uintptr_t key);
+
+bool gfx_display_atlas_upload(gfx_display_atlas_t *atlas);
+
+const gfx_display_atlas_region_t *gfx_display_atlas_find(
+      const gfx_display_atlas_t *atlas, uintptr_t key);
+
+void gfx_display_atlas_tex_coords(
+      const gfx_display_atlas_region_t *region,
+      const float *tex_coord, float *out, unsigned count);
+
+void gfx_display_atlas_free(gfx_display_atlas_t *atlas);
+
 void gfx_display_deinit_white_texture(void);
 
 void gfx_display_init_white_texture(void);
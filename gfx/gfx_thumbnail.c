@@ -27,27 +27,150 @@
 #include <features/features_cpu.h>
 #include <file/file_path.h>
 #include <string/stdstring.h>
+#include <lrc_hash.h>
+#include <retro_math.h>
 
 #include "gfx_display.h"
 #include "gfx_animation.h"
 
 #include "gfx_thumbnail.h"
 
+#include "../configuration.h"
 #include "../tasks/tasks_internal.h"
 
 #define DEFAULT_GFX_THUMBNAIL_STREAM_DELAY  83.333333f
 #define DEFAULT_GFX_THUMBNAIL_FADE_DURATION 166.66667f
 
+#ifdef GFX_DISPLAY_LOW_MEMORY
+#define GFX_THUMBNAIL_CACHE_MAX_SIZE        (4 * 1024 * 1024)
+#else
+#define GFX_THUMBNAIL_CACHE_MAX_SIZE        (32 * 1024 * 1024)
+#endif
+
+/* Processed thumbnails are cached on disk
+ * in this subdirectory of the cache directory */
+#define GFX_THUMBNAIL_CACHE_DIR             "thumbnails"
+
 /* Utility structure, sent as userdata when pushing
  * an image load */
 typedef struct
 {
    uint64_t list_id;
    gfx_thumbnail_t *thumbnail;
+   char *path; /* NULL if image should not be cached */
 } gfx_thumbnail_tag_t;
 
 static gfx_thumbnail_state_t gfx_thumb_st = {0}; /* uint64_t alignment */
 
+/* In-memory cache */
+
+static size_t gfx_thumbnail_cache_entry_size(
+      const gfx_thumbnail_cache_entry_t *entry)
+{
+   return entry->image.width * entry->image.height * sizeof(uint32_t);
+}
+
+static void gfx_thumbnail_cache_entry_free(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   if (!entry->path)
+      return;
+
+   p_gfx_thumb->cache_size -= gfx_thumbnail_cache_entry_size(entry);
+
+   image_texture_free(&entry->image);
+   free(entry->path);
+   entry->path      = NULL;
+   entry->hash      = 0;
+   entry->last_used = 0;
+}
+
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_find(
+      gfx_thumbnail_state_t *p_gfx_thumb, const char *path)
+{
+   size_t i;
+   uint32_t hash = djb2_calculate(path);
+
+   for (i = 0; i < GFX_THUMBNAIL_CACHE_ENTRIES; i++)
+   {
+      gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->cache[i];
+
+      if (   entry->path
+          && (entry->hash == hash)
+          && string_is_equal(entry->path, path))
+      {
+         entry->last_used = ++p_gfx_thumb->cache_clock;
+         return entry;
+      }
+   }
+
+   return NULL;
+}
+
+/* Takes ownership of the pixels of 'img' on success */
+static bool gfx_thumbnail_cache_insert(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, struct texture_image *img)
+{
+   size_t i;
+   size_t size = img->width * img->height * sizeof(uint32_t);
+
+   if (size > GFX_THUMBNAIL_CACHE_MAX_SIZE)
+      return false;
+
+   /* Evict least recently used entries until
+    * there is room for the new image */
+   for (;;)
+   {
+      gfx_thumbnail_cache_entry_t *lru  = NULL;
+      gfx_thumbnail_cache_entry_t *free_entry = NULL;
+
+      for (i = 0; i < GFX_THUMBNAIL_CACHE_ENTRIES; i++)
+      {
+         gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->cache[i];
+
+         if (!entry->path)
+         {
+            if (!free_entry)
+               free_entry = entry;
+         }
+         else if (!lru || (entry->last_used < lru->last_used))
+            lru = entry;
+      }
+
+      if (     free_entry
+            && (p_gfx_thumb->cache_size + size <= GFX_THUMBNAIL_CACHE_MAX_SIZE))
+      {
+         if (!(free_entry->path = strdup(path)))
+            return false;
+
+         free_entry->hash      = djb2_calculate(path);
+         free_entry->image     = *img;
+         free_entry->last_used = ++p_gfx_thumb->cache_clock;
+         p_gfx_thumb->cache_size += size;
+         return true;
+      }
+
+      if (!lru)
+         return false;
+
+      gfx_thumbnail_cache_entry_free(p_gfx_thumb, lru);
+   }
+}
+
+/* Releases all thumbnails retained in memory */
+void gfx_thumbnail_cache_clear(void)
+{
+   size_t i;
+   gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
+
+   for (i = 0; i < GFX_THUMBNAIL_CACHE_ENTRIES; i++)
+      gfx_thumbnail_cache_entry_free(p_gfx_thumb, &p_gfx_thumb->cache[i]);
+
+   p_gfx_thumb->cache_size = 0;
+}
+
 gfx_thumbnail_state_t *gfx_thumb_get_ptr(void)
 {
    return &gfx_thumb_st;
@@ -89,6 +212,53 @@ void gfx_thumbnail_set_fade_missing(bool fade_missing)
    p_gfx_thumb->fade_missing = fade_missing;
 }
 
+/* Sets the largest dimensions at which the menu
+ * driver will ever display a thumbnail. Larger images
+ * are downscaled when loaded
+ * > If 'width' or 'height' is zero, that dimension
+ *   is unbounded */
+void gfx_thumbnail_set_max_dimensions(unsigned width, unsigned height)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
+
+   /* Round the limits up to a power of two, so that
+    * resizing the window does not change them (and
+    * with them the images cached on disk) every time */
+   if (width)
+      width  = next_pow2(width);
+   if (height)
+      height = next_pow2(height);
+
+   if (   (p_gfx_thumb->max_width  == width)
+       && (p_gfx_thumb->max_height == height))
+      return;
+
+   /* Cached images were sized for the old limits */
+   gfx_thumbnail_cache_clear();
+
+   p_gfx_thumb->max_width  = width;
+   p_gfx_thumb->max_height = height;
+}
+
+/* Fetches the directory in which processed thumbnail
+ * images are cached on disk
+ * > Returns false (and sets 's' to an empty string)
+ *   if no cache directory is configured */
+bool gfx_thumbnail_get_cache_dir(char *s, size_t len)
+{
+   settings_t *settings  = config_get_ptr();
+   const char *dir_cache = settings ? settings->paths.directory_cache : NULL;
+
+   if (string_is_empty(dir_cache))
+   {
+      *s = '\0';
+      return false;
+   }
+
+   fill_pathname_join_special(s, dir_cache, GFX_THUMBNAIL_CACHE_DIR, len);
+   return true;
+}
+
 /* Callbacks */
 
 /* Fade animation callback - simply resets thumbnail
@@ -194,6 +364,12 @@ static void gfx_thumbnail_handle_upload(
    /* Update thumbnail status */
    thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
 
+   /* Retain decoded image for subsequent requests */
+   if (thumbnail_tag->path)
+      if (gfx_thumbnail_cache_insert(p_gfx_thumb,
+               thumbnail_tag->path, img))
+         img->pixels = NULL;
+
 end:
    /* Clean up */
    if (img)
@@ -209,10 +385,41 @@ end:
          gfx_thumbnail_init_fade(p_gfx_thumb,
                thumbnail_tag->thumbnail);
 
+      if (thumbnail_tag->path)
+         free(thumbnail_tag->path);
       free(thumbnail_tag);
    }
 }
 
+/* Uploads a thumbnail from the in-memory cache,
+ * if available */
+static bool gfx_thumbnail_load_cached(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, gfx_thumbnail_t *thumbnail)
+{
+   struct texture_image img;
+   gfx_thumbnail_cache_entry_t *entry =
+         gfx_thumbnail_cache_find(p_gfx_thumb, path);
+
+   if (!entry)
+      return false;
+
+   /* The texture loader must not take ownership
+    * of the cached pixel buffer */
+   img = entry->image;
+
+   if (!video_driver_texture_load(
+            &img, TEXTURE_FILTER_MIPMAP_LINEAR,
+            &thumbnail->texture))
+      return false;
+
+   thumbnail->width  = entry->image.width;
+   thumbnail->height = entry->image.height;
+   thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
+
+   return true;
+}
+
 /* Core interface */
 
 /* When called, prevents the handling of any pending
@@ -264,9 +471,14 @@ void gfx_thumbnail_request(
          const char *thumbnail_path = NULL;
          if (gfx_thumbnail_get_path(path_data, thumbnail_id, &thumbnail_path))
          {
+            /* Use previously decoded image, if available */
+            if (gfx_thumbnail_load_cached(p_gfx_thumb,
+                     thumbnail_path, thumbnail))
+               goto end;
             /* Load thumbnail, if required */
-            if (path_is_valid(thumbnail_path))
+            else if (path_is_valid(thumbnail_path))
             {
+               char cache_dir[PATH_MAX_LENGTH];
                gfx_thumbnail_tag_t *thumbnail_tag =
                   (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t));
 
@@ -276,14 +488,25 @@ void gfx_thumbnail_request(
                /* Configure user data */
                thumbnail_tag->thumbnail = thumbnail;
                thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+               thumbnail_tag->path      = strdup(thumbnail_path);
+
+               gfx_thumbnail_get_cache_dir(cache_dir, sizeof(cache_dir));
 
                /* Would like to cancel any existing image load tasks
                 * here, but can't see how to do it... */
-               if (task_push_image_load(
+               if (task_push_image_load_scaled(
                         thumbnail_path, video_driver_supports_rgba(),
                         gfx_thumbnail_upscale_threshold,
+                        p_gfx_thumb->max_width, p_gfx_thumb->max_height,
+                        cache_dir,
                         gfx_thumbnail_handle_upload, thumbnail_tag))
                   thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+               else
+               {
+                  if (thumbnail_tag->path)
+                     free(thumbnail_tag->path);
+                  free(thumbnail_tag);
+               }
             }
 #ifdef HAVE_NETWORKING
             /* Handle on demand thumbnail downloads */
@@ -370,17 +593,25 @@ void gfx_thumbnail_request_file(
    if (!(thumbnail_tag = (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t))))
       return;
 
-   /* Configure user data */
+   /* Configure user data
+    * > Files loaded this way (e.g. savestate images)
+    *   may be overwritten at any time, so they are
+    *   never cached */
    thumbnail_tag->thumbnail = thumbnail;
    thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+   thumbnail_tag->path      = NULL;
 
    /* Would like to cancel any existing image load tasks
     * here, but can't see how to do it... */
-   if (task_push_image_load(
+   if (task_push_image_load_scaled(
          file_path, video_driver_supports_rgba(),
          gfx_thumbnail_upscale_threshold,
+         p_gfx_thumb->max_width, p_gfx_thumb->max_height,
+         NULL,
          gfx_thumbnail_handle_upload, thumbnail_tag))
       thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+   else
+      free(thumbnail_tag);
 }
 
 /* Resets (and free()s the current texture of) the
@@ -27,6 +27,7 @@
 #include <libretro.h>
 
 #include <boolean.h>
+#include <formats/image.h>
 
 #include "gfx_animation.h"
 #include "gfx_thumbnail_path.h"
@@ -99,6 +100,20 @@ typedef struct
    enum gfx_thumbnail_shadow_type type;
 } gfx_thumbnail_shadow_t;
 
+/* Maximum number of decoded images held by the
+ * in-memory thumbnail cache */
+#define GFX_THUMBNAIL_CACHE_ENTRIES 32
+
+/* A decoded, ready-to-upload thumbnail image held
+ * by the in-memory cache */
+typedef struct
+{
+   char *path;
+   struct texture_image image; /* ptr alignment */
+   uint64_t last_used;
+   uint32_t hash;
+} gfx_thumbnail_cache_entry_t;
+
 /* Structure containing all gfx_thumbnail
  * variables */
 struct gfx_thumbnail_state
@@ -115,6 +130,20 @@ struct gfx_thumbnail_state
     * at the time when the load completes */
    uint64_t list_id;
 
+   /* Recently displayed thumbnails are retained in
+    * memory (least recently used entries are evicted
+    * first), so that scrolling back and forth through
+    * a playlist does not decode the same images over
+    * and over again */
+   gfx_thumbnail_cache_entry_t cache[GFX_THUMBNAIL_CACHE_ENTRIES];
+   uint64_t cache_clock;
+   size_t cache_size;
+
+   /* Images larger than this are downscaled before
+    * being uploaded (0: no limit) */
+   unsigned max_width;
+   unsigned max_height;
+
    /* When streaming thumbnails, to minimise the processing
     * of unnecessary images (i.e. when scrolling rapidly through
     * playlists), we delay loading until an entry has been on screen
@@ -151,6 +180,22 @@ void gfx_thumbnail_set_fade_duration(float duration);
  *   any 'thumbnail unavailable' notifications */
 void gfx_thumbnail_set_fade_missing(bool fade_missing);
 
+/* Sets the largest dimensions at which the menu
+ * driver will ever display a thumbnail. Larger images
+ * are downscaled when loaded
+ * > If 'width' or 'height' is zero, that dimension
+ *   is unbounded */
+void gfx_thumbnail_set_max_dimensions(unsigned width, unsigned height);
+
+/* Releases all thumbnails retained in memory */
+void gfx_thumbnail_cache_clear(void);
+
+/* Fetches the directory in which processed thumbnail
+ * images are cached on disk
+ * > Returns false (and sets 's' to an empty string)
+ *   if no cache directory is configured */
+bool gfx_thumbnail_get_cache_dir(char *s, size_t len);
+
 /* Core interface */
 
 /* When called, prevents the handling of any pending
@@ -1591,6 +1591,10 @@ void gfx_widgets_frame(void *data)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, true, false);
 
+   /* Plain quads are drawn from the icon atlas */
+   p_disp->atlas = p_dispwidget->icon_atlas.texture
+      ? &p_dispwidget->icon_atlas : NULL;
+
    /* Font setup */
    gfx_widgets_font_bind(&p_dispwidget->gfx_widget_fonts.regular);
    gfx_widgets_font_bind(&p_dispwidget->gfx_widget_fonts.bold);
@@ -1842,6 +1846,8 @@ void gfx_widgets_frame(void *data)
    gfx_widgets_font_unbind(&p_dispwidget->gfx_widget_fonts.bold);
    gfx_widgets_font_unbind(&p_dispwidget->gfx_widget_fonts.msg_queue);
 
+   p_disp->atlas = NULL;
+
    if (video_st->current_video && video_st->current_video->set_viewport)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, false, true);
@@ -1942,33 +1948,40 @@ static void gfx_widgets_context_reset(
       const char *dir_assets, char *font_path)
 {
    size_t i;
+   gfx_display_atlas_t *atlas = NULL;
+
+   /* Icons are additionally packed into an atlas
+    * when the display driver batches its draws */
+   gfx_display_atlas_free(&p_dispwidget->icon_atlas);
+   if (     p_disp->dispctx
+         && p_disp->dispctx->batched
+         && gfx_display_atlas_init(&p_dispwidget->icon_atlas,
+            1024, 512, video_driver_supports_rgba()))
+      atlas = &p_dispwidget->icon_atlas;
 
    /* Load textures */
    /* Icons */
    for (i = 0; i < MENU_WIDGETS_ICON_LAST; i++)
-      gfx_display_reset_textures_list(
+      gfx_display_reset_textures_list_atlas(
             gfx_widgets_icons_names[i],
             p_dispwidget->monochrome_png_path,
             &p_dispwidget->gfx_widgets_icons_textures[i],
             TEXTURE_FILTER_MIPMAP_LINEAR,
-            NULL,
-            NULL);
+            atlas);
 
    /* Message queue */
-   gfx_display_reset_textures_list(
+   gfx_display_reset_textures_list_atlas(
          "msg_queue_icon.png",
          p_dispwidget->gfx_widgets_path,
          &p_dispwidget->msg_queue_icon,
          TEXTURE_FILTER_LINEAR,
-         NULL,
-         NULL);
-   gfx_display_reset_textures_list(
+         atlas);
+   gfx_display_reset_textures_list_atlas(
          "msg_queue_icon_outline.png",
          p_dispwidget->gfx_widgets_path,
          &p_dispwidget->msg_queue_icon_outline,
          TEXTURE_FILTER_LINEAR,
-         NULL,
-         NULL);
+         atlas);
    gfx_display_reset_textures_list(
          "msg_queue_icon_rect.png",
          p_dispwidget->gfx_widgets_path,
@@ -1977,6 +1990,9 @@ static void gfx_widgets_context_reset(
          NULL,
          NULL);
 
+   if (atlas)
+      gfx_display_atlas_upload(atlas);
+
    if (  p_dispwidget->msg_queue_icon
       && p_dispwidget->msg_queue_icon_outline
       && p_dispwidget->msg_queue_icon_rect)
@@ -2160,6 +2176,7 @@ static void gfx_widgets_context_destroy(dispgfx_widget_t *p_dispwidget)
    video_driver_texture_unload(&p_dispwidget->msg_queue_icon);
    video_driver_texture_unload(&p_dispwidget->msg_queue_icon_outline);
    video_driver_texture_unload(&p_dispwidget->msg_queue_icon_rect);
+   gfx_display_atlas_free(&p_dispwidget->icon_atlas);
 
    p_dispwidget->msg_queue_icon         = 0;
    p_dispwidget->msg_queue_icon_outline = 0;
@@ -193,6 +193,9 @@ typedef struct dispgfx_widget
    MENU_WIDGETS_ICON_LAST];
    uintptr_t gfx_widgets_generic_tag;
 
+   /* Icons packed together, for batched drawing */
+   gfx_display_atlas_t icon_atlas;
+
    size_t current_msgs_size;
 
 #ifdef HAVE_TRANSLATE
@@ -283,6 +283,7 @@ struct font_atlas
    uint8_t *buffer; /* Alpha channel. */
    unsigned width;
    unsigned height;
+   unsigned generation; /* Bumped when a glyph slot is reused */
    bool dirty;
 };
 
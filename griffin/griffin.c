@@ -144,6 +144,9 @@ COMPRESSION
 #ifdef HAVE_ZLIB
 #include "../libretro-common/streams/trans_stream_zlib.c"
 #include "../libretro-common/streams/rzip_stream.c"
+#ifdef HAVE_ZSTD
+#include "../libretro-common/streams/trans_stream_zstd.c"
+#endif
 #endif
 
 /*============================================================
@@ -1058,9 +1061,13 @@ FILE
 #endif
 
 #include "../libretro-common/string/stdstring.c"
+#include "../libretro-common/string/string_pool.c"
 #include "../libretro-common/file/nbio/nbio_stdio.c"
 #if defined(__linux__)
 #include "../libretro-common/file/nbio/nbio_linux.c"
+#if defined(HAVE_IO_URING)
+#include "../libretro-common/file/nbio/nbio_uring.c"
+#endif
 #endif
 #if defined(HAVE_MMAP) && defined(BSD)
 #include "../libretro-common/file/nbio/nbio_unixmmap.c"
@@ -1348,6 +1355,7 @@ MENU
 #include "../menu/cbs/menu_cbs_sublabel.c"
 #include "../menu/menu_displaylist.c"
 #include "../menu/menu_contentless_cores.c"
+#include "../tasks/task_menu_dir_list.c"
 #ifdef HAVE_LIBRETRODB
 #include "../menu/menu_explore.c"
 #include "../tasks/task_menu_explore.c"
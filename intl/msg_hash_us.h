@@ -4511,6 +4511,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION,
    "Write save state files in an archived format. Dramatically reduces file size at the expense of increased saving/loading times."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_FILE_COMPRESSION_ZSTD,
+   "Compress Files with Zstandard"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_FILE_COMPRESSION_ZSTD,
+   "Compress save and save state files with Zstandard instead of zlib. Saving and loading are faster, but these files cannot be loaded by older versions of RetroArch."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SORT_SCREENSHOTS_BY_CONTENT_ENABLE,
    "Sort Screenshots into Folders by Content Directory"
@@ -313,6 +313,24 @@ static bool file_archive_walk(const char *file, const char *valid_exts,
    return returnerr;
 }
 
+/* Same as file_archive_walk, from the index of the
+ * archive if its backend keeps one. If 'name' is set,
+ * only that member is enumerated.
+ *
+ * Returns: false if no index is available. */
+static bool file_archive_index_walk(const char *file, const char *name,
+      const char *valid_exts, file_archive_file_cb file_cb,
+      struct archive_extract_userdata *userdata)
+{
+   const struct file_archive_file_backend *backend =
+      file_archive_get_file_backend(file);
+
+   return backend
+      && backend->archive_index_walk
+      && backend->archive_index_walk(file, name, valid_exts,
+            userdata, file_cb);
+}
+
 int file_archive_parse_file_progress(file_archive_transfer_t *state)
 {
    if (!state || state->step_total == 0)
@@ -412,8 +430,10 @@ bool file_archive_get_file_list_noalloc(struct string_list *list,
    userdata.transfer                        = NULL;
    userdata.dec                             = NULL;
 
-   if (!file_archive_walk(path, valid_exts,
-            file_archive_get_file_list_cb, &userdata))
+   if (     !file_archive_index_walk(path, NULL, valid_exts,
+               file_archive_get_file_list_cb, &userdata)
+         && !file_archive_walk(path, valid_exts,
+               file_archive_get_file_list_cb, &userdata))
       return false;
    return true;
 }
@@ -443,8 +463,10 @@ struct string_list *file_archive_get_file_list(const char *path,
 
    if (!userdata.list)
       return NULL;
-   if (!file_archive_walk(path, valid_exts,
-         file_archive_get_file_list_cb, &userdata))
+   if (     !file_archive_index_walk(path, NULL, valid_exts,
+               file_archive_get_file_list_cb, &userdata)
+         && !file_archive_walk(path, valid_exts,
+               file_archive_get_file_list_cb, &userdata))
    {
       string_list_free(userdata.list);
       return NULL;
@@ -622,6 +644,15 @@ const struct file_archive_file_backend* file_archive_get_file_backend(const char
    return NULL;
 }
 
+static int file_archive_get_file_crc32_cb(const char *name,
+      const char *valid_exts, const uint8_t *cdata,
+      unsigned cmode, uint32_t csize, uint32_t size,
+      uint32_t checksum, struct archive_extract_userdata *userdata)
+{
+   userdata->crc = checksum;
+   return 0;
+}
+
 /**
  * file_archive_get_file_crc32:
  * @path                         : filename path of archive
@@ -647,6 +678,11 @@ uint32_t file_archive_get_file_crc32(const char *path)
          archive_path += 1;
    }
 
+   /* Look the member up in the index of the archive */
+   if (file_archive_index_walk(path, archive_path, NULL,
+            file_archive_get_file_crc32_cb, &userdata))
+      return userdata.crc;
+
    state.type              = ARCHIVE_TRANSFER_INIT;
    state.archive_file      = NULL;
 #ifdef HAVE_MMAP
@@ -687,6 +723,13 @@ uint32_t file_archive_get_file_crc32(const char *path)
       }
       else
          break;
+
+      /* File is not in the archive */
+      if (state.type != ARCHIVE_TRANSFER_ITERATE)
+      {
+         userdata.crc = 0;
+         break;
+      }
    }
 
    file_archive_parse_file_iterate_stop(&state);
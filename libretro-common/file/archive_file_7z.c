@@ -21,6 +21,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <boolean.h>
 #include <file/archive_file.h>
@@ -32,14 +33,30 @@
 #include <lists/string_list.h>
 #include <file/file_path.h>
 #include <compat/strl.h>
+#include <array/rbuf.h>
 #include <7zip/7z.h>
 #include <7zip/7zCrc.h>
 #include <7zip/7zFile.h>
+#include <7zip/Lzma2Dec.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
+#endif
 
 #define SEVENZIP_MAGIC "7z\xBC\xAF\x27\x1C"
 #define SEVENZIP_MAGIC_LEN 6
 #define SEVENZIP_LOOKTOREAD_BUF_SIZE (1 << 14)
 
+#define SEVENZIP_METHOD_LZMA2 0x21
+
+/* Each part of an LZMA2 stream decoded on its own is read
+ * whole, streams with larger parts are left to the LZMA SDK */
+#define SEVENZIP_MT_MAX_SEGMENT_SIZE (16 * 1024 * 1024)
+
+/* Decoded blocks larger than this are not kept */
+#define SEVENZIP_BLOCK_CACHE_MAX_SIZE (16 * 1024 * 1024)
+
 /* Assume W-functions do not work below Win2K and Xbox platforms */
 #if defined(_WIN32_WINNT) && _WIN32_WINNT < 0x0500 || defined(_XBOX)
 #ifndef LEGACY_WIN32
@@ -49,7 +66,9 @@
 
 struct sevenzip_context_t
 {
+   char *path;
    uint8_t *output;
+   size_t output_size;
    CFileInStream archiveStream;
    CLookToRead2 lookStream;
    ISzAlloc allocImp;
@@ -62,6 +81,46 @@ struct sevenzip_context_t
    uint32_t   block_index;
 };
 
+/* Part of an LZMA2 stream starting with a dictionary
+ * reset, which can be decoded on its own */
+typedef struct
+{
+   uint64_t src_pos;
+   size_t src_len;
+   size_t dst_pos;
+   size_t dst_len;
+} sevenzip_lzma2_segment_t;
+
+typedef struct
+{
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   ILookInStream *stream; /* Read under the lock */
+   uint8_t *out;
+   sevenzip_lzma2_segment_t *segments;
+   size_t num_segments;
+   size_t next_segment;
+   uint8_t prop;
+   bool error;
+} sevenzip_lzma2_state_t;
+
+/* Last solid block decoded, so that reading the next
+ * member of the block does not decode it again */
+static struct
+{
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   char *path;
+   uint8_t *output;
+   size_t output_size;
+   int64_t mtime;
+   int64_t size;
+   uint32_t block_index;
+   bool inited;
+} sevenzip_block_cache;
+
 static void *sevenzip_stream_alloc_impl(ISzAllocPtr p, size_t size)
 {
    if (size == 0)
@@ -85,6 +144,408 @@ static void *sevenzip_stream_alloc_tmp_impl(ISzAllocPtr p, size_t size)
    return malloc(size);
 }
 
+static bool sevenzip_lzma2_decode_segment(
+      const sevenzip_lzma2_segment_t *segment, const uint8_t *src,
+      uint8_t *out, uint8_t prop)
+{
+   CLzma2Dec dec;
+   ISzAlloc alloc;
+   ELzmaStatus status;
+   SizeT src_len = segment->src_len;
+   SRes res;
+
+   alloc.Alloc = sevenzip_stream_alloc_impl;
+   alloc.Free  = sevenzip_stream_free_impl;
+
+   Lzma2Dec_Construct(&dec);
+   if (Lzma2Dec_AllocateProbs(&dec, prop, &alloc) != SZ_OK)
+      return false;
+
+   /* Decode straight into the block */
+   dec.decoder.dic        = out + segment->dst_pos;
+   dec.decoder.dicBufSize = segment->dst_len;
+   Lzma2Dec_Init(&dec);
+
+   res = Lzma2Dec_DecodeToDic(&dec, segment->dst_len,
+         src, &src_len, LZMA_FINISH_ANY, &status);
+
+   Lzma2Dec_FreeProbs(&dec, &alloc);
+
+   return res == SZ_OK
+      && src_len == segment->src_len
+      && dec.decoder.dicPos == segment->dst_len;
+}
+
+static void sevenzip_lzma2_decode_thread(void *data)
+{
+   sevenzip_lzma2_state_t *state = (sevenzip_lzma2_state_t*)data;
+   uint8_t *src                  = NULL;
+   size_t src_size               = 0;
+
+   for (;;)
+   {
+      size_t i;
+      bool error;
+      const sevenzip_lzma2_segment_t *segment = NULL;
+
+#ifdef HAVE_THREADS
+      slock_lock(state->lock);
+#endif
+      i     = state->next_segment++;
+      error = state->error;
+
+      /* Only the packed segment being decoded is in memory */
+      if (i < state->num_segments && !error)
+      {
+         segment = &state->segments[i];
+
+         if (segment->src_len > src_size)
+         {
+            free(src);
+            src_size = 0;
+            if ((src = (uint8_t*)malloc(segment->src_len)))
+               src_size = segment->src_len;
+         }
+
+         if (     !src
+               || LookInStream_SeekTo(state->stream,
+                  segment->src_pos) != SZ_OK
+               || LookInStream_Read(state->stream, src,
+                  segment->src_len) != SZ_OK)
+            error = state->error = true;
+      }
+#ifdef HAVE_THREADS
+      slock_unlock(state->lock);
+#endif
+
+      if (i >= state->num_segments || error)
+         break;
+
+      if (!sevenzip_lzma2_decode_segment(segment, src,
+               state->out, state->prop))
+      {
+#ifdef HAVE_THREADS
+         slock_lock(state->lock);
+#endif
+         state->error = true;
+#ifdef HAVE_THREADS
+         slock_unlock(state->lock);
+#endif
+      }
+   }
+
+   free(src);
+}
+
+/* Splits the LZMA2 stream at 'src_pos' at its dictionary
+ * resets, reading only the chunk headers. Returns false if
+ * the stream is malformed, does not decode to exactly
+ * 'out_size' bytes or has a part too large to be read whole */
+static bool sevenzip_lzma2_split(ILookInStream *stream,
+      uint64_t src_pos, uint64_t src_size, size_t out_size,
+      sevenzip_lzma2_segment_t **segments, size_t *num_segments)
+{
+   uint64_t pos                      = 0;
+   size_t out_pos                    = 0;
+   sevenzip_lzma2_segment_t *current = NULL;
+
+   for (;;)
+   {
+      uint8_t header[6];
+      unsigned control;
+      size_t unpack_size, pack_size, header_size;
+      size_t len = (size_t)MIN(sizeof(header), src_size - pos);
+
+      if (     pos >= src_size
+            || LookInStream_SeekTo(stream, src_pos + pos) != SZ_OK
+            || LookInStream_Read(stream, header, len) != SZ_OK)
+         return false;
+
+      /* End of stream */
+      if (!(control = header[0]))
+         break;
+
+      if (control == 1 || control == 2)
+      {
+         /* Uncompressed chunk */
+         if (len < 3)
+            return false;
+         unpack_size = ((header[1] << 8) | header[2]) + 1;
+         pack_size   = unpack_size;
+         header_size = 3;
+      }
+      else if (control >= 0x80)
+      {
+         /* LZMA chunk, the properties are reset from 0xC0 on */
+         if (len < 5)
+            return false;
+         unpack_size = ((size_t)(control & 0x1F) << 16)
+            + ((header[1] << 8) | header[2]) + 1;
+         pack_size   = ((header[3] << 8) | header[4]) + 1;
+         header_size = (control >= 0xC0) ? 6 : 5;
+      }
+      else
+         return false;
+
+      if (     pos + header_size + pack_size > src_size
+            || out_pos + unpack_size > out_size)
+         return false;
+
+      /* A new segment starts at each chunk resetting both
+       * the dictionary and the properties */
+      if (!current || control >= 0xE0)
+      {
+         sevenzip_lzma2_segment_t segment;
+
+         if (!current && control != 1 && control < 0xE0)
+            return false;
+
+         segment.src_pos = src_pos + pos;
+         segment.src_len = 0;
+         segment.dst_pos = out_pos;
+         segment.dst_len = 0;
+         RBUF_PUSH(*segments, segment);
+         current         = &(*segments)[RBUF_LEN(*segments) - 1];
+      }
+
+      current->src_len += header_size + pack_size;
+      current->dst_len += unpack_size;
+      pos              += header_size + pack_size;
+      out_pos          += unpack_size;
+
+      if (current->src_len > SEVENZIP_MT_MAX_SEGMENT_SIZE)
+         return false;
+   }
+
+   *num_segments = RBUF_LEN(*segments);
+
+   return out_pos == out_size;
+}
+
+/* Decodes a solid block made of a single LZMA2 stream, on
+ * as many threads as there are parts starting with a
+ * dictionary reset. These are only found in archives
+ * compressed on several threads.
+ *
+ * Returns the block, or NULL if it cannot be decoded this
+ * way - a stream made of a single part is left to the SDK */
+static uint8_t *sevenzip_decode_block_lzma2(const CSzArEx *db,
+      ILookInStream *stream, uint32_t block_index,
+      ISzAllocPtr alloc, size_t out_size)
+{
+   CSzData sd;
+   CSzFolder folder;
+   size_t i, num_threads;
+   sevenzip_lzma2_state_t state;
+   const uint8_t *coders        = db->db.CodersData
+      + db->db.FoCodersOffsets[block_index];
+   uint32_t pack_index          = db->db.FoStartPackStreamIndex[block_index];
+   uint64_t pack_size           = db->db.PackPositions[pack_index + 1]
+      - db->db.PackPositions[pack_index];
+   bool ret                     = false;
+#ifdef HAVE_THREADS
+   sthread_t *threads[16];
+#endif
+
+   sd.Data = coders;
+   sd.Size = db->db.FoCodersOffsets[block_index + 1]
+      - db->db.FoCodersOffsets[block_index];
+
+   if (     SzGetNextFolderItem(&folder, &sd) != SZ_OK
+         || folder.NumCoders            != 1
+         || folder.NumPackStreams       != 1
+         || folder.Coders[0].MethodID   != SEVENZIP_METHOD_LZMA2
+         || folder.Coders[0].PropsSize  != 1)
+      return NULL;
+
+   memset(&state, 0, sizeof(state));
+   state.prop   = coders[folder.Coders[0].PropsOffset];
+   state.stream = stream;
+
+   if (     !sevenzip_lzma2_split(stream,
+               db->dataPos + db->db.PackPositions[pack_index], pack_size,
+               out_size, &state.segments, &state.num_segments)
+         || state.num_segments < 2
+         || !(state.out = (uint8_t*)ISzAlloc_Alloc(alloc, out_size)))
+      goto end;
+
+   num_threads = 1;
+#ifdef HAVE_THREADS
+   num_threads = MIN(MIN(cpu_features_get_core_amount(),
+            state.num_segments), ARRAY_SIZE(threads));
+
+   if (num_threads > 1 && !(state.lock = slock_new()))
+      num_threads = 1;
+
+   for (i = 1; i < num_threads; i++)
+      if (!(threads[i] = sthread_create(
+                  sevenzip_lzma2_decode_thread, &state)))
+         break;
+   num_threads = i;
+#endif
+
+   /* This thread decodes segments as well */
+   sevenzip_lzma2_decode_thread(&state);
+
+#ifdef HAVE_THREADS
+   for (i = 1; i < num_threads; i++)
+      sthread_join(threads[i]);
+   slock_free(state.lock);
+#endif
+
+   if (state.error)
+      goto end;
+
+   ret = !SzBitWithVals_Check(&db->db.FolderCRCs, block_index)
+      || CrcCalc(state.out, out_size) == db->db.FolderCRCs.Vals[block_index];
+
+end:
+   RBUF_FREE(state.segments);
+   if (!ret)
+   {
+      ISzAlloc_Free(alloc, state.out);
+      state.out = NULL;
+   }
+   return state.out;
+}
+
+/* Gets the solid block holding 'file_index' into *output,
+ * from the cache or by decoding it, unless it is already
+ * there. SzArEx_Extract then only has to locate the member
+ * in the block, or decodes it itself if this failed */
+static void sevenzip_load_block(const char *path, const CSzArEx *db,
+      ILookInStream *stream, uint32_t file_index,
+      ISzAllocPtr alloc, uint8_t **output, size_t *output_size,
+      uint32_t *block_index)
+{
+   uint32_t index = db->FileToFolder[file_index];
+   uint64_t size;
+
+   if (index == (uint32_t)-1 || (*output && *block_index == index))
+      return;
+
+   ISzAlloc_Free(alloc, *output);
+   *output      = NULL;
+   *block_index = (uint32_t)-1;
+
+   if (path && sevenzip_block_cache.inited)
+   {
+      int64_t mtime = path_get_mtime(path);
+      int64_t len   = path_get_size(path);
+
+#ifdef HAVE_THREADS
+      slock_lock(sevenzip_block_cache.lock);
+#endif
+      /* The cached block is handed over */
+      if (     sevenzip_block_cache.output
+            && sevenzip_block_cache.block_index == index
+            && sevenzip_block_cache.mtime       == mtime
+            && sevenzip_block_cache.size        == len
+            && string_is_equal(sevenzip_block_cache.path, path))
+      {
+         *output                     = sevenzip_block_cache.output;
+         *output_size                = sevenzip_block_cache.output_size;
+         *block_index                = index;
+         sevenzip_block_cache.output = NULL;
+      }
+#ifdef HAVE_THREADS
+      slock_unlock(sevenzip_block_cache.lock);
+#endif
+
+      if (*output)
+         return;
+   }
+
+   size = SzAr_GetFolderUnpackSize(&db->db, index);
+
+   if (     size
+         && size == (size_t)size
+         && (*output = sevenzip_decode_block_lzma2(db, stream, index,
+               alloc, (size_t)size)))
+   {
+      *output_size = (size_t)size;
+      *block_index = index;
+   }
+}
+
+/* Hands a decoded block over to the cache, or frees it */
+static void sevenzip_release_block(const char *path,
+      ISzAllocPtr alloc, uint8_t *output, size_t output_size,
+      uint32_t block_index)
+{
+   if (     path
+         && output
+         && output_size <= SEVENZIP_BLOCK_CACHE_MAX_SIZE
+         && sevenzip_block_cache.inited)
+   {
+      char *cached_path = strdup(path);
+      int64_t mtime     = path_get_mtime(path);
+      int64_t size      = path_get_size(path);
+
+#ifdef HAVE_THREADS
+      slock_lock(sevenzip_block_cache.lock);
+#endif
+      free(sevenzip_block_cache.path);
+      free(sevenzip_block_cache.output);
+      sevenzip_block_cache.path        = cached_path;
+      sevenzip_block_cache.output      = output;
+      sevenzip_block_cache.output_size = output_size;
+      sevenzip_block_cache.mtime       = mtime;
+      sevenzip_block_cache.size        = size;
+      sevenzip_block_cache.block_index = block_index;
+#ifdef HAVE_THREADS
+      slock_unlock(sevenzip_block_cache.lock);
+#endif
+      return;
+   }
+
+   ISzAlloc_Free(alloc, output);
+}
+
+void file_archive_7z_block_cache_init(void)
+{
+   if (sevenzip_block_cache.inited)
+      return;
+
+#ifdef HAVE_THREADS
+   if (!(sevenzip_block_cache.lock = slock_new()))
+      return;
+#endif
+
+   sevenzip_block_cache.inited = true;
+}
+
+void file_archive_7z_block_cache_clear(void)
+{
+   if (!sevenzip_block_cache.inited)
+      return;
+
+#ifdef HAVE_THREADS
+   slock_lock(sevenzip_block_cache.lock);
+#endif
+   free(sevenzip_block_cache.path);
+   free(sevenzip_block_cache.output);
+   sevenzip_block_cache.path        = NULL;
+   sevenzip_block_cache.output      = NULL;
+   sevenzip_block_cache.output_size = 0;
+#ifdef HAVE_THREADS
+   slock_unlock(sevenzip_block_cache.lock);
+#endif
+}
+
+void file_archive_7z_block_cache_deinit(void)
+{
+   if (!sevenzip_block_cache.inited)
+      return;
+
+   free(sevenzip_block_cache.path);
+   free(sevenzip_block_cache.output);
+#ifdef HAVE_THREADS
+   slock_free(sevenzip_block_cache.lock);
+#endif
+   memset(&sevenzip_block_cache, 0, sizeof(sevenzip_block_cache));
+}
+
 static void* sevenzip_stream_new(void)
 {
    struct sevenzip_context_t *sevenzip_context =
@@ -115,11 +576,11 @@ static void sevenzip_parse_file_free(void *context)
    if (!sevenzip_context)
       return;
 
-   if (sevenzip_context->output)
-   {
-      IAlloc_Free(&sevenzip_context->allocImp, sevenzip_context->output);
-      sevenzip_context->output       = NULL;
-   }
+   sevenzip_release_block(sevenzip_context->path,
+         &sevenzip_context->allocImp, sevenzip_context->output,
+         sevenzip_context->output_size, sevenzip_context->block_index);
+   sevenzip_context->output = NULL;
+   free(sevenzip_context->path);
 
    SzArEx_Free(&sevenzip_context->db, &sevenzip_context->allocImp);
    File_Close(&sevenzip_context->archiveStream.file);
@@ -200,6 +661,7 @@ static int64_t sevenzip_file_read(
       bool file_found      = false;
       uint16_t *temp       = NULL;
       size_t temp_size     = 0;
+      size_t output_size   = 0;
       uint32_t block_index   = 0xFFFFFFFF;
       SRes res             = SZ_OK;
 
@@ -241,12 +703,12 @@ static int64_t sevenzip_file_read(
 
          if (string_is_equal(infile, needle))
          {
-            size_t output_size   = 0;
-
             /* C LZMA SDK does not support chunked extraction - see here:
              * sourceforge.net/p/sevenzip/discussion/45798/thread/6fb59aaf/
              * */
             file_found = true;
+            sevenzip_load_block(path, &db, &lookStream.vt, i, &allocImp,
+                  &output, &output_size, &block_index);
             res = SzArEx_Extract(&db, &lookStream.vt, i, &block_index,
                   &output, &output_size, &offset, &outSizeProcessed,
                   &allocImp, &allocTempImp);
@@ -284,7 +746,12 @@ static int64_t sevenzip_file_read(
 
       if (temp)
          free(temp);
-      IAlloc_Free(&allocImp, output);
+
+      if (res == SZ_OK)
+         sevenzip_release_block(path, &allocImp, output,
+               output_size, block_index);
+      else
+         IAlloc_Free(&allocImp, output);
 
       if (!(file_found && res == SZ_OK))
       {
@@ -328,14 +795,18 @@ static int sevenzip_stream_decompress_data_to_file_iterate(
          (struct sevenzip_context_t*)context;
 
    SRes res                = SZ_ERROR_FAIL;
-   size_t output_size      = 0;
    size_t offset           = 0;
    size_t outSizeProcessed = 0;
 
+   sevenzip_load_block(sevenzip_context->path, &sevenzip_context->db,
+         &sevenzip_context->lookStream.vt, sevenzip_context->decompress_index,
+         &sevenzip_context->allocImp, &sevenzip_context->output,
+         &sevenzip_context->output_size, &sevenzip_context->block_index);
+
    res = SzArEx_Extract(&sevenzip_context->db,
          &sevenzip_context->lookStream.vt, sevenzip_context->decompress_index,
          &sevenzip_context->block_index, &sevenzip_context->output,
-         &output_size, &offset, &outSizeProcessed,
+         &sevenzip_context->output_size, &offset, &outSizeProcessed,
          &sevenzip_context->allocImp, &sevenzip_context->allocTempImp);
 
    if (res != SZ_OK)
@@ -364,6 +835,7 @@ static int sevenzip_parse_file_init(file_archive_transfer_t *state,
       goto error;
 
    sevenzip_context = (struct sevenzip_context_t*)sevenzip_stream_new();
+   sevenzip_context->path = strdup(file);
    state->context = sevenzip_context;
 
 #if defined(_WIN32) && defined(USE_WINDOWS_FILE) && !defined(LEGACY_WIN32)
@@ -522,5 +994,6 @@ const struct file_archive_file_backend sevenzip_backend = {
    sevenzip_stream_decompress_data_to_file_iterate,
    sevenzip_stream_crc32_calculate,
    sevenzip_file_read,
+   NULL,
    "7z"
 };
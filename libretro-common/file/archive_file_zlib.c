@@ -24,10 +24,18 @@
 #include <string.h>
 
 #include <file/archive_file.h>
+#include <file/file_path.h>
 #include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <array/rbuf.h>
 #include <retro_inline.h>
 #include <retro_miscellaneous.h>
 #include <encodings/crc32.h>
+#include <lrc_hash.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include <zlib.h>
 
@@ -41,6 +49,9 @@
 
 #define _READ_CHUNK_SIZE   (128*1024)   /* Read 128KiB compressed chunks */
 
+/* Number of archive directories kept in memory */
+#define ZIP_INDEX_CACHE_SIZE 4
+
 enum file_archive_compression_mode
 {
    ZIP_MODE_STORED   = 0,
@@ -61,6 +72,38 @@ typedef struct
    uint8_t *decompressed_data;
 } zip_context_t;
 
+typedef struct
+{
+   const char *name;
+   uint32_t offset; /* Local file header */
+   uint32_t csize, size, crc;
+   unsigned cmode;
+} zip_index_entry_t;
+
+/* Parsed central directory of an archive, with a hash
+ * table of the member names */
+typedef struct
+{
+   char *path;
+   char *names;
+   zip_index_entry_t *entries; /* RBUF */
+   uint32_t *buckets;          /* Entry index + 1, 0 if empty */
+   int64_t mtime;
+   int64_t size;
+   size_t num_buckets;
+   unsigned last_used;
+} zip_index_t;
+
+static struct
+{
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   zip_index_t indexes[ZIP_INDEX_CACHE_SIZE];
+   unsigned counter;
+   bool inited;
+} zip_index_cache;
+
 static INLINE uint32_t read_le(const uint8_t *data, unsigned size)
 {
    unsigned i;
@@ -356,17 +399,71 @@ static int zip_file_decompressed(
    return 1;
 }
 
+static bool zip_index_find(const char *path, const char *name,
+      zip_index_entry_t *entry);
+
+/* Decompresses a member found in the archive index,
+ * without going through the directory */
+static int64_t zip_file_read_entry(
+      const char *path, const zip_index_entry_t *entry,
+      void **buf, const char *optional_outfile)
+{
+   file_archive_transfer_t state     = {0};
+   zip_context_t zip_context         = {0};
+   file_archive_file_handle_t handle = {0};
+   int64_t ret                       = -1;
+
+   if (!(state.archive_file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return -1;
+
+   state.archive_size = filestream_get_size(state.archive_file);
+   state.context      = &zip_context;
+   zip_context.state  = &state;
+
+   if (zip_file_decompressed_handle(&state, &handle,
+            (const uint8_t*)(size_t)entry->offset, entry->cmode,
+            entry->csize, entry->size, entry->crc))
+   {
+      if (optional_outfile)
+      {
+         if (filestream_write_file(optional_outfile,
+                  handle.data, entry->size))
+            ret = 0;
+      }
+      else
+      {
+         *buf                           = handle.data;
+         /* We keep the data, prevent its deallocation during free */
+         zip_context.decompressed_data  = NULL;
+         ret                            = entry->size;
+      }
+   }
+
+   zip_context_free_stream(&zip_context, false);
+   filestream_close(state.archive_file);
+
+   return ret;
+}
+
 static int64_t zip_file_read(
       const char *path,
       const char *needle, void **buf,
       const char *optional_outfile)
 {
+   zip_index_entry_t entry;
    file_archive_transfer_t state            = {0};
    decomp_state_t decomp                    = {0};
    struct archive_extract_userdata userdata = {0};
    bool returnerr                           = true;
    int ret                                  = 0;
 
+   /* Members are usually named exactly, look them up
+    * directly; otherwise search the directory */
+   if (needle && zip_index_find(path, needle, &entry))
+      return zip_file_read_entry(path, &entry, buf, optional_outfile);
+
    if (needle)
       decomp.needle          = strdup(needle);
    if (optional_outfile)
@@ -551,6 +648,303 @@ static void zip_parse_file_free(void *context)
    free(zip_context);
 }
 
+static void zip_index_free(zip_index_t *index)
+{
+   free(index->path);
+   free(index->names);
+   free(index->buckets);
+   RBUF_FREE(index->entries);
+   memset(index, 0, sizeof(*index));
+}
+
+static bool zip_index_build(zip_index_t *index, const char *path)
+{
+   size_t i, names_size;
+   char filename[PATH_MAX_LENGTH];
+   file_archive_transfer_t state = {0};
+   zip_context_t *zip_context    = NULL;
+   size_t names_len              = 0;
+   bool ret                      = false;
+
+   if (!(state.archive_file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   state.archive_size = filestream_get_size(state.archive_file);
+
+   if (zip_parse_file_init(&state, path) != 0)
+      goto end;
+
+   /* Each name takes less space than its directory entry */
+   zip_context = (zip_context_t*)state.context;
+   names_size  = zip_context->directory_end - zip_context->directory;
+
+   if (!(index->names = (char*)malloc(names_size + 1)))
+      goto end;
+
+   for (;;)
+   {
+      zip_index_entry_t entry;
+      const uint8_t *cdata = NULL;
+      unsigned payback     = 0;
+      size_t len;
+      int res              = zip_parse_file_iterate_step_internal(
+            zip_context, filename, &cdata, &entry.cmode,
+            &entry.size, &entry.csize, &entry.crc, &payback);
+
+      if (res == 0)
+         break;
+
+      len = strlen(filename) + 1;
+
+      if (res != 1 || names_len + len > names_size)
+         goto end;
+
+      memcpy(index->names + names_len, filename, len);
+      entry.name   = index->names + names_len;
+      entry.offset = (uint32_t)(size_t)cdata;
+      names_len   += len;
+
+      RBUF_PUSH(index->entries, entry);
+      zip_context->directory_entry += payback;
+   }
+
+   /* Keep the load factor under one half */
+   for (index->num_buckets = 16;
+         index->num_buckets < RBUF_LEN(index->entries) * 2;
+         index->num_buckets *= 2);
+
+   if (!(index->buckets = (uint32_t*)calloc(
+               index->num_buckets, sizeof(uint32_t))))
+      goto end;
+
+   for (i = 0; i < RBUF_LEN(index->entries); i++)
+   {
+      size_t mask   = index->num_buckets - 1;
+      size_t bucket = fnv1a_calculate(FNV1A_INIT,
+            index->entries[i].name, strlen(index->entries[i].name)) & mask;
+
+      /* The first of several members with the same name wins,
+       * as when walking the directory */
+      while (     index->buckets[bucket]
+            && !string_is_equal(
+               index->entries[index->buckets[bucket] - 1].name,
+               index->entries[i].name))
+         bucket = (bucket + 1) & mask;
+
+      if (!index->buckets[bucket])
+         index->buckets[bucket] = (uint32_t)(i + 1);
+   }
+
+   ret = true;
+
+end:
+   if (state.context)
+      zip_parse_file_free(state.context);
+   filestream_close(state.archive_file);
+
+   if (!ret)
+      zip_index_free(index);
+
+   return ret;
+}
+
+/* Returns the index of the archive 'path', parsing it if
+ * it is not cached or was modified. Called with the lock held */
+static zip_index_t *zip_index_cache_get(const char *path)
+{
+   size_t i;
+   zip_index_t *index = NULL;
+   int64_t mtime, size;
+
+   if (!zip_index_cache.inited)
+      return NULL;
+
+   mtime = path_get_mtime(path);
+   size  = path_get_size(path);
+
+   if (size <= 0)
+      return NULL;
+
+   for (i = 0; i < ZIP_INDEX_CACHE_SIZE; i++)
+   {
+      zip_index_t *cur = &zip_index_cache.indexes[i];
+
+      if (cur->path && string_is_equal(cur->path, path))
+      {
+         index = cur;
+         break;
+      }
+   }
+
+   /* Otherwise replace an unused or the least recently
+    * used index */
+   if (!index)
+   {
+      for (i = 0; i < ZIP_INDEX_CACHE_SIZE; i++)
+      {
+         zip_index_t *cur = &zip_index_cache.indexes[i];
+
+         if (     !index
+               || !cur->path
+               || (index->path
+                  && (zip_index_cache.counter - cur->last_used) >
+                     (zip_index_cache.counter - index->last_used)))
+            index = cur;
+
+         if (!cur->path)
+            break;
+      }
+   }
+
+   if (     !index->path
+         || index->mtime != mtime
+         || index->size  != size)
+   {
+      zip_index_free(index);
+
+      if (!zip_index_build(index, path))
+         return NULL;
+
+      index->path  = strdup(path);
+      index->mtime = mtime;
+      index->size  = size;
+   }
+
+   index->last_used = ++zip_index_cache.counter;
+
+   return index;
+}
+
+static const zip_index_entry_t *zip_index_lookup(
+      const zip_index_t *index, const char *name)
+{
+   size_t mask   = index->num_buckets - 1;
+   size_t bucket = fnv1a_calculate(FNV1A_INIT,
+         name, strlen(name)) & mask;
+
+   while (index->buckets[bucket])
+   {
+      const zip_index_entry_t *entry =
+         &index->entries[index->buckets[bucket] - 1];
+
+      if (string_is_equal(entry->name, name))
+         return entry;
+
+      bucket = (bucket + 1) & mask;
+   }
+
+   return NULL;
+}
+
+/* Copies the entry of member 'name', if the archive
+ * could be indexed and the member is a file */
+static bool zip_index_find(const char *path, const char *name,
+      zip_index_entry_t *entry)
+{
+   const zip_index_entry_t *found = NULL;
+   zip_index_t *index             = NULL;
+   size_t len                     = strlen(name);
+
+   if (     !zip_index_cache.inited
+         || !len
+         || name[len - 1] == '/'
+         || name[len - 1] == '\\')
+      return false;
+
+#ifdef HAVE_THREADS
+   slock_lock(zip_index_cache.lock);
+#endif
+   if (     (index = zip_index_cache_get(path))
+         && (found = zip_index_lookup(index, name)))
+      *entry = *found;
+#ifdef HAVE_THREADS
+   slock_unlock(zip_index_cache.lock);
+#endif
+
+   return found != NULL;
+}
+
+static bool zip_index_walk(const char *file, const char *name,
+      const char *valid_exts, struct archive_extract_userdata *userdata,
+      file_archive_file_cb file_cb)
+{
+   char path[PATH_MAX_LENGTH];
+   size_t i;
+   char *last         = NULL;
+   zip_index_t *index = NULL;
+
+   if (!zip_index_cache.inited)
+      return false;
+
+   strlcpy(path, file, sizeof(path));
+
+   if ((last = (char*)path_get_archive_delim(path)))
+      *last  = '\0';
+
+   /* Members are not decompressed */
+   userdata->transfer = NULL;
+
+#ifdef HAVE_THREADS
+   slock_lock(zip_index_cache.lock);
+#endif
+   if ((index = zip_index_cache_get(path)))
+   {
+      for (i = 0; i < RBUF_LEN(index->entries); i++)
+      {
+         const zip_index_entry_t *entry = &index->entries[i];
+
+         if (name && !(entry = zip_index_lookup(index, name)))
+            break;
+
+         strlcpy(userdata->current_file_path, entry->name,
+               sizeof(userdata->current_file_path));
+         userdata->crc = entry->crc;
+
+         if (     !file_cb(entry->name, valid_exts,
+                     (const uint8_t*)(size_t)entry->offset, entry->cmode,
+                     entry->csize, entry->size, entry->crc, userdata)
+               || name)
+            break;
+      }
+   }
+#ifdef HAVE_THREADS
+   slock_unlock(zip_index_cache.lock);
+#endif
+
+   return index != NULL;
+}
+
+void file_archive_zip_index_cache_init(void)
+{
+   if (zip_index_cache.inited)
+      return;
+
+#ifdef HAVE_THREADS
+   if (!(zip_index_cache.lock = slock_new()))
+      return;
+#endif
+
+   zip_index_cache.inited = true;
+}
+
+void file_archive_zip_index_cache_deinit(void)
+{
+   size_t i;
+
+   if (!zip_index_cache.inited)
+      return;
+
+   for (i = 0; i < ZIP_INDEX_CACHE_SIZE; i++)
+      zip_index_free(&zip_index_cache.indexes[i]);
+
+#ifdef HAVE_THREADS
+   slock_free(zip_index_cache.lock);
+#endif
+   memset(&zip_index_cache, 0, sizeof(zip_index_cache));
+}
+
 const struct file_archive_file_backend zlib_backend = {
    zip_parse_file_init,
    zip_parse_file_iterate_step,
@@ -559,5 +953,6 @@ const struct file_archive_file_backend zlib_backend = {
    zlib_stream_decompress_data_to_file_iterate,
    zlib_stream_crc32_calculate,
    zip_file_read,
+   zip_index_walk,
    "zlib"
 };
@@ -38,6 +38,7 @@
 
 #ifdef _WIN32
 #include <direct.h>
+#include <encodings/utf.h>
 #else
 #include <unistd.h> /* stat() is defined here */
 #endif
@@ -98,6 +99,51 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Gets the last modification time of a file or directory.
+ * Bypasses the VFS interface, which has no notion of
+ * timestamps - on platforms without a usable stat()
+ * this always returns 0, so callers using the result
+ * as a cache key should also check the file size.
+ *
+ * @return modification time in seconds since the epoch,
+ * or -1 if the path could not be stat'ed.
+ **/
+int64_t path_get_mtime(const char *path)
+{
+#if defined(VITA) || defined(__PSL1GHT__) || defined(__PS3__)
+   return path_is_valid(path) ? 0 : -1;
+#elif defined(_WIN32) && !defined(LEGACY_WIN32)
+   struct _stat stat_buf;
+   int ret            = -1;
+   wchar_t *path_wide = NULL;
+
+   if (!path || !*path)
+      return -1;
+   if ((path_wide = utf8_to_utf16_string_alloc(path)))
+   {
+      ret = _wstat(path_wide, &stat_buf);
+      free(path_wide);
+   }
+   if (ret < 0)
+      return -1;
+   return (int64_t)stat_buf.st_mtime;
+#elif defined(_WIN32)
+   struct _stat stat_buf;
+   if (!path || !*path || _stat(path, &stat_buf) < 0)
+      return -1;
+   return (int64_t)stat_buf.st_mtime;
+#else
+   struct stat stat_buf;
+   if (!path || !*path || stat(path, &stat_buf) < 0)
+      return -1;
+   return (int64_t)stat_buf.st_mtime;
+#endif
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
@@ -34,6 +34,11 @@ extern nbio_intf_t nbio_mmap_unix;
 extern nbio_intf_t nbio_mmap_win32;
 extern nbio_intf_t nbio_stdio;
 
+#ifdef HAVE_IO_URING
+extern nbio_intf_t nbio_uring;
+bool nbio_uring_available(void);
+#endif
+
 #ifndef _XBOX
 #if defined(_WIN32)
 #if defined(_MSC_VER) && _MSC_VER >= 1500
@@ -62,42 +67,65 @@ static nbio_intf_t *internal_nbio = &nbio_mmap_win32;
 static nbio_intf_t *internal_nbio = &nbio_stdio;
 #endif
 
+static nbio_intf_t *nbio_get_intf(void)
+{
+#ifdef HAVE_IO_URING
+   /* io_uring may be missing or blocked at runtime */
+   if (nbio_uring_available())
+      return &nbio_uring;
+#endif
+   return internal_nbio;
+}
+
 void *nbio_open(const char * filename, unsigned mode)
 {
-   return internal_nbio->open(filename, mode);
+   return nbio_get_intf()->open(filename, mode);
 }
 
 void nbio_begin_read(void *data)
 {
-   internal_nbio->begin_read(data);
+   nbio_get_intf()->begin_read(data);
+}
+
+void nbio_begin_read_batch(void **handles, size_t count)
+{
+   size_t i;
+   nbio_intf_t *intf = nbio_get_intf();
+
+   if (intf->begin_read_batch)
+      intf->begin_read_batch(handles, count);
+   else
+      for (i = 0; i < count; i++)
+         if (handles[i])
+            intf->begin_read(handles[i]);
 }
 
 void nbio_begin_write(void *data)
 {
-   internal_nbio->begin_write(data);
+   nbio_get_intf()->begin_write(data);
 }
 
 bool nbio_iterate(void *data)
 {
-   return internal_nbio->iterate(data);
+   return nbio_get_intf()->iterate(data);
 }
 
 void nbio_resize(void *data, size_t len)
 {
-   internal_nbio->resize(data, len);
+   nbio_get_intf()->resize(data, len);
 }
 
 void *nbio_get_ptr(void *data, size_t* len)
 {
-   return internal_nbio->get_ptr(data, len);
+   return nbio_get_intf()->get_ptr(data, len);
 }
 
 void nbio_cancel(void *data)
 {
-   internal_nbio->cancel(data);
+   nbio_get_intf()->cancel(data);
 }
 
 void nbio_free(void *data)
 {
-   internal_nbio->free(data);
+   nbio_get_intf()->free(data);
 }
@@ -217,6 +217,7 @@ nbio_intf_t nbio_linux = {
    nbio_linux_get_ptr,
    nbio_linux_cancel,
    nbio_linux_free,
+   NULL,
    "nbio_linux",
 };
 #else
@@ -229,6 +230,7 @@ nbio_intf_t nbio_linux = {
    NULL,
    NULL,
    NULL,
+   NULL,
    "nbio_linux",
 };
 
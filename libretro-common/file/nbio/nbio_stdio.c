@@ -299,5 +299,6 @@ nbio_intf_t nbio_stdio = {
    nbio_stdio_get_ptr,
    nbio_stdio_cancel,
    nbio_stdio_free,
+   NULL,
    "nbio_stdio",
 };
@@ -166,6 +166,7 @@ nbio_intf_t nbio_mmap_unix = {
    nbio_mmap_unix_get_ptr,
    nbio_mmap_unix_cancel,
    nbio_mmap_unix_free,
+   NULL,
    "nbio_mmap_unix",
 };
 #else
@@ -178,6 +179,7 @@ nbio_intf_t nbio_mmap_unix = {
    NULL,
    NULL,
    NULL,
+   NULL,
    "nbio_mmap_unix",
 };
 
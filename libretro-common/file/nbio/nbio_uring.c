@@ -0,0 +1,500 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (nbio_uring.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <file/nbio.h>
+
+#if defined(__linux__) && defined(HAVE_IO_URING)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#ifdef HAVE_THREADS
+#include <pthread.h>
+#endif
+
+/* Every handle shares a single ring, so that reads of
+ * many files are in flight at the same time and are
+ * submitted together. Operations are only queued when
+ * they begin, and submitted by the next nbio_iterate()
+ * or nbio_begin_read_batch() call */
+#define NBIO_URING_ENTRIES 64
+
+struct nbio_uring_t
+{
+   void *ptr;
+   struct iovec iov;
+   size_t len;
+   size_t done;
+   int fd;
+   uint8_t op;
+   bool blocking;
+   bool busy;
+   /* Waiting for room in the ring */
+   bool queued;
+   /* Submitted, completion not reaped yet */
+   bool inflight;
+};
+
+struct nbio_uring_ring
+{
+   struct io_uring_sqe *sqes;
+   struct io_uring_cqe *cqes;
+   unsigned *sq_head;
+   unsigned *sq_tail;
+   unsigned *sq_mask;
+   unsigned *sq_array;
+   unsigned *cq_head;
+   unsigned *cq_tail;
+   unsigned *cq_mask;
+   void *sq_ptr;
+   void *cq_ptr;
+   size_t sq_size;
+   size_t cq_size;
+   size_t sqes_size;
+   unsigned sq_entries;
+   unsigned cq_entries;
+   unsigned to_submit;
+   unsigned inflight;
+   int fd;
+   /* 0: not set up yet, 1: ready, -1: unavailable */
+   int state;
+};
+
+static struct nbio_uring_ring nbio_uring_ring;
+
+#ifdef HAVE_THREADS
+static pthread_mutex_t nbio_uring_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define NBIO_URING_LOCK()   pthread_mutex_lock(&nbio_uring_mutex)
+#define NBIO_URING_UNLOCK() pthread_mutex_unlock(&nbio_uring_mutex)
+#else
+#define NBIO_URING_LOCK()
+#define NBIO_URING_UNLOCK()
+#endif
+
+/* No liburing, for the same reason as nbio_linux */
+
+static int nbio_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+   return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int nbio_uring_enter(int fd, unsigned to_submit,
+      unsigned min_complete, unsigned flags)
+{
+   return (int)syscall(__NR_io_uring_enter, fd, to_submit,
+         min_complete, flags, NULL, 0);
+}
+
+static bool nbio_uring_ring_init(struct nbio_uring_ring *ring)
+{
+   struct io_uring_params p;
+   uint8_t *sq_ptr = NULL;
+   uint8_t *cq_ptr = NULL;
+
+   memset(&p, 0, sizeof(p));
+
+   if ((ring->fd = nbio_uring_setup(NBIO_URING_ENTRIES, &p)) < 0)
+      return false;
+
+   ring->sq_size   = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+   ring->cq_size   = p.cq_off.cqes
+      + p.cq_entries * sizeof(struct io_uring_cqe);
+   ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+   ring->sq_ptr    = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+         MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+   ring->cq_ptr    = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+         MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+   ring->sqes      = (struct io_uring_sqe*)mmap(NULL, ring->sqes_size,
+         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+         ring->fd, IORING_OFF_SQES);
+
+   if (     ring->sq_ptr == MAP_FAILED
+         || ring->cq_ptr == MAP_FAILED
+         || ring->sqes   == MAP_FAILED)
+   {
+      if (ring->sq_ptr != MAP_FAILED)
+         munmap(ring->sq_ptr, ring->sq_size);
+      if (ring->cq_ptr != MAP_FAILED)
+         munmap(ring->cq_ptr, ring->cq_size);
+      if (ring->sqes   != MAP_FAILED)
+         munmap(ring->sqes, ring->sqes_size);
+      close(ring->fd);
+      return false;
+   }
+
+   sq_ptr           = (uint8_t*)ring->sq_ptr;
+   cq_ptr           = (uint8_t*)ring->cq_ptr;
+   ring->sq_head    = (unsigned*)(sq_ptr + p.sq_off.head);
+   ring->sq_tail    = (unsigned*)(sq_ptr + p.sq_off.tail);
+   ring->sq_mask    = (unsigned*)(sq_ptr + p.sq_off.ring_mask);
+   ring->sq_array   = (unsigned*)(sq_ptr + p.sq_off.array);
+   ring->cq_head    = (unsigned*)(cq_ptr + p.cq_off.head);
+   ring->cq_tail    = (unsigned*)(cq_ptr + p.cq_off.tail);
+   ring->cq_mask    = (unsigned*)(cq_ptr + p.cq_off.ring_mask);
+   ring->cqes       = (struct io_uring_cqe*)(cq_ptr + p.cq_off.cqes);
+   ring->sq_entries = p.sq_entries;
+   ring->cq_entries = p.cq_entries;
+   ring->to_submit  = 0;
+   ring->inflight   = 0;
+
+   return true;
+}
+
+/* The ring is set up on first use and kept for the lifetime
+ * of the process. Returns false if io_uring is missing or
+ * blocked, in which case another backend must be used */
+bool nbio_uring_available(void)
+{
+   int state = __atomic_load_n(&nbio_uring_ring.state, __ATOMIC_ACQUIRE);
+
+   if (state == 0)
+   {
+      NBIO_URING_LOCK();
+      if ((state = nbio_uring_ring.state) == 0)
+      {
+         state = nbio_uring_ring_init(&nbio_uring_ring) ? 1 : -1;
+         __atomic_store_n(&nbio_uring_ring.state, state, __ATOMIC_RELEASE);
+      }
+      NBIO_URING_UNLOCK();
+   }
+
+   return state == 1;
+}
+
+/* Returns false if there is no room in the ring. The number
+ * of operations in flight is bounded by the size of the
+ * completion queue, so that it can never overflow */
+static bool nbio_uring_queue(struct nbio_uring_ring *ring,
+      struct nbio_uring_t *handle)
+{
+   struct io_uring_sqe *sqe;
+   unsigned index;
+   unsigned tail = *ring->sq_tail;
+
+   if (     ring->inflight >= ring->cq_entries
+         || tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE)
+            >= ring->sq_entries)
+      return false;
+
+   index                 = tail & *ring->sq_mask;
+   sqe                   = &ring->sqes[index];
+   handle->iov.iov_base  = (uint8_t*)handle->ptr + handle->done;
+   handle->iov.iov_len   = handle->len - handle->done;
+
+   memset(sqe, 0, sizeof(*sqe));
+   sqe->opcode           = handle->op;
+   sqe->fd               = handle->fd;
+   sqe->addr             = (uint64_t)(uintptr_t)&handle->iov;
+   sqe->len              = 1;
+   sqe->off              = handle->done;
+   sqe->user_data        = (uint64_t)(uintptr_t)handle;
+   ring->sq_array[index] = index;
+
+   __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+   ring->to_submit++;
+   ring->inflight++;
+   handle->queued        = false;
+   handle->inflight      = true;
+
+   return true;
+}
+
+static void nbio_uring_submit(struct nbio_uring_ring *ring,
+      unsigned min_complete)
+{
+   int ret;
+
+   if (!ring->to_submit && !min_complete)
+      return;
+
+   ret = nbio_uring_enter(ring->fd, ring->to_submit, min_complete,
+         min_complete ? IORING_ENTER_GETEVENTS : 0);
+
+   /* Entries that were not consumed are
+    * submitted again by the next call */
+   if (ret > 0)
+      ring->to_submit -= ((unsigned)ret < ring->to_submit)
+         ? (unsigned)ret : ring->to_submit;
+}
+
+static void nbio_uring_reap(struct nbio_uring_ring *ring)
+{
+   unsigned head = *ring->cq_head;
+   unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+   for (; head != tail; head++)
+   {
+      struct io_uring_cqe *cqe       = &ring->cqes[head & *ring->cq_mask];
+      struct nbio_uring_t *handle    =
+         (struct nbio_uring_t*)(uintptr_t)cqe->user_data;
+
+      ring->inflight--;
+      handle->inflight = false;
+
+      if (cqe->res > 0)
+         handle->done += cqe->res;
+
+      /* Short transfers are continued where they stopped */
+      if (     (cqe->res > 0 && handle->done < handle->len)
+            || cqe->res == -EINTR
+            || cqe->res == -EAGAIN)
+         handle->queued = true;
+      else
+      {
+         /* Like the other backends, errors are not
+          * reported: a failed read leaves less data */
+         if (handle->op == IORING_OP_READV)
+            handle->len = handle->done;
+         handle->busy   = false;
+      }
+   }
+
+   __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/* Lock must be held */
+static void nbio_uring_poll(struct nbio_uring_t *handle, bool wait)
+{
+   struct nbio_uring_ring *ring = &nbio_uring_ring;
+
+   do
+   {
+      if (handle->queued)
+         nbio_uring_queue(ring, handle);
+      nbio_uring_submit(ring, (wait && ring->inflight) ? 1 : 0);
+      nbio_uring_reap(ring);
+   } while (wait && (handle->inflight || (handle->busy && handle->queued)));
+}
+
+/* Lock must be held */
+static void nbio_uring_begin_op(struct nbio_uring_t *handle, uint8_t op)
+{
+   if (handle->busy)
+      return;
+
+   handle->op     = op;
+   handle->done   = 0;
+   handle->busy   = (handle->len > 0);
+   handle->queued = handle->busy;
+
+   if (handle->queued)
+      nbio_uring_queue(&nbio_uring_ring, handle);
+
+   if (handle->blocking)
+      nbio_uring_poll(handle, true);
+}
+
+static void *nbio_uring_open(const char * filename, unsigned mode)
+{
+   static const int o_flags[]  =   { O_RDONLY, O_RDWR|O_CREAT|O_TRUNC, O_RDWR, O_RDONLY, O_RDWR|O_CREAT|O_TRUNC };
+
+   off_t len;
+   struct nbio_uring_t* handle = NULL;
+   int fd                      = open(filename, o_flags[mode]|O_CLOEXEC, 0644);
+   if (fd < 0)
+      return NULL;
+
+   if (     (len = lseek(fd, 0, SEEK_END)) < 0
+         || !(handle = (struct nbio_uring_t*)calloc(1, sizeof(*handle))))
+   {
+      close(fd);
+      return NULL;
+   }
+
+   handle->fd       = fd;
+   handle->len      = (size_t)len;
+   handle->ptr      = malloc(handle->len);
+   handle->blocking = (mode == BIO_READ || mode == BIO_WRITE);
+
+   if (handle->len && !handle->ptr)
+   {
+      close(fd);
+      free(handle);
+      return NULL;
+   }
+
+   return handle;
+}
+
+static void nbio_uring_begin_read(void *data)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   NBIO_URING_LOCK();
+   nbio_uring_begin_op(handle, IORING_OP_READV);
+   NBIO_URING_UNLOCK();
+}
+
+static void nbio_uring_begin_write(void *data)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   NBIO_URING_LOCK();
+   nbio_uring_begin_op(handle, IORING_OP_WRITEV);
+   NBIO_URING_UNLOCK();
+}
+
+static void nbio_uring_begin_read_batch(void **handles, size_t count)
+{
+   size_t i;
+
+   NBIO_URING_LOCK();
+   for (i = 0; i < count; i++)
+      if (handles[i])
+         nbio_uring_begin_op((struct nbio_uring_t*)handles[i],
+               IORING_OP_READV);
+   nbio_uring_submit(&nbio_uring_ring, 0);
+   NBIO_URING_UNLOCK();
+}
+
+static bool nbio_uring_iterate(void *data)
+{
+   bool done                   = false;
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return false;
+
+   NBIO_URING_LOCK();
+   nbio_uring_poll(handle, false);
+   done = !handle->busy;
+   NBIO_URING_UNLOCK();
+
+   return done;
+}
+
+static void nbio_uring_resize(void *data, size_t len)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   /* Same restriction as the other backends */
+   if (len < handle->len || handle->busy)
+      abort();
+
+   if (ftruncate(handle->fd, len) != 0)
+      abort();
+
+   handle->ptr = realloc(handle->ptr, len);
+   handle->len = len;
+}
+
+static void *nbio_uring_get_ptr(void *data, size_t* len)
+{
+   bool busy                   = false;
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return NULL;
+
+   NBIO_URING_LOCK();
+   busy = handle->busy;
+   if (len)
+      *len = handle->len;
+   NBIO_URING_UNLOCK();
+
+   if (!busy)
+      return handle->ptr;
+   return NULL;
+}
+
+static void nbio_uring_cancel(void *data)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   NBIO_URING_LOCK();
+   /* The kernel may be accessing the buffer until
+    * the completion is reaped, so wait for it */
+   while (handle->inflight)
+   {
+      nbio_uring_submit(&nbio_uring_ring, 1);
+      nbio_uring_reap(&nbio_uring_ring);
+   }
+   handle->queued = false;
+   handle->busy   = false;
+   NBIO_URING_UNLOCK();
+}
+
+static void nbio_uring_free(void *data)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   nbio_uring_cancel(handle);
+   close(handle->fd);
+   free(handle->ptr);
+   free(handle);
+}
+
+nbio_intf_t nbio_uring = {
+   nbio_uring_open,
+   nbio_uring_begin_read,
+   nbio_uring_begin_write,
+   nbio_uring_iterate,
+   nbio_uring_resize,
+   nbio_uring_get_ptr,
+   nbio_uring_cancel,
+   nbio_uring_free,
+   nbio_uring_begin_read_batch,
+   "nbio_uring",
+};
+#else
+bool nbio_uring_available(void)
+{
+   return false;
+}
+
+nbio_intf_t nbio_uring = {
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   "nbio_uring",
+};
+
+#endif
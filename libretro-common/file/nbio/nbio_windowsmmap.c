@@ -219,6 +219,7 @@ nbio_intf_t nbio_mmap_win32 = {
    nbio_mmap_win32_get_ptr,
    nbio_mmap_win32_cancel,
    nbio_mmap_win32_free,
+   NULL,
    "nbio_mmap_win32",
 };
 #else
@@ -231,6 +232,7 @@ nbio_intf_t nbio_mmap_win32 = {
    NULL,
    NULL,
    NULL,
+   NULL,
    "nbio_mmap_win32",
 };
 
@@ -27,6 +27,9 @@
 
 #include <boolean.h>
 #include <formats/image.h>
+#ifdef HAVE_RPNG
+#include <formats/rpng.h>
+#endif
 #include <file/nbio.h>
 #include <string/stdstring.h>
 
@@ -190,13 +193,37 @@ static bool image_texture_internal_gx_convert_texture32(
 }
 #endif
 
+/* Replaces the ARGB8888 pixels of @img with RGB565 ones */
+static bool image_texture_convert_rgb565(struct texture_image *img)
+{
+   size_t i;
+   size_t count  = (size_t)img->width * img->height;
+   uint16_t *out = (uint16_t*)malloc(count * sizeof(uint16_t));
+
+   if (!out)
+      return false;
+
+   for (i = 0; i < count; i++)
+   {
+      uint32_t col = img->pixels[i];
+      out[i]       = (uint16_t)(((col >> 8) & 0xf800)
+            | ((col >> 5) & 0x07e0) | ((col >> 3) & 0x001f));
+   }
+
+   free(img->pixels);
+   img->pixels = (uint32_t*)out;
+   return true;
+}
+
 static bool image_texture_load_internal(
       enum image_type_enum type,
       void *ptr,
       size_t len,
       struct texture_image *out_img,
       unsigned a_shift, unsigned r_shift,
-      unsigned g_shift, unsigned b_shift)
+      unsigned g_shift, unsigned b_shift,
+      unsigned max_width, unsigned max_height,
+      bool rgb565)
 {
    int ret;
    bool success = false;
@@ -207,6 +234,16 @@ static bool image_texture_load_internal(
 
    image_transfer_set_buffer_ptr(img, type, (uint8_t*)ptr, len);
 
+#ifdef HAVE_RPNG
+   /* PNG images are decoded to RGB565 directly,
+    * without an intermediate ARGB8888 image */
+   if (rgb565 && type == IMAGE_TYPE_PNG)
+      rpng_set_output_rgb565((rpng_t*)img, true);
+#endif
+
+   if (max_width || max_height)
+      image_transfer_set_target_size(img, type, max_width, max_height);
+
    if (!image_transfer_start(img, type))
       goto end;
 
@@ -225,6 +262,19 @@ static bool image_texture_load_internal(
    if (ret == IMAGE_PROCESS_ERROR || ret == IMAGE_PROCESS_ERROR_END)
       goto end;
 
+   if (rgb565)
+   {
+      if (     type != IMAGE_TYPE_PNG
+            && !image_texture_convert_rgb565(out_img))
+      {
+         image_texture_free(out_img);
+         goto end;
+      }
+
+      success = true;
+      goto end;
+   }
+
    image_texture_color_convert(r_shift, g_shift, b_shift,
          a_shift, out_img);
 
@@ -268,7 +318,7 @@ bool image_texture_load_buffer(struct texture_image *out_img,
    {
       if (image_texture_load_internal(
          type, buffer, buffer_len, out_img,
-         a_shift, r_shift, g_shift, b_shift))
+         a_shift, r_shift, g_shift, b_shift, 0, 0, false))
       {
          return true;
       }
@@ -282,8 +332,9 @@ bool image_texture_load_buffer(struct texture_image *out_img,
    return false;
 }
 
-bool image_texture_load(struct texture_image *out_img,
-      const char *path)
+static bool image_texture_load_file(struct texture_image *out_img,
+      const char *path, unsigned max_width, unsigned max_height,
+      bool rgb565)
 {
    unsigned r_shift, g_shift, b_shift, a_shift;
    size_t file_len             = 0;
@@ -311,7 +362,8 @@ bool image_texture_load(struct texture_image *out_img,
       if (image_texture_load_internal(
                type,
                ptr, file_len, out_img,
-               a_shift, r_shift, g_shift, b_shift))
+               a_shift, r_shift, g_shift, b_shift,
+               max_width, max_height, rgb565))
          goto success;
    }
 
@@ -331,3 +383,78 @@ success:
 
    return true;
 }
+
+bool image_texture_load_scaled(struct texture_image *out_img,
+      const char *path, unsigned max_width, unsigned max_height)
+{
+   return image_texture_load_file(out_img, path,
+         max_width, max_height, false);
+}
+
+bool image_texture_load(struct texture_image *out_img,
+      const char *path)
+{
+   return image_texture_load_file(out_img, path, 0, 0, false);
+}
+
+bool image_texture_load_rgb565(struct texture_image *out_img,
+      const char *path)
+{
+   out_img->supports_rgba = false;
+   return image_texture_load_file(out_img, path, 0, 0, true);
+}
+
+void image_texture_load_list(const char **paths, size_t count,
+      bool supports_rgba, image_texture_list_cb_t cb, void *userdata)
+{
+   size_t i;
+   unsigned r_shift, g_shift, b_shift, a_shift;
+   struct texture_image img;
+   void **handles = NULL;
+
+   if (!count || !(handles = (void**)calloc(count, sizeof(*handles))))
+      return;
+
+   img.supports_rgba = supports_rgba;
+   image_texture_set_color_shifts(&r_shift, &g_shift, &b_shift,
+         &a_shift, &img);
+
+   for (i = 0; i < count; i++)
+      if (     paths[i]
+            && image_texture_get_type(paths[i]) != IMAGE_TYPE_NONE)
+         handles[i] = nbio_open(paths[i], NBIO_READ);
+
+   /* All the files are read at the same time, and
+    * decoded one by one as their reads complete */
+   nbio_begin_read_batch(handles, count);
+
+   for (i = 0; i < count; i++)
+   {
+      size_t file_len = 0;
+      void *ptr       = NULL;
+
+      if (!handles[i])
+         continue;
+
+      while (!nbio_iterate(handles[i]));
+
+      img.pixels        = NULL;
+      img.width         = 0;
+      img.height        = 0;
+      img.supports_rgba = supports_rgba;
+
+      if (     (ptr = nbio_get_ptr(handles[i], &file_len))
+            && image_texture_load_internal(
+               image_texture_get_type(paths[i]),
+               ptr, file_len, &img,
+               a_shift, r_shift, g_shift, b_shift, 0, 0, false))
+      {
+         cb(&img, i, userdata);
+         image_texture_free(&img);
+      }
+
+      nbio_free(handles[i]);
+   }
+
+   free(handles);
+}
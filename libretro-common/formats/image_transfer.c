@@ -208,6 +208,29 @@ void image_transfer_set_buffer_ptr(
    }
 }
 
+/* Hints the size the image is going to be displayed at,
+ * decoders that can skip detail (JPEG) decode at a
+ * reduced scale that still covers it */
+void image_transfer_set_target_size(
+      void *data,
+      enum image_type_enum type,
+      unsigned width, unsigned height)
+{
+   switch (type)
+   {
+      case IMAGE_TYPE_JPEG:
+#ifdef HAVE_RJPEG
+         rjpeg_set_target_size((rjpeg_t*)data, width, height);
+#endif
+         break;
+      case IMAGE_TYPE_PNG:
+      case IMAGE_TYPE_TGA:
+      case IMAGE_TYPE_BMP:
+      case IMAGE_TYPE_NONE:
+         break;
+   }
+}
+
 int image_transfer_process(
       void *data,
       enum image_type_enum type,
@@ -67,6 +67,8 @@ typedef struct
 struct rjpeg
 {
    uint8_t *buff_data;
+   unsigned target_width;
+   unsigned target_height;
 };
 
 #ifdef _MSC_VER
@@ -220,6 +222,9 @@ typedef struct
    int            eob_run;
    int scan_n, order[4];
    int restart_interval, todo;
+   int scale_shift;              /* decode at 1/(1 << scale_shift) size */
+   unsigned target_width;        /* smallest size worth decoding at */
+   unsigned target_height;
    uint32_t       code_buffer;   /* jpeg entropy-coded buffer */
    rjpeg_huffman huff_dc[4];     /* unsigned int alignment */
    rjpeg_huffman huff_ac[4];     /* unsigned int alignment */
@@ -771,7 +776,7 @@ static INLINE uint8_t rjpeg_clamp(int x)
 {
    /* trick to use a single test to catch both cases */
    if ((unsigned int) x > 255)
-      return 255;
+      return (x < 0) ? 0 : 255;
    return (uint8_t) x;
 }
 
@@ -890,6 +895,70 @@ static void rjpeg_idct_block(uint8_t *out, int out_stride, short data[64])
    }
 }
 
+/* Reduced size IDCTs, used when decoding at 1/2, 1/4 or 1/8
+ * scale. Only the low frequency coefficients that fit in the
+ * smaller block are kept, each weighted so that the output
+ * is the box average of what the full IDCT would produce. */
+static const int rjpeg_idct_4x4_table[4 * 4] = {
+   RJPEG_F2F(0.35355339f), RJPEG_F2F( 0.45306372f), RJPEG_F2F( 0.32664074f), RJPEG_F2F( 0.15909482f),
+   RJPEG_F2F(0.35355339f), RJPEG_F2F( 0.18766514f), RJPEG_F2F(-0.32664074f), RJPEG_F2F(-0.38408888f),
+   RJPEG_F2F(0.35355339f), RJPEG_F2F(-0.18766514f), RJPEG_F2F(-0.32664074f), RJPEG_F2F( 0.38408888f),
+   RJPEG_F2F(0.35355339f), RJPEG_F2F(-0.45306372f), RJPEG_F2F( 0.32664074f), RJPEG_F2F(-0.15909482f)
+};
+
+static const int rjpeg_idct_2x2_table[2 * 2] = {
+   RJPEG_F2F(0.35355339f), RJPEG_F2F( 0.32036443f),
+   RJPEG_F2F(0.35355339f), RJPEG_F2F(-0.32036443f)
+};
+
+static void rjpeg_idct_reduced(uint8_t *out, int out_stride,
+      const short *data, const int *table, int n)
+{
+   int x, y, k;
+   int val[4 * 4];
+
+   /* columns, keeping 2 fractional bits */
+   for (x = 0; x < n; ++x)
+   {
+      for (y = 0; y < n; ++y)
+      {
+         int sum = 0;
+         for (k = 0; k < n; ++k)
+            sum += table[y * n + k] * data[k * 8 + x];
+         val[y * n + x] = (sum + 512) >> 10;
+      }
+   }
+
+   /* rows, with rounding and the +128 level shift */
+   for (y = 0; y < n; ++y, out += out_stride)
+   {
+      for (x = 0; x < n; ++x)
+      {
+         int sum = 8192 + (128 << 14);
+         for (k = 0; k < n; ++k)
+            sum += table[x * n + k] * val[y * n + k];
+         out[x] = rjpeg_clamp(sum >> 14);
+      }
+   }
+}
+
+static void rjpeg_idct_block_4x4(uint8_t *out, int out_stride, short data[64])
+{
+   rjpeg_idct_reduced(out, out_stride, data, rjpeg_idct_4x4_table, 4);
+}
+
+static void rjpeg_idct_block_2x2(uint8_t *out, int out_stride, short data[64])
+{
+   rjpeg_idct_reduced(out, out_stride, data, rjpeg_idct_2x2_table, 2);
+}
+
+static void rjpeg_idct_block_1x1(uint8_t *out, int out_stride, short data[64])
+{
+   (void)out_stride;
+   /* DC alone is 8 times the block average */
+   *out = rjpeg_clamp(((data[0] + 4) >> 3) + 128);
+}
+
 #if defined(__SSE2__)
 /* sse2 integer IDCT. not the fastest possible implementation but it
  * produces bit-identical results to the generic C version so it's
@@ -1388,7 +1457,8 @@ static int rjpeg_parse_entropy_coded_data(rjpeg_jpeg *z)
                         z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq]))
                   return 0;
 
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8,
+               z->idct_block_kernel(z->img_comp[n].data
+                     + ((z->img_comp[n].w2 * j * 8 + i * 8) >> z->scale_shift),
                      z->img_comp[n].w2, data);
 
                /* every data block is an MCU, so countdown the restart interval */
@@ -1478,7 +1548,8 @@ static int rjpeg_parse_entropy_coded_data(rjpeg_jpeg *z)
                                  n, z->dequant[z->img_comp[n].tq]))
                            return 0;
 
-                        z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*y2+x2,
+                        z->idct_block_kernel(z->img_comp[n].data
+                              + ((z->img_comp[n].w2 * y2 + x2) >> z->scale_shift),
                               z->img_comp[n].w2, data);
                      }
                   }
@@ -1527,7 +1598,8 @@ static void rjpeg_jpeg_finish(rjpeg_jpeg *z)
          {
             short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
             rjpeg_jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-            z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8,
+            z->idct_block_kernel(z->img_comp[n].data
+                  + ((z->img_comp[n].w2 * j * 8 + i * 8) >> z->scale_shift),
                   z->img_comp[n].w2, data);
          }
       }
@@ -1805,6 +1877,33 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
    z->img_mcu_x = (s->img_x + z->img_mcu_w-1) / z->img_mcu_w;
    z->img_mcu_y = (s->img_y + z->img_mcu_h-1) / z->img_mcu_h;
 
+   /* Decode at the smallest scale that is still at least as
+    * large as the image fitted inside the target box, the IDCT
+    * then only produces 4x4, 2x2 or 1x1 pixels per block */
+   z->scale_shift = 0;
+   if (z->target_width || z->target_height)
+   {
+      while (z->scale_shift < 3
+            && (  (z->target_width
+                  && (s->img_x >> (z->scale_shift + 1)) >= z->target_width)
+               || (z->target_height
+                  && (s->img_y >> (z->scale_shift + 1)) >= z->target_height)))
+         z->scale_shift++;
+   }
+
+   switch (z->scale_shift)
+   {
+      case 1:
+         z->idct_block_kernel = rjpeg_idct_block_4x4;
+         break;
+      case 2:
+         z->idct_block_kernel = rjpeg_idct_block_2x2;
+         break;
+      case 3:
+         z->idct_block_kernel = rjpeg_idct_block_1x1;
+         break;
+   }
+
    if (z->progressive)
    {
       for (i = 0; i < s->img_n; ++i)
@@ -1817,8 +1916,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
           * the bogus oversized data from using interleaved MCUs and their
           * big blocks (e.g. a 16x16 iMCU on an image of width 33); we won't
           * discard the extra data until colorspace conversion */
-         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * 8;
-         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * 8;
+         z->img_comp[i].w2       = (z->img_mcu_x * z->img_comp[i].h * 8) >> z->scale_shift;
+         z->img_comp[i].h2       = (z->img_mcu_y * z->img_comp[i].v * 8) >> z->scale_shift;
          z->img_comp[i].raw_data = malloc(z->img_comp[i].w2 * z->img_comp[i].h2+15);
 
          /* Out of memory? */
@@ -1836,8 +1935,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
          /* align blocks for IDCT using MMX/SSE */
          z->img_comp[i].data      = (uint8_t*) (((size_t) z->img_comp[i].raw_data + 15) & ~15);
          z->img_comp[i].linebuf   = NULL;
-         z->img_comp[i].coeff_w   = (z->img_comp[i].w2 + 7) >> 3;
-         z->img_comp[i].coeff_h   = (z->img_comp[i].h2 + 7) >> 3;
+         z->img_comp[i].coeff_w   = z->img_mcu_x * z->img_comp[i].h;
+         z->img_comp[i].coeff_h   = z->img_mcu_y * z->img_comp[i].v;
          z->img_comp[i].raw_coeff = malloc(z->img_comp[i].coeff_w *
                                     z->img_comp[i].coeff_h * 64 * sizeof(short) + 15);
          z->img_comp[i].coeff     = (short*) (((size_t) z->img_comp[i].raw_coeff + 15) & ~15);
@@ -1855,8 +1954,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
           * the bogus oversized data from using interleaved MCUs and their
           * big blocks (e.g. a 16x16 iMCU on an image of width 33); we won't
           * discard the extra data until colorspace conversion */
-         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * 8;
-         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * 8;
+         z->img_comp[i].w2       = (z->img_mcu_x * z->img_comp[i].h * 8) >> z->scale_shift;
+         z->img_comp[i].h2       = (z->img_mcu_y * z->img_comp[i].v * 8) >> z->scale_shift;
          z->img_comp[i].raw_data = malloc(z->img_comp[i].w2 * z->img_comp[i].h2+15);
 
          /* Out of memory? */
@@ -2214,11 +2313,11 @@ static void rjpeg_YCbCr_to_RGB_row(uint8_t *out, const uint8_t *y,
       g >>= 20;
       b >>= 20;
       if ((unsigned) r > 255)
-         r = 255;
+         r = (r < 0) ? 0 : 255;
       if ((unsigned) g > 255)
-         g = 255;
+         g = (g < 0) ? 0 : 255;
       if ((unsigned) b > 255)
-         b = 255;
+         b = (b < 0) ? 0 : 255;
       out[0] = (uint8_t)r;
       out[1] = (uint8_t)g;
       out[2] = (uint8_t)b;
@@ -2358,11 +2457,11 @@ static void rjpeg_YCbCr_to_RGB_simd(uint8_t *out, const uint8_t *y,
       g >>= 20;
       b >>= 20;
       if ((unsigned) r > 255)
-         r = 255;
+         r = (r < 0) ? 0 : 255;
       if ((unsigned) g > 255)
-         g = 255;
+         g = (g < 0) ? 0 : 255;
       if ((unsigned) b > 255)
-         b = 255;
+         b = (b < 0) ? 0 : 255;
       out[0] = (uint8_t)r;
       out[1] = (uint8_t)g;
       out[2] = (uint8_t)b;
@@ -2433,6 +2532,7 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
    int n, decode_n;
    int k;
    unsigned int i,j;
+   unsigned img_x, img_y;
    rjpeg_resample res_comp[4];
    uint8_t *coutput[4] = {0};
    uint8_t *output     = NULL;
@@ -2442,6 +2542,10 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
    if (!rjpeg_decode_jpeg_image(z))
       goto error;
 
+   /* size of the decoded image, after DCT scaling */
+   img_x = (z->s->img_x + (1 << z->scale_shift) - 1) >> z->scale_shift;
+   img_y = (z->s->img_y + (1 << z->scale_shift) - 1) >> z->scale_shift;
+
    /* determine actual number of components to generate */
    n = req_comp ? req_comp : z->s->img_n;
 
@@ -2457,14 +2561,14 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
 
       /* allocate line buffer big enough for upsampling off the edges
        * with upsample factor of 4 */
-      z->img_comp[k].linebuf = (uint8_t *) malloc(z->s->img_x + 3);
+      z->img_comp[k].linebuf = (uint8_t *) malloc(img_x + 3);
       if (!z->img_comp[k].linebuf)
          goto error;
 
       r->hs       = z->img_h_max / z->img_comp[k].h;
       r->vs       = z->img_v_max / z->img_comp[k].v;
       r->ystep    = r->vs >> 1;
-      r->w_lores  = (z->s->img_x + r->hs-1) / r->hs;
+      r->w_lores  = (img_x + r->hs-1) / r->hs;
       r->ypos     = 0;
       r->line0    = r->line1 = z->img_comp[k].data;
       r->resample = rjpeg_resample_row_generic;
@@ -2480,15 +2584,15 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
    }
 
    /* can't error after this so, this is safe */
-   output = (uint8_t *) malloc(n * z->s->img_x * z->s->img_y + 1);
+   output = (uint8_t *) malloc(n * img_x * img_y + 1);
 
    if (!output)
       goto error;
 
    /* now go ahead and resample */
-   for (j = 0; j < z->s->img_y; ++j)
+   for (j = 0; j < img_y; ++j)
    {
-      uint8_t *out = output + n * z->s->img_x * j;
+      uint8_t *out = output + n * img_x * j;
       for (k = 0; k < decode_n; ++k)
       {
          rjpeg_resample *r = &res_comp[k];
@@ -2503,7 +2607,8 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
          {
             r->ystep = 0;
             r->line0 = r->line1;
-            if (++r->ypos < z->img_comp[k].y)
+            if (++r->ypos < (z->img_comp[k].y + (1 << z->scale_shift) - 1)
+                  >> z->scale_shift)
                r->line1 += z->img_comp[k].w2;
          }
       }
@@ -2514,9 +2619,9 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
          if (y)
          {
             if (z->s->img_n == 3)
-               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], img_x, n);
             else
-               for (i = 0; i < z->s->img_x; ++i)
+               for (i = 0; i < img_x; ++i)
                {
                   out[0]  = out[1] = out[2] = y[i];
                   out[3]  = 255; /* not used if n==3 */
@@ -2528,10 +2633,10 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
       {
          uint8_t *y = coutput[0];
          if (n == 1)
-            for (i = 0; i < z->s->img_x; ++i)
+            for (i = 0; i < img_x; ++i)
                out[i] = y[i];
          else
-            for (i = 0; i < z->s->img_x; ++i)
+            for (i = 0; i < img_x; ++i)
             {
                *out++ = y[i];
                *out++ = 255;
@@ -2540,8 +2645,8 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
    }
 
    rjpeg_cleanup_jpeg(z);
-   *out_x = z->s->img_x;
-   *out_y = z->s->img_y;
+   *out_x = img_x;
+   *out_y = img_y;
 
    if (comp)
       *comp  = z->s->img_n; /* report original components, not output */
@@ -2559,7 +2664,6 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    rjpeg_context s;
    int comp;
    uint32_t *img         = NULL;
-   uint32_t *pixels      = NULL;
    unsigned size_tex     = 0;
 
    if (!rjpeg)
@@ -2570,6 +2674,9 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    s.img_buffer_end      = (uint8_t*)rjpeg->buff_data + (int)size;
 
    j.s                   = &s;
+   j.target_width        = rjpeg->target_width;
+   j.target_height       = rjpeg->target_height;
+   j.scale_shift         = 0;
 
    rjpeg_setup_jpeg(&j);
 
@@ -2578,18 +2685,10 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    if (!img)
       return IMAGE_PROCESS_ERROR;
 
-   size_tex = (*width) * (*height);
-   pixels   = (uint32_t*)malloc(size_tex * sizeof(uint32_t));
+   size_tex  = (*width) * (*height);
+   *buf_data = img;
 
-   if (!pixels)
-   {
-      free(img);
-      return IMAGE_PROCESS_ERROR;
-   }
-
-   *buf_data = pixels;
-
-   /* Convert RGBA to ARGB */
+   /* Convert RGBA to ARGB, in place */
    while (size_tex--)
    {
       unsigned int texel = img[size_tex];
@@ -2597,14 +2696,22 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
       unsigned int B     = texel & 0x00FF0000;
       unsigned int G     = texel & 0x0000FF00;
       unsigned int R     = texel & 0x000000FF;
-      ((unsigned int*)pixels)[size_tex] = A | (R << 16) | G | (B >> 16);
+      img[size_tex]      = A | (R << 16) | G | (B >> 16);
    }
 
-   free(img);
-
    return IMAGE_PROCESS_END;
 }
 
+void rjpeg_set_target_size(rjpeg_t *rjpeg,
+      unsigned width, unsigned height)
+{
+   if (!rjpeg)
+      return;
+
+   rjpeg->target_width  = width;
+   rjpeg->target_height = height;
+}
+
 bool rjpeg_set_buf_ptr(rjpeg_t *rjpeg, void *data)
 {
    if (!rjpeg)
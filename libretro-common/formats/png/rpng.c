@@ -20,7 +20,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifdef DEBUG
+#if defined(DEBUG) || defined(RPNG_TEST)
 #include <stdio.h>
 #endif
 #include <stdint.h>
@@ -31,6 +31,14 @@
 #include <malloc.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define RPNG_SIMD_SSE2
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(MSB_FIRST)
+#include <arm_neon.h>
+#define RPNG_SIMD_NEON
+#endif
+
 #include <boolean.h>
 #include <formats/image.h>
 #include <formats/rpng.h>
@@ -76,12 +84,6 @@ struct adam7_pass
    unsigned stride_y;
 };
 
-struct idat_buffer
-{
-   uint8_t *data;
-   size_t size;
-};
-
 enum rpng_process_flags
 {
    RPNG_PROCESS_FLAG_INFLATE_INITIALIZED    = (1 << 0),
@@ -93,6 +95,8 @@ struct rpng_process
 {
    uint32_t *data;
    uint32_t *palette;
+   uint32_t *line;
+   uint8_t *idat_next;
    void *stream;
    const struct trans_stream_backend *stream_backend;
    uint8_t *prev_scanline;
@@ -100,7 +104,6 @@ struct rpng_process
    uint8_t *inflate_buf;
    size_t restore_buf_size;
    size_t adam7_restore_buf_size;
-   size_t data_restore_buf_size;
    size_t inflate_buf_size;
    size_t avail_in;
    size_t avail_out;
@@ -122,7 +125,8 @@ enum rpng_flags
    RPNG_FLAG_HAS_IDAT = (1 << 1),
    RPNG_FLAG_HAS_IEND = (1 << 2),
    RPNG_FLAG_HAS_PLTE = (1 << 3),
-   RPNG_FLAG_HAS_TRNS = (1 << 4)
+   RPNG_FLAG_HAS_TRNS = (1 << 4),
+   RPNG_FLAG_RGB565   = (1 << 5)
 };
 
 struct rpng
@@ -130,7 +134,7 @@ struct rpng
    struct rpng_process *process;
    uint8_t *buff_data;
    uint8_t *buff_end;
-   struct idat_buffer idat_buf; /* ptr alignment */
+   uint8_t *idat_first;
    struct png_ihdr ihdr; /* uint32 alignment */
    uint32_t palette[256];
    uint8_t flags;
@@ -420,6 +424,19 @@ static void rpng_reverse_filter_copy_line_plt(uint32_t *data,
    }
 }
 
+static void rpng_convert_line_rgb565(uint16_t *data,
+      const uint32_t *line, unsigned width)
+{
+   unsigned i;
+
+   for (i = 0; i < width; i++)
+   {
+      uint32_t col = line[i];
+      data[i]      = (uint16_t)(((col >> 8) & 0xf800)
+            | ((col >> 5) & 0x07e0) | ((col >> 3) & 0x001f));
+   }
+}
+
 static void rpng_pass_geom(const struct png_ihdr *ihdr,
       unsigned width, unsigned height,
       unsigned *bpp_out, unsigned *pitch_out, size_t *pass_size)
@@ -461,22 +478,31 @@ static void rpng_pass_geom(const struct png_ihdr *ihdr,
       *pitch_out = pitch;
 }
 
-static void rpng_reverse_filter_adam7_deinterlace_pass(uint32_t *data,
+static void rpng_reverse_filter_adam7_deinterlace_pass(void *data,
       const struct png_ihdr *ihdr,
       const uint32_t *input, unsigned pass_width, unsigned pass_height,
-      const struct adam7_pass *pass)
+      const struct adam7_pass *pass, bool rgb565)
 {
    unsigned x, y;
-
-   data += pass->y * ihdr->width + pass->x;
+   size_t offset = pass->y * ihdr->width + pass->x;
 
    for (y = 0; y < pass_height;
-         y++, data += ihdr->width * pass->stride_y, input += pass_width)
+         y++, offset += ihdr->width * pass->stride_y, input += pass_width)
    {
-      uint32_t *out = data;
+      if (rgb565)
+      {
+         uint16_t *out = (uint16_t*)data + offset;
 
-      for (x = 0; x < pass_width; x++, out += pass->stride_x)
-         *out = input[x];
+         for (x = 0; x < pass_width; x++, out += pass->stride_x)
+            rpng_convert_line_rgb565(out, &input[x], 1);
+      }
+      else
+      {
+         uint32_t *out = (uint32_t*)data + offset;
+
+         for (x = 0; x < pass_width; x++, out += pass->stride_x)
+            *out = input[x];
+      }
    }
 }
 
@@ -545,7 +571,6 @@ static int rpng_reverse_filter_init(const struct png_ihdr *ihdr,
       return -1;
 
    pngp->restore_buf_size      = 0;
-   pngp->data_restore_buf_size = 0;
    pngp->prev_scanline         = (uint8_t*)calloc(1, pngp->pitch);
    pngp->decoded_scanline      = (uint8_t*)calloc(1, pngp->pitch);
 
@@ -562,92 +587,348 @@ error:
    return -1;
 }
 
-static int rpng_reverse_filter_copy_line(uint32_t *data,
-      const struct png_ihdr *ihdr,
-      struct rpng_process *pngp, unsigned filter)
+static void rpng_unfilter_line(uint8_t *row, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp,
+      unsigned filter)
 {
-   unsigned i;
+   unsigned i = 0;
 
    switch (filter)
    {
       case PNG_FILTER_NONE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
+         memcpy(row, in, pitch);
          break;
       case PNG_FILTER_SUB:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] += pngp->decoded_scanline[i - pngp->bpp];
+         for (; i < bpp; i++)
+            row[i] = in[i];
+         for (; i < pitch; i++)
+            row[i] = in[i] + row[i - bpp];
          break;
       case PNG_FILTER_UP:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] += pngp->prev_scanline[i];
+#if defined(RPNG_SIMD_SSE2)
+         for (; i + 16 <= pitch; i += 16)
+            _mm_storeu_si128((__m128i*)(row + i), _mm_add_epi8(
+                     _mm_loadu_si128((const __m128i*)(in   + i)),
+                     _mm_loadu_si128((const __m128i*)(prev + i))));
+#elif defined(RPNG_SIMD_NEON)
+         for (; i + 16 <= pitch; i += 16)
+            vst1q_u8(row + i, vaddq_u8(vld1q_u8(in + i), vld1q_u8(prev + i)));
+#endif
+         for (; i < pitch; i++)
+            row[i] = in[i] + prev[i];
          break;
       case PNG_FILTER_AVERAGE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = 0; i < pngp->bpp; i++)
+         for (; i < bpp; i++)
+            row[i] = in[i] + (prev[i] >> 1);
+         for (; i < pitch; i++)
+            row[i] = in[i] + ((row[i - bpp] + prev[i]) >> 1);
+         break;
+      case PNG_FILTER_PAETH:
+         for (; i < bpp; i++)
+            row[i] = in[i] + prev[i];
+         for (; i < pitch; i++)
+            row[i] = in[i] + paeth(row[i - bpp], prev[i], prev[i - bpp]);
+         break;
+   }
+}
+
+#if defined(RPNG_SIMD_SSE2)
+static INLINE __m128i rpng_simd_load(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+   if (bpp == 4)
+      v      |= (uint32_t)p[3] << 24;
+   return _mm_cvtsi32_si128((int)v);
+}
+
+static INLINE void rpng_simd_store(uint8_t *p, __m128i v, unsigned bpp)
+{
+   uint32_t x = (uint32_t)_mm_cvtsi128_si32(v);
+   p[0]       = (uint8_t)x;
+   p[1]       = (uint8_t)(x >> 8);
+   p[2]       = (uint8_t)(x >> 16);
+   if (bpp == 4)
+      p[3]    = (uint8_t)(x >> 24);
+}
+
+/* Takes R, G, B, A as 16-bit lanes, returns the ARGB32 pixel */
+static INLINE uint32_t rpng_simd_argb(__m128i v, __m128i alpha)
+{
+   v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 0, 1, 2));
+   return (uint32_t)_mm_cvtsi128_si32(
+         _mm_or_si128(_mm_packus_epi16(v, v), alpha));
+}
+
+static INLINE __m128i rpng_simd_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static INLINE __m128i rpng_simd_select(__m128i mask, __m128i t, __m128i e)
+{
+   return _mm_or_si128(_mm_and_si128(mask, t), _mm_andnot_si128(mask, e));
+}
+
+/* Undoes the filter of an 8-bit RGB/RGBA scanline and converts
+ * it to ARGB32 in the same pass, one pixel per iteration */
+static void rpng_unfilter_convert_line(uint8_t *row, uint32_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned width,
+      unsigned bpp, unsigned filter)
+{
+   unsigned x;
+   const __m128i zero  = _mm_setzero_si128();
+   const __m128i alpha = _mm_cvtsi32_si128(bpp == 3 ? (int)0xff000000 : 0);
+   __m128i a           = zero;
+
+   switch (filter)
+   {
+      case PNG_FILTER_NONE:
+         for (x = 0; x < width; x++, in += bpp, row += bpp)
+         {
+            a      = rpng_simd_load(in, bpp);
+            rpng_simd_store(row, a, bpp);
+            out[x] = rpng_simd_argb(_mm_unpacklo_epi8(a, zero), alpha);
+         }
+         break;
+      case PNG_FILTER_SUB:
+         for (x = 0; x < width; x++, in += bpp, row += bpp)
          {
-            uint8_t avg = pngp->prev_scanline[i] >> 1;
-            pngp->decoded_scanline[i] += avg;
+            a      = _mm_add_epi8(rpng_simd_load(in, bpp), a);
+            rpng_simd_store(row, a, bpp);
+            out[x] = rpng_simd_argb(_mm_unpacklo_epi8(a, zero), alpha);
          }
-         for (i = pngp->bpp; i < pngp->pitch; i++)
+         break;
+      case PNG_FILTER_UP:
+         for (x = 0; x < width; x++, in += bpp, prev += bpp, row += bpp)
          {
-            uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
-            pngp->decoded_scanline[i] += avg;
+            a      = _mm_add_epi8(rpng_simd_load(in, bpp),
+                  rpng_simd_load(prev, bpp));
+            rpng_simd_store(row, a, bpp);
+            out[x] = rpng_simd_argb(_mm_unpacklo_epi8(a, zero), alpha);
+         }
+         break;
+      case PNG_FILTER_AVERAGE:
+         {
+            const __m128i ones = _mm_set1_epi8(1);
+
+            for (x = 0; x < width; x++, in += bpp, prev += bpp, row += bpp)
+            {
+               /* pavgb rounds up, take the carry back out
+                * to get (a + b) >> 1 */
+               __m128i b   = rpng_simd_load(prev, bpp);
+               __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                     _mm_and_si128(_mm_xor_si128(a, b), ones));
+               a           = _mm_add_epi8(rpng_simd_load(in, bpp), avg);
+               rpng_simd_store(row, a, bpp);
+               out[x]      = rpng_simd_argb(_mm_unpacklo_epi8(a, zero), alpha);
+            }
          }
          break;
       case PNG_FILTER_PAETH:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] += pngp->prev_scanline[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] += paeth(pngp->decoded_scanline[i - pngp->bpp],
-                  pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]);
+         {
+            __m128i c = zero;
+
+            /* a, b and c are kept as 16-bit lanes */
+            for (x = 0; x < width; x++, in += bpp, prev += bpp, row += bpp)
+            {
+               __m128i b  = _mm_unpacklo_epi8(rpng_simd_load(prev, bpp), zero);
+               __m128i pa = _mm_sub_epi16(b, c);
+               __m128i pb = _mm_sub_epi16(a, c);
+               __m128i pc = _mm_add_epi16(pa, pb);
+               __m128i smallest, nearest;
+
+               pa         = rpng_simd_abs_epi16(pa);
+               pb         = rpng_simd_abs_epi16(pb);
+               pc         = rpng_simd_abs_epi16(pc);
+               smallest   = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+               nearest    = rpng_simd_select(_mm_cmpeq_epi16(smallest, pa), a,
+                     rpng_simd_select(_mm_cmpeq_epi16(smallest, pb), b, c));
+               nearest    = _mm_add_epi8(rpng_simd_load(in, bpp),
+                     _mm_packus_epi16(nearest, nearest));
+               rpng_simd_store(row, nearest, bpp);
+
+               c          = b;
+               a          = _mm_unpacklo_epi8(nearest, zero);
+               out[x]     = rpng_simd_argb(a, alpha);
+            }
+         }
          break;
-      default:
-         return IMAGE_PROCESS_ERROR_END;
    }
+}
+#elif defined(RPNG_SIMD_NEON)
+static INLINE uint8x8_t rpng_simd_load(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+   if (bpp == 4)
+      v      |= (uint32_t)p[3] << 24;
+   return vreinterpret_u8_u32(vdup_n_u32(v));
+}
 
-   switch (ihdr->color_type)
+static INLINE void rpng_simd_store(uint8_t *p, uint8x8_t v, unsigned bpp)
+{
+   uint32_t x = vget_lane_u32(vreinterpret_u32_u8(v), 0);
+   p[0]       = (uint8_t)x;
+   p[1]       = (uint8_t)(x >> 8);
+   p[2]       = (uint8_t)(x >> 16);
+   if (bpp == 4)
+      p[3]    = (uint8_t)(x >> 24);
+}
+
+/* Takes R, G, B, A as 8-bit lanes, returns the ARGB32 pixel */
+static INLINE uint32_t rpng_simd_argb(uint8x8_t v, uint8x8_t swizzle,
+      uint8x8_t alpha)
+{
+   return vget_lane_u32(vreinterpret_u32_u8(
+            vorr_u8(vtbl1_u8(v, swizzle), alpha)), 0);
+}
+
+/* Undoes the filter of an 8-bit RGB/RGBA scanline and converts
+ * it to ARGB32 in the same pass, one pixel per iteration */
+static void rpng_unfilter_convert_line(uint8_t *row, uint32_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned width,
+      unsigned bpp, unsigned filter)
+{
+   unsigned x;
+   const uint8x8_t swizzle = vreinterpret_u8_u32(vdup_n_u32(0x03000102));
+   const uint8x8_t alpha   = vreinterpret_u8_u32(
+         vdup_n_u32(bpp == 3 ? 0xff000000 : 0));
+   uint8x8_t a             = vdup_n_u8(0);
+
+   switch (filter)
    {
-      case PNG_IHDR_COLOR_GRAY:
-         rpng_reverse_filter_copy_line_bw(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+      case PNG_FILTER_NONE:
+         for (x = 0; x < width; x++, in += bpp, row += bpp)
+         {
+            a      = rpng_simd_load(in, bpp);
+            rpng_simd_store(row, a, bpp);
+            out[x] = rpng_simd_argb(a, swizzle, alpha);
+         }
          break;
-      case PNG_IHDR_COLOR_RGB:
-         rpng_reverse_filter_copy_line_rgb(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+      case PNG_FILTER_SUB:
+         for (x = 0; x < width; x++, in += bpp, row += bpp)
+         {
+            a      = vadd_u8(rpng_simd_load(in, bpp), a);
+            rpng_simd_store(row, a, bpp);
+            out[x] = rpng_simd_argb(a, swizzle, alpha);
+         }
          break;
-      case PNG_IHDR_COLOR_PLT:
-         rpng_reverse_filter_copy_line_plt(
-               data, pngp->decoded_scanline, ihdr->width,
-               ihdr->depth, pngp->palette);
+      case PNG_FILTER_UP:
+         for (x = 0; x < width; x++, in += bpp, prev += bpp, row += bpp)
+         {
+            a      = vadd_u8(rpng_simd_load(in, bpp),
+                  rpng_simd_load(prev, bpp));
+            rpng_simd_store(row, a, bpp);
+            out[x] = rpng_simd_argb(a, swizzle, alpha);
+         }
          break;
-      case PNG_IHDR_COLOR_GRAY_ALPHA:
-         rpng_reverse_filter_copy_line_gray_alpha(data, pngp->decoded_scanline, ihdr->width,
-               ihdr->depth);
+      case PNG_FILTER_AVERAGE:
+         for (x = 0; x < width; x++, in += bpp, prev += bpp, row += bpp)
+         {
+            a      = vadd_u8(rpng_simd_load(in, bpp),
+                  vhadd_u8(a, rpng_simd_load(prev, bpp)));
+            rpng_simd_store(row, a, bpp);
+            out[x] = rpng_simd_argb(a, swizzle, alpha);
+         }
          break;
-      case PNG_IHDR_COLOR_RGBA:
-         rpng_reverse_filter_copy_line_rgba(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+      case PNG_FILTER_PAETH:
+         {
+            uint8x8_t c = vdup_n_u8(0);
+
+            for (x = 0; x < width; x++, in += bpp, prev += bpp, row += bpp)
+            {
+               uint8x8_t b     = rpng_simd_load(prev, bpp);
+               uint16x8_t pa   = vabdl_u8(b, c);
+               uint16x8_t pb   = vabdl_u8(a, c);
+               uint16x8_t pc   = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+               uint8x8_t pick_a = vmovn_u16(vandq_u16(
+                        vcleq_u16(pa, pb), vcleq_u16(pa, pc)));
+               uint8x8_t pick_b = vmovn_u16(vcleq_u16(pb, pc));
+
+               a      = vadd_u8(rpng_simd_load(in, bpp),
+                     vbsl_u8(pick_a, a, vbsl_u8(pick_b, b, c)));
+               c      = b;
+               rpng_simd_store(row, a, bpp);
+               out[x] = rpng_simd_argb(a, swizzle, alpha);
+            }
+         }
          break;
    }
+}
+#endif
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
+static int rpng_reverse_filter_copy_line(uint32_t *data,
+      const struct png_ihdr *ihdr,
+      struct rpng_process *pngp, unsigned filter)
+{
+   uint8_t *swap;
+
+   if (filter > PNG_FILTER_PAETH)
+      return IMAGE_PROCESS_ERROR_END;
+
+#if defined(RPNG_SIMD_SSE2) || defined(RPNG_SIMD_NEON)
+   if (      ihdr->depth == 8
+         && (ihdr->color_type == PNG_IHDR_COLOR_RGB
+          || ihdr->color_type == PNG_IHDR_COLOR_RGBA))
+      rpng_unfilter_convert_line(pngp->decoded_scanline, data,
+            pngp->inflate_buf, pngp->prev_scanline, ihdr->width,
+            pngp->bpp, filter);
+   else
+#endif
+   {
+      rpng_unfilter_line(pngp->decoded_scanline, pngp->inflate_buf,
+            pngp->prev_scanline, pngp->pitch, pngp->bpp, filter);
+
+      switch (ihdr->color_type)
+      {
+         case PNG_IHDR_COLOR_GRAY:
+            rpng_reverse_filter_copy_line_bw(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+            break;
+         case PNG_IHDR_COLOR_RGB:
+            rpng_reverse_filter_copy_line_rgb(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+            break;
+         case PNG_IHDR_COLOR_PLT:
+            rpng_reverse_filter_copy_line_plt(
+                  data, pngp->decoded_scanline, ihdr->width,
+                  ihdr->depth, pngp->palette);
+            break;
+         case PNG_IHDR_COLOR_GRAY_ALPHA:
+            rpng_reverse_filter_copy_line_gray_alpha(data, pngp->decoded_scanline, ihdr->width,
+                  ihdr->depth);
+            break;
+         case PNG_IHDR_COLOR_RGBA:
+            rpng_reverse_filter_copy_line_rgba(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+            break;
+      }
+   }
+
+   /* The line just decoded is the previous one of the next line */
+   swap                   = pngp->prev_scanline;
+   pngp->prev_scanline    = pngp->decoded_scanline;
+   pngp->decoded_scanline = swap;
 
    return IMAGE_PROCESS_NEXT;
 }
 
 static int rpng_reverse_filter_regular_iterate(
-      uint32_t **data, const struct png_ihdr *ihdr,
-      struct rpng_process *pngp)
+      void *data, const struct png_ihdr *ihdr,
+      struct rpng_process *pngp, bool rgb565)
 {
    int ret = IMAGE_PROCESS_END;
    if (pngp->h < ihdr->height)
    {
       unsigned filter         = *pngp->inflate_buf++;
+      size_t offset           = (size_t)pngp->h * ihdr->width;
       pngp->restore_buf_size += 1;
-      ret                     = rpng_reverse_filter_copy_line(*data,
+
+      ret                     = rpng_reverse_filter_copy_line(
+            rgb565 ? pngp->line : (uint32_t*)data + offset,
             ihdr, pngp, filter);
       if (ret == IMAGE_PROCESS_END || ret == IMAGE_PROCESS_ERROR_END)
          goto end;
+
+      if (rgb565)
+         rpng_convert_line_rgb565((uint16_t*)data + offset,
+               pngp->line, ihdr->width);
    }
    else
       goto end;
@@ -656,27 +937,21 @@ static int rpng_reverse_filter_regular_iterate(
    pngp->inflate_buf           += pngp->pitch;
    pngp->restore_buf_size      += pngp->pitch;
 
-   *data                       += ihdr->width;
-   pngp->data_restore_buf_size += ihdr->width;
-
    return IMAGE_PROCESS_NEXT;
 
 end:
    rpng_reverse_filter_deinit(pngp);
 
    pngp->inflate_buf -= pngp->restore_buf_size;
-   *data             -= pngp->data_restore_buf_size;
-   pngp->data_restore_buf_size = 0;
    return ret;
 }
 
-static int rpng_reverse_filter_adam7_iterate(uint32_t **data_,
+static int rpng_reverse_filter_adam7_iterate(void *data,
       const struct png_ihdr *ihdr,
-      struct rpng_process *pngp)
+      struct rpng_process *pngp, bool rgb565)
 {
    int        ret = 0;
    bool   to_next = pngp->pass_pos < ARRAY_SIZE(rpng_passes);
-   uint32_t *data = *data_;
 
    if (!to_next)
       return IMAGE_PROCESS_END;
@@ -691,8 +966,8 @@ static int rpng_reverse_filter_adam7_iterate(uint32_t **data_,
 
    do
    {
-      ret = rpng_reverse_filter_regular_iterate(&pngp->data,
-            &pngp->ihdr, pngp);
+      ret = rpng_reverse_filter_regular_iterate(pngp->data,
+            &pngp->ihdr, pngp, false);
    } while (ret == IMAGE_PROCESS_NEXT);
 
    if (ret == IMAGE_PROCESS_ERROR || ret == IMAGE_PROCESS_ERROR_END)
@@ -705,7 +980,7 @@ static int rpng_reverse_filter_adam7_iterate(uint32_t **data_,
 
    rpng_reverse_filter_adam7_deinterlace_pass(data,
          ihdr, pngp->data, pngp->pass_width, pngp->pass_height,
-         &rpng_passes[pngp->pass_pos]);
+         &rpng_passes[pngp->pass_pos], rgb565);
 
    free(pngp->data);
 
@@ -718,12 +993,12 @@ static int rpng_reverse_filter_adam7_iterate(uint32_t **data_,
    return IMAGE_PROCESS_NEXT;
 }
 
-static int rpng_reverse_filter_adam7(uint32_t **data_,
+static int rpng_reverse_filter_adam7(void *data,
       const struct png_ihdr *ihdr,
-      struct rpng_process *pngp)
+      struct rpng_process *pngp, bool rgb565)
 {
-   int ret = rpng_reverse_filter_adam7_iterate(data_,
-         ihdr, pngp);
+   int ret = rpng_reverse_filter_adam7_iterate(data,
+         ihdr, pngp, rgb565);
 
    switch (ret)
    {
@@ -749,12 +1024,137 @@ static int rpng_reverse_filter_adam7(uint32_t **data_,
    return ret;
 }
 
+/**
+ * rpng_read_chunk_header:
+ *
+ * Leaf function.
+ *
+ * @return The PNG type of the memory chunk (i.e. IHDR, IDAT, IEND,
+   PLTE, and/or tRNS)
+ **/
+static enum png_chunk_type rpng_read_chunk_header(
+      uint8_t *buf, uint32_t chunk_size)
+{
+   int i;
+   char type[4];
+
+   for (i = 0; i < 4; i++)
+   {
+      uint8_t byte = buf[i + 4];
+
+      /* All four bytes of the chunk type must be
+       * ASCII letters (codes 65-90 and 97-122) */
+      if ((byte < 65) || ((byte > 90) && (byte < 97)) || (byte > 122))
+         return PNG_CHUNK_ERROR;
+      type[i]      = byte;
+   }
+
+   if (     
+            type[0] == 'I'
+         && type[1] == 'H'
+         && type[2] == 'D'
+         && type[3] == 'R'
+      )
+      return PNG_CHUNK_IHDR;
+   else if
+      (
+          type[0] == 'I'
+       && type[1] == 'D'
+       && type[2] == 'A'
+       && type[3] == 'T'
+      )
+         return PNG_CHUNK_IDAT;
+   else if
+      (
+          type[0] == 'I'
+       && type[1] == 'E'
+       && type[2] == 'N'
+       && type[3] == 'D'
+      )
+         return PNG_CHUNK_IEND;
+   else if
+      (
+          type[0] == 'P'
+       && type[1] == 'L'
+       && type[2] == 'T'
+       && type[3] == 'E'
+      )
+         return PNG_CHUNK_PLTE;
+   else if
+      (
+          type[0] == 't'
+       && type[1] == 'R'
+       && type[2] == 'N'
+       && type[3] == 'S'
+      )
+         return PNG_CHUNK_tRNS;
+
+   return PNG_CHUNK_NOOP;
+}
+
+/* Returns the next IDAT chunk at or after @buf, skipping
+ * any ancillary chunk in between, or NULL once the image
+ * data is exhausted */
+static uint8_t *rpng_find_idat(uint8_t *buf, const uint8_t *end)
+{
+   while (buf <= end && end - buf >= 8)
+   {
+      uint32_t chunk_size = rpng_dword_be(buf);
+
+      if ((size_t)(end - buf) - 8 < chunk_size)
+         return NULL;
+
+      switch (rpng_read_chunk_header(buf, chunk_size))
+      {
+         case PNG_CHUNK_IDAT:
+            return buf;
+         case PNG_CHUNK_IEND:
+         case PNG_CHUNK_ERROR:
+            return NULL;
+         default:
+            break;
+      }
+
+      buf += chunk_size + 12;
+   }
+
+   return NULL;
+}
+
+/* Hands the next non-empty IDAT chunk to the inflate
+ * stream, straight from the PNG buffer */
+static bool rpng_process_next_idat(rpng_t *rpng,
+      struct rpng_process *process)
+{
+   uint8_t *chunk;
+
+   while (   process->idat_next
+         && (chunk = rpng_find_idat(process->idat_next, rpng->buff_end)))
+   {
+      uint32_t chunk_size = rpng_dword_be(chunk);
+
+      process->idat_next  = chunk + chunk_size + 12;
+
+      if (chunk_size == 0)
+         continue;
+
+      process->avail_in   = chunk_size;
+      process->stream_backend->set_in(process->stream,
+            chunk + 8, chunk_size);
+      return true;
+   }
+
+   process->idat_next = NULL;
+   return false;
+}
+
 static int rpng_load_image_argb_process_inflate_init(
       rpng_t *rpng, uint32_t **data)
 {
    bool zstatus;
    enum trans_stream_error terror;
    uint32_t rd, wn;
+   size_t pixel_size;
    struct rpng_process *process = (struct rpng_process*)rpng->process;
    bool to_continue        = (process->avail_in > 0
          && process->avail_out > 0);
@@ -772,19 +1172,28 @@ static int rpng_load_image_argb_process_inflate_init(
    process->total_out += wn;
 
    if (terror)
+   {
+      /* Current IDAT chunk is used up, the next one
+       * gets inflated on the next call */
+      if (terror == TRANS_STREAM_ERROR_AGAIN && process->avail_in == 0)
+         rpng_process_next_idat(rpng, process);
       return 0;
+   }
 
 end:
    process->stream_backend->stream_free(process->stream);
    process->stream = NULL;
 
+   pixel_size = (rpng->flags & RPNG_FLAG_RGB565)
+      ? sizeof(uint16_t) : sizeof(uint32_t);
+
 #ifdef GEKKO
    /* we often use these in textures, make sure they're 32-byte aligned */
    *data = (uint32_t*)memalign(32, rpng->ihdr.width *
-         rpng->ihdr.height * sizeof(uint32_t));
+         rpng->ihdr.height * pixel_size);
 #else
    *data = (uint32_t*)malloc(rpng->ihdr.width *
-         rpng->ihdr.height * sizeof(uint32_t));
+         rpng->ihdr.height * pixel_size);
 #endif
    if (!*data)
       goto false_end;
@@ -794,8 +1203,16 @@ end:
    process->palette                = rpng->palette;
 
    if (rpng->ihdr.interlace != 1)
+   {
+      /* Scanlines are decoded to ARGB first, then packed */
+      if (rpng->flags & RPNG_FLAG_RGB565)
+         if (!(process->line = (uint32_t*)malloc(
+               rpng->ihdr.width * sizeof(uint32_t))))
+            goto false_end;
+
       if (rpng_reverse_filter_init(&rpng->ihdr, process) == -1)
          goto false_end;
+   }
 
    process->flags              |=  RPNG_PROCESS_FLAG_INFLATE_INITIALIZED;
    return 1;
@@ -806,17 +1223,6 @@ false_end:
    return -1;
 }
 
-static bool rpng_realloc_idat(struct idat_buffer *buf, uint32_t chunk_size)
-{
-   uint8_t *new_buffer = (uint8_t*)realloc(buf->data, buf->size + chunk_size);
-
-   if (!new_buffer)
-      return false;
-
-   buf->data  = new_buffer;
-   return true;
-}
-
 static struct rpng_process *rpng_process_init(rpng_t *rpng)
 {
    uint8_t *inflate_buf            = NULL;
@@ -829,6 +1235,8 @@ static struct rpng_process *rpng_process_init(rpng_t *rpng)
    process->prev_scanline          = NULL;
    process->decoded_scanline       = NULL;
    process->inflate_buf            = NULL;
+   process->line                   = NULL;
+   process->idat_next              = rpng->idat_first;
 
    process->ihdr.width             = 0;
    process->ihdr.height            = 0;
@@ -840,7 +1248,6 @@ static struct rpng_process *rpng_process_init(rpng_t *rpng)
 
    process->restore_buf_size       = 0;
    process->adam7_restore_buf_size = 0;
-   process->data_restore_buf_size  = 0;
    process->inflate_buf_size       = 0;
    process->avail_in               = 0;
    process->avail_out              = 0;
@@ -875,13 +1282,11 @@ static struct rpng_process *rpng_process_init(rpng_t *rpng)
       goto error;
 
    process->inflate_buf = inflate_buf;
-   process->avail_in    = rpng->idat_buf.size;
    process->avail_out   = process->inflate_buf_size;
 
-   process->stream_backend->set_in(
-         process->stream,
-         rpng->idat_buf.data,
-         (uint32_t)rpng->idat_buf.size);
+   if (!rpng_process_next_idat(rpng, process))
+      goto error;
+
    process->stream_backend->set_out(
          process->stream,
          process->inflate_buf,
@@ -892,6 +1297,8 @@ static struct rpng_process *rpng_process_init(rpng_t *rpng)
 error:
    if (process)
    {
+      if (process->inflate_buf)
+         free(process->inflate_buf);
       if (process->stream)
          process->stream_backend->stream_free(process->stream);
       free(process);
@@ -899,77 +1306,8 @@ error:
    return NULL;
 }
 
-/**
- * rpng_read_chunk_header:
- *
- * Leaf function.
- *
- * @return The PNG type of the memory chunk (i.e. IHDR, IDAT, IEND,
-   PLTE, and/or tRNS)
- **/
-static enum png_chunk_type rpng_read_chunk_header(
-      uint8_t *buf, uint32_t chunk_size)
-{
-   int i;
-   char type[4];
-
-   for (i = 0; i < 4; i++)
-   {
-      uint8_t byte = buf[i + 4];
-
-      /* All four bytes of the chunk type must be
-       * ASCII letters (codes 65-90 and 97-122) */
-      if ((byte < 65) || ((byte > 90) && (byte < 97)) || (byte > 122))
-         return PNG_CHUNK_ERROR;
-      type[i]      = byte;
-   }
-
-   if (     
-            type[0] == 'I'
-         && type[1] == 'H'
-         && type[2] == 'D'
-         && type[3] == 'R'
-      )
-      return PNG_CHUNK_IHDR;
-   else if
-      (
-          type[0] == 'I'
-       && type[1] == 'D'
-       && type[2] == 'A'
-       && type[3] == 'T'
-      )
-         return PNG_CHUNK_IDAT;
-   else if
-      (
-          type[0] == 'I'
-       && type[1] == 'E'
-       && type[2] == 'N'
-       && type[3] == 'D'
-      )
-         return PNG_CHUNK_IEND;
-   else if
-      (
-          type[0] == 'P'
-       && type[1] == 'L'
-       && type[2] == 'T'
-       && type[3] == 'E'
-      )
-         return PNG_CHUNK_PLTE;
-   else if
-      (
-          type[0] == 't'
-       && type[1] == 'R'
-       && type[2] == 'N'
-       && type[3] == 'S'
-      )
-         return PNG_CHUNK_tRNS;
-
-   return PNG_CHUNK_NOOP;
-}
-
 bool rpng_iterate_image(rpng_t *rpng)
 {
-   unsigned i;
    uint8_t *buf             = (uint8_t*)rpng->buff_data;
    uint32_t chunk_size      = 0;
 
@@ -1098,15 +1436,10 @@ bool rpng_iterate_image(rpng_t *rpng)
                   !(rpng->flags & RPNG_FLAG_HAS_PLTE)))
             return false;
 
-         if (!rpng_realloc_idat(&rpng->idat_buf, chunk_size))
-            return false;
-
-         buf += 8;
-
-         for (i = 0; i < chunk_size; i++)
-            rpng->idat_buf.data[i + rpng->idat_buf.size] = buf[i];
-
-         rpng->idat_buf.size += chunk_size;
+         /* The image data is inflated straight from
+          * the buffer later on, just remember where it starts */
+         if (!rpng->idat_first)
+            rpng->idat_first  = buf;
 
          rpng->flags         |= RPNG_FLAG_HAS_IDAT;
          break;
@@ -1155,14 +1488,18 @@ int rpng_process_image(rpng_t *rpng,
    *height = rpng->ihdr.height;
 
    if (rpng->ihdr.interlace && rpng->process)
-      return rpng_reverse_filter_adam7(data, &rpng->ihdr, rpng->process);
-   return rpng_reverse_filter_regular_iterate(data, &rpng->ihdr, rpng->process);
+      return rpng_reverse_filter_adam7(*data, &rpng->ihdr, rpng->process,
+            (rpng->flags & RPNG_FLAG_RGB565) ? true : false);
+   return rpng_reverse_filter_regular_iterate(*data, &rpng->ihdr, rpng->process,
+         (rpng->flags & RPNG_FLAG_RGB565) ? true : false);
 
 error:
    if (rpng->process)
    {
       if (rpng->process->inflate_buf)
          free(rpng->process->inflate_buf);
+      if (rpng->process->line)
+         free(rpng->process->line);
       if (rpng->process->stream)
          rpng->process->stream_backend->stream_free(rpng->process->stream);
       free(rpng->process);
@@ -1176,12 +1513,12 @@ void rpng_free(rpng_t *rpng)
    if (!rpng)
       return;
 
-   if (rpng->idat_buf.data)
-      free(rpng->idat_buf.data);
    if (rpng->process)
    {
       if (rpng->process->inflate_buf)
          free(rpng->process->inflate_buf);
+      if (rpng->process->line)
+         free(rpng->process->line);
       if (rpng->process->stream)
       {
          if (rpng->process->stream_backend && rpng->process->stream_backend->stream_free)
@@ -1231,6 +1568,17 @@ bool rpng_is_valid(rpng_t *rpng)
 RPNG_FLAG_HAS_IEND)) > 0));
 }
 
+void rpng_set_output_rgb565(rpng_t *rpng, bool enable)
+{
+   if (!rpng)
+      return;
+
+   if (enable)
+      rpng->flags |=  RPNG_FLAG_RGB565;
+   else
+      rpng->flags &= ~RPNG_FLAG_RGB565;
+}
+
 bool rpng_set_buf_ptr(rpng_t *rpng, void *data, size_t len)
 {
    if (!rpng || (len < 1))
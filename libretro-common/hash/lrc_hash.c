@@ -574,3 +574,14 @@ uint32_t djb2_calculate(const char *str)
 
    return hash;
 }
+
+uint32_t fnv1a_calculate(uint32_t hash, const void *data, size_t len)
+{
+   size_t i;
+   const uint8_t *bytes = (const uint8_t*)data;
+
+   for (i = 0; i < len; i++)
+      hash = (hash ^ bytes[i]) * 16777619U;
+
+   return hash;
+}
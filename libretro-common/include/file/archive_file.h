@@ -131,6 +131,13 @@ struct file_archive_file_backend
    uint32_t (*stream_crc_calculate)(uint32_t, const uint8_t *, size_t);
    int64_t (*compressed_file_read)(const char *path, const char *needle, void **buf,
          const char *optional_outfile);
+   /* Optional. Calls file_cb for the member 'name' of the
+    * archive, or for every member if 'name' is NULL, from an
+    * index of the archive directory, without decompressing
+    * anything. Returns false if no index is available */
+   bool     (*archive_index_walk)(const char *file, const char *name,
+         const char *valid_exts, struct archive_extract_userdata *userdata,
+         file_archive_file_cb file_cb);
    const char *ident;
 };
 
@@ -202,6 +209,29 @@ const struct file_archive_file_backend* file_archive_get_file_backend(const char
  **/
 uint32_t file_archive_get_file_crc32(const char *path);
 
+#ifdef HAVE_ZLIB
+/* The directories of recently used zip archives are kept
+ * in memory, so that their members can be listed and read
+ * without parsing the whole directory again. The index is
+ * only used between these two calls */
+void file_archive_zip_index_cache_init(void);
+
+void file_archive_zip_index_cache_deinit(void);
+#endif
+
+#ifdef HAVE_7ZIP
+/* The last solid block decoded from a 7z archive is kept,
+ * so that reading another member of the block does not
+ * decode it again. Only used between these two calls */
+void file_archive_7z_block_cache_init(void);
+
+/* Frees the kept block, once nothing else is
+ * likely to be read from it */
+void file_archive_7z_block_cache_clear(void);
+
+void file_archive_7z_block_cache_deinit(void);
+#endif
+
 extern const struct file_archive_file_backend zlib_backend;
 extern const struct file_archive_file_backend sevenzip_backend;
 
@@ -69,6 +69,9 @@ typedef struct nbio_intf
 
    void (*free)(void *data);
 
+   /* Optional, begin_read is called for each handle if NULL */
+   void (*begin_read_batch)(void **handles, size_t count);
+
    /* Human readable string. */
    const char *ident;
 } nbio_intf_t;
@@ -85,6 +88,13 @@ void *nbio_open(const char * filename, unsigned mode);
  */
 void nbio_begin_read(void *data);
 
+/*
+ * Starts reading all the given files at once. With backends that
+ * support it (io_uring), the reads are submitted together and are
+ * in flight at the same time. NULL handles are skipped.
+ */
+void nbio_begin_read_batch(void **handles, size_t count);
+
 /*
  * Starts writing to the given file. Before this, you should've copied the data to nbio_get_ptr.
  * Can not be done if the structure was created with {N,}BIO_READ.
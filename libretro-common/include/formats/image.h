@@ -71,8 +71,32 @@ bool image_texture_load_buffer(struct texture_image *img,
    enum image_type_enum type, void *buffer, size_t buffer_len);
 
 bool image_texture_load(struct texture_image *img, const char *path);
+
+/* Same as image_texture_load(), for an image that is going
+ * to be shrunk to fit inside max_width x max_height: the
+ * decoder may work at a reduced scale that is still no
+ * smaller than that (currently JPEG only). The result is
+ * not resized, it may still be larger than the box. */
+bool image_texture_load_scaled(struct texture_image *img, const char *path,
+      unsigned max_width, unsigned max_height);
 void image_texture_free(struct texture_image *img);
 
+/* Same as image_texture_load(), but the pixels are RGB565
+ * (uint16_t), alpha being dropped. PNG images are decoded
+ * to RGB565 directly, other formats are converted */
+bool image_texture_load_rgb565(struct texture_image *img, const char *path);
+
+typedef void (*image_texture_list_cb_t)(struct texture_image *img,
+      size_t idx, void *userdata);
+
+/* Loads each image of @paths, and calls @cb with the ones
+ * that could be loaded - @idx being their index in @paths.
+ * The image is freed once @cb returns. All the files are
+ * read at the same time, with nbio_begin_read_batch().
+ * NULL entries of @paths are skipped */
+void image_texture_load_list(const char **paths, size_t count,
+      bool supports_rgba, image_texture_list_cb_t cb, void *userdata);
+
 /* Image transfer */
 
 void image_transfer_free(void *data, enum image_type_enum type);
@@ -87,6 +111,11 @@ void image_transfer_set_buffer_ptr(
       void *ptr,
       size_t len);
 
+void image_transfer_set_target_size(
+      void *data,
+      enum image_type_enum type,
+      unsigned width, unsigned height);
+
 int image_transfer_process(
       void *data,
       enum image_type_enum type,
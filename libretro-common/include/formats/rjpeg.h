@@ -39,6 +39,14 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf,
 
 bool rjpeg_set_buf_ptr(rjpeg_t *rjpeg, void *data);
 
+/* Lets the decoder skip detail that would be thrown away
+ * when the image is shrunk to fit inside @width x @height:
+ * it is decoded at 1/2, 1/4 or 1/8 scale as long as that
+ * is still no smaller than the fitted size. 0 leaves an
+ * axis unconstrained, 0 x 0 decodes at full size. */
+void rjpeg_set_target_size(rjpeg_t *rjpeg,
+      unsigned width, unsigned height);
+
 void rjpeg_free(rjpeg_t *rjpeg);
 
 rjpeg_t *rjpeg_alloc(void);
@@ -38,8 +38,15 @@ rpng_t *rpng_init(const char *path);
 
 bool rpng_is_valid(rpng_t *rpng);
 
+/* The buffer is not copied, it must stay valid until
+ * rpng_process_image() has finished. */
 bool rpng_set_buf_ptr(rpng_t *rpng, void *data, size_t len);
 
+/* Makes rpng_process_image() output RGB565 pixels
+ * (uint16_t) instead of ARGB8888, alpha is dropped.
+ * Must be set before processing starts. */
+void rpng_set_output_rgb565(rpng_t *rpng, bool enable);
+
 rpng_t *rpng_alloc(void);
 
 void rpng_free(rpng_t *rpng);
@@ -94,6 +94,19 @@ void dir_list_sort(struct string_list *list, bool dir_first);
  **/
 void dir_list_sort_ignore_ext(struct string_list *list, bool dir_first);
 
+/**
+ * dir_list_sort_merge:
+ * @list        : pointer to the directory listing.
+ * @sorted_size : number of leading entries that are already sorted.
+ * @dir_first   : move the directories in the listing to the top?
+ *
+ * Sorts the entries appended after the first @sorted_size
+ * ones and merges them in, so that a listing read in
+ * batches stays sorted without sorting it all again.
+ **/
+void dir_list_sort_merge(struct string_list *list,
+      size_t sorted_size, bool dir_first);
+
 /**
  * dir_list_free:
  * @list : pointer to the directory listing
@@ -104,6 +117,41 @@ void dir_list_free(struct string_list *list);
 
 bool dir_list_deinitialize(struct string_list *list);
 
+struct dir_list_iterator;
+
+/**
+ * dir_list_iterator_new:
+ * @dir                : directory path.
+ * @ext                : allowed extensions of file directory entries to include.
+ * @include_dirs       : include directories as part of the finished directory listing?
+ * @include_hidden     : include hidden files and directories as part of the finished directory listing?
+ * @include_compressed : include compressed files, even when not part of ext.
+ *
+ * Opens a directory for reading its listing in batches
+ * with dir_list_iterator_read().
+ *
+ * @return NULL if the directory cannot be opened.
+ **/
+struct dir_list_iterator *dir_list_iterator_new(const char *dir,
+      const char *ext, bool include_dirs,
+      bool include_hidden, bool include_compressed);
+
+/**
+ * dir_list_iterator_read:
+ * @iter        : directory iterator.
+ * @list        : the string list to add files to.
+ * @max_entries : maximum number of directory entries to go through.
+ *
+ * Continues reading the directory listing into @list.
+ *
+ * @return -1 on error, 0 once the whole directory
+ * has been read, 1 if there are entries left.
+ **/
+int dir_list_iterator_read(struct dir_list_iterator *iter,
+      struct string_list *list, size_t max_entries);
+
+void dir_list_iterator_free(struct dir_list_iterator *iter);
+
 RETRO_END_DECLS
 
 #endif
@@ -51,6 +51,12 @@ int sha1_calculate(const char *path, char *result);
 
 uint32_t djb2_calculate(const char *str);
 
+#define FNV1A_INIT 2166136261U
+
+/* Continues the 32-bit FNV-1a hash 'hash' (FNV1A_INIT
+ * to start a new one) over 'len' bytes of 'data' */
+uint32_t fnv1a_calculate(uint32_t hash, const void *data, size_t len);
+
 /* Any 32-bit or wider unsigned integer data type will do */
 typedef unsigned int MD5_u32plus;
 
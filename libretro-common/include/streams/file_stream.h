@@ -67,6 +67,11 @@ int64_t filestream_seek(RFILE *stream, int64_t offset, int seek_position);
 
 int64_t filestream_read(RFILE *stream, void *data, int64_t len);
 
+/* Fills each buffer in turn, with as few reads from
+ * the OS as possible */
+int64_t filestream_readv(RFILE *stream,
+      const struct retro_vfs_iovec *iov, unsigned count);
+
 int64_t filestream_write(RFILE *stream, const void *data, int64_t len);
 
 int64_t filestream_tell(RFILE *stream);
@@ -120,10 +125,29 @@ int filestream_error(RFILE *stream);
 
 int filestream_flush(RFILE *stream);
 
+/* Like filestream_flush(), but also waits for the data
+ * to reach the storage device */
+int filestream_sync(RFILE *stream);
+
 int filestream_delete(const char *path);
 
 int filestream_rename(const char *old_path, const char *new_path);
 
+/**
+ * filestream_replace:
+ * @tmp_path : fully written temporary file
+ * @path     : destination
+ *
+ * Renames @tmp_path over @path, so that @path holds either
+ * the old or the new file in full. On Windows, where @path
+ * has to be deleted first, @tmp_path is kept if the rename
+ * still fails, as it then holds the only copy of the new
+ * file; otherwise @tmp_path is deleted on failure.
+ *
+ * @return 0 if successful, otherwise -1.
+ **/
+int filestream_replace(const char *tmp_path, const char *path);
+
 const char* filestream_get_path(RFILE *stream);
 
 bool filestream_exists(const char *path);
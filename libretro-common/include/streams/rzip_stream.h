@@ -55,6 +55,7 @@ RETRO_BEGIN_DECLS
  * 
  * <file id header>:                8 bytes
  *                                  - [#][R][Z][I][P][v][file format version][#]
+ *                                  - version 1
  * <uncompressed chunk size>:       4 bytes, little endian order
  *                                  - nominal (maximum) size of each uncompressed
  *                                    chunk, in bytes
@@ -62,16 +63,35 @@ RETRO_BEGIN_DECLS
  * <size of next compressed chunk>: 4 bytes, little endian order
  *                                  - size on-disk of next compressed data
  *                                    chunk, in bytes
- * <next compressed chunk>:         n bytes of zlib compressed data
+ * <next compressed chunk>:         n bytes of zlib/zstd compressed data
+ *                                  - zstd chunks are single zstd frames, so the
+ *                                    first chunk starting with the zstd frame
+ *                                    magic number marks a zstd file (older
+ *                                    readers fail to inflate it)
  * ...
  * <size of next compressed chunk> : repeated until end of file
  * <next compressed chunk>         :
  * 
+ * Chunks are independent of each other, so several
+ * of them are compressed/decompressed at once when
+ * threads are available.
  */
 
+enum rzip_codec
+{
+   RZIP_CODEC_ZLIB = 0,
+   RZIP_CODEC_ZSTD
+};
+
 /* Prevent direct access to rzipstream_t members */
 typedef struct rzipstream rzipstream_t;
 
+/* Sets the codec of the files opened for writing
+ * from now on (zlib by default). Files are always
+ * read with the codec recorded in their header.
+ * Returns false if the codec is not available */
+bool rzipstream_set_codec(enum rzip_codec codec);
+
 /* File Open */
 
 /* Opens a new or existing RZIP file
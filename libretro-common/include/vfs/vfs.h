@@ -23,6 +23,9 @@
 #ifndef __LIBRETRO_SDK_VFS_H
 #define __LIBRETRO_SDK_VFS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <retro_common_api.h>
 #include <boolean.h>
 
@@ -62,6 +65,24 @@ enum vfs_scheme
    VFS_SCHEME_CDROM
 };
 
+/* One destination buffer of a vectored read */
+struct retro_vfs_iovec
+{
+   void *data;
+   uint64_t len;
+};
+
+/* Read statistics of a file handle: 'reads' counts the
+ * read requests made, 'syscalls' the reads passed on to
+ * the OS (or to stdio, for uncached files) - the difference
+ * is what the read cache and vectored reads saved */
+struct retro_vfs_file_stats
+{
+   uint64_t reads;
+   uint64_t syscalls;
+   uint64_t bytes;
+};
+
 #if !(defined(__WINRT__) && defined(__cplusplus_winrt))
 #ifdef VFS_FRONTEND
 struct retro_vfs_file_handle
@@ -82,6 +103,13 @@ struct libretro_vfs_implementation_file
    char *buf;
    char* orig_path;
    uint8_t *mapped;
+   uint8_t *cache;         /* Read cache, NULL if not used */
+   uint64_t cache_offset;  /* File offset of cache[0] */
+   uint64_t pos;           /* Logical position when cached */
+   uint64_t fp_pos;        /* Position of fp when cached */
+   size_t cache_len;
+   size_t cache_size;
+   struct retro_vfs_file_stats stats;
    int fd;
    unsigned hints;
    enum vfs_scheme scheme;
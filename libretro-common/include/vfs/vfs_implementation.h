@@ -47,10 +47,41 @@ int64_t retro_vfs_file_seek_impl(libretro_vfs_implementation_file *stream, int64
 
 int64_t retro_vfs_file_read_impl(libretro_vfs_implementation_file *stream, void *s, uint64_t len);
 
+/* Reads into each buffer in turn, as a single read would;
+ * returns the total number of bytes read, or -1 */
+int64_t retro_vfs_file_readv_impl(libretro_vfs_implementation_file *stream,
+      const struct retro_vfs_iovec *iov, unsigned count);
+
+/* Files opened for reading get a cache of this size by
+ * default, so that many small reads (as done by cores
+ * reading disc images sector by sector, or by the database
+ * scanner) do not each end up as a system call */
+#define VFS_READ_CACHE_DEFAULT_SIZE (64 * 1024)
+
+/* Open hint: the reads of the file are added to the
+ * totals returned by retro_vfs_get_read_stats() */
+#define RFILE_HINT_READ_STATS (1 << 9)
+
+/* Size of the read cache given to files opened for reading
+ * from now on, 0 disables it */
+void retro_vfs_file_set_read_cache_size(size_t size);
+
+void retro_vfs_file_get_stats_impl(libretro_vfs_implementation_file *stream,
+      struct retro_vfs_file_stats *stats);
+
+/* Totals of the file handles opened with RFILE_HINT_READ_STATS
+ * and closed since the last retro_vfs_reset_read_stats() call */
+void retro_vfs_get_read_stats(struct retro_vfs_file_stats *stats);
+
+void retro_vfs_reset_read_stats(void);
+
 int64_t retro_vfs_file_write_impl(libretro_vfs_implementation_file *stream, const void *s, uint64_t len);
 
 int retro_vfs_file_flush_impl(libretro_vfs_implementation_file *stream);
 
+/* Flushes and commits the file contents to the storage device */
+int retro_vfs_file_sync_impl(libretro_vfs_implementation_file *stream);
+
 int retro_vfs_file_remove_impl(const char *path);
 
 int retro_vfs_file_rename_impl(const char *old_path, const char *new_path);
@@ -21,6 +21,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(_WIN32) && defined(_XBOX)
 #include <xtl.h>
@@ -116,6 +117,62 @@ void dir_list_sort_ignore_ext(struct string_list *list, bool dir_first)
             dir_first ? qstrcmp_dir_noext : qstrcmp_plain_noext);
 }
 
+/**
+ * dir_list_sort_merge:
+ * @list        : pointer to the directory listing.
+ * @sorted_size : number of leading entries that are already sorted.
+ * @dir_first   : move the directories in the listing to the top?
+ *
+ * Sorts the entries appended after the first @sorted_size
+ * ones and merges them in, so that a listing read in
+ * batches stays sorted without sorting it all again.
+ **/
+void dir_list_sort_merge(struct string_list *list,
+      size_t sorted_size, bool dir_first)
+{
+   size_t i, j, k;
+   struct string_list_elem *tmp = NULL;
+   int (*cmp)(const void*, const void*) = dir_first
+      ? qstrcmp_dir : qstrcmp_plain;
+
+   if (!list || sorted_size >= list->size)
+      return;
+
+   qsort(list->elems + sorted_size, list->size - sorted_size,
+         sizeof(struct string_list_elem), cmp);
+
+   if (     !sorted_size
+         || cmp(&list->elems[sorted_size - 1], &list->elems[sorted_size]) <= 0)
+      return;
+
+   /* Merge from a copy of the sorted head */
+   if (!(tmp = (struct string_list_elem*)
+            malloc(sorted_size * sizeof(struct string_list_elem))))
+   {
+      dir_list_sort(list, dir_first);
+      return;
+   }
+
+   memcpy(tmp, list->elems, sorted_size * sizeof(struct string_list_elem));
+
+   i = 0;
+   j = sorted_size;
+   k = 0;
+
+   while (i < sorted_size && j < list->size)
+   {
+      if (cmp(&tmp[i], &list->elems[j]) <= 0)
+         list->elems[k++] = tmp[i++];
+      else
+         list->elems[k++] = list->elems[j++];
+   }
+
+   while (i < sorted_size)
+      list->elems[k++] = tmp[i++];
+
+   free(tmp);
+}
+
 /**
  * dir_list_free:
  * @list : pointer to the directory listing
@@ -149,83 +206,102 @@ bool dir_list_deinitialize(struct string_list *list)
  * @return -1 on error, 0 on success.
  **/
 static int dir_list_read(const char *dir,
+      struct string_list *list, struct string_list *ext_list,
+      bool include_dirs, bool include_hidden,
+      bool include_compressed, bool recursive);
+
+/* Adds the entry 'entry' currently points at to 'list',
+ * unless it is filtered out.
+ * Returns -1 on error, 0 on success. */
+static int dir_list_read_entry(struct RDIR *entry, const char *dir,
       struct string_list *list, struct string_list *ext_list,
       bool include_dirs, bool include_hidden,
       bool include_compressed, bool recursive)
 {
-   struct RDIR *entry = retro_opendir_include_hidden(dir, include_hidden);
+   union string_list_elem_attr attr;
+   char file_path[PATH_MAX_LENGTH];
+   const char *name                = retro_dirent_get_name(entry);
 
-   if (!entry || retro_dirent_error(entry))
-      goto error;
-
-   while (retro_readdir(entry))
+   if (name[0] == '.')
    {
-      union string_list_elem_attr attr;
-      char file_path[PATH_MAX_LENGTH];
-      const char *name                = retro_dirent_get_name(entry);
-
-      if (name[0] == '.')
-      {
-         /* Do not include hidden files and directories */
-         if (!include_hidden)
-            continue;
-
-         /* char-wise comparisons to avoid string comparison */
-
-         /* Do not include current dir */
-         if (name[1] == '\0')
-            continue;
-         /* Do not include parent dir */
-         if (name[1] == '.' && name[2] == '\0')
-            continue;
-      }
+      /* Do not include hidden files and directories */
+      if (!include_hidden)
+         return 0;
+
+      /* char-wise comparisons to avoid string comparison */
+
+      /* Do not include current dir */
+      if (name[1] == '\0')
+         return 0;
+      /* Do not include parent dir */
+      if (name[1] == '.' && name[2] == '\0')
+         return 0;
+   }
 
-      fill_pathname_join_special(file_path, dir, name, sizeof(file_path));
+   fill_pathname_join_special(file_path, dir, name, sizeof(file_path));
 
-      if (retro_dirent_is_dir(entry, NULL))
-      {
-         /* Exclude this frequent hidden dir on platforms which can not handle hidden attribute */
+   if (retro_dirent_is_dir(entry, NULL))
+   {
+      /* Exclude this frequent hidden dir on platforms which can not handle hidden attribute */
 #ifndef _WIN32
-         if (!include_hidden && strcmp(name, "System Volume Information") == 0)
-            continue;
+      if (!include_hidden && strcmp(name, "System Volume Information") == 0)
+         return 0;
 #endif
-         if (recursive)
-            dir_list_read(file_path, list, ext_list, include_dirs,
-                  include_hidden, include_compressed, recursive);
+      if (recursive)
+         dir_list_read(file_path, list, ext_list, include_dirs,
+               include_hidden, include_compressed, recursive);
 
-         if (!include_dirs)
-            continue;
-         attr.i = RARCH_DIRECTORY;
-      }
+      if (!include_dirs)
+         return 0;
+      attr.i = RARCH_DIRECTORY;
+   }
+   else
+   {
+      const char *file_ext    = path_get_extension(name);
+
+      attr.i                  = RARCH_FILETYPE_UNSET;
+
+      /*
+       * If the file format is explicitly supported by the libretro-core, we
+       * need to immediately load it and not designate it as a compressed file.
+       *
+       * Example: .zip could be supported as a image by the core and as a
+       * compressed_file. In that case, we have to interpret it as a image.
+       *
+       * */
+      if (string_list_find_elem_prefix(ext_list, ".", file_ext))
+         attr.i            = RARCH_PLAIN_FILE;
       else
       {
-         const char *file_ext    = path_get_extension(name);
-
-         attr.i                  = RARCH_FILETYPE_UNSET;
-
-         /*
-          * If the file format is explicitly supported by the libretro-core, we
-          * need to immediately load it and not designate it as a compressed file.
-          *
-          * Example: .zip could be supported as a image by the core and as a
-          * compressed_file. In that case, we have to interpret it as a image.
-          *
-          * */
-         if (string_list_find_elem_prefix(ext_list, ".", file_ext))
-            attr.i            = RARCH_PLAIN_FILE;
-         else
-         {
-            bool is_compressed_file;
-            if ((is_compressed_file = path_is_compressed_file(file_path)))
-               attr.i               = RARCH_COMPRESSED_ARCHIVE;
-
-            if (ext_list &&
-                  (!is_compressed_file || !include_compressed))
-               continue;
-         }
+         bool is_compressed_file;
+         if ((is_compressed_file = path_is_compressed_file(file_path)))
+            attr.i               = RARCH_COMPRESSED_ARCHIVE;
+
+         if (ext_list &&
+               (!is_compressed_file || !include_compressed))
+            return 0;
       }
+   }
+
+   if (!string_list_append(list, file_path, attr))
+      return -1;
+   return 0;
+}
+
+static int dir_list_read(const char *dir,
+      struct string_list *list, struct string_list *ext_list,
+      bool include_dirs, bool include_hidden,
+      bool include_compressed, bool recursive)
+{
+   struct RDIR *entry = retro_opendir_include_hidden(dir, include_hidden);
+
+   if (!entry || retro_dirent_error(entry))
+      goto error;
 
-      if (!string_list_append(list, file_path, attr))
+   while (retro_readdir(entry))
+   {
+      if (dir_list_read_entry(entry, dir, list, ext_list, include_dirs,
+               include_hidden, include_compressed, recursive) == -1)
          goto error;
    }
 
@@ -326,3 +402,107 @@ bool dir_list_initialize(struct string_list *list,
             include_hidden, include_compressed, recursive);
    return false;
 }
+
+struct dir_list_iterator
+{
+   struct RDIR *entry;
+   char *dir;
+   struct string_list ext_list;
+   bool has_ext_list;
+   bool include_dirs;
+   bool include_hidden;
+   bool include_compressed;
+};
+
+/**
+ * dir_list_iterator_new:
+ * @dir                : directory path.
+ * @ext                : allowed extensions of file directory entries to include.
+ * @include_dirs       : include directories as part of the finished directory listing?
+ * @include_hidden     : include hidden files and directories as part of the finished directory listing?
+ * @include_compressed : include compressed files, even when not part of ext.
+ *
+ * Opens a directory for reading its listing in batches
+ * with dir_list_iterator_read().
+ *
+ * @return NULL if the directory cannot be opened.
+ **/
+struct dir_list_iterator *dir_list_iterator_new(const char *dir,
+      const char *ext, bool include_dirs,
+      bool include_hidden, bool include_compressed)
+{
+   struct dir_list_iterator *iter = (struct dir_list_iterator*)
+      calloc(1, sizeof(*iter));
+
+   if (!iter)
+      return NULL;
+
+   iter->entry = retro_opendir_include_hidden(dir, include_hidden);
+
+   if (!iter->entry || retro_dirent_error(iter->entry))
+   {
+      dir_list_iterator_free(iter);
+      return NULL;
+   }
+
+   iter->dir                = strdup(dir);
+   iter->include_dirs       = include_dirs;
+   iter->include_hidden     = include_hidden;
+   iter->include_compressed = include_compressed;
+
+   if (ext)
+   {
+      string_list_initialize(&iter->ext_list);
+      string_split_noalloc(&iter->ext_list, ext, "|");
+      iter->has_ext_list    = true;
+   }
+
+   return iter;
+}
+
+/**
+ * dir_list_iterator_read:
+ * @iter        : directory iterator.
+ * @list        : the string list to add files to.
+ * @max_entries : maximum number of directory entries to go through.
+ *
+ * Continues reading the directory listing into @list.
+ *
+ * @return -1 on error, 0 once the whole directory
+ * has been read, 1 if there are entries left.
+ **/
+int dir_list_iterator_read(struct dir_list_iterator *iter,
+      struct string_list *list, size_t max_entries)
+{
+   size_t i;
+
+   if (!iter || !iter->entry)
+      return -1;
+
+   for (i = 0; i < max_entries; i++)
+   {
+      if (!retro_readdir(iter->entry))
+         return 0;
+
+      if (dir_list_read_entry(iter->entry, iter->dir, list,
+               iter->has_ext_list ? &iter->ext_list : NULL,
+               iter->include_dirs, iter->include_hidden,
+               iter->include_compressed, false) == -1)
+         return -1;
+   }
+
+   return 1;
+}
+
+void dir_list_iterator_free(struct dir_list_iterator *iter)
+{
+   if (!iter)
+      return;
+
+   if (iter->entry)
+      retro_closedir(iter->entry);
+   if (iter->has_ext_list)
+      string_list_deinitialize(&iter->ext_list);
+   free(iter->dir);
+   free(iter);
+}
@@ -0,0 +1,212 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rpng_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Decodes every PNG of a thumbnail corpus (files and/or
+ * directories given on the command line) several times and
+ * reports decode throughput. With -v, a CRC of the decoded
+ * pixels of each file is printed as well, which can be used
+ * to check that decoder changes do not alter the output. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <retro_dirent.h>
+#include <retro_miscellaneous.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
+#include <formats/rpng.h>
+#include <formats/image.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+struct bench_totals
+{
+   double seconds;
+   uint64_t pixels;
+   uint64_t bytes;
+   unsigned files;
+   unsigned failures;
+};
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+static bool bench_decode(const void *buf, size_t len, bool rgb565,
+      void **data, unsigned *width, unsigned *height)
+{
+   int retval;
+   bool ret     = false;
+   rpng_t *rpng = rpng_alloc();
+
+   *data        = NULL;
+
+   if (!rpng)
+      return false;
+
+   rpng_set_output_rgb565(rpng, rgb565);
+
+   if (     !rpng_set_buf_ptr(rpng, (void*)buf, len)
+         || !rpng_start(rpng))
+      goto end;
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+      goto end;
+
+   do
+   {
+      retval = rpng_process_image(rpng, data, len, width, height);
+   } while (retval == IMAGE_PROCESS_NEXT);
+
+   ret = (retval == IMAGE_PROCESS_END);
+
+end:
+   rpng_free(rpng);
+   if (!ret && *data)
+   {
+      free(*data);
+      *data = NULL;
+   }
+   return ret;
+}
+
+static void bench_file(const char *path, unsigned iterations,
+      bool rgb565, bool verbose, struct bench_totals *totals)
+{
+   unsigned i;
+   double start;
+   void *buf      = NULL;
+   int64_t len    = 0;
+   unsigned width = 0, height = 0;
+
+   if (!string_is_equal_noncase(path_get_extension(path), "png"))
+      return;
+
+   if (!filestream_read_file(path, &buf, &len))
+      return;
+
+   start = bench_time();
+
+   for (i = 0; i < iterations; i++)
+   {
+      void *data = NULL;
+
+      if (!bench_decode(buf, (size_t)len, rgb565, &data, &width, &height))
+      {
+         totals->failures++;
+         if (verbose)
+            printf("FAIL %s\n", path);
+         break;
+      }
+
+      if (verbose && i == 0)
+         printf("%08x %ux%u %s\n", (unsigned)encoding_crc32(0,
+                  (const uint8_t*)data, width * height *
+                  (rgb565 ? sizeof(uint16_t) : sizeof(uint32_t))),
+               width, height, path);
+
+      free(data);
+   }
+
+   if (i == iterations)
+   {
+      totals->seconds += bench_time() - start;
+      totals->pixels  += (uint64_t)width * height * iterations;
+      totals->bytes   += (uint64_t)len * iterations;
+      totals->files++;
+   }
+
+   free(buf);
+}
+
+static void bench_path(const char *path, unsigned iterations,
+      bool rgb565, bool verbose, struct bench_totals *totals)
+{
+   struct RDIR *dir;
+
+   if (!path_is_directory(path))
+   {
+      bench_file(path, iterations, rgb565, verbose, totals);
+      return;
+   }
+
+   if (!(dir = retro_opendir(path)))
+      return;
+
+   while (retro_readdir(dir))
+   {
+      char child[PATH_MAX_LENGTH];
+      const char *name = retro_dirent_get_name(dir);
+
+      if (string_is_equal(name, ".") || string_is_equal(name, ".."))
+         continue;
+
+      fill_pathname_join_special(child, path, name, sizeof(child));
+      bench_path(child, iterations, rgb565, verbose, totals);
+   }
+
+   retro_closedir(dir);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned iterations        = 10;
+   bool rgb565                = false;
+   bool verbose               = false;
+   struct bench_totals totals = {0};
+
+   for (i = 1; i < argc; i++)
+   {
+      if (string_is_equal(argv[i], "-n") && i + 1 < argc)
+         iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+      else if (string_is_equal(argv[i], "-565"))
+         rgb565     = true;
+      else if (string_is_equal(argv[i], "-v"))
+         verbose    = true;
+      else
+         bench_path(argv[i], iterations ? iterations : 1,
+               rgb565, verbose, &totals);
+   }
+
+   if (!totals.files)
+   {
+      fprintf(stderr, "Usage: %s [-n iterations] [-565] [-v] <png file or directory>...\n",
+            argv[0]);
+      return 1;
+   }
+
+   printf("Decoded %u files (%u failed) x %u: %.3f s, %.2f MPixel/s, %.2f MB/s compressed\n",
+         totals.files, totals.failures, iterations, totals.seconds,
+         (double)totals.pixels / totals.seconds / 1000000.0,
+         (double)totals.bytes  / totals.seconds / (1024.0 * 1024.0));
+
+   return 0;
+}
@@ -28,17 +28,53 @@
 
 #include <streams/chd_stream.h>
 #include <retro_endianness.h>
+#include <retro_miscellaneous.h>
 #include <libchdr/chd.h>
 #include <string/stdstring.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+/* Number of decoded hunks kept */
+#define CHDSTREAM_CACHE_HUNKS 16
+/* Number of hunks decoded ahead of sequential reads */
+#define CHDSTREAM_PREFETCH_HUNKS 8
+
+typedef struct chdstream_hunk
+{
+   uint8_t *data;
+   int32_t hunknum;
+   unsigned last_used;
+} chdstream_hunk_t;
+
 struct chdstream
 {
    chd_file *chd;
-   /* Loaded hunk */
+   /* Decoded hunks, least recently used first out */
+   chdstream_hunk_t cache[CHDSTREAM_CACHE_HUNKS];
+#ifdef HAVE_THREADS
+   /* Decodes the hunks following the ones being read */
+   sthread_t *prefetch_thread;
+   /* Guards the cache and the prefetch state */
+   slock_t *lock;
+   /* Guards the chd file */
+   slock_t *chd_lock;
+   scond_t *cond;
+   /* Decode buffer of the prefetch thread */
+   uint8_t *prefetch_mem;
+   /* Hunks left to prefetch, from next to end */
+   uint32_t prefetch_next;
+   uint32_t prefetch_end;
+   /* Hunk being prefetched, or -1 */
+   int32_t prefetch_hunknum;
+   bool prefetch_quit;
+#endif
+   /* Decode buffer */
    uint8_t *hunkmem;
    /* Byte offset where track data starts (after pregap) */
    size_t track_start;
@@ -46,8 +82,12 @@ struct chdstream
    size_t track_end;
    /* Byte offset of read cursor */
    size_t offset;
-   /* Loaded hunk number */
+   /* Last hunk read */
    int32_t hunknum;
+   unsigned counter;
+   /* Number of hunks in the chd */
+   uint32_t total_hunks;
+   uint32_t hunkbytes;
    /* Size of frame taken from each hunk */
    uint32_t frame_size;
    /* Offset of data within frame */
@@ -206,6 +246,7 @@ chdstream_find_track(chd_file *fd, int32_t track, metadata_t *meta)
 chdstream_t *chdstream_open(const char *path, int32_t track)
 {
    metadata_t meta;
+   unsigned i;
    uint32_t pregap         = 0;
    uint8_t *hunkmem        = NULL;
    const chd_header *hd    = NULL;
@@ -219,20 +260,10 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    if (!chdstream_find_track(chd, track, &meta))
       goto error;
 
-   stream                  = (chdstream_t*)malloc(sizeof(*stream));
+   stream                  = (chdstream_t*)calloc(1, sizeof(*stream));
    if (!stream)
       goto error;
 
-   stream->chd             = NULL;
-   stream->swab            = false;
-   stream->frame_size      = 0;
-   stream->frame_offset    = 0;
-   stream->frames_per_hunk = 0;
-   stream->track_frame     = 0;
-   stream->track_start     = 0;
-   stream->track_end       = 0;
-   stream->offset          = 0;
-   stream->hunkmem         = NULL;
    stream->hunknum         = -1;
 
    hd                      = chd_get_header(chd);
@@ -241,6 +272,24 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
       goto error;
 
    stream->hunkmem         = hunkmem;
+   stream->hunkbytes       = hd->hunkbytes;
+   stream->total_hunks     = hd->totalhunks;
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+      stream->cache[i].hunknum = -1;
+      if (!(stream->cache[i].data = (uint8_t*)malloc(hd->hunkbytes)))
+         goto error;
+   }
+
+#ifdef HAVE_THREADS
+   /* Without these, hunks are only decoded on read */
+   stream->prefetch_hunknum = -1;
+   stream->lock             = slock_new();
+   stream->chd_lock         = slock_new();
+   stream->cond             = scond_new();
+   stream->prefetch_mem     = (uint8_t*)malloc(hd->hunkbytes);
+#endif
 
    if (string_is_equal(meta.type, "MODE1_RAW"))
       stream->frame_size   = SECTOR_SIZE;
@@ -279,9 +328,35 @@ error:
 
 void chdstream_close(chdstream_t *stream)
 {
+   unsigned i;
+
    if (!stream)
       return;
 
+#ifdef HAVE_THREADS
+   if (stream->prefetch_thread)
+   {
+      slock_lock(stream->lock);
+      stream->prefetch_quit = true;
+      scond_broadcast(stream->cond);
+      slock_unlock(stream->lock);
+      sthread_join(stream->prefetch_thread);
+   }
+
+   if (stream->lock)
+      slock_free(stream->lock);
+   if (stream->chd_lock)
+      slock_free(stream->chd_lock);
+   if (stream->cond)
+      scond_free(stream->cond);
+   if (stream->prefetch_mem)
+      free(stream->prefetch_mem);
+#endif
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+      if (stream->cache[i].data)
+         free(stream->cache[i].data);
+
    if (stream->hunkmem)
       free(stream->hunkmem);
    if (stream->chd)
@@ -289,27 +364,194 @@ void chdstream_close(chdstream_t *stream)
    free(stream);
 }
 
-static bool
-chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+/* Decodes a hunk into 'mem'. Called with chd_lock held */
+static bool chdstream_decode_hunk(chdstream_t *stream,
+      uint32_t hunknum, uint8_t *mem)
 {
-   uint16_t *array;
-
-   if ((int)hunknum == stream->hunknum)
-      return true;
-
-   if (chd_read(stream->chd, hunknum, stream->hunkmem) != CHDERR_NONE)
+   if (chd_read(stream->chd, hunknum, mem) != CHDERR_NONE)
       return false;
 
    if (stream->swab)
    {
       uint32_t i;
-      uint32_t count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array          = (uint16_t*)stream->hunkmem;
+      uint32_t count  = stream->hunkbytes / 2;
+      uint16_t *array = (uint16_t*)mem;
       for (i = 0; i < count; ++i)
          array[i] = SWAP16(array[i]);
    }
 
+   return true;
+}
+
+/* The cache functions are called with the lock held */
+static chdstream_hunk_t *chdstream_cache_find(chdstream_t *stream,
+      int32_t hunknum)
+{
+   unsigned i;
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+      if (stream->cache[i].hunknum == hunknum)
+         return &stream->cache[i];
+
+   return NULL;
+}
+
+/* Swaps the decode buffer '*mem' with the buffer of the
+ * least recently used slot, which then holds 'hunknum' */
+static void chdstream_cache_insert(chdstream_t *stream,
+      int32_t hunknum, uint8_t **mem)
+{
+   unsigned i;
+   uint8_t *data          = NULL;
+   chdstream_hunk_t *hunk = &stream->cache[0];
+
+   for (i = 1; i < CHDSTREAM_CACHE_HUNKS && hunk->hunknum != -1; i++)
+      if (     stream->cache[i].hunknum == -1
+            || (stream->counter - stream->cache[i].last_used) >
+               (stream->counter - hunk->last_used))
+         hunk = &stream->cache[i];
+
+   data            = hunk->data;
+   hunk->data      = *mem;
+   hunk->hunknum   = hunknum;
+   hunk->last_used = ++stream->counter;
+   *mem            = data;
+}
+
+#ifdef HAVE_THREADS
+static void chdstream_prefetch_thread(void *data)
+{
+   chdstream_t *stream = (chdstream_t*)data;
+
+   slock_lock(stream->lock);
+
+   for (;;)
+   {
+      bool ok;
+      uint32_t hunknum;
+
+      while (     !stream->prefetch_quit
+            &&     stream->prefetch_next >= stream->prefetch_end)
+         scond_wait(stream->cond, stream->lock);
+
+      if (stream->prefetch_quit)
+         break;
+
+      hunknum = stream->prefetch_next++;
+
+      if (chdstream_cache_find(stream, hunknum))
+         continue;
+
+      stream->prefetch_hunknum = hunknum;
+      slock_unlock(stream->lock);
+
+      slock_lock(stream->chd_lock);
+      ok = chdstream_decode_hunk(stream, hunknum, stream->prefetch_mem);
+      slock_unlock(stream->chd_lock);
+
+      slock_lock(stream->lock);
+      if (ok && !chdstream_cache_find(stream, hunknum))
+         chdstream_cache_insert(stream, hunknum, &stream->prefetch_mem);
+      stream->prefetch_hunknum = -1;
+      /* A read may be waiting for this hunk */
+      scond_broadcast(stream->cond);
+   }
+
+   slock_unlock(stream->lock);
+}
+
+/* Called with the lock held */
+static void chdstream_prefetch(chdstream_t *stream, uint32_t hunknum)
+{
+   uint32_t end;
+
+   /* Only sequential reads are followed */
+   if (     stream->hunknum < 0
+         || (int32_t)hunknum != stream->hunknum + 1)
+   {
+      stream->prefetch_next = stream->prefetch_end = 0;
+      return;
+   }
+
+   /* The thread is only started once the stream is read
+    * past a hunk, so that short reads do not pay for it */
+   if (!stream->prefetch_thread)
+   {
+      if (     !stream->lock
+            || !stream->chd_lock
+            || !stream->cond
+            || !stream->prefetch_mem
+            || !(stream->prefetch_thread = sthread_create(
+                  chdstream_prefetch_thread, stream)))
+         return;
+   }
+
+   end = MIN(hunknum + 1 + CHDSTREAM_PREFETCH_HUNKS, stream->total_hunks);
+
+   if (     stream->prefetch_next <= hunknum
+         || stream->prefetch_next >  end)
+      stream->prefetch_next = hunknum + 1;
+   stream->prefetch_end     = end;
+
+   scond_broadcast(stream->cond);
+}
+#endif
+
+/* Copies 'len' bytes from 'offset' in hunk 'hunknum' */
+static bool chdstream_read_hunk(chdstream_t *stream,
+      uint32_t hunknum, size_t offset, uint8_t *out, size_t len)
+{
+   bool ok;
+   chdstream_hunk_t *hunk = NULL;
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
+
+   if ((int32_t)hunknum != stream->hunknum)
+      chdstream_prefetch(stream, hunknum);
+
+   /* The hunk is being decoded ahead */
+   while (stream->prefetch_hunknum == (int32_t)hunknum)
+      scond_wait(stream->cond, stream->lock);
+#endif
+
    stream->hunknum = hunknum;
+
+   if ((hunk = chdstream_cache_find(stream, hunknum)))
+   {
+      hunk->last_used = ++stream->counter;
+      memcpy(out, hunk->data + offset, len);
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(stream->lock);
+#endif
+
+   if (hunk)
+      return true;
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->chd_lock);
+#endif
+   ok = chdstream_decode_hunk(stream, hunknum, stream->hunkmem);
+#ifdef HAVE_THREADS
+   slock_unlock(stream->chd_lock);
+#endif
+
+   if (!ok)
+      return false;
+
+   memcpy(out, stream->hunkmem + offset, len);
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
+#endif
+   if (!chdstream_cache_find(stream, hunknum))
+      chdstream_cache_insert(stream, hunknum, &stream->hunkmem);
+#ifdef HAVE_THREADS
+   slock_unlock(stream->lock);
+#endif
+
    return true;
 }
 
@@ -344,12 +586,10 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
          uint32_t hunk_offset = (chd_frame % stream->frames_per_hunk) 
             * hd->unitbytes;
 
-         if (!chdstream_load_hunk(stream, hunk))
+         if (!chdstream_read_hunk(stream, hunk,
+                  frame_offset + hunk_offset + stream->frame_offset,
+                  out + data_offset, amount))
             return -1;
-
-         memcpy(out + data_offset,
-                stream->hunkmem + frame_offset
-                + hunk_offset + stream->frame_offset, amount);
       }
 
       data_offset    += amount;
@@ -408,6 +408,41 @@ int64_t filestream_read(RFILE *stream, void *s, int64_t len)
    return output;
 }
 
+int64_t filestream_readv(RFILE *stream,
+      const struct retro_vfs_iovec *iov, unsigned count)
+{
+   int64_t output;
+
+   /* The VFS interface has no vectored read */
+   if (filestream_read_cb)
+   {
+      unsigned i;
+      int64_t ret;
+
+      for (i = 0, output = 0; i < count; i++)
+      {
+         if ((ret = filestream_read_cb(stream->hfile,
+                     iov[i].data, iov[i].len)) < 0)
+         {
+            if (!output)
+               output = ret;
+            break;
+         }
+         output += ret;
+         if ((uint64_t)ret < iov[i].len)
+            break;
+      }
+   }
+   else
+      output = retro_vfs_file_readv_impl(
+            (libretro_vfs_implementation_file*)stream->hfile, iov, count);
+
+   if (output == VFS_ERROR_RETURN_VALUE)
+      stream->error_flag = true;
+
+   return output;
+}
+
 int filestream_flush(RFILE *stream)
 {
    int output;
@@ -424,6 +459,24 @@ int filestream_flush(RFILE *stream)
    return output;
 }
 
+int filestream_sync(RFILE *stream)
+{
+   int output;
+
+   /* The frontend VFS interface has no sync, flushing
+    * is the closest it gets */
+   if (filestream_flush_cb)
+      output = filestream_flush_cb(stream->hfile);
+   else
+      output = retro_vfs_file_sync_impl(
+            (libretro_vfs_implementation_file*)stream->hfile);
+
+   if (output == VFS_ERROR_RETURN_VALUE)
+      stream->error_flag = true;
+
+   return output;
+}
+
 int filestream_delete(const char *path)
 {
    if (filestream_remove_cb)
@@ -440,6 +493,29 @@ int filestream_rename(const char *old_path, const char *new_path)
    return retro_vfs_file_rename_impl(old_path, new_path);
 }
 
+int filestream_replace(const char *tmp_path, const char *path)
+{
+   if (filestream_rename(tmp_path, path) == 0)
+      return 0;
+
+#ifdef _WIN32
+   /* Windows cannot rename over an existing file */
+   if (filestream_exists(path))
+   {
+      filestream_delete(path);
+      if (filestream_rename(tmp_path, path) == 0)
+         return 0;
+
+      /* The old file is gone, keep the new one */
+      if (!filestream_exists(path))
+         return -1;
+   }
+#endif
+
+   filestream_delete(tmp_path);
+   return -1;
+}
+
 const char* filestream_get_path(RFILE *stream)
 {
    if (filestream_get_path_cb)
@@ -22,20 +22,41 @@
 
 #include <string/stdstring.h>
 #include <file/file_path.h>
+#include <retro_miscellaneous.h>
 
 #include <streams/file_stream.h>
 #include <streams/trans_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
+#endif
+
 #include <streams/rzip_stream.h>
 
-/* Current RZIP file format version */
+/* Current RZIP file format version
+ * > Chunks of zstd compressed files are
+ *   framed the same way, and are told apart
+ *   by the zstd frame magic number that
+ *   starts the first chunk. No zlib stream
+ *   can start with it (its header check
+ *   fails), so older readers reject these
+ *   files when inflating the first chunk */
 #define RZIP_VERSION 1
+#define RZIP_ZSTD_MAGIC 0xFD2FB528
 
 /* Compression level
  * > zlib default of 6 provides the best
  *   balance between file size and
  *   compression speed */
 #define RZIP_COMPRESSION_LEVEL 6
+/* > zstd default of 3 is both faster and
+ *   smaller than zlib level 6 */
+#define RZIP_ZSTD_COMPRESSION_LEVEL 3
+
+/* Maximum number of chunks compressed or
+ * decompressed at once, one per thread */
+#define RZIP_MAX_BATCH 8
 
 /* Default chunk size: 128kb */
 #define RZIP_DEFAULT_CHUNK_SIZE 131072
@@ -44,6 +65,16 @@
 #define RZIP_HEADER_SIZE 20
 #define RZIP_CHUNK_HEADER_SIZE 4
 
+/* One chunk of the batch being (de)compressed */
+typedef struct rzip_chunk
+{
+   uint8_t *in;
+   uint8_t *out;
+   uint32_t in_size;
+   uint32_t out_size;   /* Capacity, then amount written */
+   bool ok;
+} rzip_chunk_t;
+
 /* Holds all metadata for an RZIP file stream */
 struct rzipstream
 {
@@ -51,11 +82,14 @@ struct rzipstream
    /* virtual_ptr: Used to track how much
     * uncompressed data has been read */
    uint64_t virtual_ptr;
+   /* out_buf_start: Uncompressed offset of
+    * the data held in the output buffer */
+   uint64_t out_buf_start;
    RFILE* file;
-   const struct trans_stream_backend *deflate_backend;
-   void *deflate_stream;
-   const struct trans_stream_backend *inflate_backend;
-   void *inflate_stream;
+   const struct trans_stream_backend *backend;
+   /* One transform stream per chunk of a batch */
+   void *trans_streams[RZIP_MAX_BATCH];
+   rzip_chunk_t chunks[RZIP_MAX_BATCH];
    uint8_t *in_buf;
    uint8_t *out_buf;
    uint32_t in_buf_size;
@@ -64,10 +98,118 @@ struct rzipstream
    uint32_t out_buf_ptr;
    uint32_t out_buf_occupancy;
    uint32_t chunk_size;
+   unsigned batch_size;
+   enum rzip_codec codec;
    bool is_compressed;
    bool is_writing;
 };
 
+/* Codec of new files */
+static enum rzip_codec rzip_codec = RZIP_CODEC_ZLIB;
+
+bool rzipstream_set_codec(enum rzip_codec codec)
+{
+#ifndef HAVE_ZSTD
+   if (codec == RZIP_CODEC_ZSTD)
+      return false;
+#endif
+   rzip_codec = codec;
+   return true;
+}
+
+/* Batches */
+
+static void rzipstream_process_chunk(rzipstream_t *stream, unsigned i)
+{
+   uint32_t read;
+   uint32_t written;
+   rzip_chunk_t *chunk = &stream->chunks[i];
+   void *trans         = stream->trans_streams[i];
+
+   stream->backend->set_in(trans, chunk->in, chunk->in_size);
+   stream->backend->set_out(trans, chunk->out, chunk->out_size);
+
+   /* Note: We have to set 'flush == true' here, otherwise we
+    * can't guarantee that the entire chunk will be written
+    * to the output buffer - this is inefficient, but not
+    * much we can do... */
+   chunk->ok = stream->backend->trans(trans, true,
+         &read, &written, NULL)
+      && (read    == chunk->in_size)
+      && (written >  0)
+      && (written <= chunk->out_size);
+
+   chunk->out_size = written;
+}
+
+#ifdef HAVE_THREADS
+typedef struct rzip_batch_worker
+{
+   rzipstream_t *stream;
+   unsigned first;
+   unsigned step;
+   unsigned count;
+} rzip_batch_worker_t;
+
+static void rzipstream_batch_thread(void *data)
+{
+   unsigned i;
+   rzip_batch_worker_t *worker = (rzip_batch_worker_t*)data;
+
+   for (i = worker->first; i < worker->count; i += worker->step)
+      rzipstream_process_chunk(worker->stream, i);
+}
+#endif
+
+/* (De)compresses the first 'count' chunks, spreading
+ * them over up to one thread per chunk */
+static bool rzipstream_process_batch(rzipstream_t *stream, unsigned count)
+{
+   unsigned i;
+#ifdef HAVE_THREADS
+   sthread_t *threads[RZIP_MAX_BATCH];
+   rzip_batch_worker_t workers[RZIP_MAX_BATCH];
+   unsigned num_threads = MIN(count, stream->batch_size);
+
+   if (num_threads < 1)
+      num_threads = 1;
+
+   for (i = 0; i < num_threads; i++)
+   {
+      threads[i]        = NULL;
+      workers[i].stream = stream;
+      workers[i].first  = i;
+      workers[i].step   = num_threads;
+      workers[i].count  = count;
+   }
+
+   for (i = 1; i < num_threads; i++)
+      if (!(threads[i] = sthread_create(
+                  rzipstream_batch_thread, &workers[i])))
+         break;
+
+   /* Chunks of the threads that could not be
+    * started are done here */
+   for (; i < num_threads; i++)
+      rzipstream_batch_thread(&workers[i]);
+
+   rzipstream_batch_thread(&workers[0]);
+
+   for (i = 1; i < num_threads; i++)
+      if (threads[i])
+         sthread_join(threads[i]);
+#else
+   for (i = 0; i < count; i++)
+      rzipstream_process_chunk(stream, i);
+#endif
+
+   for (i = 0; i < count; i++)
+      if (!stream->chunks[i].ok)
+         return false;
+
+   return true;
+}
+
 /* Header Functions */
 
 /* Reads header information from RZIP file
@@ -133,7 +275,21 @@ static bool rzipstream_read_file_header(rzipstream_t *stream)
                    (uint64_t)header_bytes[12]) == 0)
       return false;
 
+   /* Get codec - start of the first chunk, after
+    * its compressed size */
+   if (filestream_read(stream->file, header_bytes,
+            RZIP_CHUNK_HEADER_SIZE + 4) != RZIP_CHUNK_HEADER_SIZE + 4)
+      return false;
+
+   stream->codec         = ((((uint32_t)header_bytes[7] << 24) |
+                             ((uint32_t)header_bytes[6] << 16) |
+                             ((uint32_t)header_bytes[5] <<  8) |
+                              (uint32_t)header_bytes[4]) == RZIP_ZSTD_MAGIC)
+      ? RZIP_CODEC_ZSTD : RZIP_CODEC_ZLIB;
    stream->is_compressed = true;
+
+   /* Reset file to first chunk */
+   filestream_seek(stream->file, RZIP_HEADER_SIZE, SEEK_SET);
    return true;
 }
 
@@ -193,7 +349,9 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
 static bool rzipstream_init_stream(
       rzipstream_t *stream, const char *path, bool is_writing)
 {
+   unsigned i;
    unsigned file_mode;
+   uint32_t out_chunk_size = 0;
 
    if (!stream)
       return false;
@@ -202,10 +360,7 @@ static bool rzipstream_init_stream(
    stream->size              = 0;
    stream->chunk_size        = RZIP_DEFAULT_CHUNK_SIZE;
    stream->file              = NULL;
-   stream->deflate_backend   = NULL;
-   stream->deflate_stream    = NULL;
-   stream->inflate_backend   = NULL;
-   stream->inflate_stream    = NULL;
+   stream->backend           = NULL;
    stream->in_buf            = NULL;
    stream->in_buf_size       = 0;
    stream->in_buf_ptr        = 0;
@@ -213,6 +368,12 @@ static bool rzipstream_init_stream(
    stream->out_buf_size      = 0;
    stream->out_buf_ptr       = 0;
    stream->out_buf_occupancy = 0;
+   stream->out_buf_start     = 0;
+   stream->batch_size        = 1;
+   stream->codec             = rzip_codec;
+
+   for (i = 0; i < RZIP_MAX_BATCH; i++)
+      stream->trans_streams[i] = NULL;
 
    /* Check whether this is a read or write stream */
    stream->is_writing = is_writing;
@@ -248,81 +409,94 @@ static bool rzipstream_init_stream(
    else if (!rzipstream_read_file_header(stream))
       return false;
 
-   /* Initialise appropriate transform stream
-    * and determine associated buffer sizes */
-   if (stream->is_writing)
-   {
-      /* Compression */
-      if (!(stream->deflate_backend = trans_stream_get_zlib_deflate_backend()))
-         return false;
+   /* When reading, don't need a transform stream
+    * (or buffers) if source file is uncompressed */
+   if (!stream->is_compressed)
+      return true;
+
+   /* Initialise appropriate transform streams */
+   if (stream->codec == RZIP_CODEC_ZSTD)
+      stream->backend = stream->is_writing
+         ? trans_stream_get_zstd_compress_backend()
+         : trans_stream_get_zstd_decompress_backend();
+   else
+      stream->backend = stream->is_writing
+         ? trans_stream_get_zlib_deflate_backend()
+         : trans_stream_get_zlib_inflate_backend();
+
+   if (!stream->backend)
+      return false;
 
-      if (!(stream->deflate_stream = stream->deflate_backend->stream_new()))
+#ifdef HAVE_THREADS
+   /* Only worth it if there is data for several
+    * chunks, which is unknown when writing */
+   if (     stream->is_writing
+         || stream->size > stream->chunk_size)
+      stream->batch_size = MIN(cpu_features_get_core_amount(),
+            RZIP_MAX_BATCH);
+   if (stream->batch_size < 1)
+      stream->batch_size = 1;
+#endif
+
+   for (i = 0; i < stream->batch_size; i++)
+   {
+      if (!(stream->trans_streams[i] = stream->backend->stream_new()))
          return false;
 
       /* Set compression level */
-      if (!stream->deflate_backend->define(
-            stream->deflate_stream, "level", RZIP_COMPRESSION_LEVEL))
+      if (     stream->is_writing
+            && !stream->backend->define(stream->trans_streams[i], "level",
+               (stream->codec == RZIP_CODEC_ZSTD)
+               ? RZIP_ZSTD_COMPRESSION_LEVEL
+               : RZIP_COMPRESSION_LEVEL))
          return false;
+   }
 
+   /* Determine buffer sizes */
+   if (stream->is_writing)
+   {
       /* Buffers
        * > Input: uncompressed
        * > Output: compressed */
-      stream->in_buf_size  = stream->chunk_size;
-      stream->out_buf_size = stream->chunk_size * 2;
+      out_chunk_size = stream->chunk_size * 2;
       /* > Account for minimum zlib overhead
        *   of 11 bytes... */ 
-      stream->out_buf_size =
-            (stream->out_buf_size < (stream->in_buf_size + 11)) ?
-                  stream->out_buf_size + 11 :
-                  stream->out_buf_size;
-
-      /* Redundant safety check */
-      if (   (stream->in_buf_size  == 0)
-          || (stream->out_buf_size == 0))
-         return false;
+      out_chunk_size =
+            (out_chunk_size < (stream->chunk_size + 11)) ?
+                  out_chunk_size + 11 :
+                  out_chunk_size;
+
+      stream->in_buf_size  = stream->chunk_size * stream->batch_size;
+      stream->out_buf_size = out_chunk_size     * stream->batch_size;
    }
-   /* When reading, don't need an inflate transform
-    * stream (or buffers) if source file is uncompressed */
-   else if (stream->is_compressed)
+   else
    {
-      /* Decompression */
-      if (!(stream->inflate_backend = trans_stream_get_zlib_inflate_backend()))
-         return false;
-
-      if (!(stream->inflate_stream = stream->inflate_backend->stream_new()))
-         return false;
-
       /* Buffers
        * > Input: compressed
        * > Output: uncompressed
        * Note 1: Actual compressed chunk sizes are read
        *         from the file - just allocate a sensible
        *         default to minimise memory reallocations
-       * Note 2: If file header is valid, output buffer
-       *         should have a size of exactly stream->chunk_size.
-       *         Allocate some additional space, just for
-       *         redundant safety... */
+       * Note 2: If file header is valid, each chunk
+       *         should decompress to exactly stream->chunk_size
+       *         (apart from the last one). Allocate some
+       *         additional space, just for redundant safety... */
       stream->in_buf_size  = stream->chunk_size * 2;
-      stream->out_buf_size = stream->chunk_size + (stream->chunk_size >> 2);
-
-      /* Redundant safety check */
-      if (   (stream->in_buf_size  == 0)
-          || (stream->out_buf_size == 0))
-         return false;
+      stream->out_buf_size = stream->chunk_size * stream->batch_size
+         + (stream->chunk_size >> 2);
    }
 
+   /* Redundant safety check */
+   if (   (stream->in_buf_size  == 0)
+       || (stream->out_buf_size == 0))
+      return false;
+
    /* Allocate buffers */
-   if (stream->in_buf_size > 0)
-   {
-      if (!(stream->in_buf = (uint8_t *)calloc(stream->in_buf_size, 1)))
-         return false;
-   }
+   if (!(stream->in_buf = (uint8_t *)calloc(stream->in_buf_size, 1)))
+      return false;
 
-   if (stream->out_buf_size > 0)
-   {
-      if (!(stream->out_buf = (uint8_t *)calloc(stream->out_buf_size, 1)))
-         return false;
-   }
+   if (!(stream->out_buf = (uint8_t *)calloc(stream->out_buf_size, 1)))
+      return false;
 
    return true;
 }
@@ -331,23 +505,21 @@ static bool rzipstream_init_stream(
  * > Also closes associated file, if currently open */
 static int rzipstream_free_stream(rzipstream_t *stream)
 {
+   unsigned i;
    int ret = 0;
 
    if (!stream)
       return -1;
 
    /* Free transform streams */
-   if (stream->deflate_stream && stream->deflate_backend)
-      stream->deflate_backend->stream_free(stream->deflate_stream);
-
-   stream->deflate_stream  = NULL;
-   stream->deflate_backend = NULL;
-
-   if (stream->inflate_stream && stream->inflate_backend)
-      stream->inflate_backend->stream_free(stream->inflate_stream);
+   for (i = 0; i < RZIP_MAX_BATCH; i++)
+   {
+      if (stream->trans_streams[i] && stream->backend)
+         stream->backend->stream_free(stream->trans_streams[i]);
+      stream->trans_streams[i] = NULL;
+   }
 
-   stream->inflate_stream  = NULL;
-   stream->inflate_backend = NULL;
+   stream->backend = NULL;
 
    /* Free buffers */
    if (stream->in_buf)
@@ -404,11 +576,12 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
    stream->size            = 0;
    stream->chunk_size      = 0;
    stream->virtual_ptr     = 0;
+   stream->out_buf_start   = 0;
    stream->file            = NULL;
-   stream->deflate_backend = NULL;
-   stream->deflate_stream  = NULL;
-   stream->inflate_backend = NULL;
-   stream->inflate_stream  = NULL;
+   stream->backend         = NULL;
+   stream->batch_size      = 0;
+   stream->codec           = RZIP_CODEC_ZLIB;
+   memset(stream->trans_streams, 0, sizeof(stream->trans_streams));
    stream->in_buf          = NULL;
    stream->in_buf_size     = 0;
    stream->in_buf_ptr      = 0;
@@ -431,88 +604,128 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
 
 /* File Read */
 
-/* Reads and decompresses the next chunk of data
- * in the RZIP file */
-static bool rzipstream_read_chunk(rzipstream_t *stream)
+/* Reads the next chunks of data in the RZIP file
+ * (as many as there are threads to decompress them)
+ * and decompresses them into the output buffer */
+static bool rzipstream_read_batch(rzipstream_t *stream)
 {
    unsigned i;
+   unsigned count;
+   uint64_t remaining;
    uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
-   uint32_t compressed_chunk_size;
-   uint32_t inflate_read;
-   uint32_t inflate_written;
+   uint32_t in_offsets[RZIP_MAX_BATCH];
+   uint32_t in_size   = 0;
+   uint32_t out_size  = 0;
+   uint64_t next      = 0;
+   bool has_header    = false;
 
-   if (!stream || !stream->inflate_backend || !stream->inflate_stream)
+   if (!stream || !stream->backend || !stream->trans_streams[0])
       return false;
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
-
-   /* Attempt to read chunk header bytes */
-   if (filestream_read(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
-         RZIP_CHUNK_HEADER_SIZE)
+   /* Get number of chunks left */
+   if ((next = stream->out_buf_start + stream->out_buf_occupancy)
+         >= stream->size)
       return false;
 
-   /* Get size of next compressed chunk */
-   compressed_chunk_size = ((uint32_t)chunk_header_bytes[3] << 24) |
-                           ((uint32_t)chunk_header_bytes[2] << 16) |
-                           ((uint32_t)chunk_header_bytes[1] <<  8) |
-                            (uint32_t)chunk_header_bytes[0];
-   if (compressed_chunk_size == 0)
-      return false;
+   remaining = (stream->size - next + stream->chunk_size - 1)
+      / stream->chunk_size;
+   count     = (remaining < stream->batch_size)
+      ? (unsigned)remaining : stream->batch_size;
 
-   /* Resize input buffer, if required */
-   if (compressed_chunk_size > stream->in_buf_size)
-   {
-      free(stream->in_buf);
-      stream->in_buf      = NULL;
+   /* Attempt to read first chunk header bytes - the
+    * following ones are read along with the chunks */
+   has_header = filestream_read(stream->file,
+         chunk_header_bytes, sizeof(chunk_header_bytes))
+      == RZIP_CHUNK_HEADER_SIZE;
 
-      stream->in_buf_size = compressed_chunk_size;
-      stream->in_buf      = (uint8_t *)calloc(stream->in_buf_size, 1);
-      if (!stream->in_buf)
+   for (i = 0; i < count && has_header; i++)
+   {
+      int64_t read_len;
+      struct retro_vfs_iovec iov[2];
+      uint32_t compressed_chunk_size;
+
+      /* Get size of next compressed chunk */
+      compressed_chunk_size = ((uint32_t)chunk_header_bytes[3] << 24) |
+                              ((uint32_t)chunk_header_bytes[2] << 16) |
+                              ((uint32_t)chunk_header_bytes[1] <<  8) |
+                               (uint32_t)chunk_header_bytes[0];
+      if (     compressed_chunk_size == 0
+            || compressed_chunk_size > UINT32_MAX - in_size)
          return false;
 
-      /* Note: Uncompressed data size is fixed, and read
-       * from the file header - we therefore don't attempt
-       * to resize the output buffer (if it's too small, then
-       * that's an error condition) */
-   }
+      /* Resize input buffer, if required */
+      if (in_size + compressed_chunk_size > stream->in_buf_size)
+      {
+         uint8_t *in_buf      = NULL;
+         uint32_t in_buf_size = in_size + compressed_chunk_size;
 
-   /* Read compressed chunk from file */
-   if (filestream_read(
-         stream->file, stream->in_buf, compressed_chunk_size) !=
-         compressed_chunk_size)
-      return false;
+         if (in_buf_size < stream->in_buf_size * 2)
+            in_buf_size = stream->in_buf_size * 2;
 
-   /* Decompress chunk data */
-   stream->inflate_backend->set_in(
-         stream->inflate_stream,
-         stream->in_buf, compressed_chunk_size);
+         if (!(in_buf = (uint8_t *)realloc(stream->in_buf, in_buf_size)))
+            return false;
 
-   stream->inflate_backend->set_out(
-         stream->inflate_stream,
-         stream->out_buf, stream->out_buf_size);
+         stream->in_buf      = in_buf;
+         stream->in_buf_size = in_buf_size;
 
-   /* Note: We have to set 'flush == true' here, otherwise we
-    * can't guarantee that the entire chunk will be written
-    * to the output buffer - this is inefficient, but not
-    * much we can do... */
-   if (!stream->inflate_backend->trans(
-         stream->inflate_stream, true,
-         &inflate_read, &inflate_written, NULL))
-      return false;
+         /* Note: Uncompressed data size is fixed, and read
+          * from the file header - we therefore don't attempt
+          * to resize the output buffer (if it's too small, then
+          * that's an error condition) */
+      }
+
+      /* Read compressed chunk from file, and the header
+       * of the next one in the batch with the same read */
+      iov[0].data = stream->in_buf + in_size;
+      iov[0].len  = compressed_chunk_size;
+      iov[1].data = chunk_header_bytes;
+      iov[1].len  = sizeof(chunk_header_bytes);
+
+      if ((read_len = filestream_readv(stream->file, iov,
+                  (i + 1 < count) ? 2 : 1)) < (int64_t)compressed_chunk_size)
+         break;
 
-   /* Error checking */
-   if (inflate_read != compressed_chunk_size)
+      has_header = read_len ==
+         (int64_t)compressed_chunk_size + RZIP_CHUNK_HEADER_SIZE;
+
+      in_offsets[i]            = in_size;
+      stream->chunks[i].in_size = compressed_chunk_size;
+      in_size                 += compressed_chunk_size;
+   }
+
+   /* A truncated file is an error only once
+    * the missing data is needed */
+   if (!(count = i))
       return false;
 
-   if ((inflate_written == 0) ||
-       (inflate_written > stream->out_buf_size))
+   /* Each chunk is decompressed at its place in
+    * the output buffer, the last one may use the
+    * safety margin */
+   for (i = 0; i < count; i++)
+   {
+      stream->chunks[i].in       = stream->in_buf  + in_offsets[i];
+      stream->chunks[i].out      = stream->out_buf + i * stream->chunk_size;
+      stream->chunks[i].out_size = (i == count - 1)
+         ? stream->out_buf_size - i * stream->chunk_size
+         : stream->chunk_size;
+   }
+
+   if (!rzipstream_process_batch(stream, count))
       return false;
 
+   /* Close the gaps left by short chunks, if any */
+   for (i = 0; i < count; i++)
+   {
+      if (stream->chunks[i].out != stream->out_buf + out_size)
+         memmove(stream->out_buf + out_size,
+               stream->chunks[i].out, stream->chunks[i].out_size);
+      out_size += stream->chunks[i].out_size;
+   }
+
    /* Record current output buffer occupancy
     * and reset pointer */
-   stream->out_buf_occupancy = inflate_written;
+   stream->out_buf_start     = next;
+   stream->out_buf_occupancy = out_size;
    stream->out_buf_ptr       = 0;
 
    return true;
@@ -549,7 +762,7 @@ int64_t rzipstream_read(rzipstream_t *stream, void *data, int64_t len)
        * been read, grab and extract the next chunk
        * from disk */
       if (stream->out_buf_ptr >= stream->out_buf_occupancy)
-         if (!rzipstream_read_chunk(stream))
+         if (!rzipstream_read_batch(stream))
             return -1;
 
       /* Get amount of data to 'read out' this loop
@@ -717,61 +930,56 @@ error:
 /* File Write */
 
 /* Compresses currently cached data and writes it
- * as the next RZIP file chunk */
-static bool rzipstream_write_chunk(rzipstream_t *stream)
+ * as the next RZIP file chunks */
+static bool rzipstream_write_batch(rzipstream_t *stream)
 {
    unsigned i;
+   unsigned count;
+   uint32_t out_chunk_size;
    uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
-   uint32_t deflate_read;
-   uint32_t deflate_written;
 
-   if (!stream || !stream->deflate_backend || !stream->deflate_stream)
+   if (!stream || !stream->backend || !stream->trans_streams[0])
       return false;
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
-
-   /* Compress data currently held in input buffer */
-   stream->deflate_backend->set_in(
-         stream->deflate_stream,
-         stream->in_buf, stream->in_buf_ptr);
-
-   stream->deflate_backend->set_out(
-         stream->deflate_stream,
-         stream->out_buf, stream->out_buf_size);
+   count          = (stream->in_buf_ptr + stream->chunk_size - 1)
+      / stream->chunk_size;
+   out_chunk_size = stream->out_buf_size / stream->batch_size;
 
-   /* Note: We have to set 'flush == true' here, otherwise we
-    * can't guarantee that the entire chunk will be written
-    * to the output buffer - this is inefficient, but not
-    * much we can do... */
-   if (!stream->deflate_backend->trans(
-         stream->deflate_stream, true,
-         &deflate_read, &deflate_written, NULL))
-      return false;
+   for (i = 0; i < count; i++)
+   {
+      uint32_t offset            = i * stream->chunk_size;
+      stream->chunks[i].in       = stream->in_buf  + offset;
+      stream->chunks[i].in_size  = MIN(stream->chunk_size,
+            stream->in_buf_ptr - offset);
+      stream->chunks[i].out      = stream->out_buf + i * out_chunk_size;
+      stream->chunks[i].out_size = out_chunk_size;
+   }
 
-   /* Error checking */
-   if (deflate_read != stream->in_buf_ptr)
+   /* Compress data currently held in input buffer */
+   if (!rzipstream_process_batch(stream, count))
       return false;
 
-   if ((deflate_written == 0) ||
-       (deflate_written > stream->out_buf_size))
-      return false;
+   for (i = 0; i < count; i++)
+   {
+      uint32_t deflate_written = stream->chunks[i].out_size;
 
-   /* Write compressed chunk size to file */
-   chunk_header_bytes[3] = (deflate_written >> 24) & 0xFF;
-   chunk_header_bytes[2] = (deflate_written >> 16) & 0xFF;
-   chunk_header_bytes[1] = (deflate_written >>  8) & 0xFF;
-   chunk_header_bytes[0] =  deflate_written        & 0xFF;
+      /* Write compressed chunk size to file */
+      chunk_header_bytes[3] = (deflate_written >> 24) & 0xFF;
+      chunk_header_bytes[2] = (deflate_written >> 16) & 0xFF;
+      chunk_header_bytes[1] = (deflate_written >>  8) & 0xFF;
+      chunk_header_bytes[0] =  deflate_written        & 0xFF;
 
-   if (filestream_write(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
-         RZIP_CHUNK_HEADER_SIZE)
-      return false;
+      if (filestream_write(
+            stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
+            RZIP_CHUNK_HEADER_SIZE)
+         return false;
 
-   /* Write compressed data to file */
-   if (filestream_write(
-         stream->file, stream->out_buf, deflate_written) != deflate_written)
-      return false;
+      /* Write compressed data to file */
+      if (filestream_write(
+            stream->file, stream->chunks[i].out, deflate_written) !=
+            deflate_written)
+         return false;
+   }
 
    /* Reset input buffer pointer */
    stream->in_buf_ptr = 0;
@@ -797,7 +1005,7 @@ int64_t rzipstream_write(rzipstream_t *stream, const void *data, int64_t len)
 
       /* If input buffer is full, compress and write to disk */
       if (stream->in_buf_ptr >= stream->in_buf_size)
-         if (!rzipstream_write_chunk(stream))
+         if (!rzipstream_write_batch(stream))
             return -1;
 
       /* Get amount of data to cache during this loop
@@ -820,7 +1028,7 @@ int64_t rzipstream_write(rzipstream_t *stream, const void *data, int64_t len)
    }
 
    /* We always write the specified number of bytes
-    * (unless rzipstream_write_chunk() fails, in
+    * (unless rzipstream_write_batch() fails, in
     * which we register a complete failure...) */
    return len;
 }
@@ -956,8 +1164,8 @@ void rzipstream_rewind(rzipstream_t *stream)
    {
       /* Check whether first file chunk is currently
        * buffered in memory */
-      if ((stream->virtual_ptr < stream->chunk_size) &&
-          (stream->out_buf_ptr < stream->out_buf_occupancy))
+      if ((stream->out_buf_start == 0) &&
+          (stream->out_buf_occupancy > 0))
       {
          /* It is: No file access is therefore required
           * > Just reset pointers */
@@ -966,7 +1174,7 @@ void rzipstream_rewind(rzipstream_t *stream)
       }
       else
       {
-         /* It isn't: Have to re-read the first chunk
+         /* It isn't: Have to re-read the first chunks
           * from disk... */
 
          /* Reset file position to first chunk location */
@@ -974,8 +1182,11 @@ void rzipstream_rewind(rzipstream_t *stream)
          if (filestream_error(stream->file))
             return;
 
-         /* Read chunk */
-         if (!rzipstream_read_chunk(stream))
+         stream->out_buf_start     = 0;
+         stream->out_buf_occupancy = 0;
+
+         /* Read chunks */
+         if (!rzipstream_read_batch(stream))
             return;
 
          /* Reset pointers */
@@ -1051,7 +1262,7 @@ int rzipstream_close(rzipstream_t *stream)
    if (stream->is_writing)
    {
       if (stream->in_buf_ptr > 0)
-         if (!rzipstream_write_chunk(stream))
+         if (!rzipstream_write_batch(stream))
             goto error;
 
       if (!rzipstream_write_file_header(stream))
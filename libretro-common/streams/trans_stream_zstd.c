@@ -0,0 +1,210 @@
+/* Copyright  (C) 2010-2023 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (trans_stream_zstd.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zstd.h>
+#include <string/stdstring.h>
+#include <streams/trans_stream.h>
+
+struct zstd_trans_stream
+{
+   ZSTD_CCtx *cctx;
+   ZSTD_DCtx *dctx;
+   ZSTD_inBuffer in;
+   ZSTD_outBuffer out;
+   int level;
+};
+
+static void *zstd_compress_stream_new(void)
+{
+   struct zstd_trans_stream *ret = (struct zstd_trans_stream*)
+      calloc(1, sizeof(*ret));
+   if (!ret)
+      return NULL;
+   if (!(ret->cctx = ZSTD_createCCtx()))
+   {
+      free(ret);
+      return NULL;
+   }
+   ret->level = ZSTD_CLEVEL_DEFAULT;
+   return (void *)ret;
+}
+
+static void *zstd_decompress_stream_new(void)
+{
+   struct zstd_trans_stream *ret = (struct zstd_trans_stream*)
+      calloc(1, sizeof(*ret));
+   if (!ret)
+      return NULL;
+   if (!(ret->dctx = ZSTD_createDCtx()))
+   {
+      free(ret);
+      return NULL;
+   }
+   return (void *)ret;
+}
+
+static void zstd_stream_free(void *data)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   if (!z)
+      return;
+   if (z->cctx)
+      ZSTD_freeCCtx(z->cctx);
+   if (z->dctx)
+      ZSTD_freeDCtx(z->dctx);
+   free(z);
+}
+
+static bool zstd_compress_define(void *data, const char *prop, uint32_t val)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   if (string_is_equal(prop, "level"))
+   {
+      if (z)
+      {
+         z->level = (int) val;
+         ZSTD_CCtx_setParameter(z->cctx, ZSTD_c_compressionLevel, z->level);
+      }
+      return true;
+   }
+   return false;
+}
+
+static bool zstd_decompress_define(void *data, const char *prop, uint32_t val)
+{
+   return false;
+}
+
+static void zstd_set_in(void *data, const uint8_t *in, uint32_t in_size)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+
+   if (!z)
+      return;
+
+   z->in.src  = in;
+   z->in.size = in_size;
+   z->in.pos  = 0;
+}
+
+static void zstd_set_out(void *data, uint8_t *out, uint32_t out_size)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+
+   if (!z)
+      return;
+
+   z->out.dst  = out;
+   z->out.size = out_size;
+   z->out.pos  = 0;
+}
+
+/* A frame is complete once 'remaining' reaches zero; if
+ * it does not and the output buffer is full, the buffer
+ * was too small */
+static bool zstd_trans_result(struct zstd_trans_stream *z,
+      size_t remaining, size_t pre_in, size_t pre_out,
+      uint32_t *rd, uint32_t *wn,
+      enum trans_stream_error *error)
+{
+   bool ret = true;
+
+   if (ZSTD_isError(remaining))
+   {
+      if (error)
+         *error = TRANS_STREAM_ERROR_OTHER;
+      return false;
+   }
+
+   if (error)
+      *error = remaining ? TRANS_STREAM_ERROR_AGAIN : TRANS_STREAM_ERROR_NONE;
+
+   if (remaining && z->out.pos == z->out.size)
+   {
+      ret = false;
+      if (error)
+         *error = TRANS_STREAM_ERROR_BUFFER_FULL;
+   }
+
+   *rd = (uint32_t)(z->in.pos  - pre_in);
+   *wn = (uint32_t)(z->out.pos - pre_out);
+
+   return ret;
+}
+
+static bool zstd_compress_trans(
+   void *data, bool flush,
+   uint32_t *rd, uint32_t *wn,
+   enum trans_stream_error *error)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   size_t pre_in               = z->in.pos;
+   size_t pre_out              = z->out.pos;
+   size_t remaining            = ZSTD_compressStream2(z->cctx,
+         &z->out, &z->in, flush ? ZSTD_e_end : ZSTD_e_continue);
+
+   /* Without a flush, there is nothing left to do
+    * once all the input has been taken */
+   if (!flush && !ZSTD_isError(remaining) && z->in.pos == z->in.size)
+      remaining = 0;
+
+   return zstd_trans_result(z, remaining, pre_in, pre_out, rd, wn, error);
+}
+
+static bool zstd_decompress_trans(
+   void *data, bool flush,
+   uint32_t *rd, uint32_t *wn,
+   enum trans_stream_error *error)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   size_t pre_in               = z->in.pos;
+   size_t pre_out              = z->out.pos;
+   size_t remaining            = ZSTD_decompressStream(z->dctx,
+         &z->out, &z->in);
+
+   return zstd_trans_result(z, remaining, pre_in, pre_out, rd, wn, error);
+}
+
+const struct trans_stream_backend zstd_compress_backend = {
+   "zstd_compress",
+   &zstd_decompress_backend,
+   zstd_compress_stream_new,
+   zstd_stream_free,
+   zstd_compress_define,
+   zstd_set_in,
+   zstd_set_out,
+   zstd_compress_trans
+};
+
+const struct trans_stream_backend zstd_decompress_backend = {
+   "zstd_decompress",
+   &zstd_compress_backend,
+   zstd_decompress_stream_new,
+   zstd_stream_free,
+   zstd_decompress_define,
+   zstd_set_in,
+   zstd_set_out,
+   zstd_decompress_trans
+};
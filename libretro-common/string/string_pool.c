@@ -0,0 +1,200 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (string_pool.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string/string_pool.h>
+
+#define STRING_POOL_BLOCK_MIN   1024
+#define STRING_POOL_BLOCK_MAX   65536
+#define STRING_POOL_SLOTS_MIN   64
+
+struct string_pool_block
+{
+   struct string_pool_block *next;
+   char *data;
+   size_t size;
+   size_t used;
+};
+
+struct string_pool_slot
+{
+   char *str;
+   uint32_t hash;
+};
+
+struct string_pool
+{
+   struct string_pool_block *blocks;   /* Most recent first */
+   struct string_pool_slot *slots;     /* Open addressing */
+   size_t num_slots;                   /* Power of two */
+   size_t num_strings;
+};
+
+static uint32_t string_pool_hash(const char *str)
+{
+   uint32_t hash = 5381;
+   while (*str)
+      hash = (hash << 5) + hash + (unsigned char)*str++;
+   return hash;
+}
+
+static bool string_pool_grow(string_pool_t *pool)
+{
+   size_t i;
+   size_t num_slots                = pool->num_slots
+      ? pool->num_slots * 2 : STRING_POOL_SLOTS_MIN;
+   struct string_pool_slot *slots  = (struct string_pool_slot*)
+      calloc(num_slots, sizeof(*slots));
+
+   if (!slots)
+      return false;
+
+   for (i = 0; i < pool->num_slots; i++)
+   {
+      size_t j;
+      if (!pool->slots[i].str)
+         continue;
+      j = pool->slots[i].hash & (num_slots - 1);
+      while (slots[j].str)
+         j = (j + 1) & (num_slots - 1);
+      slots[j] = pool->slots[i];
+   }
+
+   free(pool->slots);
+   pool->slots     = slots;
+   pool->num_slots = num_slots;
+   return true;
+}
+
+static char *string_pool_alloc(string_pool_t *pool, size_t len)
+{
+   char *str                       = NULL;
+   struct string_pool_block *block = pool->blocks;
+
+   if (!block || block->size - block->used < len)
+   {
+      /* Blocks grow with the pool, so that there are
+       * few of them to search in string_pool_contains() */
+      size_t size = block ? block->size * 2 : STRING_POOL_BLOCK_MIN;
+      if (size > STRING_POOL_BLOCK_MAX)
+         size     = STRING_POOL_BLOCK_MAX;
+      if (size < len)
+         size     = len;
+
+      if (!(block = (struct string_pool_block*)malloc(sizeof(*block))))
+         return NULL;
+      if (!(block->data = (char*)malloc(size)))
+      {
+         free(block);
+         return NULL;
+      }
+
+      block->size  = size;
+      block->used  = 0;
+      block->next  = pool->blocks;
+      pool->blocks = block;
+   }
+
+   str          = block->data + block->used;
+   block->used += len;
+   return str;
+}
+
+string_pool_t *string_pool_new(void)
+{
+   return (string_pool_t*)calloc(1, sizeof(string_pool_t));
+}
+
+void string_pool_free(string_pool_t *pool)
+{
+   struct string_pool_block *block = NULL;
+
+   if (!pool)
+      return;
+
+   block = pool->blocks;
+   while (block)
+   {
+      struct string_pool_block *next = block->next;
+      free(block->data);
+      free(block);
+      block = next;
+   }
+
+   free(pool->slots);
+   free(pool);
+}
+
+char *string_pool_intern(string_pool_t *pool, const char *str)
+{
+   size_t i, len;
+   uint32_t hash;
+   char *copy = NULL;
+
+   if (!pool || !str)
+      return NULL;
+
+   /* Keep the load factor at or below one half */
+   if (     (pool->num_strings + 1) * 2 > pool->num_slots
+         && !string_pool_grow(pool))
+      return NULL;
+
+   hash = string_pool_hash(str);
+   i    = hash & (pool->num_slots - 1);
+
+   while (pool->slots[i].str)
+   {
+      if (     pool->slots[i].hash == hash
+            && !strcmp(pool->slots[i].str, str))
+         return pool->slots[i].str;
+      i = (i + 1) & (pool->num_slots - 1);
+   }
+
+   len = strlen(str) + 1;
+   if (!(copy = string_pool_alloc(pool, len)))
+      return NULL;
+   memcpy(copy, str, len);
+
+   pool->slots[i].str  = copy;
+   pool->slots[i].hash = hash;
+   pool->num_strings++;
+   return copy;
+}
+
+bool string_pool_contains(const string_pool_t *pool, const char *str)
+{
+   const struct string_pool_block *block = NULL;
+
+   if (!pool || !str)
+      return false;
+
+   for (block = pool->blocks; block; block = block->next)
+      if (     (uintptr_t)str >= (uintptr_t)block->data
+            && (uintptr_t)str <  (uintptr_t)block->data + block->used)
+         return true;
+
+   return false;
+}
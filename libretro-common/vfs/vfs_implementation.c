@@ -221,6 +221,269 @@
 
 #define RFILE_HINT_UNBUFFERED (1 << 8)
 
+#if (defined(__linux__) && !defined(ANDROID)) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#include <sys/uio.h>
+#define HAVE_VFS_PREADV
+/* Buffers handed to the OS per vectored read */
+#define VFS_READV_MAX_IOV 64
+#endif
+
+/* Handles may be closed from several threads; the totals
+ * are only approximate where 64-bit atomics are not free */
+#if defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && __GCC_ATOMIC_LLONG_LOCK_FREE == 2
+#define VFS_STATS_ADD(var, val)   __atomic_fetch_add(&(var), (val), __ATOMIC_RELAXED)
+#define VFS_STATS_LOAD(var)       __atomic_load_n(&(var), __ATOMIC_RELAXED)
+#define VFS_STATS_STORE(var, val) __atomic_store_n(&(var), (val), __ATOMIC_RELAXED)
+#else
+#define VFS_STATS_ADD(var, val)   ((var) += (val))
+#define VFS_STATS_LOAD(var)       (var)
+#define VFS_STATS_STORE(var, val) ((var) = (val))
+#endif
+
+static size_t vfs_read_cache_size = VFS_READ_CACHE_DEFAULT_SIZE;
+static struct retro_vfs_file_stats vfs_read_stats;
+
+static int64_t retro_vfs_file_seek_fp(FILE *fp, int64_t offset, int whence)
+{
+#ifdef ATLEAST_VC2005
+   /* VC2005 and up have a special 64-bit fseek */
+   return _fseeki64(fp, offset, whence);
+#elif defined(HAVE_64BIT_OFFSETS)
+   return fseeko(fp, (off_t)offset, whence);
+#else
+   return fseek(fp, (long)offset, whence);
+#endif
+}
+
+/* Seeking a cached file only moves the logical position,
+ * the file itself is positioned by the next read that
+ * cannot be served from the cache */
+static int64_t retro_vfs_file_seek_cached(
+      libretro_vfs_implementation_file *stream,
+      int64_t offset, int whence)
+{
+   int64_t pos;
+
+   switch (whence)
+   {
+      case SEEK_SET:
+         pos = offset;
+         break;
+      case SEEK_CUR:
+         pos = (int64_t)stream->pos + offset;
+         break;
+      case SEEK_END:
+         pos = stream->size + offset;
+         break;
+      default:
+         return -1;
+   }
+
+   if (pos < 0)
+      return -1;
+
+   stream->pos = (uint64_t)pos;
+   return 0;
+}
+
+static int64_t retro_vfs_file_read_cached(
+      libretro_vfs_implementation_file *stream,
+      uint8_t *s, uint64_t len)
+{
+   uint64_t done = 0;
+
+   while (done < len)
+   {
+      size_t got;
+
+      if (     stream->pos >= stream->cache_offset
+            && stream->pos <  stream->cache_offset + stream->cache_len)
+      {
+         size_t   ofs   = (size_t)(stream->pos - stream->cache_offset);
+         uint64_t avail = stream->cache_len - ofs;
+
+         if (avail > len - done)
+            avail = len - done;
+
+         memcpy(s + done, stream->cache + ofs, (size_t)avail);
+         done        += avail;
+         stream->pos += avail;
+         continue;
+      }
+
+      if (stream->fp_pos != stream->pos)
+      {
+         if (retro_vfs_file_seek_fp(stream->fp,
+                  (int64_t)stream->pos, SEEK_SET) != 0)
+            return done ? (int64_t)done : -1;
+         stream->fp_pos = stream->pos;
+      }
+
+      stream->stats.syscalls++;
+
+      /* Reads at least as large as the cache go straight
+       * to the destination */
+      if (len - done >= stream->cache_size)
+      {
+         got             = fread(s + done, 1, (size_t)(len - done),
+               stream->fp);
+         stream->fp_pos += got;
+         stream->pos    += got;
+         done           += got;
+         break;
+      }
+
+      got                  = fread(stream->cache, 1,
+            stream->cache_size, stream->fp);
+      stream->cache_offset = stream->pos;
+      stream->cache_len    = got;
+      stream->fp_pos      += got;
+
+      if (!got)
+         break;
+   }
+
+   if (!done && ferror(stream->fp))
+      return -1;
+
+   return (int64_t)done;
+}
+
+static int64_t retro_vfs_file_readv_cached(
+      libretro_vfs_implementation_file *stream,
+      const struct retro_vfs_iovec *iov, unsigned count)
+{
+   unsigned i;
+   int64_t ret;
+   uint64_t total = 0;
+   uint64_t len   = 0;
+
+   for (i = 0; i < count; i++)
+      len += iov[i].len;
+
+#ifdef HAVE_VFS_PREADV
+   /* Batches larger than the cache are read with as few
+    * system calls as possible, after taking what the
+    * cache already holds */
+   if (len >= stream->cache_size)
+   {
+      uint64_t skip = 0;
+      i             = 0;
+
+      while (     i < count
+            &&    stream->pos >= stream->cache_offset
+            &&    stream->pos <  stream->cache_offset + stream->cache_len)
+      {
+         size_t   ofs   = (size_t)(stream->pos - stream->cache_offset);
+         uint64_t avail = stream->cache_len - ofs;
+
+         if (avail > iov[i].len - skip)
+            avail = iov[i].len - skip;
+
+         memcpy((uint8_t*)iov[i].data + skip,
+               stream->cache + ofs, (size_t)avail);
+         total       += avail;
+         stream->pos += avail;
+         if ((skip += avail) == iov[i].len)
+         {
+            skip = 0;
+            i++;
+         }
+      }
+
+      while (i < count)
+      {
+         struct iovec vec[VFS_READV_MAX_IOV];
+         ssize_t got;
+         unsigned j;
+         unsigned vec_count = 0;
+
+         for (j = i; j < count && vec_count < VFS_READV_MAX_IOV; j++)
+         {
+            vec[vec_count].iov_base = (uint8_t*)iov[j].data
+               + (j == i ? skip : 0);
+            vec[vec_count].iov_len  = (size_t)(iov[j].len
+               - (j == i ? skip : 0));
+            vec_count++;
+         }
+
+         stream->stats.syscalls++;
+
+         /* preadv leaves the file position alone, so the
+          * stdio stream stays where fp_pos says it is */
+         if ((got = preadv(fileno(stream->fp), vec, (int)vec_count,
+                     (off_t)stream->pos)) < 0)
+         {
+            if (errno == EINTR)
+               continue;
+            return total ? (int64_t)total : -1;
+         }
+
+         if (!got)
+            break;
+
+         total       += (uint64_t)got;
+         stream->pos += (uint64_t)got;
+
+         while (got > 0)
+         {
+            uint64_t left = iov[i].len - skip;
+            if ((uint64_t)got < left)
+            {
+               skip += (uint64_t)got;
+               break;
+            }
+            got -= (ssize_t)left;
+            skip  = 0;
+            i++;
+         }
+      }
+
+      return (int64_t)total;
+   }
+#endif
+
+   for (i = 0; i < count; i++)
+   {
+      if ((ret = retro_vfs_file_read_cached(stream,
+                  (uint8_t*)iov[i].data, iov[i].len)) < 0)
+         return total ? (int64_t)total : -1;
+      total += (uint64_t)ret;
+      if ((uint64_t)ret < iov[i].len)
+         break;
+   }
+
+   return (int64_t)total;
+}
+
+void retro_vfs_file_set_read_cache_size(size_t size)
+{
+   vfs_read_cache_size = size;
+}
+
+void retro_vfs_file_get_stats_impl(libretro_vfs_implementation_file *stream,
+      struct retro_vfs_file_stats *stats)
+{
+   if (stream)
+      *stats = stream->stats;
+   else
+      memset(stats, 0, sizeof(*stats));
+}
+
+void retro_vfs_get_read_stats(struct retro_vfs_file_stats *stats)
+{
+   stats->reads    = VFS_STATS_LOAD(vfs_read_stats.reads);
+   stats->syscalls = VFS_STATS_LOAD(vfs_read_stats.syscalls);
+   stats->bytes    = VFS_STATS_LOAD(vfs_read_stats.bytes);
+}
+
+void retro_vfs_reset_read_stats(void)
+{
+   VFS_STATS_STORE(vfs_read_stats.reads,    0);
+   VFS_STATS_STORE(vfs_read_stats.syscalls, 0);
+   VFS_STATS_STORE(vfs_read_stats.bytes,    0);
+}
+
 int64_t retro_vfs_file_seek_internal(
       libretro_vfs_implementation_file *stream,
       int64_t offset, int whence)
@@ -234,14 +497,9 @@ int64_t retro_vfs_file_seek_internal(
       if (stream->scheme == VFS_SCHEME_CDROM)
          return retro_vfs_file_seek_cdrom(stream, offset, whence);
 #endif
-#ifdef ATLEAST_VC2005
-      /* VC2005 and up have a special 64-bit fseek */
-      return _fseeki64(stream->fp, offset, whence);
-#elif defined(HAVE_64BIT_OFFSETS)
-      return fseeko(stream->fp, (off_t)offset, whence);
-#else
-      return fseek(stream->fp, (long)offset, whence);
-#endif
+      if (stream->cache)
+         return retro_vfs_file_seek_cached(stream, offset, whence);
+      return retro_vfs_file_seek_fp(stream->fp, offset, whence);
    }
 #ifdef HAVE_MMAP
    /* Need to check stream->mapped because this function is
@@ -300,6 +558,8 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
       const char *path, unsigned mode, unsigned hints)
 {
    int                                flags = 0;
+   size_t                        cache_size = 0;
+   uint8_t                           *cache = NULL;
    const char                     *mode_str = NULL;
    libretro_vfs_implementation_file *stream =
       (libretro_vfs_implementation_file*)
@@ -320,7 +580,14 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
    stream->mappos                 = 0;
    stream->mapsize                = 0;
    stream->mapped                 = NULL;
+   stream->cache                  = NULL;
+   stream->cache_offset           = 0;
+   stream->pos                    = 0;
+   stream->fp_pos                 = 0;
+   stream->cache_len              = 0;
+   stream->cache_size             = 0;
    stream->scheme                 = VFS_SCHEME_NONE;
+   memset(&stream->stats, 0, sizeof(stream->stats));
 
 #ifdef VFS_FRONTEND
    if (     path
@@ -446,6 +713,13 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
             goto error;
 
          stream->fp  = fp;
+
+         /* Reads are served from our own cache, a stdio
+          * buffer on top of it would only add a copy */
+         if (     mode == RETRO_VFS_FILE_ACCESS_READ
+               && (cache_size = vfs_read_cache_size) > 0
+               && (cache = (uint8_t*)malloc(cache_size)))
+            setvbuf(fp, NULL, _IONBF, 0);
       }
 
       /* Regarding setvbuf:
@@ -462,14 +736,14 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
       /* TODO: this is only useful for a few platforms,
        * find which and add ifdef */
 #if defined(_3DS)
-      if (stream->scheme != VFS_SCHEME_CDROM)
+      if (stream->scheme != VFS_SCHEME_CDROM && !cache)
       {
          stream->buf = (char*)calloc(1, 0x10000);
          if (stream->fp)
             setvbuf(stream->fp, stream->buf, _IOFBF, 0x10000);
       }
 #elif defined(WIIU)
-      if (stream->scheme != VFS_SCHEME_CDROM)
+      if (stream->scheme != VFS_SCHEME_CDROM && !cache)
       {
          const int bufsize = 128 * 1024;
          stream->buf = (char*)memalign(0x40, bufsize);
@@ -540,9 +814,13 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
 
       retro_vfs_file_seek_internal(stream, 0, SEEK_SET);
    }
+
+   stream->cache      = cache;
+   stream->cache_size = cache_size;
    return stream;
 
 error:
+   free(cache);
    retro_vfs_file_close_impl(stream);
    return NULL;
 }
@@ -582,6 +860,15 @@ end:
 #endif
    if (stream->buf)
       free(stream->buf);
+   if (stream->cache)
+      free(stream->cache);
+
+   if (stream->hints & RFILE_HINT_READ_STATS)
+   {
+      VFS_STATS_ADD(vfs_read_stats.reads,    stream->stats.reads);
+      VFS_STATS_ADD(vfs_read_stats.syscalls, stream->stats.syscalls);
+      VFS_STATS_ADD(vfs_read_stats.bytes,    stream->stats.bytes);
+   }
 
    if (stream->orig_path)
       free(stream->orig_path);
@@ -636,6 +923,8 @@ int64_t retro_vfs_file_tell_impl(libretro_vfs_implementation_file *stream)
       if (stream->scheme == VFS_SCHEME_CDROM)
          return retro_vfs_file_tell_cdrom(stream);
 #endif
+      if (stream->cache)
+         return (int64_t)stream->pos;
 #ifdef ATLEAST_VC2005
       /* VC2005 and up have a special 64-bit ftell */
       return _ftelli64(stream->fp);
@@ -667,16 +956,30 @@ int64_t retro_vfs_file_seek_impl(libretro_vfs_implementation_file *stream,
 int64_t retro_vfs_file_read_impl(libretro_vfs_implementation_file *stream,
       void *s, uint64_t len)
 {
+   int64_t ret;
+
    if (!stream || !s)
       return -1;
 
+   stream->stats.reads++;
+
    if ((stream->hints & RFILE_HINT_UNBUFFERED) == 0)
    {
 #ifdef HAVE_CDROM
       if (stream->scheme == VFS_SCHEME_CDROM)
          return retro_vfs_file_read_cdrom(stream, s, len);
 #endif
-      return fread(s, 1, (size_t)len, stream->fp);
+      if (stream->cache)
+         ret = retro_vfs_file_read_cached(stream, (uint8_t*)s, len);
+      else
+      {
+         stream->stats.syscalls++;
+         ret = fread(s, 1, (size_t)len, stream->fp);
+      }
+
+      if (ret > 0)
+         stream->stats.bytes += ret;
+      return ret;
    }
 #ifdef HAVE_MMAP
    if (stream->hints & RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS)
@@ -688,13 +991,48 @@ int64_t retro_vfs_file_read_impl(libretro_vfs_implementation_file *stream,
          len = stream->mapsize - stream->mappos;
 
       memcpy(s, &stream->mapped[stream->mappos], len);
-      stream->mappos += len;
+      stream->mappos      += len;
+      stream->stats.bytes += len;
 
       return len;
    }
 #endif
 
-   return read(stream->fd, s, (size_t)len);
+   stream->stats.syscalls++;
+   if ((ret = read(stream->fd, s, (size_t)len)) > 0)
+      stream->stats.bytes += ret;
+   return ret;
+}
+
+int64_t retro_vfs_file_readv_impl(libretro_vfs_implementation_file *stream,
+      const struct retro_vfs_iovec *iov, unsigned count)
+{
+   unsigned i;
+   int64_t ret;
+   uint64_t total = 0;
+
+   if (!stream || (!iov && count))
+      return -1;
+
+   if (stream->cache)
+   {
+      stream->stats.reads++;
+      if ((ret = retro_vfs_file_readv_cached(stream, iov, count)) > 0)
+         stream->stats.bytes += ret;
+      return ret;
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      if ((ret = retro_vfs_file_read_impl(stream,
+                  iov[i].data, iov[i].len)) < 0)
+         return total ? (int64_t)total : -1;
+      total += (uint64_t)ret;
+      if ((uint64_t)ret < iov[i].len)
+         break;
+   }
+
+   return (int64_t)total;
 }
 
 int64_t retro_vfs_file_write_impl(libretro_vfs_implementation_file *stream, const void *s, uint64_t len)
@@ -736,6 +1074,30 @@ int retro_vfs_file_flush_impl(libretro_vfs_implementation_file *stream)
    return -1;
 }
 
+int retro_vfs_file_sync_impl(libretro_vfs_implementation_file *stream)
+{
+   if (!stream)
+      return -1;
+   if ((stream->hints & RFILE_HINT_UNBUFFERED) == 0)
+   {
+      if (fflush(stream->fp) != 0)
+         return -1;
+#if defined(_WIN32) && !defined(_XBOX)
+      if (_commit(_fileno(stream->fp)) != 0)
+         return -1;
+#elif !defined(VITA) && !defined(PSP) && !defined(PS2) && !defined(ORBIS) && (!defined(SWITCH) || defined(HAVE_LIBNX))
+      if (fsync(fileno(stream->fp)) != 0)
+         return -1;
+#endif
+      return 0;
+   }
+#if !defined(_WIN32) && !defined(VITA) && !defined(PSP) && !defined(PS2) && !defined(ORBIS) && (!defined(SWITCH) || defined(HAVE_LIBNX))
+   if (fsync(stream->fd) != 0)
+      return -1;
+#endif
+   return 0;
+}
+
 int retro_vfs_file_remove_impl(const char *path)
 {
    if (path && *path)
@@ -187,6 +187,42 @@ int64_t retro_vfs_file_read_impl(libretro_vfs_implementation_file* stream,
 }
 
 
+/* No read cache here: reads go to the OS one by one */
+int64_t retro_vfs_file_readv_impl(libretro_vfs_implementation_file* stream,
+    const struct retro_vfs_iovec* iov, unsigned count)
+{
+    unsigned i;
+    int64_t total = 0;
+
+    if (!stream || (!iov && count))
+        return -1;
+
+    for (i = 0; i < count; i++)
+    {
+        int64_t ret = retro_vfs_file_read_impl(stream, iov[i].data, iov[i].len);
+        if (ret < 0)
+            return total ? total : -1;
+        total += ret;
+        if ((uint64_t)ret < iov[i].len)
+            break;
+    }
+
+    return total;
+}
+
+void retro_vfs_file_set_read_cache_size(size_t size) { }
+
+void retro_vfs_file_get_stats_impl(libretro_vfs_implementation_file* stream,
+    struct retro_vfs_file_stats* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+void retro_vfs_get_read_stats(struct retro_vfs_file_stats* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
 int64_t retro_vfs_file_write_impl(libretro_vfs_implementation_file* stream, const void* s, uint64_t len)
 {
     if (!stream || (!stream->fp && stream->fh == INVALID_HANDLE_VALUE) || !s)
@@ -212,6 +248,13 @@ int retro_vfs_file_flush_impl(libretro_vfs_implementation_file* stream)
     return -1;
 }
 
+int retro_vfs_file_sync_impl(libretro_vfs_implementation_file* stream)
+{
+    if (stream && fflush(stream->fp) == 0 && _commit(_fileno(stream->fp)) == 0)
+       return 0;
+    return -1;
+}
+
 int retro_vfs_file_remove_impl(const char *path)
 {
    BOOL result;
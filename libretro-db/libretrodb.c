@@ -26,6 +26,7 @@
 #else
 #include <unistd.h>
 #endif
+#include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <stdlib.h>
@@ -34,6 +35,19 @@
 #include <retro_endianness.h>
 #include <string/stdstring.h>
 #include <compat/strl.h>
+#include <file/file_path.h>
+#include <array/rbuf.h>
+#include <lrc_hash.h>
+#include <retro_miscellaneous.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#define LIBRETRODB_MMAP
+#endif
 
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
@@ -44,6 +58,19 @@
 
 #define MAGIC_NUMBER "RARCHDB"
 
+/* Secondary indexes of all databases together
+ * may not use more than this many entries */
+#define LIBRETRODB_INDEX_CACHE_MAX_ENTRIES (512 * 1024)
+
+/* CRC filters use about ten bits per CRC and seven
+ * hashes, for about 1% of false positives */
+#define LIBRETRODB_BLOOM_BITS_PER_KEY 10
+#define LIBRETRODB_BLOOM_HASHES       7
+#define LIBRETRODB_BLOOM_MAGIC        0x4d4f4f4c42424452ULL /* "RDBBLOOM" */
+#define LIBRETRODB_BLOOM_VERSION      1
+#define LIBRETRODB_BLOOM_EXT          ".bloom"
+#define LIBRETRODB_BLOOM_DIR          "databases"
+
 struct node_iter_ctx
 {
    libretrodb_t *db;
@@ -54,6 +81,10 @@ struct libretrodb
 {
    RFILE *fd;
    char *path;
+   /* Whole file, if it was opened read-only
+    * and could be mapped */
+   const uint8_t *map;
+   size_t map_size;
    bool can_write;
    uint64_t root;
    uint64_t count;
@@ -84,8 +115,96 @@ struct libretrodb_cursor
    RFILE *fd;
    libretrodb_query_t *query;
    libretrodb_t *db;
+   /* Candidate documents found by the query planner,
+    * sorted, only read if 'indexed' is set */
+   uint32_t *offsets; /* RBUF */
+   size_t next_offset;
+   /* Read position, if the database is mapped */
+   uint64_t pos;
+   /* Documents read from the mapping, only valid
+    * until the next one is read */
+   struct rmsgpack_dom_arena arena;
+   /* Last document returned by
+    * libretrodb_cursor_read_item_borrowed(), if
+    * it had to be allocated */
+   struct rmsgpack_dom_value item;
    int is_valid;
    int eof;
+   int indexed;
+};
+
+typedef struct libretrodb_index_entry
+{
+   uint32_t key;
+   uint32_t offset;
+} libretrodb_index_entry_t;
+
+typedef struct libretrodb_field_index
+{
+   char field[32];
+   libretrodb_index_entry_t *entries; /* RBUF, sorted by key */
+   enum libretrodb_index_type type;
+} libretrodb_field_index_t;
+
+typedef struct libretrodb_index_cache_entry
+{
+   char *path;
+   libretrodb_field_index_t *indexes; /* RBUF */
+   int64_t mtime;
+   uint64_t count;
+   unsigned last_used;
+} libretrodb_index_cache_entry_t;
+
+/* Stored as is after the database, followed by the bits */
+typedef struct libretrodb_bloom_header
+{
+   uint64_t magic;
+   int64_t db_mtime;
+   int64_t db_size;
+   uint32_t version;
+   uint32_t num_bits;
+} libretrodb_bloom_header_t;
+
+typedef struct libretrodb_bloom
+{
+   char *path;
+   uint8_t *bits;
+   int64_t mtime;
+   int64_t size;
+   uint32_t num_bits;
+} libretrodb_bloom_t;
+
+/* Secondary indexes are built in memory the first time
+ * a field of a database is looked up, and kept for all
+ * the handles later opened on the same file */
+typedef struct libretrodb_index_cache
+{
+   libretrodb_index_cache_entry_t *dbs; /* RBUF */
+   /* Filters of the CRCs of each database, which are
+    * small enough to be kept for all of them */
+   libretrodb_bloom_t *blooms; /* RBUF */
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   /* Where filters are saved, empty if they are
+    * only kept in memory */
+   char bloom_dir[PATH_MAX_LENGTH];
+   size_t num_entries;
+   unsigned counter;
+   bool inited;
+} libretrodb_index_cache_t;
+
+static libretrodb_index_cache_t libretrodb_index_cache;
+
+/* Only fields that are commonly queried are indexed */
+static const char *libretrodb_indexed_fields[] = {
+   "crc",
+   "serial",
+   "name",
+   "developer",
+   "publisher",
+   "releaseyear",
+   NULL
 };
 
 static int libretrodb_validate_document(const struct rmsgpack_dom_value *doc)
@@ -171,8 +290,40 @@ clean:
    return rv;
 }
 
+static void libretrodb_map(libretrodb_t *db)
+{
+#ifdef LIBRETRODB_MMAP
+   struct stat st;
+   int fd = open(db->path, O_RDONLY);
+
+   if (fd < 0)
+      return;
+
+   if (     fstat(fd, &st) == 0
+         && st.st_size > 0
+         && (uint64_t)st.st_size == (size_t)st.st_size)
+   {
+      void *map = mmap(NULL, (size_t)st.st_size, PROT_READ,
+            MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED)
+      {
+         db->map      = (const uint8_t*)map;
+         db->map_size = (size_t)st.st_size;
+      }
+   }
+
+   close(fd);
+#endif
+}
+
 void libretrodb_close(libretrodb_t *db)
 {
+#ifdef LIBRETRODB_MMAP
+   if (db->map)
+      munmap((void*)db->map, db->map_size);
+#endif
+   db->map      = NULL;
+   db->map_size = 0;
    if (db->fd)
       filestream_close(db->fd);
    if (!string_is_empty(db->path))
@@ -214,6 +365,11 @@ int libretrodb_open(const char *path, libretrodb_t *db, bool write)
    db->count              = md.count;
    db->first_index_offset = filestream_tell(fd);
    db->fd                 = fd;
+
+   /* Documents are then read without going through
+    * the file stream, nor copying binaries */
+   if (!write)
+      libretrodb_map(db);
    return 0;
 
 error:
@@ -328,22 +484,56 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
+   cursor->eof         = 0;
+   cursor->next_offset = 0;
+   cursor->pos         = cursor->db->root + sizeof(libretrodb_header_t);
+   if (!cursor->fd)
+      return 0;
    return (int)filestream_seek(cursor->fd,
          (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
          RETRO_VFS_SEEK_POSITION_START);
 }
 
-int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+/* Reads the next document matching the query. If the
+ * database is mapped, the document is held by the arena
+ * of the cursor */
+static int libretrodb_cursor_read(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out)
 {
    int rv;
+   const uint8_t *map = NULL;
 
    if (cursor->eof)
       return EOF;
 
+   map = cursor->db->map;
+
 retry:
-   if ((rv = rmsgpack_dom_read(cursor->fd, out)) < 0)
+   if (cursor->indexed)
+   {
+      if (cursor->next_offset >= RBUF_LEN(cursor->offsets))
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+
+      cursor->pos = cursor->offsets[cursor->next_offset++];
+      if (!map)
+         filestream_seek(cursor->fd, (ssize_t)cursor->pos,
+               RETRO_VFS_SEEK_POSITION_START);
+   }
+
+   if (map)
+   {
+      rmsgpack_dom_arena_reset(&cursor->arena);
+      if (     cursor->pos >= cursor->db->map_size
+            || (rv = rmsgpack_dom_read_buf(map + cursor->pos,
+                  cursor->db->map_size - (size_t)cursor->pos,
+                  &cursor->arena, out)) < 0)
+         return -1;
+      cursor->pos += rv;
+   }
+   else if ((rv = rmsgpack_dom_read(cursor->fd, out)) < 0)
       return rv;
 
    if (out->type == RDT_NULL)
@@ -356,7 +546,8 @@ retry:
    {
       if (!libretrodb_query_filter(cursor->query, out))
       {
-         rmsgpack_dom_value_free(out);
+         if (!map)
+            rmsgpack_dom_value_free(out);
          goto retry;
       }
    }
@@ -364,6 +555,46 @@ retry:
    return 0;
 }
 
+static int64_t libretrodb_cursor_tell(libretrodb_cursor_t *cursor)
+{
+   if (cursor->db->map)
+      return (int64_t)cursor->pos;
+   return filestream_tell(cursor->fd);
+}
+
+int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   int rv;
+   struct rmsgpack_dom_value item;
+
+   if ((rv = libretrodb_cursor_read(cursor, &item)) != 0)
+      return rv;
+
+   /* Only documents matching the query are allocated */
+   if (cursor->db->map)
+      return rmsgpack_dom_value_copy(out, &item);
+
+   *out = item;
+   return 0;
+}
+
+int libretrodb_cursor_read_item_borrowed(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   int rv;
+
+   rmsgpack_dom_value_free(&cursor->item);
+   cursor->item.type = RDT_NULL;
+
+   if ((rv = libretrodb_cursor_read(cursor, out)) != 0)
+      return rv;
+
+   if (!cursor->db->map)
+      cursor->item = *out;
+   return 0;
+}
+
 /**
  * libretrodb_cursor_close:
  * @cursor              : Handle to database cursor.
@@ -381,8 +612,14 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
+   RBUF_FREE(cursor->offsets);
+   rmsgpack_dom_value_free(&cursor->item);
+   rmsgpack_dom_arena_free(&cursor->arena);
+   cursor->item.type = RDT_NULL;
+
    cursor->is_valid = 0;
    cursor->eof      = 1;
+   cursor->indexed  = 0;
    cursor->fd       = NULL;
    cursor->db       = NULL;
    cursor->query    = NULL;
@@ -406,20 +643,32 @@ int libretrodb_cursor_open(libretrodb_t *db,
    if (!db || string_is_empty(db->path))
       return -1;
 
-   if (!(fd = filestream_open(db->path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   if (     !db->map
+         && !(fd = filestream_open(db->path,
+               RETRO_VFS_FILE_ACCESS_READ,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
       return -1;
 
-   cursor->fd       = fd;
-   cursor->db       = db;
-   cursor->is_valid = 1;
+   cursor->fd         = fd;
+   cursor->db         = db;
+   cursor->is_valid   = 1;
+   cursor->offsets    = NULL;
+   cursor->indexed    = 0;
+   cursor->arena.head = NULL;
+   cursor->item.type  = RDT_NULL;
    libretrodb_cursor_reset(cursor);
    cursor->query    = q;
 
    if (q)
+   {
       libretrodb_query_inc_ref(q);
 
+      /* Only read the documents that may match,
+       * if the query can use secondary indexes */
+      cursor->indexed = (libretrodb_query_plan(q, db,
+               &cursor->offsets) == 0);
+   }
+
    return 0;
 }
 
@@ -568,6 +817,12 @@ libretrodb_cursor_t *libretrodb_cursor_new(void)
    dbc->is_valid            = 0;
    dbc->fd                  = NULL;
    dbc->eof                 = 0;
+   dbc->indexed             = 0;
+   dbc->offsets             = NULL;
+   dbc->next_offset         = 0;
+   dbc->pos                 = 0;
+   dbc->arena.head          = NULL;
+   dbc->item.type           = RDT_NULL;
    dbc->query               = NULL;
    dbc->db                  = NULL;
 
@@ -592,6 +847,8 @@ libretrodb_t *libretrodb_new(void)
    db->count              = 0;
    db->first_index_offset = 0;
    db->path               = NULL;
+   db->map                = NULL;
+   db->map_size           = 0;
 
    return db;
 }
@@ -601,3 +858,633 @@ void libretrodb_free(libretrodb_t *db)
    if (db)
       free(db);
 }
+
+/* Secondary indexes */
+
+bool libretrodb_index_key(enum libretrodb_index_type type,
+      const struct rmsgpack_dom_value *value, uint32_t *key)
+{
+   uint32_t i;
+
+   switch (value->type)
+   {
+      case RDT_INT:
+      case RDT_UINT:
+         if (type != LIBRETRODB_INDEX_VALUE)
+            return false;
+         /* Values beyond 32 bits share keys, which
+          * only costs a few more documents to check */
+         *key = (uint32_t)value->val.uint_;
+         return true;
+      case RDT_STRING:
+         if (type == LIBRETRODB_INDEX_PREFIX)
+         {
+            /* Big endian, so that strings sharing a
+             * prefix have adjacent keys */
+            *key = 0;
+            for (i = 0; i < 4; i++)
+            {
+               *key <<= 8;
+               if (i < value->val.string.len)
+                  *key |= (uint8_t)value->val.string.buff[i];
+            }
+            return true;
+         }
+         /* fall-through */
+      case RDT_BINARY:
+         if (type != LIBRETRODB_INDEX_VALUE)
+            return false;
+         *key = 5381;
+         for (i = 0; i < value->val.string.len; i++)
+            *key = (*key << 5) + *key
+                 + (uint8_t)value->val.string.buff[i];
+         return true;
+      default:
+         break;
+   }
+
+   return false;
+}
+
+static int libretrodb_index_entry_compare(const void *a, const void *b)
+{
+   const libretrodb_index_entry_t *ea = (const libretrodb_index_entry_t*)a;
+   const libretrodb_index_entry_t *eb = (const libretrodb_index_entry_t*)b;
+
+   if (ea->key != eb->key)
+      return (ea->key < eb->key) ? -1 : 1;
+   if (ea->offset != eb->offset)
+      return (ea->offset < eb->offset) ? -1 : 1;
+   return 0;
+}
+
+/* Reads every document of the database once */
+static libretrodb_index_entry_t *libretrodb_index_build(libretrodb_t *db,
+      const char *field, enum libretrodb_index_type type)
+{
+   struct rmsgpack_dom_value key;
+   struct rmsgpack_dom_value item;
+   libretrodb_cursor_t cur           = {0};
+   libretrodb_index_entry_t *entries = NULL;
+
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
+      return NULL;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = (uint32_t)strlen(field);
+   key.val.string.buff = (char*)field; /* Not modified */
+
+   for (;;)
+   {
+      libretrodb_index_entry_t entry;
+      struct rmsgpack_dom_value *value = NULL;
+      int64_t offset                   = libretrodb_cursor_tell(&cur);
+
+      if (offset < 0 || offset > (int64_t)UINT32_MAX)
+         goto error;
+
+      if (libretrodb_cursor_read_item_borrowed(&cur, &item) != 0)
+      {
+         if (cur.eof)
+            break;
+         goto error;
+      }
+
+      if (     item.type == RDT_MAP
+            && (value = rmsgpack_dom_value_map_value(&item, &key))
+            && libretrodb_index_key(type, value, &entry.key))
+      {
+         entry.offset = (uint32_t)offset;
+         if (!RBUF_TRYFIT(entries, RBUF_LEN(entries) + 1))
+            goto error;
+         RBUF_PUSH(entries, entry);
+      }
+   }
+
+   libretrodb_cursor_close(&cur);
+
+   if (entries)
+      qsort(entries, RBUF_LEN(entries), sizeof(*entries),
+            libretrodb_index_entry_compare);
+
+   return entries;
+
+error:
+   libretrodb_cursor_close(&cur);
+   RBUF_FREE(entries);
+   return NULL;
+}
+
+static void libretrodb_index_cache_entry_free(
+      libretrodb_index_cache_entry_t *entry)
+{
+   size_t i;
+
+   for (i = 0; i < RBUF_LEN(entry->indexes); i++)
+   {
+      libretrodb_index_cache.num_entries -=
+         RBUF_LEN(entry->indexes[i].entries);
+      RBUF_FREE(entry->indexes[i].entries);
+   }
+
+   RBUF_FREE(entry->indexes);
+   free(entry->path);
+}
+
+/* Must be called with the cache locked */
+static libretrodb_field_index_t *libretrodb_index_cache_find(
+      libretrodb_t *db, int64_t mtime, const char *field,
+      enum libretrodb_index_type type)
+{
+   size_t i, j;
+
+   for (i = 0; i < RBUF_LEN(libretrodb_index_cache.dbs); i++)
+   {
+      libretrodb_index_cache_entry_t *entry = &libretrodb_index_cache.dbs[i];
+
+      if (!string_is_equal(entry->path, db->path))
+         continue;
+
+      /* Database was updated */
+      if (entry->mtime != mtime || entry->count != db->count)
+      {
+         libretrodb_index_cache_entry_free(entry);
+         RBUF_REMOVE(libretrodb_index_cache.dbs, i);
+         return NULL;
+      }
+
+      entry->last_used = ++libretrodb_index_cache.counter;
+
+      for (j = 0; j < RBUF_LEN(entry->indexes); j++)
+         if (     entry->indexes[j].type == type
+               && string_is_equal(entry->indexes[j].field, field))
+            return &entry->indexes[j];
+
+      return NULL;
+   }
+
+   return NULL;
+}
+
+/* Must be called with the cache locked, takes
+ * ownership of 'entries' */
+static libretrodb_field_index_t *libretrodb_index_cache_add(
+      libretrodb_t *db, int64_t mtime, const char *field,
+      enum libretrodb_index_type type, libretrodb_index_entry_t *entries)
+{
+   size_t i;
+   libretrodb_field_index_t index;
+   libretrodb_index_cache_entry_t *entry = NULL;
+
+   /* Evict the least recently used databases */
+   while (     RBUF_LEN(libretrodb_index_cache.dbs)
+         &&    libretrodb_index_cache.num_entries + RBUF_LEN(entries)
+             > LIBRETRODB_INDEX_CACHE_MAX_ENTRIES)
+   {
+      size_t oldest = 0;
+      for (i = 1; i < RBUF_LEN(libretrodb_index_cache.dbs); i++)
+         if (     (libretrodb_index_cache.counter - libretrodb_index_cache.dbs[i].last_used)
+                > (libretrodb_index_cache.counter - libretrodb_index_cache.dbs[oldest].last_used))
+            oldest = i;
+      libretrodb_index_cache_entry_free(&libretrodb_index_cache.dbs[oldest]);
+      RBUF_REMOVE(libretrodb_index_cache.dbs, oldest);
+   }
+
+   for (i = 0; i < RBUF_LEN(libretrodb_index_cache.dbs); i++)
+   {
+      if (string_is_equal(libretrodb_index_cache.dbs[i].path, db->path))
+      {
+         entry = &libretrodb_index_cache.dbs[i];
+         break;
+      }
+   }
+
+   if (!entry)
+   {
+      libretrodb_index_cache_entry_t new_entry;
+
+      new_entry.path      = strdup(db->path);
+      new_entry.indexes   = NULL;
+      new_entry.mtime     = mtime;
+      new_entry.count     = db->count;
+      new_entry.last_used = ++libretrodb_index_cache.counter;
+
+      if (     !new_entry.path
+            || !RBUF_TRYFIT(libretrodb_index_cache.dbs,
+                  RBUF_LEN(libretrodb_index_cache.dbs) + 1))
+      {
+         free(new_entry.path);
+         RBUF_FREE(entries);
+         return NULL;
+      }
+
+      RBUF_PUSH(libretrodb_index_cache.dbs, new_entry);
+      entry = &RBUF_END(libretrodb_index_cache.dbs)[-1];
+   }
+
+   /* Another thread may have built the same index */
+   for (i = 0; i < RBUF_LEN(entry->indexes); i++)
+   {
+      if (     entry->indexes[i].type == type
+            && string_is_equal(entry->indexes[i].field, field))
+      {
+         RBUF_FREE(entries);
+         return &entry->indexes[i];
+      }
+   }
+
+   if (!RBUF_TRYFIT(entry->indexes, RBUF_LEN(entry->indexes) + 1))
+   {
+      RBUF_FREE(entries);
+      return NULL;
+   }
+
+   strlcpy(index.field, field, sizeof(index.field));
+   index.entries = entries;
+   index.type    = type;
+   RBUF_PUSH(entry->indexes, index);
+
+   libretrodb_index_cache.num_entries += RBUF_LEN(entries);
+   return &RBUF_END(entry->indexes)[-1];
+}
+
+static void libretrodb_index_cache_lock(void)
+{
+#ifdef HAVE_THREADS
+   slock_lock(libretrodb_index_cache.lock);
+#endif
+}
+
+static void libretrodb_index_cache_unlock(void)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(libretrodb_index_cache.lock);
+#endif
+}
+
+int libretrodb_index_lookup(libretrodb_t *db, const char *field,
+      enum libretrodb_index_type type,
+      uint32_t key_min, uint32_t key_max, uint32_t **offsets)
+{
+   size_t i, lo, hi, len;
+   int64_t mtime;
+   const char **indexed              = libretrodb_indexed_fields;
+   libretrodb_field_index_t *index   = NULL;
+   libretrodb_index_entry_t *entries = NULL;
+
+   if (     !libretrodb_index_cache.inited
+         || !db
+         || string_is_empty(db->path)
+         || strlen(field) >= sizeof(index->field))
+      return -1;
+
+   while (*indexed && !string_is_equal(*indexed, field))
+      indexed++;
+   if (!*indexed)
+      return -1;
+
+   mtime = path_get_mtime(db->path);
+
+   libretrodb_index_cache_lock();
+   if (!(index = libretrodb_index_cache_find(db, mtime, field, type)))
+   {
+      /* Do not hold the lock while reading the whole database */
+      libretrodb_index_cache_unlock();
+      if (!(entries = libretrodb_index_build(db, field, type)))
+         return -1;
+      libretrodb_index_cache_lock();
+      if (!(index = libretrodb_index_cache_add(db, mtime, field,
+                  type, entries)))
+      {
+         libretrodb_index_cache_unlock();
+         return -1;
+      }
+   }
+
+   /* Find the first entry with a key >= key_min */
+   entries = index->entries;
+   len     = RBUF_LEN(entries);
+   lo      = 0;
+   hi      = len;
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (entries[mid].key < key_min)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   for (i = lo; i < len && entries[i].key <= key_max; i++)
+      RBUF_PUSH(*offsets, entries[i].offset);
+
+   libretrodb_index_cache_unlock();
+   return 0;
+}
+
+void libretrodb_index_cache_init(void)
+{
+   if (libretrodb_index_cache.inited)
+      return;
+
+#ifdef HAVE_THREADS
+   if (!(libretrodb_index_cache.lock = slock_new()))
+      return;
+#endif
+
+   libretrodb_index_cache.inited = true;
+}
+
+void libretrodb_index_cache_set_directory(const char *path)
+{
+   if (!libretrodb_index_cache.inited)
+      return;
+
+   libretrodb_index_cache_lock();
+   if (string_is_empty(path))
+      *libretrodb_index_cache.bloom_dir = '\0';
+   else
+      fill_pathname_join_special(libretrodb_index_cache.bloom_dir, path,
+            LIBRETRODB_BLOOM_DIR, sizeof(libretrodb_index_cache.bloom_dir));
+   libretrodb_index_cache_unlock();
+}
+
+void libretrodb_index_cache_deinit(void)
+{
+   size_t i;
+
+   if (!libretrodb_index_cache.inited)
+      return;
+
+   for (i = 0; i < RBUF_LEN(libretrodb_index_cache.dbs); i++)
+      libretrodb_index_cache_entry_free(&libretrodb_index_cache.dbs[i]);
+   RBUF_FREE(libretrodb_index_cache.dbs);
+
+   for (i = 0; i < RBUF_LEN(libretrodb_index_cache.blooms); i++)
+   {
+      free(libretrodb_index_cache.blooms[i].path);
+      free(libretrodb_index_cache.blooms[i].bits);
+   }
+   RBUF_FREE(libretrodb_index_cache.blooms);
+
+#ifdef HAVE_THREADS
+   slock_free(libretrodb_index_cache.lock);
+#endif
+   memset(&libretrodb_index_cache, 0, sizeof(libretrodb_index_cache));
+}
+
+/* CRC filters */
+
+static uint32_t libretrodb_bloom_bit(uint32_t crc, unsigned i,
+      uint32_t num_bits)
+{
+   /* CRCs are already well distributed: a second hash
+    * derived from the CRC is enough for double hashing */
+   uint32_t h2 = ((crc * 0x9e3779b1U) >> 7) | 1;
+   return (crc + i * h2) % num_bits;
+}
+
+static bool libretrodb_bloom_test(const libretrodb_bloom_t *bloom,
+      uint32_t crc)
+{
+   unsigned i;
+
+   for (i = 0; i < LIBRETRODB_BLOOM_HASHES; i++)
+   {
+      uint32_t bit = libretrodb_bloom_bit(crc, i, bloom->num_bits);
+      if (!(bloom->bits[bit >> 3] & (1 << (bit & 7))))
+         return false;
+   }
+
+   return true;
+}
+
+/* Filters are named after the database, and the hash of
+ * its path tells apart databases of the same name in
+ * different directories.
+ * Returns false if filters are only kept in memory. */
+static bool libretrodb_bloom_get_path(const libretrodb_bloom_t *bloom,
+      char *s, size_t len)
+{
+   size_t _len;
+
+   if (string_is_empty(libretrodb_index_cache.bloom_dir))
+      return false;
+
+   _len  = fill_pathname_join_special(s, libretrodb_index_cache.bloom_dir,
+         path_basename(bloom->path), len);
+   _len += snprintf(s + _len, len - _len, "-%08x",
+         (unsigned)fnv1a_calculate(FNV1A_INIT,
+            bloom->path, strlen(bloom->path)));
+   strlcpy(s + _len, LIBRETRODB_BLOOM_EXT, len - _len);
+   return true;
+}
+
+static bool libretrodb_bloom_load(libretrodb_bloom_t *bloom)
+{
+   char path[PATH_MAX_LENGTH];
+   libretrodb_bloom_header_t header;
+   void *buf   = NULL;
+   int64_t len = 0;
+
+   if (     !libretrodb_bloom_get_path(bloom, path, sizeof(path))
+         || !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &len))
+      return false;
+
+   if ((size_t)len < sizeof(header))
+      goto error;
+
+   memcpy(&header, buf, sizeof(header));
+
+   if (     header.magic    != LIBRETRODB_BLOOM_MAGIC
+         || header.version  != LIBRETRODB_BLOOM_VERSION
+         || header.db_mtime != bloom->mtime
+         || header.db_size  != bloom->size
+         || header.num_bits == 0
+         || (uint64_t)len   != sizeof(header)
+            + ((uint64_t)header.num_bits + 7) / 8)
+      goto error;
+
+   if (!(bloom->bits = (uint8_t*)malloc((size_t)len - sizeof(header))))
+      goto error;
+
+   memcpy(bloom->bits, (uint8_t*)buf + sizeof(header),
+         (size_t)len - sizeof(header));
+   bloom->num_bits = header.num_bits;
+   free(buf);
+   return true;
+
+error:
+   free(buf);
+   return false;
+}
+
+/* Without a (writable) cache directory, the
+ * filter is rebuilt in each session */
+static void libretrodb_bloom_save(const libretrodb_bloom_t *bloom)
+{
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   libretrodb_bloom_header_t header;
+   size_t bytes = (bloom->num_bits + 7) / 8;
+   uint8_t *buf = NULL;
+
+   if (     !libretrodb_bloom_get_path(bloom, path, sizeof(path))
+         || !path_mkdir(libretrodb_index_cache.bloom_dir)
+         || !(buf = (uint8_t*)malloc(sizeof(header) + bytes)))
+      return;
+
+   memset(&header, 0, sizeof(header));
+   header.magic    = LIBRETRODB_BLOOM_MAGIC;
+   header.version  = LIBRETRODB_BLOOM_VERSION;
+   header.db_mtime = bloom->mtime;
+   header.db_size  = bloom->size;
+   header.num_bits = bloom->num_bits;
+
+   memcpy(buf, &header, sizeof(header));
+   memcpy(buf + sizeof(header), bloom->bits, bytes);
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (filestream_write_file(tmp_path, buf, (int64_t)(sizeof(header) + bytes)))
+      filestream_replace(tmp_path, path);
+
+   free(buf);
+}
+
+/* Reads the CRC of every document once */
+static bool libretrodb_bloom_build(libretrodb_bloom_t *bloom)
+{
+   struct rmsgpack_dom_value key;
+   struct rmsgpack_dom_value item;
+   uint32_t *crcs           = NULL; /* RBUF */
+   libretrodb_t db          = {0};
+   libretrodb_cursor_t cur  = {0};
+   bool ret                 = false;
+   size_t i;
+
+   if (     libretrodb_open(bloom->path, &db, false) != 0
+         || libretrodb_cursor_open(&db, &cur, NULL) != 0)
+      goto end;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = STRLEN_CONST("crc");
+   key.val.string.buff = (char*)"crc"; /* Not modified */
+
+   while (libretrodb_cursor_read_item_borrowed(&cur, &item) == 0)
+   {
+      struct rmsgpack_dom_value *value = NULL;
+
+      if (     item.type != RDT_MAP
+            || !(value = rmsgpack_dom_value_map_value(&item, &key))
+            ||  value->type != RDT_BINARY
+            ||  value->val.binary.len != 4)
+         continue;
+
+      if (!RBUF_TRYFIT(crcs, RBUF_LEN(crcs) + 1))
+         goto end;
+      RBUF_PUSH(crcs, retro_get_unaligned_32be(value->val.binary.buff));
+   }
+
+   if (!cur.eof)
+      goto end;
+
+   bloom->num_bits = (uint32_t)(RBUF_LEN(crcs)
+         * LIBRETRODB_BLOOM_BITS_PER_KEY);
+   if (bloom->num_bits < 64)
+      bloom->num_bits = 64;
+
+   if (!(bloom->bits = (uint8_t*)calloc((bloom->num_bits + 7) / 8, 1)))
+      goto end;
+
+   for (i = 0; i < RBUF_LEN(crcs); i++)
+   {
+      unsigned j;
+      for (j = 0; j < LIBRETRODB_BLOOM_HASHES; j++)
+      {
+         uint32_t bit = libretrodb_bloom_bit(crcs[i], j, bloom->num_bits);
+         bloom->bits[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+      }
+   }
+
+   ret = true;
+
+end:
+   RBUF_FREE(crcs);
+   if (cur.is_valid)
+      libretrodb_cursor_close(&cur);
+   libretrodb_close(&db);
+   return ret;
+}
+
+bool libretrodb_may_contain_crc(const char *path, uint32_t crc)
+{
+   size_t i;
+   bool ret;
+   libretrodb_bloom_t bloom;
+
+   if (!libretrodb_index_cache.inited || string_is_empty(path))
+      return true;
+
+   bloom.mtime = path_get_mtime(path);
+   bloom.size  = path_get_size(path);
+
+   libretrodb_index_cache_lock();
+   for (i = 0; i < RBUF_LEN(libretrodb_index_cache.blooms); i++)
+   {
+      libretrodb_bloom_t *cached = &libretrodb_index_cache.blooms[i];
+
+      if (!string_is_equal(cached->path, path))
+         continue;
+
+      if (cached->mtime == bloom.mtime && cached->size == bloom.size)
+      {
+         ret = libretrodb_bloom_test(cached, crc);
+         libretrodb_index_cache_unlock();
+         return ret;
+      }
+
+      /* Database was updated */
+      free(cached->path);
+      free(cached->bits);
+      RBUF_REMOVE(libretrodb_index_cache.blooms, i);
+      break;
+   }
+   libretrodb_index_cache_unlock();
+
+   /* Do not hold the lock while reading the whole database */
+   if (!(bloom.path = strdup(path)))
+      return true;
+   bloom.bits = NULL;
+
+   if (!libretrodb_bloom_load(&bloom))
+   {
+      if (!libretrodb_bloom_build(&bloom))
+      {
+         free(bloom.path);
+         return true;
+      }
+      libretrodb_bloom_save(&bloom);
+   }
+
+   ret = libretrodb_bloom_test(&bloom, crc);
+
+   libretrodb_index_cache_lock();
+   for (i = 0; i < RBUF_LEN(libretrodb_index_cache.blooms); i++)
+      if (string_is_equal(libretrodb_index_cache.blooms[i].path, path))
+         break;
+   /* Another thread may have added the same filter */
+   if (     i == RBUF_LEN(libretrodb_index_cache.blooms)
+         && RBUF_TRYFIT(libretrodb_index_cache.blooms, i + 1))
+      RBUF_PUSH(libretrodb_index_cache.blooms, bloom);
+   else
+   {
+      free(bloom.path);
+      free(bloom.bits);
+   }
+   libretrodb_index_cache_unlock();
+
+   return ret;
+}
@@ -30,6 +30,7 @@
 #include <unistd.h>
 #endif
 
+#include <boolean.h>
 #include <retro_common_api.h>
 
 #include "query.h"
@@ -105,6 +106,81 @@ void libretrodb_query_free(void *q);
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_cursor_read_item_borrowed:
+ * @cursor              : Handle to database cursor.
+ * @out                 : Document read.
+ *
+ * Same as libretrodb_cursor_read_item(), except that @out
+ * belongs to the cursor: it is only valid until the next
+ * read or until the cursor is closed, and must not be
+ * freed. Nothing is allocated for each document when the
+ * database is memory mapped.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_cursor_read_item_borrowed(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out);
+
+/* Secondary indexes map a 32-bit key computed from the
+ * value of a field to the documents holding that value.
+ * Different values may share a key: documents found
+ * through an index must still be matched by the query */
+enum libretrodb_index_type
+{
+   /* Integers as is, hash of strings and binaries */
+   LIBRETRODB_INDEX_VALUE = 0,
+   /* First four bytes of strings, big endian */
+   LIBRETRODB_INDEX_PREFIX
+};
+
+/* Secondary indexes and CRC filters are
+ * only used between these calls */
+void libretrodb_index_cache_init(void);
+
+/* Sets the cache directory, where CRC filters are saved.
+ * Without one (empty path), they are rebuilt in each
+ * session */
+void libretrodb_index_cache_set_directory(const char *path);
+
+void libretrodb_index_cache_deinit(void);
+
+bool libretrodb_index_key(enum libretrodb_index_type type,
+      const struct rmsgpack_dom_value *value, uint32_t *key);
+
+/**
+ * libretrodb_index_lookup:
+ * @db                  : Handle to database.
+ * @field               : Name of the field.
+ * @type                : Type of index.
+ * @key_min             : Lowest key.
+ * @key_max             : Highest key.
+ * @offsets             : RBUF to append document offsets to.
+ *
+ * Finds the documents whose @field has a key between
+ * @key_min and @key_max, building the index first if
+ * needed.
+ *
+ * Returns: 0 if successful, -1 if @field cannot be indexed.
+ **/
+int libretrodb_index_lookup(libretrodb_t *db, const char *field,
+      enum libretrodb_index_type type,
+      uint32_t key_min, uint32_t key_max, uint32_t **offsets);
+
+/**
+ * libretrodb_may_contain_crc:
+ * @path                : Path of the database.
+ * @crc                 : CRC32 to look for.
+ *
+ * Checks a Bloom filter of the CRCs of the database. The
+ * filter is built the first time, and saved next to the
+ * database so that later sessions only need to load it.
+ *
+ * Returns: false if no document of the database has
+ * this CRC, true if some may have it.
+ **/
+bool libretrodb_may_contain_crc(const char *path, uint32_t crc);
+
 RETRO_END_DECLS
 
 #endif
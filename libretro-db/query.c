@@ -34,6 +34,7 @@
 #include <compat/strl.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
+#include <array/rbuf.h>
 
 #include "libretrodb.h"
 #include "query.h"
@@ -991,3 +992,171 @@ int libretrodb_query_filter(libretrodb_query_t *q,
    struct rmsgpack_dom_value res = inv.func(*v, inv.argc, inv.argv);
    return (res.type == RDT_BOOL && res.val.bool_);
 }
+
+/* Query planner
+ * > Only tables, i.e. queries of the form
+ *   { field: argument, ... }, are planned: the
+ *   candidates are the documents found through the
+ *   index of the most selective field.
+ * > An argument can use an index if it is a value,
+ *   'or' of such arguments, 'between' two integers,
+ *   or 'glob' with a pattern that does not start
+ *   with a wildcard. */
+
+static int query_plan_lookup(libretrodb_t *db, const char *field,
+      enum libretrodb_index_type type,
+      const struct rmsgpack_dom_value *value, uint32_t **offsets)
+{
+   uint32_t key;
+   if (!libretrodb_index_key(type, value, &key))
+      return -1;
+   return libretrodb_index_lookup(db, field, type, key, key, offsets);
+}
+
+static int query_plan_argument(libretrodb_t *db, const char *field,
+      const struct argument *arg, uint32_t **offsets)
+{
+   unsigned i;
+   const struct invocation *inv = NULL;
+
+   if (arg->type == AT_VALUE)
+      return query_plan_lookup(db, field, LIBRETRODB_INDEX_VALUE,
+            &arg->a.value, offsets);
+
+   inv = &arg->a.invocation;
+
+   if (inv->func == query_func_operator_or)
+   {
+      if (!inv->argc)
+         return -1;
+      for (i = 0; i < inv->argc; i++)
+         if (query_plan_argument(db, field, &inv->argv[i], offsets) != 0)
+            return -1;
+      return 0;
+   }
+
+   if (inv->func == query_func_between)
+   {
+      int64_t min, max;
+
+      if (     inv->argc != 2
+            || inv->argv[0].type         != AT_VALUE
+            || inv->argv[1].type         != AT_VALUE
+            || inv->argv[0].a.value.type != RDT_INT
+            || inv->argv[1].a.value.type != RDT_INT)
+         return -1;
+
+      min = inv->argv[0].a.value.val.int_;
+      max = inv->argv[1].a.value.val.int_;
+
+      if (min < 0 || max > (int64_t)UINT32_MAX || min > max)
+         return -1;
+
+      return libretrodb_index_lookup(db, field, LIBRETRODB_INDEX_VALUE,
+            (uint32_t)min, (uint32_t)max, offsets);
+   }
+
+   if (inv->func == query_func_glob)
+   {
+      struct rmsgpack_dom_value prefix;
+      uint32_t key_min, key_max;
+      const char *pattern = NULL;
+      size_t len          = 0;
+
+      if (     inv->argc != 1
+            || inv->argv[0].type         != AT_VALUE
+            || inv->argv[0].a.value.type != RDT_STRING)
+         return -1;
+
+      pattern = inv->argv[0].a.value.val.string.buff;
+      len     = strcspn(pattern, "*?[\\");
+
+      /* No wildcard: same as comparing the strings */
+      if (!pattern[len])
+         return query_plan_lookup(db, field, LIBRETRODB_INDEX_VALUE,
+               &inv->argv[0].a.value, offsets);
+
+      if (!len)
+         return -1;
+
+      /* Keys of strings starting with the prefix lie
+       * between the prefix padded with zeros and the
+       * prefix padded with ones */
+      prefix.type            = RDT_STRING;
+      prefix.val.string.buff = (char*)pattern;
+      prefix.val.string.len  = (uint32_t)MIN(len, 4);
+
+      if (!libretrodb_index_key(LIBRETRODB_INDEX_PREFIX, &prefix, &key_min))
+         return -1;
+      key_max = key_min;
+      if (len < 4)
+         key_max |= 0xFFFFFFFF >> (len * 8);
+
+      return libretrodb_index_lookup(db, field, LIBRETRODB_INDEX_PREFIX,
+            key_min, key_max, offsets);
+   }
+
+   return -1;
+}
+
+static int query_plan_offset_compare(const void *a, const void *b)
+{
+   uint32_t oa = *(const uint32_t*)a;
+   uint32_t ob = *(const uint32_t*)b;
+   return (oa < ob) ? -1 : (oa > ob);
+}
+
+int libretrodb_query_plan(libretrodb_query_t *q, libretrodb_t *db,
+      uint32_t **offsets)
+{
+   unsigned i;
+   size_t j, k, len;
+   struct invocation *root = &((struct query*)q)->root;
+   uint32_t *best          = NULL;
+   bool planned            = false;
+
+   if (root->func != query_func_all_map)
+      return -1;
+
+   for (i = 0; i + 1 < root->argc; i += 2)
+   {
+      uint32_t *candidates = NULL;
+
+      if (     root->argv[i].type         != AT_VALUE
+            || root->argv[i].a.value.type != RDT_STRING)
+         continue;
+
+      if (query_plan_argument(db, root->argv[i].a.value.val.string.buff,
+               &root->argv[i + 1], &candidates) != 0)
+      {
+         RBUF_FREE(candidates);
+         continue;
+      }
+
+      /* All fields must match: keep the shortest list */
+      if (!planned || RBUF_LEN(candidates) < RBUF_LEN(best))
+      {
+         RBUF_FREE(best);
+         best       = candidates;
+         planned    = true;
+      }
+      else
+         RBUF_FREE(candidates);
+   }
+
+   if (!planned)
+      return -1;
+
+   /* Read documents in file order, each once */
+   if ((len = RBUF_LEN(best)) > 1)
+   {
+      qsort(best, len, sizeof(*best), query_plan_offset_compare);
+      for (j = 1, k = 1; k < len; k++)
+         if (best[k] != best[j - 1])
+            best[j++] = best[k];
+      RBUF_RESIZE(best, j);
+   }
+
+   *offsets = best;
+   return 0;
+}
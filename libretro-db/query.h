@@ -32,12 +32,20 @@ RETRO_BEGIN_DECLS
 
 typedef struct libretrodb_query libretrodb_query_t;
 
+struct libretrodb;
+
 void libretrodb_query_inc_ref(libretrodb_query_t *q);
 
 void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/* Lists in @offsets (RBUF, sorted) the documents that
+ * may match @q according to the secondary indexes of
+ * @db. Returns -1 if the whole database must be read */
+int libretrodb_query_plan(libretrodb_query_t *q, struct libretrodb *db,
+      uint32_t **offsets);
+
 RETRO_END_DECLS
 
 #endif
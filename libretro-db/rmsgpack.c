@@ -593,3 +593,185 @@ end:
       free(buff);
    return 0;
 }
+
+static int rmsgpack_read_buf_uint(const uint8_t **ptr, const uint8_t *end,
+      size_t size, uint64_t *out)
+{
+   size_t i;
+
+   if ((size_t)(end - *ptr) < size)
+      return -1;
+
+   *out = 0;
+   for (i = 0; i < size; i++)
+      *out = (*out << 8) | (*ptr)[i];
+   *ptr += size;
+   return 0;
+}
+
+static int rmsgpack_read_buf_value(const uint8_t **ptr, const uint8_t *end,
+      struct rmsgpack_read_callbacks *callbacks, void *data)
+{
+   int rv;
+   uint32_t i;
+   uint64_t tmp_len  = 0;
+   uint64_t tmp_uint = 0;
+   uint8_t type;
+
+   if (*ptr >= end)
+      return -1;
+
+   type = *(*ptr)++;
+
+   if (type < MPF_FIXMAP)
+   {
+      if (callbacks->read_int)
+         return callbacks->read_int(type, data);
+      return 0;
+   }
+   else if (type < MPF_FIXARRAY)
+   {
+      tmp_len = type - MPF_FIXMAP;
+      goto map;
+   }
+   else if (type < MPF_FIXSTR)
+   {
+      tmp_len = type - MPF_FIXARRAY;
+      goto array;
+   }
+   else if (type < MPF_NIL)
+   {
+      tmp_len = type - MPF_FIXSTR;
+      goto string;
+   }
+   else if (type > MPF_MAP32)
+   {
+      if (callbacks->read_int)
+         return callbacks->read_int(type - 0xff - 1, data);
+      return 0;
+   }
+
+   switch (type)
+   {
+      case _MPF_NIL:
+         if (callbacks->read_nil)
+            return callbacks->read_nil(data);
+         return 0;
+      case _MPF_FALSE:
+      case _MPF_TRUE:
+         if (callbacks->read_bool)
+            return callbacks->read_bool(type == _MPF_TRUE, data);
+         return 0;
+      case _MPF_BIN8:
+      case _MPF_BIN16:
+      case _MPF_BIN32:
+         if (     rmsgpack_read_buf_uint(ptr, end,
+                  (size_t)1 << (type - _MPF_BIN8), &tmp_len) == -1
+               || (uint64_t)(end - *ptr) < tmp_len)
+            return -1;
+         *ptr += tmp_len;
+         if (callbacks->read_bin)
+            return callbacks->read_bin((void*)(*ptr - tmp_len),
+                  (uint32_t)tmp_len, data);
+         return 0;
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+         if (rmsgpack_read_buf_uint(ptr, end,
+                  (size_t)1 << (type - _MPF_UINT8), &tmp_uint) == -1)
+            return -1;
+         if (callbacks->read_uint)
+            return callbacks->read_uint(tmp_uint, data);
+         return 0;
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         if (rmsgpack_read_buf_uint(ptr, end,
+                  (size_t)1 << (type - _MPF_INT8), &tmp_uint) == -1)
+            return -1;
+         if (callbacks->read_int)
+         {
+            switch (type)
+            {
+               case _MPF_INT8:
+                  return callbacks->read_int((int8_t)tmp_uint, data);
+               case _MPF_INT16:
+                  return callbacks->read_int((int16_t)tmp_uint, data);
+               case _MPF_INT32:
+                  return callbacks->read_int((int32_t)tmp_uint, data);
+               default:
+                  return callbacks->read_int((int64_t)tmp_uint, data);
+            }
+         }
+         return 0;
+      case _MPF_STR8:
+      case _MPF_STR16:
+      case _MPF_STR32:
+         if (rmsgpack_read_buf_uint(ptr, end,
+                  (size_t)1 << (type - _MPF_STR8), &tmp_len) == -1)
+            return -1;
+         goto string;
+      case _MPF_ARRAY16:
+      case _MPF_ARRAY32:
+         if (rmsgpack_read_buf_uint(ptr, end,
+                  (size_t)2 << (type - _MPF_ARRAY16), &tmp_len) == -1)
+            return -1;
+         goto array;
+      case _MPF_MAP16:
+      case _MPF_MAP32:
+         if (rmsgpack_read_buf_uint(ptr, end,
+                  (size_t)2 << (type - _MPF_MAP16), &tmp_len) == -1)
+            return -1;
+         goto map;
+   }
+
+   return 0;
+
+string:
+   if ((uint64_t)(end - *ptr) < tmp_len)
+      return -1;
+   *ptr += tmp_len;
+   if (callbacks->read_string)
+      return callbacks->read_string((char*)(*ptr - tmp_len),
+            (uint32_t)tmp_len, data);
+   return 0;
+
+map:
+   if (     (     callbacks->read_map_start)
+         && (rv = callbacks->read_map_start((uint32_t)tmp_len, data)) < 0)
+      return rv;
+   for (i = 0; i < (uint32_t)tmp_len; i++)
+   {
+      if ((rv = rmsgpack_read_buf_value(ptr, end, callbacks, data)) < 0)
+         return rv;
+      if ((rv = rmsgpack_read_buf_value(ptr, end, callbacks, data)) < 0)
+         return rv;
+   }
+   return 0;
+
+array:
+   if (     (     callbacks->read_array_start)
+         && (rv = callbacks->read_array_start((uint32_t)tmp_len, data)) < 0)
+      return rv;
+   for (i = 0; i < (uint32_t)tmp_len; i++)
+   {
+      if ((rv = rmsgpack_read_buf_value(ptr, end, callbacks, data)) < 0)
+         return rv;
+   }
+   return 0;
+}
+
+int rmsgpack_read_buf(const void *buf, size_t len,
+      struct rmsgpack_read_callbacks *callbacks, void *data)
+{
+   int rv;
+   const uint8_t *ptr = (const uint8_t*)buf;
+
+   if ((rv = rmsgpack_read_buf_value(&ptr, ptr + len,
+               callbacks, data)) < 0)
+      return rv;
+
+   return (int)(ptr - (const uint8_t*)buf);
+}
@@ -57,4 +57,11 @@ int rmsgpack_write_uint(RFILE *fd, uint64_t value );
 
 int rmsgpack_read(RFILE *fd, struct rmsgpack_read_callbacks *callbacks, void *data);
 
+/* Reads one value from memory. Strings and binaries passed
+ * to the callbacks point into 'buf': they are neither
+ * terminated nor owned by the callbacks.
+ * Returns the number of bytes read, or a negative value */
+int rmsgpack_read_buf(const void *buf, size_t len,
+      struct rmsgpack_read_callbacks *callbacks, void *data);
+
 #endif
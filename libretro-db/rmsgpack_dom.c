@@ -32,12 +32,87 @@
 
 #define MAX_DEPTH 128
 
+/* Arena blocks grow up to this size, unless
+ * a single allocation is larger */
+#define ARENA_BLOCK_MIN (16 * 1024)
+#define ARENA_BLOCK_MAX (1024 * 1024)
+#define ARENA_ALIGN(x)  (((x) + 7) & ~(size_t)7)
+
+struct rmsgpack_dom_arena_block
+{
+   struct rmsgpack_dom_arena_block *next;
+   size_t size;
+   size_t used;
+};
+
+#define ARENA_HEADER_SIZE ARENA_ALIGN(sizeof(struct rmsgpack_dom_arena_block))
+
 struct dom_reader_state
 {
+   /* NULL when reading from a file */
+   struct rmsgpack_dom_arena *arena;
    int i;
    struct rmsgpack_dom_value *stack[MAX_DEPTH];
 };
 
+static void *rmsgpack_dom_arena_alloc(struct rmsgpack_dom_arena *arena,
+      size_t size)
+{
+   struct rmsgpack_dom_arena_block *block = arena->head;
+
+   size = ARENA_ALIGN(size);
+
+   if (!block || block->size - block->used < size)
+   {
+      size_t block_size = block ? block->size * 2 : ARENA_BLOCK_MIN;
+
+      if (block_size > ARENA_BLOCK_MAX)
+         block_size = ARENA_BLOCK_MAX;
+      if (block_size < size)
+         block_size = size;
+
+      if (!(block = (struct rmsgpack_dom_arena_block*)
+               malloc(ARENA_HEADER_SIZE + block_size)))
+         return NULL;
+
+      block->next = arena->head;
+      block->size = block_size;
+      block->used = 0;
+      arena->head = block;
+   }
+
+   block->used += size;
+   return (uint8_t*)block + ARENA_HEADER_SIZE + block->used - size;
+}
+
+void rmsgpack_dom_arena_reset(struct rmsgpack_dom_arena *arena)
+{
+   struct rmsgpack_dom_arena_block *block = arena->head;
+
+   if (!block)
+      return;
+
+   /* The newest block is normally the largest */
+   while (block->next)
+   {
+      struct rmsgpack_dom_arena_block *next = block->next->next;
+      free(block->next);
+      block->next = next;
+   }
+
+   block->used = 0;
+}
+
+void rmsgpack_dom_arena_free(struct rmsgpack_dom_arena *arena)
+{
+   while (arena->head)
+   {
+      struct rmsgpack_dom_arena_block *next = arena->head->next;
+      free(arena->head);
+      arena->head = next;
+   }
+}
+
 static struct rmsgpack_dom_value *dom_reader_state_pop(
       struct dom_reader_state *s)
 {
@@ -101,6 +176,16 @@ static int dom_read_string(char *value, uint32_t len, void *data)
    struct rmsgpack_dom_value *v       =
       (struct rmsgpack_dom_value*)dom_reader_state_pop(dom_state);
 
+   if (dom_state->arena)
+   {
+      char *copy = (char*)rmsgpack_dom_arena_alloc(dom_state->arena, len + 1);
+      if (!copy)
+         return -1;
+      memcpy(copy, value, len);
+      copy[len]                       = '\0';
+      value                           = copy;
+   }
+
    v->type                            = RDT_STRING;
    v->val.string.len                  = len;
    v->val.string.buff                 = value;
@@ -129,7 +214,17 @@ static int dom_read_map_start(uint32_t len, void *data)
    v->val.map.len                     = len;
    v->val.map.items                   = NULL;
 
-   if (!(items = (struct rmsgpack_dom_pair *)
+   if (dom_state->arena)
+   {
+      /* Would not fit on the stack anyway */
+      if (len >= MAX_DEPTH)
+         return -1;
+      if (!(items = (struct rmsgpack_dom_pair *)rmsgpack_dom_arena_alloc(
+                  dom_state->arena, len * sizeof(*items))))
+         return -1;
+      memset(items, 0, len * sizeof(*items));
+   }
+   else if (!(items = (struct rmsgpack_dom_pair *)
       calloc(len, sizeof(struct rmsgpack_dom_pair))))
       return -1;
 
@@ -157,7 +252,17 @@ static int dom_read_array_start(uint32_t len, void *data)
    v->val.array.len                   = len;
    v->val.array.items                 = NULL;
 
-   if (!(items = (struct rmsgpack_dom_value *)
+   if (dom_state->arena)
+   {
+      /* Would not fit on the stack anyway */
+      if (len >= MAX_DEPTH)
+         return -1;
+      if (!(items = (struct rmsgpack_dom_value *)rmsgpack_dom_arena_alloc(
+                  dom_state->arena, len * sizeof(*items))))
+         return -1;
+      memset(items, 0, len * sizeof(*items));
+   }
+   else if (!(items = (struct rmsgpack_dom_value *)
             calloc(len, sizeof(*items))))
       return -1;
 
@@ -408,6 +513,7 @@ int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out)
    int rv;
    struct dom_reader_state s;
 
+   s.arena    = NULL;
    s.i        = 0;
    s.stack[0] = out;
 
@@ -417,6 +523,78 @@ int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out)
    return rv;
 }
 
+int rmsgpack_dom_read_buf(const void *buf, size_t len,
+      struct rmsgpack_dom_arena *arena, struct rmsgpack_dom_value *out)
+{
+   struct dom_reader_state s;
+
+   s.arena    = arena;
+   s.i        = 0;
+   s.stack[0] = out;
+   out->type  = RDT_NULL;
+
+   return rmsgpack_read_buf(buf, len, &dom_reader_callbacks, &s);
+}
+
+int rmsgpack_dom_value_copy(struct rmsgpack_dom_value *dst,
+      const struct rmsgpack_dom_value *src)
+{
+   uint32_t i;
+
+   *dst = *src;
+
+   switch (src->type)
+   {
+      case RDT_STRING:
+      case RDT_BINARY:
+         /* Binaries are terminated as well, like
+          * the ones read from a file */
+         if (!(dst->val.string.buff = (char*)malloc(src->val.string.len + 1)))
+            break;
+         memcpy(dst->val.string.buff, src->val.string.buff,
+               src->val.string.len);
+         dst->val.string.buff[src->val.string.len] = '\0';
+         return 0;
+      case RDT_MAP:
+         if (!(dst->val.map.items = (struct rmsgpack_dom_pair*)
+                  calloc(src->val.map.len, sizeof(*dst->val.map.items))))
+            break;
+         for (i = 0; i < src->val.map.len; i++)
+         {
+            if (     rmsgpack_dom_value_copy(&dst->val.map.items[i].key,
+                        &src->val.map.items[i].key) < 0
+                  || rmsgpack_dom_value_copy(&dst->val.map.items[i].value,
+                        &src->val.map.items[i].value) < 0)
+            {
+               rmsgpack_dom_value_free(dst);
+               dst->type = RDT_NULL;
+               return -1;
+            }
+         }
+         return 0;
+      case RDT_ARRAY:
+         if (!(dst->val.array.items = (struct rmsgpack_dom_value*)
+                  calloc(src->val.array.len, sizeof(*dst->val.array.items))))
+            break;
+         for (i = 0; i < src->val.array.len; i++)
+         {
+            if (rmsgpack_dom_value_copy(&dst->val.array.items[i],
+                     &src->val.array.items[i]) < 0)
+            {
+               rmsgpack_dom_value_free(dst);
+               dst->type = RDT_NULL;
+               return -1;
+            }
+         }
+         return 0;
+      default:
+         return 0;
+   }
+
+   dst->type = RDT_NULL;
+   return -1;
+}
+
 int rmsgpack_dom_read_into(RFILE *fd, ...)
 {
    int rv;
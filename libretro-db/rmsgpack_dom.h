@@ -79,6 +79,21 @@ struct rmsgpack_dom_pair
 	struct rmsgpack_dom_value value; /* uint64_t alignment */
 };
 
+struct rmsgpack_dom_arena_block;
+
+/* Values read from memory are allocated from an arena
+ * and released all at once: they must never be passed
+ * to rmsgpack_dom_value_free(). Zero-initialize before use */
+struct rmsgpack_dom_arena
+{
+   struct rmsgpack_dom_arena_block *head;
+};
+
+/* Keeps the newest block for the next values */
+void rmsgpack_dom_arena_reset(struct rmsgpack_dom_arena *arena);
+
+void rmsgpack_dom_arena_free(struct rmsgpack_dom_arena *arena);
+
 void rmsgpack_dom_value_print(struct rmsgpack_dom_value *obj);
 void rmsgpack_dom_value_free(struct rmsgpack_dom_value *v);
 
@@ -91,6 +106,27 @@ struct rmsgpack_dom_value *rmsgpack_dom_value_map_value(
 
 int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out);
 
+/**
+ * rmsgpack_dom_read_buf:
+ * @buf                 : Serialized value.
+ * @len                 : Size of @buf.
+ * @arena               : Arena holding the nodes and strings.
+ * @out                 : Value read.
+ *
+ * Reads a value without copying binaries, which point into
+ * @buf. Strings are copied to the arena, since they must be
+ * terminated. @out is valid as long as both @buf and @arena
+ * are, until the arena is reset.
+ *
+ * Returns: number of bytes read, or negative on error.
+ **/
+int rmsgpack_dom_read_buf(const void *buf, size_t len,
+      struct rmsgpack_dom_arena *arena, struct rmsgpack_dom_value *out);
+
+/* Deep copy, to be freed with rmsgpack_dom_value_free() */
+int rmsgpack_dom_value_copy(struct rmsgpack_dom_value *dst,
+      const struct rmsgpack_dom_value *src);
+
 int rmsgpack_dom_write(RFILE *fd, const struct rmsgpack_dom_value *obj);
 
 int rmsgpack_dom_read_into(RFILE *fd, ...);
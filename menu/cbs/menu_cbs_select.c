@@ -45,8 +45,7 @@ static int action_select_default(
    file_list_t *selection_buf = menu_list ? MENU_LIST_GET_SELECTION(menu_list, 0) : NULL;
 
    if (selection_buf)
-      if (!(cbs = (menu_file_list_cbs_t*)
-         file_list_get_actiondata_at_offset(selection_buf, idx)))
+      if (!(cbs = menu_entries_get_actiondata(selection_buf, idx)))
          return -1;
 
    if (cbs->setting)
@@ -601,6 +601,8 @@ typedef struct materialui_handle
       uintptr_t list[MUI_TEXTURE_LAST];
    } textures;
 
+   gfx_display_atlas_t icon_atlas;
+
    menu_screensaver_t *screensaver;
 
    /* Status bar */
@@ -2381,14 +2383,28 @@ static uintptr_t materialui_get_playlist_icon(
 static void materialui_context_reset_textures(materialui_handle_t *mui)
 {
    int i;
+   gfx_display_t *p_disp      = disp_get_ptr();
+   gfx_display_atlas_t *atlas = NULL;
+
+   /* Icons are additionally packed into an atlas
+    * when the display driver batches its draws */
+   gfx_display_atlas_free(&mui->icon_atlas);
+   if (     p_disp->dispctx
+         && p_disp->dispctx->batched
+         && gfx_display_atlas_init(&mui->icon_atlas,
+            2048, 2048, video_driver_supports_rgba()))
+      atlas = &mui->icon_atlas;
 
    /* Loop through all textures */
    for (i = 0; i < MUI_TEXTURE_LAST; i++)
    {
-      gfx_display_reset_textures_list(
+      gfx_display_reset_textures_list_atlas(
             materialui_texture_path(i), mui->icons_path, &mui->textures.list[i],
-            TEXTURE_FILTER_MIPMAP_LINEAR, NULL, NULL);
+            TEXTURE_FILTER_MIPMAP_LINEAR, atlas);
    }
+
+   if (atlas)
+      gfx_display_atlas_upload(atlas);
 }
 
 static void materialui_draw_icon(
@@ -3609,6 +3625,7 @@ static void materialui_render(void *data,
       mui->last_scale_factor                  = scale_factor;
       mui->last_width                         = width;
       mui->last_height                        = height;
+      gfx_thumbnail_set_max_dimensions(width, height);
       mui->last_landscape_layout_optimization =
             (enum materialui_landscape_layout_optimization_type)
                   landscape_layout_optimization;
@@ -7044,6 +7061,9 @@ static void materialui_frame(void *data, video_frame_info_t *video_info)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, true, false);
 
+   /* Plain quads are drawn from the icon atlas */
+   p_disp->atlas = mui->icon_atlas.texture ? &mui->icon_atlas : NULL;
+
    /* Clear text */
    font_bind(&mui->font_data.title);
    font_bind(&mui->font_data.list);
@@ -7283,6 +7303,8 @@ static void materialui_frame(void *data, video_frame_info_t *video_info)
    font_unbind(&mui->font_data.list);
    font_unbind(&mui->font_data.hint);
 
+   p_disp->atlas = NULL;
+
    if (video_st->current_video && video_st->current_video->set_viewport)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, false, true);
@@ -8133,6 +8155,7 @@ static void *materialui_init(void **userdata, bool video_is_threaded)
 
    mui->last_width                        = width;
    mui->last_height                       = height;
+   gfx_thumbnail_set_max_dimensions(width, height);
    mui->last_scale_factor                 = gfx_display_get_dpi_scale(
          p_disp, settings, width, height,
          false, false);
@@ -8255,6 +8278,10 @@ static void materialui_free(void *data)
    p_anim->updatetime_cb = NULL;
 
    menu_screensaver_free(mui->screensaver);
+
+   gfx_display_atlas_free(&mui->icon_atlas);
+
+   gfx_thumbnail_cache_clear();
 }
 
 static void materialui_context_bg_destroy(materialui_handle_t *mui)
@@ -8300,6 +8327,7 @@ static void materialui_context_destroy(void *data)
    /* Free standard menu textures */
    for (i = 0; i < MUI_TEXTURE_LAST; i++)
       video_driver_texture_unload(&mui->textures.list[i]);
+   gfx_display_atlas_free(&mui->icon_atlas);
 
    /* Free playlist icons */
    materialui_context_destroy_playlist_icons(mui);
@@ -500,6 +500,7 @@ struct ozone_handle
    uintptr_t textures[OZONE_THEME_TEXTURE_LAST];
    uintptr_t icons_textures[OZONE_ENTRIES_ICONS_TEXTURE_LAST];
    uintptr_t tab_textures[OZONE_TAB_TEXTURE_LAST];
+   gfx_display_atlas_t icon_atlas;
 
    size_t categories_selection_ptr; /* active tab id  */
    size_t categories_active_idx_old;
@@ -4861,13 +4862,40 @@ static ozone_node_t *ozone_alloc_node(void)
    return node;
 }
 
+/* Playlist icons are loaded in pairs: icon_paths[i * 2]
+ * is the icon of icon_nodes[i], icon_paths[i * 2 + 1]
+ * its content icon */
+static void ozone_context_reset_horizontal_list_icon(
+      struct texture_image *ti, size_t idx, void *userdata)
+{
+   ozone_node_t **icon_nodes = (ozone_node_t**)userdata;
+   ozone_node_t *node        = icon_nodes[idx / 2];
+   uintptr_t *icon           = (idx & 1) ? &node->content_icon : &node->icon;
+
+   if (!ti->pixels)
+      return;
+
+   video_driver_texture_unload(icon);
+   video_driver_texture_load(ti,
+         TEXTURE_FILTER_MIPMAP_LINEAR, icon);
+}
+
 static void ozone_context_reset_horizontal_list(ozone_handle_t *ozone)
 {
    unsigned i;
-   size_t list_size = ozone_list_get_size(ozone, MENU_LIST_HORIZONTAL);
+   size_t list_size          = ozone_list_get_size(ozone, MENU_LIST_HORIZONTAL);
+   char **icon_paths         = NULL;
+   ozone_node_t **icon_nodes = NULL;
 
    RHMAP_FREE(ozone->playlist_db_node_map);
 
+   /* The icons of all the playlists are read at once */
+   if (list_size)
+   {
+      icon_paths = (char**)calloc(list_size * 2, sizeof(*icon_paths));
+      icon_nodes = (ozone_node_t**)calloc(list_size, sizeof(*icon_nodes));
+   }
+
    for (i = 0; i < list_size; i++)
    {
       const char *path         = NULL;
@@ -4884,7 +4912,6 @@ static void ozone_context_reset_horizontal_list(ozone_handle_t *ozone)
       if (string_ends_with_size(path, ".lpl", strlen(path), STRLEN_CONST(".lpl")))
       {
          size_t len;
-         struct texture_image ti;
          char sysname[PATH_MAX_LENGTH];
          char texturepath[PATH_MAX_LENGTH];
          char content_texturepath[PATH_MAX_LENGTH];
@@ -4921,23 +4948,6 @@ static void ozone_context_reset_horizontal_list(ozone_handle_t *ozone)
             texturepath[++len] = '\0';
          }
 
-         ti.width         = 0;
-         ti.height        = 0;
-         ti.pixels        = NULL;
-         ti.supports_rgba = video_driver_supports_rgba();
-
-         if (image_texture_load(&ti, texturepath))
-         {
-            if (ti.pixels)
-            {
-               video_driver_texture_unload(&node->icon);
-               video_driver_texture_load(&ti,
-                     TEXTURE_FILTER_MIPMAP_LINEAR, &node->icon);
-            }
-
-            image_texture_free(&ti);
-         }
-
          strlcat(sysname, "-content.png", sizeof(sysname));
          /* Assemble new icon path */
          fill_pathname_join_special(
@@ -4949,16 +4959,11 @@ static void ozone_context_reset_horizontal_list(ozone_handle_t *ozone)
             fill_pathname_join_delim(content_texturepath, ozone->icons_path_default,
                   "content.png", '-', sizeof(content_texturepath));
 
-         if (image_texture_load(&ti, content_texturepath))
+         if (icon_paths && icon_nodes)
          {
-            if (ti.pixels)
-            {
-               video_driver_texture_unload(&node->content_icon);
-               video_driver_texture_load(&ti,
-                     TEXTURE_FILTER_MIPMAP_LINEAR, &node->content_icon);
-            }
-
-            image_texture_free(&ti);
+            icon_nodes[i]         = node;
+            icon_paths[i * 2]     = strdup(texturepath);
+            icon_paths[i * 2 + 1] = strdup(content_texturepath);
          }
 
          /* Console name */
@@ -4984,6 +4989,19 @@ static void ozone_context_reset_horizontal_list(ozone_handle_t *ozone)
          node->icon = ozone->icons_textures[OZONE_ENTRIES_ICONS_TEXTURE_CURSOR];
       }
    }
+
+   if (icon_paths && icon_nodes)
+   {
+      image_texture_load_list((const char**)icon_paths, list_size * 2,
+            video_driver_supports_rgba(),
+            ozone_context_reset_horizontal_list_icon, icon_nodes);
+
+      for (i = 0; i < list_size * 2; i++)
+         free(icon_paths[i]);
+   }
+
+   free(icon_paths);
+   free(icon_nodes);
 }
 
 static void ozone_refresh_horizontal_list(
@@ -8603,6 +8621,7 @@ static void *ozone_init(void **userdata, bool video_is_threaded)
 
    ozone->last_width                            = width;
    ozone->last_height                           = height;
+   gfx_thumbnail_set_max_dimensions(width, height);
    ozone->last_scale_factor                     = gfx_display_get_dpi_scale(p_disp,
          settings, width, height, false, false);
    ozone->last_thumbnail_scale_factor           = settings->floats.ozone_thumbnail_scale_factor;
@@ -8826,8 +8845,11 @@ static void ozone_free(void *data)
          free(ozone->pending_message);
 
       menu_screensaver_free(ozone->screensaver);
+      gfx_display_atlas_free(&ozone->icon_atlas);
    }
 
+   gfx_thumbnail_cache_clear();
+
    gfx_display_deinit_white_texture();
 
    font_driver_bind_block(NULL, NULL);
@@ -9202,6 +9224,9 @@ static void ozone_context_reset(void *data, bool is_threaded)
 
    if (ozone)
    {
+      gfx_display_t *p_disp      = disp_get_ptr();
+      gfx_display_atlas_t *atlas = NULL;
+
       ozone->flags |= OZONE_FLAG_HAS_ALL_ASSETS;
 
       ozone_set_layout(ozone, config_get_ptr()->bools.ozone_collapse_sidebar, is_threaded);
@@ -9241,6 +9266,15 @@ static void ozone_context_reset(void *data, bool is_threaded)
          }
       }
 
+      /* Sidebar and entry icons are additionally packed
+       * into an atlas when the display driver batches its draws */
+      gfx_display_atlas_free(&ozone->icon_atlas);
+      if (     p_disp->dispctx
+            && p_disp->dispctx->batched
+            && gfx_display_atlas_init(&ozone->icon_atlas,
+               2048, 2048, video_driver_supports_rgba()))
+         atlas = &ozone->icon_atlas;
+
       /* Sidebar textures */
       for (i = 0; i < OZONE_TAB_TEXTURE_LAST; i++)
       {
@@ -9249,13 +9283,13 @@ static void ozone_context_reset(void *data, bool is_threaded)
             /* Exceptions for icons that don't exist in 'png/sidebar/' */
             case OZONE_TAB_TEXTURE_CONTENTLESS_CORES:
             case OZONE_TAB_TEXTURE_EXPLORE:
-               if (!gfx_display_reset_textures_list(OZONE_TAB_TEXTURES_FILES[i],
-                     ozone->icons_path, &ozone->tab_textures[i], TEXTURE_FILTER_MIPMAP_LINEAR, NULL, NULL))
+               if (!gfx_display_reset_textures_list_atlas(OZONE_TAB_TEXTURES_FILES[i],
+                     ozone->icons_path, &ozone->tab_textures[i], TEXTURE_FILTER_MIPMAP_LINEAR, atlas))
                   ozone->flags &= ~OZONE_FLAG_HAS_ALL_ASSETS;
                break;
             default:
-               if (!gfx_display_reset_textures_list(OZONE_TAB_TEXTURES_FILES[i],
-                     ozone->tab_path, &ozone->tab_textures[i], TEXTURE_FILTER_MIPMAP_LINEAR, NULL, NULL))
+               if (!gfx_display_reset_textures_list_atlas(OZONE_TAB_TEXTURES_FILES[i],
+                     ozone->tab_path, &ozone->tab_textures[i], TEXTURE_FILTER_MIPMAP_LINEAR, atlas))
                   ozone->flags &= ~OZONE_FLAG_HAS_ALL_ASSETS;
                break;
          }
@@ -9268,11 +9302,14 @@ static void ozone_context_reset(void *data, bool is_threaded)
       /* Icons textures init */
       for (i = 0; i < OZONE_ENTRIES_ICONS_TEXTURE_LAST; i++)
       {
-         if (!gfx_display_reset_textures_list(ozone_entries_icon_texture_path(i),
-               ozone->icons_path, &ozone->icons_textures[i], TEXTURE_FILTER_MIPMAP_LINEAR, NULL, NULL))
+         if (!gfx_display_reset_textures_list_atlas(ozone_entries_icon_texture_path(i),
+               ozone->icons_path, &ozone->icons_textures[i], TEXTURE_FILTER_MIPMAP_LINEAR, atlas))
             ozone->flags &= ~OZONE_FLAG_HAS_ALL_ASSETS;
       }
 
+      if (atlas)
+         gfx_display_atlas_upload(atlas);
+
       gfx_display_deinit_white_texture();
       gfx_display_init_white_texture();
 
@@ -9359,6 +9396,7 @@ static void ozone_context_destroy(void *data)
    /* Icons */
    for (i = 0; i < OZONE_TAB_TEXTURE_LAST; i++)
       video_driver_texture_unload(&ozone->tab_textures[i]);
+   gfx_display_atlas_free(&ozone->icon_atlas);
 
    /* Thumbnails */
    ozone_unload_thumbnail_textures(ozone);
@@ -9756,6 +9794,7 @@ static void ozone_render(void *data,
       ozone->last_thumbnail_scale_factor = thumbnail_scale_factor;
       ozone->last_width                  = width;
       ozone->last_height                 = height;
+      gfx_thumbnail_set_max_dimensions(width, height);
 
       /* Note: We don't need a full context reset here
        * > Just rescale layout, and reset frame time counter */
@@ -11405,6 +11444,9 @@ static void ozone_frame(void *data, video_frame_info_t *video_info)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, true, false);
 
+   /* Plain quads are drawn from the icon atlas */
+   p_disp->atlas = ozone->icon_atlas.texture ? &ozone->icon_atlas : NULL;
+
    /* Clear text */
    font_bind(&ozone->fonts.footer);
    font_bind(&ozone->fonts.title);
@@ -11676,6 +11718,8 @@ static void ozone_frame(void *data, video_frame_info_t *video_info)
    font_unbind(&ozone->fonts.entries_sublabel);
    font_unbind(&ozone->fonts.sidebar);
 
+   p_disp->atlas = NULL;
+
    if (video_st->current_video && video_st->current_video->set_viewport)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, false, true);
@@ -61,6 +61,7 @@
 
 /* Thumbnail additions */
 #include "../../gfx/gfx_thumbnail_path.h"
+#include "../../gfx/gfx_thumbnail.h"
 #include "../../tasks/tasks_internal.h"
 
 #if defined(GEKKO)
@@ -2335,8 +2336,11 @@ static bool rgui_request_thumbnail(
       enum gfx_thumbnail_id thumbnail_id,
       uint32_t *queue_size,
       const char *path,
+      bool cacheable,
       bool *file_missing)
 {
+   char cache_dir[PATH_MAX_LENGTH];
+
    /* Do nothing if current thumbnail path hasn't changed */
    if (!string_is_empty(path) && !string_is_empty(thumbnail->path))
       if (string_is_equal(thumbnail->path, path))
@@ -2354,11 +2358,23 @@ static bool rgui_request_thumbnail(
       strlcpy(thumbnail->path, path, sizeof(thumbnail->path));
       if (path_is_valid(path))
       {
+         /* Savestate images may be overwritten at any
+          * time, so only playlist thumbnails are cached */
+         cache_dir[0] = '\0';
+         if (cacheable)
+            gfx_thumbnail_get_cache_dir(cache_dir, sizeof(cache_dir));
+
          /* Would like to cancel any existing image load tasks
-          * here, but can't see how to do it... */
-         if (task_push_image_load(thumbnail->path,
+          * here, but can't see how to do it...
+          * > Image is only pre-shrunk to twice the target
+          *   size, so that the final downscale still uses
+          *   the user-selected RGUI thumbnail downscaler */
+         if (task_push_image_load_scaled(thumbnail->path,
                video_driver_supports_rgba(),
                0,
+               thumbnail->max_width  * 2,
+               thumbnail->max_height * 2,
+               cache_dir,
                (thumbnail_id == GFX_THUMBNAIL_LEFT)
                      ? rgui_handle_left_thumbnail_upload
                      : rgui_handle_thumbnail_upload,
@@ -6777,6 +6793,7 @@ static void rgui_load_current_thumbnails(rgui_t *rgui, struct menu_state *menu_s
             GFX_THUMBNAIL_RIGHT,
             &rgui->thumbnail_queue_size,
             thumbnail_path,
+            true,
             &thumbnails_missing))
          rgui->flags |=  RGUI_FLAG_ENTRY_HAS_THUMBNAIL;
       else
@@ -6797,6 +6814,7 @@ static void rgui_load_current_thumbnails(rgui_t *rgui, struct menu_state *menu_s
                GFX_THUMBNAIL_LEFT,
                &rgui->left_thumbnail_queue_size,
                left_thumbnail_path,
+               true,
                &thumbnails_missing))
             rgui->flags |=  RGUI_FLAG_ENTRY_HAS_LEFT_THUMBNAIL;
          else
@@ -6813,6 +6831,7 @@ static void rgui_load_current_thumbnails(rgui_t *rgui, struct menu_state *menu_s
                   GFX_THUMBNAIL_LEFT,
                   &rgui->left_thumbnail_queue_size,
                   rgui->savestate_thumbnail_file_path,
+                  false,
                   &thumbnails_missing))
             rgui->flags |=  RGUI_FLAG_ENTRY_HAS_LEFT_THUMBNAIL;
          else
@@ -6955,6 +6974,7 @@ static void rgui_update_savestate_thumbnail_image(void *data)
             GFX_THUMBNAIL_LEFT,
             &rgui->left_thumbnail_queue_size,
             rgui->savestate_thumbnail_file_path,
+            false,
             &thumbnails_missing))
          rgui->flags |=  RGUI_FLAG_ENTRY_HAS_LEFT_THUMBNAIL;
       else
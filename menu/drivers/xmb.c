@@ -344,6 +344,8 @@ typedef struct xmb_handle
       uintptr_t list[XMB_TEXTURE_LAST];
    } textures;
 
+   gfx_display_atlas_t icon_atlas;
+
    size_t categories_selection_ptr;
    size_t categories_selection_ptr_old;
    size_t selection_ptr_old;
@@ -2424,6 +2426,23 @@ static void xmb_toggle_horizontal_list(xmb_handle_t *xmb)
    }
 }
 
+/* Playlist icons are loaded in pairs: icon_paths[i * 2]
+ * is the icon of icon_nodes[i], icon_paths[i * 2 + 1]
+ * its content icon */
+static void xmb_context_reset_horizontal_list_icon(
+      struct texture_image *ti, size_t idx, void *userdata)
+{
+   xmb_node_t **icon_nodes = (xmb_node_t**)userdata;
+   xmb_node_t *node        = icon_nodes[idx / 2];
+   uintptr_t *icon         = (idx & 1) ? &node->content_icon : &node->icon;
+
+   if (!ti->pixels)
+      return;
+
+   video_driver_texture_unload(icon);
+   video_driver_texture_load(ti, TEXTURE_FILTER_MIPMAP_LINEAR, icon);
+}
+
 static void xmb_context_reset_horizontal_list(xmb_handle_t *xmb)
 {
    unsigned i;
@@ -2431,6 +2450,8 @@ static void xmb_context_reset_horizontal_list(xmb_handle_t *xmb)
    char icons_path_default[PATH_MAX_LENGTH];
    int depth                       = 1; /* keep this integer */
    size_t list_size                = xmb_list_get_size(xmb, MENU_LIST_HORIZONTAL);
+   char **icon_paths               = NULL;
+   xmb_node_t **icon_nodes         = NULL;
 
    xmb->categories_x_pos           = xmb->icon_spacing_horizontal * -(float)xmb->categories_selection_ptr;
 
@@ -2446,6 +2467,13 @@ static void xmb_context_reset_horizontal_list(xmb_handle_t *xmb)
    fill_pathname_join_special(icons_path_default, iconpath,
          "default", sizeof(icons_path_default));
 
+   /* The icons of all the playlists are read at once */
+   if (list_size)
+   {
+      icon_paths = (char**)calloc(list_size * 2, sizeof(*icon_paths));
+      icon_nodes = (xmb_node_t**)calloc(list_size, sizeof(*icon_nodes));
+   }
+
    for (i = 0; i < list_size; i++)
    {
       const char *path = NULL;
@@ -2461,7 +2489,6 @@ static void xmb_context_reset_horizontal_list(xmb_handle_t *xmb)
       if (string_ends_with_size(path, ".lpl", strlen(path), STRLEN_CONST(".lpl")))
       {
          size_t len;
-         struct texture_image ti;
          char sysname[PATH_MAX_LENGTH];
          char texturepath[PATH_MAX_LENGTH];
          char content_texturepath[PATH_MAX_LENGTH];
@@ -2497,22 +2524,6 @@ static void xmb_context_reset_horizontal_list(xmb_handle_t *xmb)
             texturepath[++len] = '\0';
          }
 
-         ti.width         = 0;
-         ti.height        = 0;
-         ti.pixels        = NULL;
-         ti.supports_rgba = video_driver_supports_rgba();
-
-         if (image_texture_load(&ti, texturepath))
-         {
-            if (ti.pixels)
-            {
-               video_driver_texture_unload(&node->icon);
-               video_driver_texture_load(&ti, TEXTURE_FILTER_MIPMAP_LINEAR, &node->icon);
-            }
-
-            image_texture_free(&ti);
-         }
-
          strlcat(sysname, "-content.png", sizeof(sysname));
          /* Assemble new icon path */
          fill_pathname_join_special(content_texturepath, iconpath, sysname,
@@ -2523,15 +2534,11 @@ static void xmb_context_reset_horizontal_list(xmb_handle_t *xmb)
             fill_pathname_join_delim(content_texturepath, icons_path_default,
                   FILE_PATH_CONTENT_BASENAME, '-', sizeof(content_texturepath));
 
-         if (image_texture_load(&ti, content_texturepath))
+         if (icon_paths && icon_nodes)
          {
-            if (ti.pixels)
-            {
-               video_driver_texture_unload(&node->content_icon);
-               video_driver_texture_load(&ti, TEXTURE_FILTER_MIPMAP_LINEAR, &node->content_icon);
-            }
-
-            image_texture_free(&ti);
+            icon_nodes[i]         = node;
+            icon_paths[i * 2]     = strdup(texturepath);
+            icon_paths[i * 2 + 1] = strdup(content_texturepath);
          }
 
          /* Console name */
@@ -2557,6 +2564,19 @@ static void xmb_context_reset_horizontal_list(xmb_handle_t *xmb)
       }
    }
 
+   if (icon_paths && icon_nodes)
+   {
+      image_texture_load_list((const char**)icon_paths, list_size * 2,
+            video_driver_supports_rgba(),
+            xmb_context_reset_horizontal_list_icon, icon_nodes);
+
+      for (i = 0; i < list_size * 2; i++)
+         free(icon_paths[i]);
+   }
+
+   free(icon_paths);
+   free(icon_nodes);
+
    xmb_toggle_horizontal_list(xmb);
 }
 
@@ -5698,6 +5718,9 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, true, false);
 
+   /* Plain quads are drawn from the icon atlas */
+   p_disp->atlas = xmb->icon_atlas.texture ? &xmb->icon_atlas : NULL;
+
    pseudo_font_length                      = xmb->icon_spacing_horizontal * 4 - xmb->icon_size / 4.0f;
    left_thumbnail_margin_width             = xmb->icon_size * 3.4f;
    right_thumbnail_margin_width            =
@@ -6395,6 +6418,8 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
                video_height);
    }
 
+   p_disp->atlas = NULL;
+
    if (video_st->current_video && video_st->current_video->set_viewport)
       video_st->current_video->set_viewport(
             video_st->data, video_width, video_height, false, true);
@@ -6556,6 +6581,9 @@ static void xmb_layout(xmb_handle_t *xmb)
    video_driver_get_size(&width, &height);
    xmb_init_scale_mod();
 
+   /* Thumbnails are never drawn larger than the screen */
+   gfx_thumbnail_set_max_dimensions(width, height);
+
    if (xmb->use_ps3_layout)
       xmb_layout_ps3(xmb, width);
    else
@@ -6827,8 +6855,10 @@ static void xmb_free(void *data)
          free(xmb->bg_file_path);
 
       menu_screensaver_free(xmb->screensaver);
+      gfx_display_atlas_free(&xmb->icon_atlas);
    }
 
+   gfx_thumbnail_cache_clear();
    gfx_display_deinit_white_texture();
    font_driver_bind_block(NULL, NULL);
 }
@@ -7137,10 +7167,21 @@ static bool xmb_context_reset_textures(
       unsigned menu_xmb_theme)
 {
    unsigned i;
+   gfx_display_t *p_disp      = disp_get_ptr();
+   gfx_display_atlas_t *atlas = NULL;
+
+   /* Icons are additionally packed into an atlas
+    * when the display driver batches its draws */
+   gfx_display_atlas_free(&xmb->icon_atlas);
+   if (     p_disp->dispctx
+         && p_disp->dispctx->batched
+         && gfx_display_atlas_init(&xmb->icon_atlas,
+            2048, 2048, video_driver_supports_rgba()))
+      atlas = &xmb->icon_atlas;
 
    for (i = 0; i < XMB_TEXTURE_LAST; i++)
    {
-      if (!gfx_display_reset_textures_list(xmb_texture_path(i), iconpath, &xmb->textures.list[i], TEXTURE_FILTER_MIPMAP_LINEAR, NULL, NULL))
+      if (!gfx_display_reset_textures_list_atlas(xmb_texture_path(i), iconpath, &xmb->textures.list[i], TEXTURE_FILTER_MIPMAP_LINEAR, atlas))
       {
          /* New extra battery icons could be missing */
          if (     i == XMB_TEXTURE_BATTERY_80
@@ -7182,6 +7223,9 @@ static bool xmb_context_reset_textures(
       }
    }
 
+   if (atlas)
+      gfx_display_atlas_upload(atlas);
+
    xmb->main_menu_node.icon       = xmb->textures.list[XMB_TEXTURE_MAIN_MENU];
    xmb->main_menu_node.alpha      = xmb->categories_active_alpha;
    xmb->main_menu_node.zoom       = xmb->categories_active_zoom;
@@ -7666,6 +7710,7 @@ static void xmb_context_destroy(void *data)
 
    for (i = 0; i < XMB_TEXTURE_LAST; i++)
       video_driver_texture_unload(&xmb->textures.list[i]);
+   gfx_display_atlas_free(&xmb->icon_atlas);
 
    xmb_unload_thumbnail_textures(xmb);
 
@@ -153,10 +153,16 @@
 struct menu_displaylist_state
 {
    enum filebrowser_enums filebrowser_types;
+   /* Playlist entry labels are built once displayed,
+    * see menu_displaylist_playlist_entry_path() */
+   char pl_label_spacer[PL_LABEL_SPACER_MAXLEN];
+   bool pl_show_inline_core_name;
 };
 
 static struct menu_displaylist_state menu_displist_st = {
-   FILEBROWSER_NONE /* filebrowser_types */
+   FILEBROWSER_NONE, /* filebrowser_types */
+   "",               /* pl_label_spacer */
+   false             /* pl_show_inline_core_name */
 };
 
 extern struct key_desc key_descriptors[RARCH_MAX_KEYS];
@@ -200,6 +206,8 @@ static int filebrowser_parse(
    enum menu_displaylist_ctl_state type         = (enum menu_displaylist_ctl_state)type_data;
    enum filebrowser_enums filebrowser_type      = filebrowser_get_type();
    bool allow_parent_directory                  = true;
+   bool list_cached                             = false;
+   bool list_complete                           = true;
    bool path_is_compressed                      = !string_is_empty(path) ?
          path_is_compressed_file(path) : false;
    menu_search_terms_t *search_terms            = menu_entries_search_get_terms();
@@ -265,9 +273,14 @@ static int filebrowser_parse(
          ret = dir_list_initialize(&str_list, path,
                exts, true, show_hidden_files, false, false);
       else
-         ret = dir_list_initialize(&str_list, path,
+      {
+         /* Large directories are read in the background,
+          * entries show up as they are enumerated */
+         ret         = menu_dir_list_get(&str_list, path,
                filter_ext ? exts : NULL,
-               true, show_hidden_files, true, false);
+               show_hidden_files, &list_complete);
+         list_cached = true;
+      }
    }
 
    switch (filebrowser_type)
@@ -310,7 +323,9 @@ static int filebrowser_parse(
       goto end;
    }
 
-   dir_list_sort(&str_list, true);
+   /* Cached listings are kept sorted */
+   if (!list_cached)
+      dir_list_sort(&str_list, true);
 
    list_size = str_list.size;
 
@@ -463,7 +478,13 @@ static int filebrowser_parse(
 
    dir_list_deinitialize(&str_list);
 
-   if (count == 0)
+   if (!list_complete)
+      menu_entries_append(info_list,
+            msg_hash_to_str(MENU_ENUM_LABEL_VALUE_EXPLORE_INITIALISING_LIST),
+            msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_INITIALISING_LIST),
+            MENU_ENUM_LABEL_EXPLORE_INITIALISING_LIST,
+            FILE_TYPE_NONE, 0, 0, NULL);
+   else if (count == 0)
       menu_entries_append(info_list,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_ITEMS),
             msg_hash_to_str(MENU_ENUM_LABEL_NO_ITEMS),
@@ -2170,6 +2191,100 @@ static unsigned menu_displaylist_parse_system_info(file_list_t *list)
    return count;
 }
 
+static void (*menu_displaylist_playlist_sanitization(
+      playlist_t *playlist))(char*)
+{
+   switch (playlist_get_label_display_mode(playlist))
+   {
+      case LABEL_DISPLAY_MODE_REMOVE_PARENTHESES :
+         return &label_remove_parens;
+      case LABEL_DISPLAY_MODE_REMOVE_BRACKETS :
+         return &label_remove_brackets;
+      case LABEL_DISPLAY_MODE_REMOVE_PARENTHESES_AND_BRACKETS :
+         return &label_remove_parens_and_brackets;
+      case LABEL_DISPLAY_MODE_KEEP_DISC_INDEX :
+         return &label_keep_disc;
+      case LABEL_DISPLAY_MODE_KEEP_REGION :
+         return &label_keep_region;
+      case LABEL_DISPLAY_MODE_KEEP_REGION_AND_DISC_INDEX :
+         return &label_keep_region_and_disc;
+      default :
+         break;
+   }
+
+   return NULL;
+}
+
+static void menu_displaylist_playlist_entry_label(
+      const struct playlist_entry *entry,
+      void (*sanitization)(char*),
+      char *s, size_t len)
+{
+   struct menu_displaylist_state *p_displist = &menu_displist_st;
+
+   if (!string_is_empty(entry->path))
+   {
+      /* Standard playlist entry
+       * > Base menu entry label is always playlist label
+       *   > If playlist label is NULL, fallback to playlist entry file name
+       * > If required, add currently associated core (if any), otherwise
+       *   no further action is necessary */
+
+      if (string_is_empty(entry->label))
+         fill_pathname(s, path_basename(entry->path), "", len);
+      else
+         strlcpy(s, entry->label, len);
+
+      if (sanitization)
+         (*sanitization)(s);
+
+      if (p_displist->pl_show_inline_core_name)
+      {
+         /* Both core name and core path must be valid */
+         if (   !string_is_empty(entry->core_name)
+             && !string_is_equal(entry->core_name, "DETECT")
+             && !string_is_empty(entry->core_path)
+             && !string_is_equal(entry->core_path, "DETECT"))
+         {
+            size_t _len  = strlen(s);
+            _len        += strlcpy(s + _len,
+                  p_displist->pl_label_spacer, len - _len);
+            if (_len < len)
+               strlcpy(s + _len, entry->core_name, len - _len);
+         }
+      }
+   }
+   /* Playlist entry without content...
+    * This is useless/broken, but have to include
+    * it otherwise synchronisation between the menu
+    * and the underlying playlist will be lost...
+    * > Use label if available, otherwise core name
+    * > If both are missing, add an empty menu entry */
+   else if (!string_is_empty(entry->label))
+      strlcpy(s, entry->label, len);
+   else if (!string_is_empty(entry->core_name))
+      strlcpy(s, entry->core_name, len);
+   else
+      *s = '\0';
+}
+
+static void menu_displaylist_playlist_entry_path(size_t entry_idx,
+      char *s, size_t len)
+{
+   const struct playlist_entry *entry = NULL;
+   playlist_t *playlist               = playlist_get_cached();
+
+   if (!playlist || entry_idx >= playlist_size(playlist))
+   {
+      *s = '\0';
+      return;
+   }
+
+   playlist_get_index(playlist, entry_idx, &entry);
+   menu_displaylist_playlist_entry_label(entry,
+         menu_displaylist_playlist_sanitization(playlist), s, len);
+}
+
 static int menu_displaylist_parse_playlist(
       file_list_t *info_list,
       const char *info_path, playlist_t *playlist,
@@ -2179,9 +2294,8 @@ static int menu_displaylist_parse_playlist(
       bool is_collection)
 {
    unsigned i;
-   char label_spacer[PL_LABEL_SPACER_MAXLEN];
    size_t           list_size        = playlist_size(playlist);
-   bool show_inline_core_name        = false;
+   struct menu_displaylist_state *p_displist = &menu_displist_st;
    struct menu_state *menu_st        = menu_state_get_ptr();
    const char *menu_driver           = menu_driver_ident();
    menu_search_terms_t *search_terms = menu_entries_search_get_terms();
@@ -2193,6 +2307,8 @@ static int menu_displaylist_parse_playlist(
    if (list_size == 0)
       return 0;
 
+   p_displist->pl_show_inline_core_name = false;
+
    /* Check whether core name should be added to playlist entries */
    if (   !string_is_equal(menu_driver, "ozone")
        && !pl_show_sublabels
@@ -2200,16 +2316,18 @@ static int menu_displaylist_parse_playlist(
        ||  (!is_collection
        && !(pl_show_inline_core_name == PLAYLIST_INLINE_CORE_DISPLAY_NEVER))))
    {
-      show_inline_core_name = true;
+      p_displist->pl_show_inline_core_name = true;
 
 #ifdef HAVE_RGUI
       /* Get spacer for menu entry labels (<content><spacer><core>)
        * > Note: Only required when showing inline core names */
       if (string_is_equal(menu_driver, "rgui"))
-         strlcpy(label_spacer, PL_LABEL_SPACER_RGUI, sizeof(label_spacer));
+         strlcpy(p_displist->pl_label_spacer, PL_LABEL_SPACER_RGUI,
+               sizeof(p_displist->pl_label_spacer));
       else
 #endif
-         strlcpy(label_spacer, PL_LABEL_SPACER_DEFAULT, sizeof(label_spacer));
+         strlcpy(p_displist->pl_label_spacer, PL_LABEL_SPACER_DEFAULT,
+               sizeof(p_displist->pl_label_spacer));
    }
 
    {
@@ -2247,29 +2365,8 @@ static int menu_displaylist_parse_playlist(
    /* Preallocate the file list */
    file_list_reserve(info_list, list_size);
 
-   switch (playlist_get_label_display_mode(playlist))
-   {
-      case LABEL_DISPLAY_MODE_REMOVE_PARENTHESES :
-         sanitization = &label_remove_parens;
-         break;
-      case LABEL_DISPLAY_MODE_REMOVE_BRACKETS :
-         sanitization = &label_remove_brackets;
-         break;
-      case LABEL_DISPLAY_MODE_REMOVE_PARENTHESES_AND_BRACKETS :
-         sanitization = &label_remove_parens_and_brackets;
-         break;
-      case LABEL_DISPLAY_MODE_KEEP_DISC_INDEX :
-         sanitization = &label_keep_disc;
-         break;
-      case LABEL_DISPLAY_MODE_KEEP_REGION :
-         sanitization = &label_keep_region;
-         break;
-      case LABEL_DISPLAY_MODE_KEEP_REGION_AND_DISC_INDEX :
-         sanitization = &label_keep_region_and_disc;
-         break;
-      default :
-         break;
-   }
+   if (search_terms)
+      sanitization = menu_displaylist_playlist_sanitization(playlist);
 
    for (i = 0; i < list_size; i++)
    {
@@ -2281,69 +2378,21 @@ static int menu_displaylist_parse_playlist(
       /* Read playlist entry */
       playlist_get_index(playlist, i, &entry);
 
-      if (!string_is_empty(entry->path))
-      {
-         size_t _len;
-         /* Standard playlist entry
-          * > Base menu entry label is always playlist label
-          *   > If playlist label is NULL, fallback to playlist entry file name
-          * > If required, add currently associated core (if any), otherwise
-          *   no further action is necessary */
-
-         if (string_is_empty(entry->label))
-            _len = fill_pathname(menu_entry_label,
-                  path_basename(entry->path), "",
-                  sizeof(menu_entry_label));
-         else
-            _len = strlcpy(menu_entry_label,
-                  entry->label,
-                  sizeof(menu_entry_label));
-
-         if (sanitization)
-            (*sanitization)(menu_entry_label);
-
-         if (show_inline_core_name)
-         {
-            /* Both core name and core path must be valid */
-            if (   !string_is_empty(entry->core_name)
-                && !string_is_equal(entry->core_name, "DETECT")
-                && !string_is_empty(entry->core_path)
-                && !string_is_equal(entry->core_path, "DETECT"))
-            {
-               _len += strlcpy(
-                     menu_entry_label         + _len,
-                     label_spacer,
-                     sizeof(menu_entry_label) - _len);
-               strlcpy(menu_entry_label       + _len,
-                     entry->core_name,
-                     sizeof(menu_entry_label) - _len);
-            }
-         }
-
-         entry_path = entry->path;
-      }
-      else
-      {
-         /* Playlist entry without content...
-          * This is useless/broken, but have to include
-          * it otherwise synchronisation between the menu
-          * and the underlying playlist will be lost...
-          * > Use label if available, otherwise core name
-          * > If both are missing, add an empty menu entry */
-         if (!string_is_empty(entry->label))
-            strlcpy(menu_entry_label, entry->label, sizeof(menu_entry_label));
-         else if (!string_is_empty(entry->core_name))
-            strlcpy(menu_entry_label, entry->core_name, sizeof(menu_entry_label));
-
-         entry_path = path_playlist;
-      }
+      entry_path = string_is_empty(entry->path)
+         ? path_playlist
+         : entry->path;
 
       /* Check whether entry matches search terms,
-       * if required */
+       * if required
+       * > Otherwise the label is only built once the
+       *   entry is displayed */
       if (search_terms)
       {
          size_t j;
 
+         menu_displaylist_playlist_entry_label(entry, sanitization,
+               menu_entry_label, sizeof(menu_entry_label));
+
          for (j = 0; j < search_terms->size; j++)
          {
             const char *search_term = search_terms->terms[j];
@@ -2358,9 +2407,10 @@ static int menu_displaylist_parse_playlist(
       }
 
       /* Add menu entry */
-      if (entry_valid && menu_entries_append(info_list,
-            menu_entry_label, entry_path,
-            MENU_ENUM_LABEL_PLAYLIST_ENTRY, FILE_TYPE_RPL_ENTRY, 0, i, NULL))
+      if (entry_valid && menu_entries_append_lazy(info_list,
+            search_terms ? menu_entry_label : NULL, entry_path,
+            MENU_ENUM_LABEL_PLAYLIST_ENTRY, FILE_TYPE_RPL_ENTRY, 0, i,
+            menu_displaylist_playlist_entry_path))
          count++;
    }
 
@@ -10210,6 +10260,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_BLOCK_SRAM_OVERWRITE,               PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVE_FILE_COMPRESSION,              PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION,         PARSE_ONLY_BOOL, true},
+               {MENU_ENUM_LABEL_FILE_COMPRESSION_ZSTD,              PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_THUMBNAIL_ENABLE,         PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE,                PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_AUTO_LOAD,                PARSE_ONLY_BOOL, true},
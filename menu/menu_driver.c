@@ -343,6 +343,37 @@ static bool menu_should_pop_stack(const char *label)
    return false;
 }
 
+/* Returns the callbacks of entry 'idx' without setting
+ * them up: entries appended lazily share 'lazy_cbs' */
+static menu_file_list_cbs_t *menu_entries_peek_actiondata(
+      struct menu_state *menu_st, file_list_t *list, size_t idx)
+{
+   if (list->list[idx].actiondata)
+      return (menu_file_list_cbs_t*)list->list[idx].actiondata;
+
+   if (     list != menu_st->entries.lazy_list
+         || list->list[idx].type != menu_st->entries.lazy_type)
+      return NULL;
+
+   return menu_st->entries.lazy_cbs;
+}
+
+/* Builds the path of a lazily appended entry into 's'.
+ * Returns NULL if the entry has no path */
+static const char *menu_entries_build_path(
+      struct menu_state *menu_st, file_list_t *list, size_t idx,
+      char *s, size_t len)
+{
+   if (     list->list[idx].path
+         || list != menu_st->entries.lazy_list
+         || list->list[idx].type != menu_st->entries.lazy_type
+         || !menu_st->entries.lazy_path)
+      return list->list[idx].path;
+
+   menu_st->entries.lazy_path(list->list[idx].entry_idx, s, len);
+   return s;
+}
+
 void menu_entry_get(menu_entry_t *entry, size_t stack_idx,
       size_t i, void *userdata, bool use_representation)
 {
@@ -363,15 +394,29 @@ void menu_entry_get(menu_entry_t *entry, size_t stack_idx,
 
    path_enabled               = (entry_flags & MENU_ENTRY_FLAG_PATH_ENABLED) ? true : false;
 
-   path                       = list->list[i].path;
    entry_label                = list->list[i].label;
    entry->type                = list->list[i].type;
    entry->entry_idx           = list->list[i].entry_idx;
    entry->setting_type        = 0;
-
-   cbs                        = (menu_file_list_cbs_t*)list->list[i].actiondata;
    entry->idx                 = (unsigned)i;
 
+   /* Lazily appended entries are only set up once they
+    * are displayed: layout passes that just ask for the
+    * sublabel of every entry use the shared callbacks */
+   if (entry_flags & (MENU_ENTRY_FLAG_PATH_ENABLED
+            | MENU_ENTRY_FLAG_LABEL_ENABLED
+            | MENU_ENTRY_FLAG_RICH_LABEL_ENABLED
+            | MENU_ENTRY_FLAG_VALUE_ENABLED))
+   {
+      path                    = menu_entries_get_path(list, i);
+      cbs                     = menu_entries_get_actiondata(list, i);
+   }
+   else
+   {
+      path                    = list->list[i].path;
+      cbs                     = menu_entries_peek_actiondata(menu_st, list, i);
+   }
+
    if (    (entry_flags & MENU_ENTRY_FLAG_LABEL_ENABLED)
          && !string_is_empty(entry_label))
       strlcpy(entry->label, entry_label, sizeof(entry->label));
@@ -456,11 +501,12 @@ void menu_entry_get(menu_entry_t *entry, size_t stack_idx,
             /* If this function callback returns true,
              * we know that the value won't change - so we
              * can cache it instead. */
-            if (cbs->action_sublabel(list,
-                     entry->type, (unsigned)i,
-                     label, path,
-                     entry->sublabel,
-                     sizeof(entry->sublabel)) > 0)
+            if (     cbs->action_sublabel(list,
+                        entry->type, (unsigned)i,
+                        label, path,
+                        entry->sublabel,
+                        sizeof(entry->sublabel)) > 0
+                  && cbs == list->list[i].actiondata)
                strlcpy(cbs->action_sublabel_cache,
                      entry->sublabel,
                      sizeof(cbs->action_sublabel_cache));
@@ -1205,6 +1251,16 @@ static bool input_event_osk_show_symbol_pages(
 #endif /* HAVE_LANGEXTRA */
 }
 
+static void menu_entries_lazy_reset(struct menu_state *menu_st)
+{
+   if (menu_st->entries.lazy_cbs)
+      free(menu_st->entries.lazy_cbs);
+   menu_st->entries.lazy_cbs  = NULL;
+   menu_st->entries.lazy_list = NULL;
+   menu_st->entries.lazy_path = NULL;
+   menu_st->entries.lazy_type = 0;
+}
+
 static void menu_driver_list_free(
       const menu_ctx_driver_t *menu_driver_ctx,
       menu_ctx_list_t *list)
@@ -1238,6 +1294,9 @@ static void menu_list_free_list(
       menu_driver_list_free(menu_driver_ctx, &list_info);
    }
 
+   if (list == menu_driver_state.entries.lazy_list)
+      menu_entries_lazy_reset(&menu_driver_state);
+
    file_list_free(list);
 }
 
@@ -3820,11 +3879,13 @@ void menu_entries_build_scroll_indices(
       struct menu_state *menu_st,
       file_list_t *list)
 {
+   char lazy_path[32];
    bool current_is_dir             = false;
    size_t i                        = 0;
    const char *path                = list->list[0].alt
                                    ? list->list[0].alt
-                                   : list->list[0].path;
+                                   : menu_entries_build_path(menu_st, list, 0,
+                                       lazy_path, sizeof(lazy_path));
    int ret                         = path ? TOLOWER((int)*path) : 0;
    int current                     = ELEM_GET_FIRST_CHAR(ret);
    unsigned type                   = list->list[0].type;
@@ -3840,9 +3901,12 @@ void menu_entries_build_scroll_indices(
       int first;
       bool is_dir  = false;
       unsigned idx = (unsigned)i;
+      /* Only the first character of lazily
+       * appended entries is built here */
       path         = list->list[i].alt
                    ? list->list[i].alt
-                   : list->list[i].path;
+                   : menu_entries_build_path(menu_st, list, i,
+                       lazy_path, sizeof(lazy_path));
       ret          = path ? TOLOWER((int)*path) : 0;
       first        = ELEM_GET_FIRST_CHAR(ret);
       type         = list->list[idx].type;
@@ -4293,6 +4357,144 @@ bool menu_entries_append(
    return true;
 }
 
+bool menu_entries_append_lazy(
+      file_list_t *list,
+      const char *path,
+      const char *label,
+      enum msg_hash_enums enum_idx,
+      unsigned type,
+      size_t directory_ptr,
+      size_t entry_idx,
+      menu_entries_path_cb_t path_cb)
+{
+   const char *menu_path          = NULL;
+   menu_file_list_cbs_t *lazy_cbs = NULL;
+   struct menu_state  *menu_st    = &menu_driver_state;
+   const file_list_t *mlist       = MENU_LIST_GET(menu_st->entries.list, 0);
+
+   if (!list || !label)
+      return false;
+
+   /* The first entry is set up as usual, and its
+    * callbacks are kept for the ones that follow */
+   if (menu_st->entries.lazy_list != list)
+   {
+      char first_path[256];
+
+      menu_entries_lazy_reset(menu_st);
+
+      if (!path && path_cb)
+      {
+         path_cb(entry_idx, first_path, sizeof(first_path));
+         path = first_path;
+      }
+
+      if (!menu_entries_append(list, path, label, enum_idx,
+               type, directory_ptr, entry_idx, NULL))
+         return false;
+
+      if (    list->list[list->size - 1].actiondata
+          && (lazy_cbs = (menu_file_list_cbs_t*)
+             malloc(sizeof(menu_file_list_cbs_t))))
+      {
+         memcpy(lazy_cbs, list->list[list->size - 1].actiondata,
+               sizeof(menu_file_list_cbs_t));
+         menu_st->entries.lazy_cbs  = lazy_cbs;
+         menu_st->entries.lazy_list = list;
+         menu_st->entries.lazy_path = path_cb;
+         menu_st->entries.lazy_type = type;
+      }
+      return true;
+   }
+
+   if (     !menu_st->entries.lazy_cbs
+         || menu_st->entries.lazy_cbs->enum_idx != enum_idx
+         || menu_st->entries.lazy_type          != type
+         || (!path && menu_st->entries.lazy_path != path_cb))
+   {
+      char entry_path[256];
+
+      if (!path && path_cb)
+      {
+         path_cb(entry_idx, entry_path, sizeof(entry_path));
+         path = entry_path;
+      }
+
+      return menu_entries_append(list, path, label, enum_idx,
+            type, directory_ptr, entry_idx, NULL);
+   }
+
+   if (!file_list_append(list, path, label, type,
+            directory_ptr, entry_idx))
+      return false;
+
+   /* Menu drivers keep per-entry layout state,
+    * so they still need to know about every entry */
+   if (  menu_st->driver_ctx &&
+         menu_st->driver_ctx->list_insert)
+   {
+      char *fullpath = NULL;
+
+      if (mlist && mlist->size)
+         menu_path   = mlist->list[mlist->size - 1].path;
+      if (!string_is_empty(menu_path))
+         fullpath    = strdup(menu_path);
+
+      menu_st->driver_ctx->list_insert(
+            menu_st->userdata,
+            list,
+            path,
+            fullpath,
+            label,
+            list->size - 1,
+            type);
+
+      if (fullpath)
+         free(fullpath);
+   }
+
+   return true;
+}
+
+menu_file_list_cbs_t *menu_entries_get_actiondata(
+      file_list_t *list, size_t idx)
+{
+   menu_file_list_cbs_t *lazy_cbs = NULL;
+   menu_file_list_cbs_t *cbs      = NULL;
+   struct menu_state *menu_st     = &menu_driver_state;
+
+   if (!list || idx >= list->size)
+      return NULL;
+
+   if (     (lazy_cbs = menu_entries_peek_actiondata(menu_st, list, idx))
+         == (menu_file_list_cbs_t*)list->list[idx].actiondata)
+      return lazy_cbs;
+
+   if (!(cbs = (menu_file_list_cbs_t*)malloc(sizeof(menu_file_list_cbs_t))))
+      return NULL;
+
+   memcpy(cbs, lazy_cbs, sizeof(menu_file_list_cbs_t));
+   list->list[idx].actiondata = cbs;
+   return cbs;
+}
+
+const char *menu_entries_get_path(file_list_t *list, size_t idx)
+{
+   char path[256];
+   const char *entry_path     = NULL;
+   struct menu_state *menu_st = &menu_driver_state;
+
+   if (!list || idx >= list->size)
+      return NULL;
+
+   if (     (entry_path = menu_entries_build_path(menu_st, list, idx,
+               path, sizeof(path)))
+         == path)
+      entry_path = list->list[idx].path = strdup(path);
+
+   return entry_path;
+}
+
 void menu_entries_prepend(file_list_t *list,
       const char *path, const char *label,
       enum msg_hash_enums enum_idx,
@@ -4421,6 +4623,9 @@ bool menu_entries_clear(file_list_t *list)
    if (!list)
       return false;
 
+   if (list == menu_st->entries.lazy_list)
+      menu_entries_lazy_reset(menu_st);
+
    /* Clear all the menu lists. */
    if (menu_st->driver_ctx->list_clear)
       menu_st->driver_ctx->list_clear(list);
@@ -5672,7 +5877,7 @@ static int menu_input_post_iterate(
    file_list_t *selection_buf                      = menu_list ? MENU_LIST_GET_SELECTION(menu_list, (unsigned)0) : NULL;
    size_t selection                                = menu_st->selection_ptr;
    menu_file_list_cbs_t *cbs                       = selection_buf
-      ? (menu_file_list_cbs_t*)selection_buf->list[selection].actiondata
+      ? menu_entries_get_actiondata(selection_buf, selection)
       : NULL;
 
    MENU_ENTRY_INITIALIZE(entry);
@@ -6621,6 +6826,7 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
          menu_explore_free();
 #endif
          menu_contentless_cores_free();
+         menu_dir_list_cache_free();
 #endif
 
          if (menu_st->driver_data)
@@ -7058,7 +7264,7 @@ static int generic_menu_iterate(
             file_list_t *selection_buf = menu_list ? MENU_LIST_GET_SELECTION(menu_list, (unsigned)0) : NULL;
             size_t selection           = menu_st->selection_ptr;
             menu_file_list_cbs_t *cbs  = selection_buf ?
-               (menu_file_list_cbs_t*)selection_buf->list[selection].actiondata
+               menu_entries_get_actiondata(selection_buf, selection)
                : NULL;
 
             if (cbs && cbs->enum_idx != MSG_UNKNOWN)
@@ -7389,7 +7595,7 @@ int generic_menu_entry_action(
    size_t entries_size            = menu_list ? MENU_LIST_GET_SELECTION(menu_list, 0)->size : 0;
    size_t selection_buf_size      = selection_buf ? selection_buf->size : 0;
    menu_file_list_cbs_t *cbs      = selection_buf ?
-      (menu_file_list_cbs_t*)selection_buf->list[i].actiondata : NULL;
+      menu_entries_get_actiondata(selection_buf, i) : NULL;
 #ifdef HAVE_ACCESSIBILITY
    bool accessibility_enable      = settings->bools.accessibility_enable;
    unsigned accessibility_narrator_speech_speed = settings->uints.accessibility_narrator_speech_speed;
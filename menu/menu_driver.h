@@ -486,7 +486,14 @@ struct menu_state
    {
       rarch_setting_t *list_settings;
       menu_list_t *list;
+      /* Entries of 'lazy_list' appended without callbacks
+       * get a copy of 'lazy_cbs' once they are displayed
+       * or acted upon, and their path from 'lazy_path' */
+      menu_file_list_cbs_t *lazy_cbs;
+      file_list_t *lazy_list;
+      menu_entries_path_cb_t lazy_path;
       size_t begin;
+      unsigned lazy_type;
    } entries;
    size_t   selection_ptr;
    size_t   contentless_core_ptr;
@@ -599,7 +606,7 @@ typedef struct
 
 #if defined(HAVE_LIBRETRODB)
 explore_state_t *menu_explore_build_list(const char *directory_playlist,
-      const char *directory_database);
+      const char *directory_database, const char *directory_cache);
 uintptr_t menu_explore_get_entry_icon(unsigned type);
 ssize_t menu_explore_get_entry_playlist_index(unsigned type,
       playlist_t **playlist, const struct playlist_entry **entry,
@@ -182,6 +182,34 @@ bool menu_entries_append(file_list_t *list,
       unsigned type, size_t directory_ptr, size_t entry_idx,
       rarch_setting_t *setting);
 
+/* Builds the path (display name) of the entry with
+ * 'entry_idx' of a list appended with
+ * menu_entries_append_lazy() */
+typedef void (*menu_entries_path_cb_t)(size_t entry_idx,
+      char *s, size_t len);
+
+/* Appends an entry without setting up its callbacks:
+ * entries of the same enum and type share the callbacks
+ * bound for the first of them, and are only given their
+ * own copy by menu_entries_get_actiondata(). If 'path'
+ * is NULL, it is built by 'path_cb' once the entry is
+ * displayed (see menu_entries_get_path()). Meant for
+ * very long lists, such as playlists */
+bool menu_entries_append_lazy(file_list_t *list,
+      const char *path, const char *label,
+      enum msg_hash_enums enum_idx,
+      unsigned type, size_t directory_ptr, size_t entry_idx,
+      menu_entries_path_cb_t path_cb);
+
+/* Returns the callbacks of entry 'idx', setting them up
+ * first if the entry was appended lazily */
+menu_file_list_cbs_t *menu_entries_get_actiondata(
+      file_list_t *list, size_t idx);
+
+/* Returns the path of entry 'idx', building it
+ * first if the entry was appended lazily */
+const char *menu_entries_get_path(file_list_t *list, size_t idx);
+
 bool menu_entries_clear(file_list_t *list);
 
 bool menu_entries_search_pop(void);
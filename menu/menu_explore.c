@@ -18,11 +18,13 @@
 
 #include <compat/strcasestr.h>
 #include <compat/strl.h>
+#include <file/file_path.h>
 #include <array/rbuf.h>
 #include <array/rhmap.h>
 #include <formats/rjson.h>
 #include <formats/rjson_helpers.h>
 #include <retro_endianness.h>
+#include <streams/file_stream.h>
 
 #include "menu_driver.h"
 #include "menu_cbs.h"
@@ -94,6 +96,7 @@ typedef struct ex_arena
 
 typedef struct
 {
+   uint32_t *entries; /* Indices of the entries having this value, ascending */
    uint32_t idx;
    char str[1];
 } explore_string_t;
@@ -113,6 +116,7 @@ struct explore_state
    ex_arena arena;
    explore_string_t **by[EXPLORE_CAT_COUNT];
    explore_entry_t *entries;
+   uint32_t **search_index; /* Label trigram -> entry indices, ascending */
    playlist_t **playlists;
    uintptr_t *icons;
    const char *label_explore_item_str;
@@ -358,6 +362,7 @@ static void explore_add_unique_string(
                   sizeof(explore_string_t) + len);
          memcpy(entry->str, str, len);
          entry->str[len]      = '\0';
+         entry->entries       = NULL;
          RBUF_PUSH(state->by[cat], entry);
          RHMAP_SET(maps[cat], hash, entry);
       }
@@ -387,6 +392,603 @@ static void explore_add_unique_string(
    }
 }
 
+/* Index */
+#define EXPLORE_TRIGRAM(s) \
+     (((uint32_t)(unsigned char)TOLOWER((s)[0]) << 16) \
+   |  ((uint32_t)(unsigned char)TOLOWER((s)[1]) <<  8) \
+   |   (uint32_t)(unsigned char)TOLOWER((s)[2]))
+
+static void explore_index_push(uint32_t **list, uint32_t idx)
+{
+   /* Entries are indexed in order, so a duplicate
+    * can only be the last element */
+   size_t len = RBUF_LEN(*list);
+   if (!len || (*list)[len - 1] != idx)
+      RBUF_PUSH(*list, idx);
+}
+
+/* Builds the list of entries of every category value
+ * and the trigram index of the entry labels, so that
+ * filtering a view only visits the matching entries */
+static void explore_build_index(explore_state_t *state)
+{
+   uint32_t i;
+   uint32_t len = (uint32_t)RBUF_LEN(state->entries);
+
+   for (i = 0; i != len; i++)
+   {
+      unsigned cat;
+      const char *label;
+      explore_entry_t *e = &state->entries[i];
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         if (e->by[cat])
+            explore_index_push(&e->by[cat]->entries, i);
+
+      if (e->split)
+      {
+         explore_string_t **split;
+         for (split = e->split; *split; split++)
+            explore_index_push(&(*split)->entries, i);
+      }
+
+      for (label = e->playlist_entry->label;
+            label[0] && label[1] && label[2]; label++)
+      {
+         uint32_t trigram = EXPLORE_TRIGRAM(label);
+         uint32_t *list   = RHMAP_GET(state->search_index, trigram);
+         explore_index_push(&list, i);
+         RHMAP_SET(state->search_index, trigram, list);
+      }
+   }
+}
+
+/* Returns false if the search cannot be narrowed down
+ * by the index, otherwise 'candidates' is set to the
+ * shortest list of entries containing all the trigrams
+ * of the search string (NULL if there is none) */
+static bool explore_search_candidates(explore_state_t *state,
+      const char *search, const uint32_t **candidates)
+{
+   const char *s;
+   const uint32_t *best = NULL;
+
+   if (!search[0] || !search[1] || !search[2])
+      return false;
+
+   for (s = search; s[2]; s++)
+   {
+      uint32_t *list = RHMAP_GET(state->search_index, EXPLORE_TRIGRAM(s));
+      if (!list)
+      {
+         *candidates = NULL;
+         return true;
+      }
+      if (!best || RBUF_LEN(list) < RBUF_LEN(best))
+         best = list;
+   }
+
+   *candidates = best;
+   return true;
+}
+
+static void explore_free_index(explore_state_t *state)
+{
+   unsigned cat;
+   size_t i, cap;
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      for (i = 0; i != RBUF_LEN(state->by[cat]); i++)
+         RBUF_FREE(state->by[cat][i]->entries);
+
+   for (i = 0, cap = RHMAP_CAP(state->search_index); i != cap; i++)
+      if (RHMAP_KEY(state->search_index, i))
+         RBUF_FREE(state->search_index[i]);
+   RHMAP_FREE(state->search_index);
+}
+
+/* Cache
+ * > Reading all databases referenced by the playlists
+ *   is by far the slowest part of building the explore
+ *   menu, so the result is written to the cache directory
+ *   and reused as long as no database file changed
+ * > Entries of the playlists that did not change are
+ *   read from the cache, only the playlists that changed
+ *   (or were added) are matched against the databases */
+typedef struct
+{
+   char *path;
+   int64_t mtime;
+   int32_t size;
+   bool used;   /* Playlist has entries in the explore menu */
+   bool cached; /* Entries of the playlist are read from the cache */
+} explore_cache_file_t;
+
+static void explore_cache_add_file(explore_cache_file_t **files,
+      const char *path)
+{
+   size_t i;
+   explore_cache_file_t file;
+
+   for (i = 0; i != RBUF_LEN(*files); i++)
+      if (string_is_equal((*files)[i].path, path))
+         return;
+
+   file.path   = strdup(path);
+   file.mtime  = path_get_mtime(path);
+   file.size   = path_get_size(path);
+   file.used   = false;
+   file.cached = false;
+   RBUF_PUSH(*files, file);
+}
+
+static void explore_cache_free_files(explore_cache_file_t **files)
+{
+   size_t i;
+   for (i = 0; i != RBUF_LEN(*files); i++)
+      free((*files)[i].path);
+   RBUF_FREE(*files);
+}
+
+#ifndef EXPLORE_SHOW_ORIGINAL_TITLE
+#define EXPLORE_CACHE
+#define EXPLORE_CACHE_MAGIC   0x58455852 /* "RXEX" */
+#define EXPLORE_CACHE_VERSION 1
+
+typedef struct
+{
+   const uint8_t *pos;
+   const uint8_t *end;
+} explore_cache_reader_t;
+
+static void explore_cache_put(uint8_t **buf, const void *data, size_t len)
+{
+   size_t pos = RBUF_LEN(*buf);
+   RBUF_RESIZE(*buf, pos + len);
+   memcpy(*buf + pos, data, len);
+}
+
+static void explore_cache_put_u32(uint8_t **buf, uint32_t val)
+{
+   explore_cache_put(buf, &val, sizeof(val));
+}
+
+static void explore_cache_put_str(uint8_t **buf, const char *str)
+{
+   uint32_t len = (uint32_t)strlen(str);
+   explore_cache_put_u32(buf, len);
+   explore_cache_put(buf, str, len + 1);
+}
+
+static void explore_cache_put_files(uint8_t **buf,
+      const explore_cache_file_t *files)
+{
+   size_t i;
+   explore_cache_put_u32(buf, (uint32_t)RBUF_LEN(files));
+   for (i = 0; i != RBUF_LEN(files); i++)
+   {
+      explore_cache_put_str(buf, files[i].path);
+      explore_cache_put(buf, &files[i].mtime, sizeof(files[i].mtime));
+      explore_cache_put(buf, &files[i].size, sizeof(files[i].size));
+      explore_cache_put_u32(buf, files[i].used);
+   }
+}
+
+static bool explore_cache_get(explore_cache_reader_t *r,
+      void *data, size_t len)
+{
+   if ((size_t)(r->end - r->pos) < len)
+      return false;
+   memcpy(data, r->pos, len);
+   r->pos += len;
+   return true;
+}
+
+static bool explore_cache_get_u32(explore_cache_reader_t *r, uint32_t *val)
+{
+   return explore_cache_get(r, val, sizeof(*val));
+}
+
+/* Returns a pointer into the cache data, or NULL */
+static const char *explore_cache_get_str(explore_cache_reader_t *r,
+      uint32_t *len)
+{
+   const char *str;
+   if (     !explore_cache_get_u32(r, len)
+         || (size_t)(r->end - r->pos) <= *len
+         || r->pos[*len] != '\0')
+      return NULL;
+   str     = (const char*)r->pos;
+   r->pos += *len + 1;
+   return str;
+}
+
+/* Matches the playlists recorded in the cache against
+ * 'files': those that did not change are marked as cached
+ * and loaded into 'playlists'. 'pl_map' maps each recorded
+ * playlist to its index in 'playlists', or -1 if its entries
+ * are not read from the cache */
+static bool explore_cache_read_playlists(explore_cache_reader_t *r,
+      explore_cache_file_t *files, playlist_t ***playlists,
+      int32_t **pl_map, bool *complete)
+{
+   uint32_t i, count, used, len;
+
+   if (!explore_cache_get_u32(r, &count))
+      return false;
+
+   *complete = (count == RBUF_LEN(files));
+
+   for (i = 0; i != count; i++)
+   {
+      size_t j;
+      int64_t mtime;
+      int32_t size;
+      const char *path = explore_cache_get_str(r, &len);
+
+      if (     !path
+            || !explore_cache_get(r, &mtime, sizeof(mtime))
+            || !explore_cache_get(r, &size, sizeof(size))
+            || !explore_cache_get_u32(r, &used))
+         return false;
+
+      /* File systems without modification times */
+      if (mtime == 0)
+         return false;
+
+      for (j = 0; j != RBUF_LEN(files); j++)
+         if (string_is_equal(files[j].path, path))
+            break;
+
+      if (     j == RBUF_LEN(files)
+            || files[j].mtime != mtime
+            || files[j].size  != size)
+      {
+         *complete = false;
+         RBUF_PUSH(*pl_map, -1);
+         continue;
+      }
+
+      files[j].cached = true;
+      files[j].used   = !!used;
+
+      if (used)
+      {
+         playlist_config_t playlist_config;
+         playlist_t *playlist                      = NULL;
+
+         playlist_config.base_content_directory[0] = '\0';
+         playlist_config.capacity                  = COLLECTION_SIZE;
+         playlist_config.old_format                = false;
+         playlist_config.compress                  = false;
+         playlist_config.fuzzy_archive_match       = false;
+         playlist_config.autofix_paths             = false;
+         strlcpy(playlist_config.path, path, sizeof(playlist_config.path));
+
+         if (!(playlist = playlist_init(&playlist_config)))
+            return false;
+         RBUF_PUSH(*pl_map, (int32_t)RBUF_LEN(*playlists));
+         RBUF_PUSH(*playlists, playlist);
+      }
+      else
+         RBUF_PUSH(*pl_map, -1);
+   }
+
+   return true;
+}
+
+/* Checks the databases recorded in the cache against the
+ * file system, and adds them to 'files' */
+static bool explore_cache_read_rdbs(explore_cache_reader_t *r,
+      explore_cache_file_t **files)
+{
+   uint32_t i, count, used, len;
+
+   if (!explore_cache_get_u32(r, &count))
+      return false;
+
+   for (i = 0; i != count; i++)
+   {
+      int64_t mtime;
+      int32_t size;
+      const char *path = explore_cache_get_str(r, &len);
+
+      if (     !path
+            || !explore_cache_get(r, &mtime, sizeof(mtime))
+            || !explore_cache_get(r, &size, sizeof(size))
+            || !explore_cache_get_u32(r, &used)
+            || mtime == 0
+            || path_get_mtime(path) != mtime
+            || path_get_size(path)  != size)
+         return false;
+
+      explore_cache_add_file(files, path);
+   }
+
+   return true;
+}
+
+static void explore_cache_write(explore_state_t *state,
+      const char *path, const explore_cache_file_t *playlist_files,
+      const explore_cache_file_t *rdb_files)
+{
+   size_t i;
+   unsigned cat;
+   uint8_t *buf = NULL;
+
+   for (i = 0; i != RBUF_LEN(playlist_files); i++)
+      if (playlist_files[i].mtime == 0)
+         return;
+
+   explore_cache_put_u32(&buf, EXPLORE_CACHE_MAGIC);
+   explore_cache_put_u32(&buf, EXPLORE_CACHE_VERSION);
+   explore_cache_put_files(&buf, playlist_files);
+   explore_cache_put_files(&buf, rdb_files);
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      explore_cache_put_u32(&buf, state->has_unknown[cat]);
+      explore_cache_put_u32(&buf, (uint32_t)RBUF_LEN(state->by[cat]));
+      for (i = 0; i != RBUF_LEN(state->by[cat]); i++)
+         explore_cache_put_str(&buf, state->by[cat][i]->str);
+   }
+
+   explore_cache_put_u32(&buf, (uint32_t)RBUF_LEN(state->entries));
+
+   for (i = 0; i != RBUF_LEN(state->entries); i++)
+   {
+      uint32_t pl_idx;
+      explore_entry_t *e = &state->entries[i];
+
+      for (pl_idx = 0; pl_idx != RBUF_LEN(state->playlists); pl_idx++)
+      {
+         const struct playlist_entry *pl_first = NULL;
+         playlist_t *pl                        = state->playlists[pl_idx];
+
+         playlist_get_index(pl, 0, &pl_first);
+
+         if (     (e->playlist_entry >= pl_first)
+               && (e->playlist_entry <  pl_first + playlist_size(pl)))
+         {
+            explore_cache_put_u32(&buf, pl_idx);
+            explore_cache_put_u32(&buf,
+                  (uint32_t)(e->playlist_entry - pl_first));
+            break;
+         }
+      }
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         explore_cache_put_u32(&buf, e->by[cat] ? e->by[cat]->idx + 1 : 0);
+
+      if (e->split)
+      {
+         explore_string_t **split;
+         for (split = e->split; *split; split++)
+         {
+            /* Values of the same category share a list */
+            for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+               if (     (*split)->idx < RBUF_LEN(state->by[cat])
+                     && state->by[cat][(*split)->idx] == *split)
+                  break;
+            explore_cache_put_u32(&buf, cat);
+            explore_cache_put_u32(&buf, (*split)->idx);
+         }
+      }
+      explore_cache_put_u32(&buf, EXPLORE_CAT_COUNT); /* terminator */
+   }
+
+   if (!filestream_write_file(path, buf, RBUF_LEN(buf)))
+      RARCH_WARN("[Explore]: Failed to write cache \"%s\".\n", path);
+
+   RBUF_FREE(buf);
+}
+
+/* Returns the entries of the playlists that did not change,
+ * 'complete' is set if no playlist changed. The databases
+ * recorded in the cache are added to 'rdb_files' */
+static explore_state_t *explore_cache_read(const char *path,
+      explore_cache_file_t *playlist_files,
+      explore_cache_file_t **rdb_files, bool *complete)
+{
+   size_t j;
+   unsigned cat;
+   uint32_t i, val, count;
+   explore_cache_reader_t r;
+   explore_string_t **split_buf = NULL;
+   int32_t *pl_map              = NULL;
+   void *data                   = NULL;
+   int64_t len                  = 0;
+   explore_state_t *state       = NULL;
+
+   if (     !path_is_valid(path)
+         || !filestream_read_file(path, &data, &len))
+      return NULL;
+
+   r.pos = (const uint8_t*)data;
+   r.end = r.pos + len;
+
+   if (     !explore_cache_get_u32(&r, &val) || val != EXPLORE_CACHE_MAGIC
+         || !explore_cache_get_u32(&r, &val) || val != EXPLORE_CACHE_VERSION)
+      goto error;
+
+   if (!(state = (explore_state_t*)calloc(1, sizeof(*state))))
+      goto error;
+
+   state->label_explore_item_str = msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
+
+   if (     !explore_cache_read_playlists(&r, playlist_files,
+               &state->playlists, &pl_map, complete)
+         || !explore_cache_read_rdbs(&r, rdb_files))
+      goto error;
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      if (     !explore_cache_get_u32(&r, &val)
+            || !explore_cache_get_u32(&r, &count))
+         goto error;
+
+      state->has_unknown[cat] = !!val;
+
+      for (i = 0; i != count; i++)
+      {
+         explore_string_t *entry;
+         const char *str = explore_cache_get_str(&r, &val);
+
+         if (!str)
+            goto error;
+
+         entry          = (explore_string_t*)ex_arena_alloc(
+               &state->arena, sizeof(explore_string_t) + val);
+         memcpy(entry->str, str, val + 1);
+         entry->entries = NULL;
+         entry->idx     = i;
+         RBUF_PUSH(state->by[cat], entry);
+      }
+   }
+
+   if (!explore_cache_get_u32(&r, &count))
+      goto error;
+
+   for (i = 0; i != count; i++)
+   {
+      uint32_t pl_idx, entry_idx;
+      explore_entry_t e;
+      playlist_t *playlist = NULL;
+
+      if (     !explore_cache_get_u32(&r, &pl_idx)
+            || !explore_cache_get_u32(&r, &entry_idx)
+            || pl_idx >= RBUF_LEN(pl_map))
+         goto error;
+
+      /* Entries of playlists that changed are skipped */
+      if (pl_map[pl_idx] >= 0)
+      {
+         playlist = state->playlists[pl_map[pl_idx]];
+
+         if (entry_idx >= playlist_size(playlist))
+            goto error;
+
+         playlist_get_index(playlist, entry_idx, &e.playlist_entry);
+
+         if (!e.playlist_entry->label || !*e.playlist_entry->label)
+            goto error;
+      }
+
+      e.split = NULL;
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      {
+         if (     !explore_cache_get_u32(&r, &val)
+               || val > RBUF_LEN(state->by[cat]))
+            goto error;
+         e.by[cat] = val ? state->by[cat][val - 1] : NULL;
+      }
+
+      for (;;)
+      {
+         uint32_t split_cat;
+         if (!explore_cache_get_u32(&r, &split_cat))
+            goto error;
+         if (split_cat == EXPLORE_CAT_COUNT)
+            break;
+         if (     split_cat > EXPLORE_CAT_COUNT
+               || !explore_cache_get_u32(&r, &val)
+               || val >= RBUF_LEN(state->by[split_cat]))
+            goto error;
+         RBUF_PUSH(split_buf, state->by[split_cat][val]);
+      }
+
+      if (!playlist)
+      {
+         RBUF_CLEAR(split_buf);
+         continue;
+      }
+
+      if (RBUF_LEN(split_buf))
+      {
+         size_t split_len;
+
+         RBUF_PUSH(split_buf, NULL); /* terminator */
+         split_len = RBUF_SIZEOF(split_buf);
+         e.split   = (explore_string_t **)
+            ex_arena_alloc(&state->arena, split_len);
+         memcpy(e.split, split_buf, split_len);
+         RBUF_CLEAR(split_buf);
+      }
+
+      RBUF_PUSH(state->entries, e);
+   }
+
+   RBUF_FREE(split_buf);
+   RBUF_FREE(pl_map);
+   free(data);
+   return state;
+
+error:
+   RBUF_FREE(split_buf);
+   RBUF_FREE(pl_map);
+   free(data);
+   if (state)
+   {
+      menu_explore_free_state(state);
+      free(state);
+   }
+   for (j = 0; j != RBUF_LEN(playlist_files); j++)
+   {
+      playlist_files[j].used   = false;
+      playlist_files[j].cached = false;
+   }
+   explore_cache_free_files(rdb_files);
+   return NULL;
+}
+
+/* Drops the values no entry has anymore, once the entries
+ * of the playlists that changed were dropped */
+static void explore_cache_prune_strings(explore_state_t *state)
+{
+   size_t i;
+   unsigned cat;
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      for (i = 0; i != RBUF_LEN(state->by[cat]); i++)
+         state->by[cat][i]->idx = 0;
+      state->has_unknown[cat] = false;
+   }
+
+   for (i = 0; i != RBUF_LEN(state->entries); i++)
+   {
+      explore_entry_t *e = &state->entries[i];
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      {
+         if (e->by[cat])
+            e->by[cat]->idx = 1;
+         else
+            state->has_unknown[cat] = true;
+      }
+
+      if (e->split)
+      {
+         explore_string_t **split;
+         for (split = e->split; *split; split++)
+            (*split)->idx = 1;
+      }
+   }
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      size_t len = 0;
+
+      for (i = 0; i != RBUF_LEN(state->by[cat]); i++)
+         if (state->by[cat][i]->idx)
+            state->by[cat][len++] = state->by[cat][i];
+
+      RBUF_RESIZE(state->by[cat], len);
+   }
+}
+#endif
+
 static void explore_unload_icons(explore_state_t *state)
 {
    unsigned i;
@@ -451,7 +1053,7 @@ static void explore_load_icons(explore_state_t *state)
 }
 
 explore_state_t *menu_explore_build_list(const char *directory_playlist,
-      const char *directory_database)
+      const char *directory_database, const char *directory_cache)
 {
    unsigned i;
    char tmp[PATH_MAX_LENGTH];
@@ -473,32 +1075,20 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
    explore_string_t **cat_maps[EXPLORE_CAT_COUNT] = {NULL};
    explore_string_t **split_buf                   = NULL;
    libretro_vfs_implementation_dir *dir           = NULL;
+#ifdef EXPLORE_CACHE
+   char cache_path[PATH_MAX_LENGTH];
+   bool cache_complete                            = false;
+   bool cache_read                                = false;
+#endif
+   explore_cache_file_t *playlist_files           = NULL;
+   explore_cache_file_t *rdb_files                = NULL;
+   explore_state_t *state                         = NULL;
 
-   explore_state_t *state = (explore_state_t*)calloc(1, sizeof(*state));
-
-   if (!state)
-      return NULL;
-
-   state->label_explore_item_str    = 
-      msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
-
-   /* Index all playlists */
+   /* List all playlists */
    for (dir = retro_vfs_opendir_impl(directory_playlist, false); dir;)
    {
-      playlist_config_t playlist_config;
-      size_t j, used_entries                    = 0;
-      playlist_t *playlist                      = NULL;
       const char *fext                          = NULL;
       const char *fname                         = NULL;
-      uint32_t fhash                            = 0;
-
-      playlist_config.path[0]                   = '\0';
-      playlist_config.base_content_directory[0] = '\0';
-      playlist_config.capacity                  = 0;
-      playlist_config.old_format                = false;
-      playlist_config.compress                  = false;
-      playlist_config.fuzzy_archive_match       = false;
-      playlist_config.autofix_paths             = false;
 
       if (!retro_vfs_readdir_impl(dir))
       {
@@ -513,9 +1103,81 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
       if (!fext || strcasecmp(fext, ".lpl"))
          continue;
 
-      fill_pathname_join_special(playlist_config.path,
-            directory_playlist, fname, sizeof(playlist_config.path));
-      playlist_config.capacity          = COLLECTION_SIZE;
+      fill_pathname_join_special(tmp,
+            directory_playlist, fname, sizeof(tmp));
+      explore_cache_add_file(&playlist_files, tmp);
+   }
+
+#ifdef EXPLORE_CACHE
+   if (string_is_empty(directory_cache))
+      *cache_path = '\0';
+   else
+      fill_pathname_join_special(cache_path, directory_cache,
+            FILE_PATH_EXPLORE_CACHE, sizeof(cache_path));
+
+   if (     *cache_path
+         && (state = explore_cache_read(cache_path, playlist_files,
+               &rdb_files, &cache_complete)))
+   {
+      unsigned cat;
+
+      cache_read = true;
+
+      if (cache_complete)
+      {
+         explore_cache_free_files(&playlist_files);
+         explore_cache_free_files(&rdb_files);
+         explore_build_index(state);
+         return state;
+      }
+
+      /* Values read from the cache are shared with the
+       * entries of the playlists indexed below */
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      {
+         for (i = 0; i != RBUF_LEN(state->by[cat]); i++)
+         {
+            explore_string_t *entry = state->by[cat][i];
+            RHMAP_SET(cat_maps[cat], ex_hash32_nocase_filtered(
+                     (unsigned char*)entry->str, strlen(entry->str),
+                     '0', 255), entry);
+         }
+      }
+   }
+#endif
+
+   if (!state && !(state = (explore_state_t*)calloc(1, sizeof(*state))))
+   {
+      explore_cache_free_files(&playlist_files);
+      return NULL;
+   }
+
+   state->label_explore_item_str    = 
+      msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
+
+   /* Index all playlists */
+   for (i = 0; i != RBUF_LEN(playlist_files); i++)
+   {
+      playlist_config_t playlist_config;
+      size_t j, used_entries                    = 0;
+      playlist_t *playlist                      = NULL;
+      const char *fname                         = path_basename(
+            playlist_files[i].path);
+      const char *fext                          = strrchr(fname, '.');
+      uint32_t fhash                            = 0;
+
+      /* Entries were read from the cache */
+      if (playlist_files[i].cached)
+         continue;
+
+      playlist_config.base_content_directory[0] = '\0';
+      playlist_config.capacity                  = COLLECTION_SIZE;
+      playlist_config.old_format                = false;
+      playlist_config.compress                  = false;
+      playlist_config.fuzzy_archive_match       = false;
+      playlist_config.autofix_paths             = false;
+      strlcpy(playlist_config.path, playlist_files[i].path,
+            sizeof(playlist_config.path));
       playlist                          = playlist_init(&playlist_config);
 
       fhash = ex_hash32_nocase_filtered(
@@ -583,6 +1245,8 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
                ext_path[3] = 'b';
             }
 
+            explore_cache_add_file(&rdb_files, tmp);
+
             if (libretrodb_open(tmp, newrdb.handle, false) != 0)
             {
                /* Invalid RDB file */
@@ -616,7 +1280,10 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
       }
 
       if (used_entries)
+      {
          RBUF_PUSH(state->playlists, playlist);
+         playlist_files[i].used = true;
+      }
       else
          playlist_free(playlist);
    }
@@ -631,10 +1298,12 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
       bool more                = 
          (
           libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
-          && libretrodb_cursor_read_item(cur, &item) == 0);
+          && libretrodb_cursor_read_item_borrowed(cur, &item) == 0);
 
-      for (; more; more = (rmsgpack_dom_value_free(&item),
-               libretrodb_cursor_read_item(cur, &item) == 0))
+      /* Items belong to the cursor, and are not copied
+       * out of the database when it is memory mapped */
+      for (; more; more = (
+               libretrodb_cursor_read_item_borrowed(cur, &item) == 0))
       {
          unsigned k, l, cat;
          explore_entry_t* e;
@@ -671,10 +1340,10 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
                      crc32 = *(uint8_t*)val->val.binary.buff;
                      break;
                   case 2:
-                     crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
+                     crc32 = retro_get_unaligned_16be(val->val.binary.buff);
                      break;
                   case 4:
-                     crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
+                     crc32 = retro_get_unaligned_32be(val->val.binary.buff);
                      break;
                   default:
                      crc32 = 0;
@@ -790,10 +1459,7 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
 
          /* if all entries have found connections, we can leave early */
          if (--rdb->count == 0)
-         {
-            rmsgpack_dom_value_free(&item);
             break;
-         }
       }
 
       libretrodb_cursor_close(cur);
@@ -807,6 +1473,11 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
    RHMAP_FREE(rdb_indices);
    RBUF_FREE(rdbs);
 
+#ifdef EXPLORE_CACHE
+   if (cache_read)
+      explore_cache_prune_strings(state);
+#endif
+
    for (i = 0; i != EXPLORE_CAT_COUNT; i++)
    {
       uint32_t idx;
@@ -827,6 +1498,15 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
       qsort(state->entries,
          RBUF_LEN(state->entries),
          sizeof(*state->entries), explore_qsort_func_entries);
+
+#ifdef EXPLORE_CACHE
+   if (*cache_path)
+      explore_cache_write(state, cache_path, playlist_files, rdb_files);
+#endif
+   explore_cache_free_files(&playlist_files);
+   explore_cache_free_files(&rdb_files);
+
+   explore_build_index(state);
    return state;
 }
 
@@ -1330,7 +2010,8 @@ unsigned menu_displaylist_explore(file_list_t *list, settings_t *settings)
       if (!menu_explore_init_in_progress(NULL))
          task_push_menu_explore_init(
                settings->paths.directory_playlist,
-               settings->paths.path_content_database);
+               settings->paths.path_content_database,
+               settings->paths.directory_cache);
 
       menu_entries_append(list,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_EXPLORE_INITIALISING_LIST),
@@ -1523,7 +2204,9 @@ unsigned menu_displaylist_explore(file_list_t *list, settings_t *settings)
          || (previous_type >= EXPLORE_TYPE_FIRSTCATEGORY
             && previous_type < EXPLORE_TYPE_FIRSTITEM))
    {
-      size_t first_list_entry;
+      size_t k, first_list_entry, num_candidates;
+      const uint32_t*    candidates       = NULL;
+      bool               use_candidates   = false;
       unsigned           view_levels      = state->view_levels;
       char*              view_search      = state->view_search;
       uint8_t*           view_op          = state->view_op;
@@ -1532,7 +2215,7 @@ unsigned menu_displaylist_explore(file_list_t *list, settings_t *settings)
       explore_string_t** view_match       = state->view_match;
       uint32_t*          view_idx_min     = state->view_idx_min;
       uint32_t*          view_idx_max     = state->view_idx_max;
-      explore_entry_t*   entries          = state->entries, *e, *eend;
+      explore_entry_t*   entries          = state->entries, *e;
       bool* map_filtered_category         = NULL;
       bool has_search                     = !!*view_search;
       bool is_show_all                    = (!view_levels && !has_search);
@@ -1591,9 +2274,32 @@ unsigned menu_displaylist_explore(file_list_t *list, settings_t *settings)
                explore_action_sublabel_spacer;
       }
 
+      /* Only visit the entries of the most selective
+       * filter, the others are checked for each entry */
+      if (has_search)
+         use_candidates = explore_search_candidates(state,
+               view_search, &candidates);
+
+      for (i = 0; i != view_levels; i++)
+      {
+         if (     view_op[i] == EXPLORE_OP_EQUAL
+               && view_match[i]
+               && (!use_candidates
+                  || RBUF_LEN(view_match[i]->entries) < RBUF_LEN(candidates)))
+         {
+            candidates     = view_match[i]->entries;
+            use_candidates = true;
+         }
+      }
+
+      num_candidates = use_candidates
+            ? RBUF_LEN(candidates) : RBUF_LEN(entries);
+
       first_list_entry = list->size;
-      for (e = entries, eend = RBUF_END(entries); e != eend; e++)
+      for (k = 0; k != num_candidates; k++)
       {
+         e = &entries[use_candidates ? candidates[k] : k];
+
          for (i = 0; i != view_levels; i++)
          {
             explore_string_t* eby = e->by[view_cats[i]];
@@ -1846,6 +2552,8 @@ void menu_explore_free_state(explore_state_t *state)
    unsigned i;
    if (!state)
       return;
+   explore_free_index(state);
+
    for (i = 0; i != EXPLORE_CAT_COUNT; i++)
       RBUF_FREE(state->by[i]);
 
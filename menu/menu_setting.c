@@ -27,6 +27,9 @@
 #include <string/stdstring.h>
 #include <lists/string_list.h>
 #include <streams/file_stream.h>
+#ifdef HAVE_ZLIB
+#include <streams/rzip_stream.h>
+#endif
 #include <audio/audio_resampler.h>
 
 #include <compat/strl.h>
@@ -115,6 +118,9 @@
 #include "../verbosity.h"
 #include "../playlist.h"
 #include "../manual_content_scan.h"
+#ifdef HAVE_LIBRETRODB
+#include "../libretro-db/libretrodb.h"
+#endif
 #include "../input/input_remapping.h"
 
 #include "../tasks/tasks_internal.h"
@@ -8257,6 +8263,20 @@ static void general_write_handler(rarch_setting_t *setting)
          }
          retroarch_override_setting_unset(RARCH_OVERRIDE_SETTING_LOG_TO_FILE, NULL);
          break;
+#if defined(HAVE_ZLIB)
+      case MENU_ENUM_LABEL_FILE_COMPRESSION_ZSTD:
+         if (!rzipstream_set_codec(settings->bools.file_compression_zstd
+                  ? RZIP_CODEC_ZSTD : RZIP_CODEC_ZLIB))
+            rzipstream_set_codec(RZIP_CODEC_ZLIB);
+         break;
+#endif
+      case MENU_ENUM_LABEL_CACHE_DIRECTORY:
+         playlist_set_cache_directory(settings->paths.directory_cache);
+#ifdef HAVE_LIBRETRODB
+         libretrodb_index_cache_set_directory(
+               settings->paths.directory_cache);
+#endif
+         break;
       case MENU_ENUM_LABEL_LOG_DIR:
       case MENU_ENUM_LABEL_LOG_TO_FILE_TIMESTAMP:
          if (verbosity_is_enabled() && is_logging_to_file())
@@ -11238,6 +11258,23 @@ static bool setting_append_list(
                   general_write_handler,
                   general_read_handler,
                   SD_FLAG_NONE);
+
+#if defined(HAVE_ZSTD)
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.file_compression_zstd,
+                  MENU_ENUM_LABEL_FILE_COMPRESSION_ZSTD,
+                  MENU_ENUM_LABEL_VALUE_FILE_COMPRESSION_ZSTD,
+                  DEFAULT_FILE_COMPRESSION_ZSTD,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
 #endif
 
             /* TODO/FIXME: This is in the wrong group... */
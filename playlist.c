@@ -15,6 +15,7 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -24,12 +25,29 @@
 #include <retro_miscellaneous.h>
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
+#include <string/string_pool.h>
 #include <streams/interface_stream.h>
+#include <streams/file_stream.h>
 #include <file/file_path.h>
 #include <file/archive_file.h>
+#include <lrc_hash.h>
 #include <lists/string_list.h>
 #include <formats/rjson.h>
 #include <array/rbuf.h>
+#include <array/rhmap.h>
+#include <queues/task_queue.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define PLAYLIST_IMAGE_MMAP
+#endif
 
 #include "playlist.h"
 #include "verbosity.h"
@@ -69,6 +87,14 @@ struct content_playlist
 
    struct playlist_entry *entries;
 
+   /* Binary image the entries were loaded from,
+    * see playlist_image_read() */
+   void *image;
+   size_t image_size;
+   /* Holds the strings shared by many entries,
+    * see playlist_intern_string() */
+   string_pool_t *strings;
+
    playlist_manual_scan_record_t scan_record; /* ptr alignment */
    playlist_config_t config;                  /* size_t alignment */
 
@@ -81,6 +107,7 @@ struct content_playlist
    bool old_format;
    bool compressed;
    bool cached_external;
+   bool image_mapped;
 };
 
 typedef struct
@@ -560,37 +587,61 @@ void playlist_get_index(playlist_t *playlist,
    *entry = &playlist->entries[idx];
 }
 
+/* Entry strings of a playlist loaded from its binary
+ * image point into the image, and are not freed */
+static void playlist_free_string(playlist_t *playlist, char *str)
+{
+   if (     playlist->image
+         && (str >= (char*)playlist->image)
+         && (str <  (char*)playlist->image + playlist->image_size))
+      return;
+   if (string_pool_contains(playlist->strings, str))
+      return;
+   free(str);
+}
+
+/* Core paths, core names and database names are the
+ * same for most entries: they are stored once in the
+ * string pool of the playlist, and freed along with it */
+static char *playlist_intern_string(playlist_t *playlist, const char *str)
+{
+   char *pooled = string_pool_intern(playlist->strings, str);
+   return pooled ? pooled : strdup(str);
+}
+
 /**
  * playlist_free_entry:
+ * @playlist            : Playlist handle.
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
    if (entry->path)
-      free(entry->path);
+      playlist_free_string(playlist, entry->path);
    if (entry->label)
-      free(entry->label);
+      playlist_free_string(playlist, entry->label);
    if (entry->core_path)
-      free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
    if (entry->core_name)
-      free(entry->core_name);
+      playlist_free_string(playlist, entry->core_name);
    if (entry->db_name)
-      free(entry->db_name);
+      playlist_free_string(playlist, entry->db_name);
    if (entry->crc32)
-      free(entry->crc32);
+      playlist_free_string(playlist, entry->crc32);
    if (entry->subsystem_ident)
-      free(entry->subsystem_ident);
+      playlist_free_string(playlist, entry->subsystem_ident);
    if (entry->subsystem_name)
-      free(entry->subsystem_name);
+      playlist_free_string(playlist, entry->subsystem_name);
    if (entry->runtime_str)
-      free(entry->runtime_str);
+      playlist_free_string(playlist, entry->runtime_str);
    if (entry->last_played_str)
-      free(entry->last_played_str);
+      playlist_free_string(playlist, entry->last_played_str);
    if (entry->subsystem_roms)
       string_list_free(entry->subsystem_roms);
    if (entry->path_id)
@@ -644,7 +695,7 @@ void playlist_delete_index(playlist_t *playlist,
    /* Free unwanted entry */
    entry_to_delete = (struct playlist_entry *)(playlist->entries + idx);
    if (entry_to_delete)
-      playlist_free_entry(entry_to_delete);
+      playlist_free_entry(playlist, entry_to_delete);
 
    /* Shift remaining entries to fill the gap */
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
@@ -759,7 +810,7 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->path && (update_entry->path != entry->path))
    {
       if (entry->path)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -774,7 +825,7 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->label && (update_entry->label != entry->label))
    {
       if (entry->label)
-         free(entry->label);
+         playlist_free_string(playlist, entry->label);
       entry->label       = strdup(update_entry->label);
       playlist->modified = true;
    }
@@ -782,32 +833,32 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
       if (entry->core_path)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
-      entry->core_path   = strdup(update_entry->core_path);
+      entry->core_path   = playlist_intern_string(playlist, update_entry->core_path);
       playlist->modified = true;
    }
 
    if (update_entry->core_name && (update_entry->core_name != entry->core_name))
    {
       if (entry->core_name)
-         free(entry->core_name);
-      entry->core_name   = strdup(update_entry->core_name);
+         playlist_free_string(playlist, entry->core_name);
+      entry->core_name   = playlist_intern_string(playlist, update_entry->core_name);
       playlist->modified = true;
    }
 
    if (update_entry->db_name && (update_entry->db_name != entry->db_name))
    {
       if (entry->db_name)
-         free(entry->db_name);
-      entry->db_name     = strdup(update_entry->db_name);
+         playlist_free_string(playlist, entry->db_name);
+      entry->db_name     = playlist_intern_string(playlist, update_entry->db_name);
       playlist->modified = true;
    }
 
    if (update_entry->crc32 && (update_entry->crc32 != entry->crc32))
    {
       if (entry->crc32)
-         free(entry->crc32);
+         playlist_free_string(playlist, entry->crc32);
       entry->crc32       = strdup(update_entry->crc32);
       playlist->modified = true;
    }
@@ -827,7 +878,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (update_entry->path && (update_entry->path != entry->path))
    {
       if (entry->path)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -842,9 +893,9 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
       if (entry->core_path)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
-      entry->core_path   = strdup(update_entry->core_path);
+      entry->core_path   = playlist_intern_string(playlist, update_entry->core_path);
       playlist->modified = playlist->modified || register_update;
    }
 
@@ -911,7 +962,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (update_entry->runtime_str && (update_entry->runtime_str != entry->runtime_str))
    {
       if (entry->runtime_str)
-         free(entry->runtime_str);
+         playlist_free_string(playlist, entry->runtime_str);
       entry->runtime_str = NULL;
       entry->runtime_str = strdup(update_entry->runtime_str);
       playlist->modified = playlist->modified || register_update;
@@ -920,7 +971,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (update_entry->last_played_str && (update_entry->last_played_str != entry->last_played_str))
    {
       if (entry->last_played_str)
-         free(entry->last_played_str);
+         playlist_free_string(playlist, entry->last_played_str);
       entry->last_played_str = NULL;
       entry->last_played_str = strdup(update_entry->last_played_str);
       playlist->modified = playlist->modified || register_update;
@@ -998,7 +1049,7 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1023,7 +1074,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       path_id                                 = NULL;
 
       if (!string_is_empty(real_core_path))
-         playlist->entries[0].core_path       = strdup(real_core_path);
+         playlist->entries[0].core_path       = playlist_intern_string(playlist, real_core_path);
 
       playlist->entries[0].runtime_status     = entry->runtime_status;
       playlist->entries[0].runtime_hours      = entry->runtime_hours;
@@ -1352,7 +1403,7 @@ bool playlist_push(playlist_t *playlist,
       if (     !playlist->entries[i].db_name 
             && !string_is_empty(entry->db_name))
       {
-         playlist->entries[i].db_name     = strdup(entry->db_name);
+         playlist->entries[i].db_name     = playlist_intern_string(playlist, entry->db_name);
          entry_updated                    = true;
       }
 
@@ -1381,7 +1432,7 @@ bool playlist_push(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1430,11 +1481,11 @@ bool playlist_push(playlist_t *playlist,
       if (!string_is_empty(entry->label))
          playlist->entries[0].label           = strdup(entry->label);
       if (!string_is_empty(real_core_path))
-         playlist->entries[0].core_path       = strdup(real_core_path);
+         playlist->entries[0].core_path       = playlist_intern_string(playlist, real_core_path);
       if (!string_is_empty(core_name))
-         playlist->entries[0].core_name       = strdup(core_name);
+         playlist->entries[0].core_name       = playlist_intern_string(playlist, core_name);
       if (!string_is_empty(entry->db_name))
-         playlist->entries[0].db_name         = strdup(entry->db_name);
+         playlist->entries[0].db_name         = playlist_intern_string(playlist, entry->db_name);
       if (!string_is_empty(entry->crc32))
          playlist->entries[0].crc32           = strdup(entry->crc32);
       if (!string_is_empty(entry->subsystem_ident))
@@ -1465,6 +1516,560 @@ error:
    return false;
 }
 
+/* Binary playlist image
+ * > Every playlist is also stored as a flat binary
+ *   image in the cache directory, named after its JSON
+ *   file: a header, fixed-size entry records, and a
+ *   table of (shared) strings. Without a cache directory,
+ *   playlists are only read from JSON.
+ *   As long as the JSON file is unchanged, the image
+ *   is loaded instead - memory-mapped when possible -
+ *   and the entry strings point straight into it
+ * > The image only holds the entries that fitted into
+ *   the playlist capacity it was made with, so it is
+ *   only used with that same capacity */
+#define PLAYLIST_IMAGE_MAGIC   0x42504C52 /* "RLPB" */
+#define PLAYLIST_IMAGE_VERSION 2
+
+enum playlist_image_flags
+{
+   PLAYLIST_IMAGE_FLAG_OLD_FORMAT         = (1 << 0),
+   PLAYLIST_IMAGE_FLAG_COMPRESSED         = (1 << 1),
+   PLAYLIST_IMAGE_FLAG_SEARCH_RECURSIVELY = (1 << 2),
+   PLAYLIST_IMAGE_FLAG_SEARCH_ARCHIVES    = (1 << 3),
+   PLAYLIST_IMAGE_FLAG_FILTER_DAT_CONTENT = (1 << 4),
+   PLAYLIST_IMAGE_FLAG_OVERWRITE_PLAYLIST = (1 << 5)
+};
+
+enum playlist_image_meta
+{
+   PLAYLIST_IMAGE_META_DEFAULT_CORE_PATH = 0,
+   PLAYLIST_IMAGE_META_DEFAULT_CORE_NAME,
+   PLAYLIST_IMAGE_META_BASE_CONTENT_DIRECTORY,
+   PLAYLIST_IMAGE_META_SCAN_CONTENT_DIR,
+   PLAYLIST_IMAGE_META_SCAN_FILE_EXTS,
+   PLAYLIST_IMAGE_META_SCAN_DAT_FILE_PATH,
+   PLAYLIST_IMAGE_META_COUNT
+};
+
+enum playlist_image_string
+{
+   PLAYLIST_IMAGE_STR_PATH = 0,
+   PLAYLIST_IMAGE_STR_LABEL,
+   PLAYLIST_IMAGE_STR_CORE_PATH,
+   PLAYLIST_IMAGE_STR_CORE_NAME,
+   PLAYLIST_IMAGE_STR_DB_NAME,
+   PLAYLIST_IMAGE_STR_CRC32,
+   PLAYLIST_IMAGE_STR_SUBSYSTEM_IDENT,
+   PLAYLIST_IMAGE_STR_SUBSYSTEM_NAME,
+   PLAYLIST_IMAGE_STR_RUNTIME,
+   PLAYLIST_IMAGE_STR_LAST_PLAYED,
+   PLAYLIST_IMAGE_STR_COUNT
+};
+
+typedef struct
+{
+   int64_t source_mtime; /* JSON file the image was made from */
+   int64_t source_size;
+   uint32_t magic;
+   uint32_t version;
+   uint32_t num_entries;
+   uint32_t capacity;    /* Playlist capacity at the time */
+   uint32_t num_roms;
+   uint32_t strings_size;
+   uint32_t meta[PLAYLIST_IMAGE_META_COUNT];
+   uint32_t label_display_mode;
+   uint32_t right_thumbnail_mode;
+   uint32_t left_thumbnail_mode;
+   uint32_t sort_mode;
+   uint32_t flags;
+} playlist_image_header_t;
+
+/* Strings are offsets into the string table,
+ * 0 being NULL */
+typedef struct
+{
+   uint32_t str[PLAYLIST_IMAGE_STR_COUNT];
+   uint32_t first_rom; /* Index of the first subsystem rom offset */
+   uint32_t num_roms;
+   uint32_t entry_slot;
+   uint32_t runtime_hours;
+   uint32_t runtime_minutes;
+   uint32_t runtime_seconds;
+   uint32_t last_played_year;
+   uint32_t last_played_month;
+   uint32_t last_played_day;
+   uint32_t last_played_hour;
+   uint32_t last_played_minute;
+   uint32_t last_played_second;
+   uint32_t runtime_status;
+} playlist_image_entry_t;
+
+typedef struct
+{
+   char *strings;       /* rbuf */
+   uint32_t *offsets;   /* rhmap: string -> offset */
+} playlist_image_strtab_t;
+
+#define PLAYLIST_IMAGE_CACHE_DIR "playlists"
+
+static char playlist_image_cache_dir[PATH_MAX_LENGTH];
+
+void playlist_set_cache_directory(const char *path)
+{
+   if (string_is_empty(path))
+      *playlist_image_cache_dir = '\0';
+   else
+      fill_pathname_join_special(playlist_image_cache_dir, path,
+            PLAYLIST_IMAGE_CACHE_DIR, sizeof(playlist_image_cache_dir));
+}
+
+/* Images are named after the JSON file, and the hash of
+ * its path tells apart playlists of the same name
+ * in different directories.
+ * Returns false if there is no cache directory. */
+static bool playlist_image_get_path(const char *path,
+      char *s, size_t len)
+{
+   size_t _len;
+   char name[NAME_MAX_LENGTH];
+
+   if (string_is_empty(playlist_image_cache_dir))
+      return false;
+
+   fill_pathname_base(name, path, sizeof(name));
+   path_remove_extension(name);
+
+   _len  = fill_pathname_join_special(s, playlist_image_cache_dir,
+         name, len);
+   _len += snprintf(s + _len, len - _len, "-%08x",
+         (unsigned)fnv1a_calculate(FNV1A_INIT, path, strlen(path)));
+   strlcpy(s + _len, FILE_PATH_LPB_EXTENSION, len - _len);
+   return true;
+}
+
+static uint32_t playlist_image_add_string(
+      playlist_image_strtab_t *strtab, const char *str)
+{
+   size_t len;
+   uint32_t offset;
+
+   if (string_is_empty(str))
+      return 0;
+
+   /* Core paths, core names and database names are
+    * the same for most entries */
+   if ((offset = RHMAP_GET_STR(strtab->offsets, str)))
+      return offset;
+
+   offset = (uint32_t)RBUF_LEN(strtab->strings);
+   len    = strlen(str) + 1;
+   RBUF_RESIZE(strtab->strings, offset + len);
+   memcpy(strtab->strings + offset, str, len);
+   RHMAP_SET_STR(strtab->offsets, str, offset);
+   return offset;
+}
+
+/* Writes 'data' to a temporary file and renames it over
+ * 'path': readers never see a partial file, and mappings
+ * of the previous file remain valid */
+static bool playlist_replace_file(const char *path,
+      const void *data, int64_t len)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   RFILE *file  = NULL;
+   bool success = false;
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if ((file = filestream_open(tmp_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      success = (filestream_write(file, data, len) == len);
+      success = (filestream_close(file) == 0) && success;
+   }
+
+   if (success)
+      return filestream_replace(tmp_path, path) == 0;
+
+   filestream_delete(tmp_path);
+   return false;
+}
+
+/**
+ * playlist_image_build:
+ * @playlist            : Playlist handle.
+ * @len                 : Size of the returned image.
+ *
+ * Returns: binary image of the playlist, to be stamped
+ * and written by playlist_image_save(), or NULL.
+ **/
+static uint8_t *playlist_image_build(playlist_t *playlist, size_t *len)
+{
+   size_t i;
+   playlist_image_header_t header;
+   playlist_image_strtab_t strtab   = {NULL, NULL};
+   playlist_image_entry_t *records  = NULL;
+   uint32_t *roms                   = NULL;
+   uint8_t *image                   = NULL;
+   size_t num_entries               = RBUF_LEN(playlist->entries);
+
+   if (!(records = (playlist_image_entry_t*)calloc(num_entries + 1,
+               sizeof(*records))))
+      return NULL;
+
+   memset(&header, 0, sizeof(header));
+   RBUF_PUSH(strtab.strings, '\0');
+
+   for (i = 0; i < num_entries; i++)
+   {
+      const struct playlist_entry *entry = &playlist->entries[i];
+      playlist_image_entry_t *record     = &records[i];
+
+      record->str[PLAYLIST_IMAGE_STR_PATH]            = playlist_image_add_string(&strtab, entry->path);
+      record->str[PLAYLIST_IMAGE_STR_LABEL]           = playlist_image_add_string(&strtab, entry->label);
+      record->str[PLAYLIST_IMAGE_STR_CORE_PATH]       = playlist_image_add_string(&strtab, entry->core_path);
+      record->str[PLAYLIST_IMAGE_STR_CORE_NAME]       = playlist_image_add_string(&strtab, entry->core_name);
+      record->str[PLAYLIST_IMAGE_STR_DB_NAME]         = playlist_image_add_string(&strtab, entry->db_name);
+      record->str[PLAYLIST_IMAGE_STR_CRC32]           = playlist_image_add_string(&strtab, entry->crc32);
+      record->str[PLAYLIST_IMAGE_STR_SUBSYSTEM_IDENT] = playlist_image_add_string(&strtab, entry->subsystem_ident);
+      record->str[PLAYLIST_IMAGE_STR_SUBSYSTEM_NAME]  = playlist_image_add_string(&strtab, entry->subsystem_name);
+      record->str[PLAYLIST_IMAGE_STR_RUNTIME]         = playlist_image_add_string(&strtab, entry->runtime_str);
+      record->str[PLAYLIST_IMAGE_STR_LAST_PLAYED]     = playlist_image_add_string(&strtab, entry->last_played_str);
+
+      record->first_rom          = (uint32_t)RBUF_LEN(roms);
+      if (entry->subsystem_roms)
+      {
+         size_t j;
+         for (j = 0; j < entry->subsystem_roms->size; j++)
+            RBUF_PUSH(roms, playlist_image_add_string(&strtab,
+                     entry->subsystem_roms->elems[j].data));
+      }
+      record->num_roms           = (uint32_t)RBUF_LEN(roms) - record->first_rom;
+
+      record->entry_slot         = entry->entry_slot;
+      record->runtime_hours      = entry->runtime_hours;
+      record->runtime_minutes    = entry->runtime_minutes;
+      record->runtime_seconds    = entry->runtime_seconds;
+      record->last_played_year   = entry->last_played_year;
+      record->last_played_month  = entry->last_played_month;
+      record->last_played_day    = entry->last_played_day;
+      record->last_played_hour   = entry->last_played_hour;
+      record->last_played_minute = entry->last_played_minute;
+      record->last_played_second = entry->last_played_second;
+      record->runtime_status     = entry->runtime_status;
+   }
+
+   header.magic                = PLAYLIST_IMAGE_MAGIC;
+   header.version              = PLAYLIST_IMAGE_VERSION;
+   header.num_entries          = (uint32_t)num_entries;
+   header.capacity             = (uint32_t)playlist->config.capacity;
+   header.num_roms             = (uint32_t)RBUF_LEN(roms);
+   header.meta[PLAYLIST_IMAGE_META_DEFAULT_CORE_PATH]      =
+      playlist_image_add_string(&strtab, playlist->default_core_path);
+   header.meta[PLAYLIST_IMAGE_META_DEFAULT_CORE_NAME]      =
+      playlist_image_add_string(&strtab, playlist->default_core_name);
+   header.meta[PLAYLIST_IMAGE_META_BASE_CONTENT_DIRECTORY] =
+      playlist_image_add_string(&strtab, playlist->base_content_directory);
+   header.meta[PLAYLIST_IMAGE_META_SCAN_CONTENT_DIR]       =
+      playlist_image_add_string(&strtab, playlist->scan_record.content_dir);
+   header.meta[PLAYLIST_IMAGE_META_SCAN_FILE_EXTS]         =
+      playlist_image_add_string(&strtab, playlist->scan_record.file_exts);
+   header.meta[PLAYLIST_IMAGE_META_SCAN_DAT_FILE_PATH]     =
+      playlist_image_add_string(&strtab, playlist->scan_record.dat_file_path);
+   header.strings_size         = (uint32_t)RBUF_LEN(strtab.strings);
+   header.label_display_mode   = playlist->label_display_mode;
+   header.right_thumbnail_mode = playlist->right_thumbnail_mode;
+   header.left_thumbnail_mode  = playlist->left_thumbnail_mode;
+   header.sort_mode            = playlist->sort_mode;
+   if (playlist->old_format)
+      header.flags            |= PLAYLIST_IMAGE_FLAG_OLD_FORMAT;
+   if (playlist->compressed)
+      header.flags            |= PLAYLIST_IMAGE_FLAG_COMPRESSED;
+   if (playlist->scan_record.search_recursively)
+      header.flags            |= PLAYLIST_IMAGE_FLAG_SEARCH_RECURSIVELY;
+   if (playlist->scan_record.search_archives)
+      header.flags            |= PLAYLIST_IMAGE_FLAG_SEARCH_ARCHIVES;
+   if (playlist->scan_record.filter_dat_content)
+      header.flags            |= PLAYLIST_IMAGE_FLAG_FILTER_DAT_CONTENT;
+   if (playlist->scan_record.overwrite_playlist)
+      header.flags            |= PLAYLIST_IMAGE_FLAG_OVERWRITE_PLAYLIST;
+
+   *len = sizeof(header) + num_entries * sizeof(*records)
+      + RBUF_SIZEOF(roms) + header.strings_size;
+
+   if ((image = (uint8_t*)malloc(*len)))
+   {
+      uint8_t *pos = image;
+      memcpy(pos, &header, sizeof(header));
+      pos += sizeof(header);
+      memcpy(pos, records, num_entries * sizeof(*records));
+      pos += num_entries * sizeof(*records);
+      if (roms)
+         memcpy(pos, roms, RBUF_SIZEOF(roms));
+      pos += RBUF_SIZEOF(roms);
+      memcpy(pos, strtab.strings, header.strings_size);
+   }
+
+   free(records);
+   RBUF_FREE(roms);
+   RBUF_FREE(strtab.strings);
+   RHMAP_FREE(strtab.offsets);
+   return image;
+}
+
+/**
+ * playlist_image_save:
+ * @json_path           : Path of the JSON playlist file.
+ * @image               : Image returned by playlist_image_build().
+ * @len                 : Size of the image.
+ *
+ * Stamps the image with the JSON file as currently
+ * on disk, and writes it.
+ **/
+static void playlist_image_save(const char *json_path,
+      uint8_t *image, size_t len)
+{
+   char path[PATH_MAX_LENGTH];
+   playlist_image_header_t *header = (playlist_image_header_t*)image;
+
+   if (     !playlist_image_get_path(json_path, path, sizeof(path))
+         || !path_mkdir(playlist_image_cache_dir))
+      return;
+
+   header->source_mtime = path_get_mtime(json_path);
+   header->source_size  = path_get_size(json_path);
+
+   /* Cannot tell whether the image is up to date */
+   if (     header->source_mtime <= 0
+         || header->source_size  <  0
+         || !playlist_replace_file(path, image, (int64_t)len))
+      filestream_delete(path);
+}
+
+/**
+ * playlist_image_write:
+ * @playlist            : Playlist handle.
+ *
+ * Writes the binary image of the playlist, which
+ * must match the JSON file currently on disk.
+ **/
+static void playlist_image_write(playlist_t *playlist)
+{
+   size_t len;
+   uint8_t *image = playlist_image_build(playlist, &len);
+
+   if (image)
+   {
+      playlist_image_save(playlist->config.path, image, len);
+      free(image);
+   }
+}
+
+static void playlist_image_free(playlist_t *playlist)
+{
+   if (!playlist->image)
+      return;
+#if defined(PLAYLIST_IMAGE_MMAP)
+   if (playlist->image_mapped)
+      munmap(playlist->image, playlist->image_size);
+   else
+#endif
+      free(playlist->image);
+   playlist->image        = NULL;
+   playlist->image_size   = 0;
+   playlist->image_mapped = false;
+}
+
+static char *playlist_image_strdup(const char *strings, uint32_t offset)
+{
+   return offset ? strdup(strings + offset) : NULL;
+}
+
+/**
+ * playlist_image_read:
+ * @playlist            : Playlist handle.
+ *
+ * Loads the playlist from its binary image,
+ * if it is up to date with the JSON file.
+ *
+ * Returns: true if the playlist was loaded.
+ **/
+static bool playlist_image_read(playlist_t *playlist)
+{
+   size_t i;
+   char path[PATH_MAX_LENGTH];
+   const playlist_image_header_t *header = NULL;
+   const playlist_image_entry_t *records = NULL;
+   const uint32_t *roms                  = NULL;
+   char *strings                         = NULL;
+   int64_t source_mtime                  = path_get_mtime(playlist->config.path);
+   int64_t size                          = 0;
+
+   if (     source_mtime <= 0
+         || !playlist_image_get_path(playlist->config.path,
+               path, sizeof(path)))
+      return false;
+
+#if defined(PLAYLIST_IMAGE_MMAP)
+   {
+      struct stat st;
+      int fd = open(path, O_RDONLY);
+
+      if (fd < 0)
+         return false;
+
+      if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(*header))
+      {
+         void *image = mmap(NULL, (size_t)st.st_size,
+               PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+         if (image != MAP_FAILED)
+         {
+            playlist->image        = image;
+            playlist->image_mapped = true;
+            size                   = st.st_size;
+         }
+      }
+      close(fd);
+   }
+#else
+   if (     !path_is_valid(path)
+         || !filestream_read_file(path, &playlist->image, &size))
+      playlist->image = NULL;
+#endif
+
+   if (!playlist->image)
+      return false;
+
+   playlist->image_size = (size_t)size;
+   header               = (const playlist_image_header_t*)playlist->image;
+
+   if (     (size_t)size < sizeof(*header)
+         || header->magic        != PLAYLIST_IMAGE_MAGIC
+         || header->version      != PLAYLIST_IMAGE_VERSION
+         || header->source_mtime != source_mtime
+         || header->source_size  != path_get_size(playlist->config.path)
+         || header->capacity     != (uint32_t)playlist->config.capacity
+         || header->num_entries  >  playlist->config.capacity
+         || header->strings_size <  1
+         || (uint64_t)size != sizeof(*header)
+            + (uint64_t)header->num_entries * sizeof(*records)
+            + (uint64_t)header->num_roms    * sizeof(*roms)
+            +           header->strings_size)
+      goto error;
+
+   records = (const playlist_image_entry_t*)(header + 1);
+   roms    = (const uint32_t*)(records + header->num_entries);
+   strings = (char*)(roms + header->num_roms);
+
+   /* Every offset below 'strings_size' is then
+    * a valid string */
+   if (strings[header->strings_size - 1] != '\0')
+      goto error;
+
+   for (i = 0; i < PLAYLIST_IMAGE_META_COUNT; i++)
+      if (header->meta[i] >= header->strings_size)
+         goto error;
+
+   for (i = 0; i < header->num_roms; i++)
+      if (roms[i] >= header->strings_size)
+         goto error;
+
+   if (!RBUF_TRYFIT(playlist->entries, header->num_entries))
+      goto error;
+
+   for (i = 0; i < header->num_entries; i++)
+   {
+      size_t j;
+      const playlist_image_entry_t *record = &records[i];
+      struct playlist_entry *entry         = &playlist->entries[i];
+
+      for (j = 0; j < PLAYLIST_IMAGE_STR_COUNT; j++)
+         if (record->str[j] >= header->strings_size)
+            break;
+
+      if (     j != PLAYLIST_IMAGE_STR_COUNT
+            || record->first_rom > header->num_roms
+            || record->num_roms  > header->num_roms - record->first_rom)
+         break;
+
+      memset(entry, 0, sizeof(*entry));
+      entry->path               = record->str[PLAYLIST_IMAGE_STR_PATH]            ? strings + record->str[PLAYLIST_IMAGE_STR_PATH]            : NULL;
+      entry->label              = record->str[PLAYLIST_IMAGE_STR_LABEL]           ? strings + record->str[PLAYLIST_IMAGE_STR_LABEL]           : NULL;
+      entry->core_path          = record->str[PLAYLIST_IMAGE_STR_CORE_PATH]       ? strings + record->str[PLAYLIST_IMAGE_STR_CORE_PATH]       : NULL;
+      entry->core_name          = record->str[PLAYLIST_IMAGE_STR_CORE_NAME]       ? strings + record->str[PLAYLIST_IMAGE_STR_CORE_NAME]       : NULL;
+      entry->db_name            = record->str[PLAYLIST_IMAGE_STR_DB_NAME]         ? strings + record->str[PLAYLIST_IMAGE_STR_DB_NAME]         : NULL;
+      entry->crc32              = record->str[PLAYLIST_IMAGE_STR_CRC32]           ? strings + record->str[PLAYLIST_IMAGE_STR_CRC32]           : NULL;
+      entry->subsystem_ident    = record->str[PLAYLIST_IMAGE_STR_SUBSYSTEM_IDENT] ? strings + record->str[PLAYLIST_IMAGE_STR_SUBSYSTEM_IDENT] : NULL;
+      entry->subsystem_name     = record->str[PLAYLIST_IMAGE_STR_SUBSYSTEM_NAME]  ? strings + record->str[PLAYLIST_IMAGE_STR_SUBSYSTEM_NAME]  : NULL;
+      entry->runtime_str        = record->str[PLAYLIST_IMAGE_STR_RUNTIME]         ? strings + record->str[PLAYLIST_IMAGE_STR_RUNTIME]         : NULL;
+      entry->last_played_str    = record->str[PLAYLIST_IMAGE_STR_LAST_PLAYED]     ? strings + record->str[PLAYLIST_IMAGE_STR_LAST_PLAYED]     : NULL;
+      entry->entry_slot         = record->entry_slot;
+      entry->runtime_hours      = record->runtime_hours;
+      entry->runtime_minutes    = record->runtime_minutes;
+      entry->runtime_seconds    = record->runtime_seconds;
+      entry->last_played_year   = record->last_played_year;
+      entry->last_played_month  = record->last_played_month;
+      entry->last_played_day    = record->last_played_day;
+      entry->last_played_hour   = record->last_played_hour;
+      entry->last_played_minute = record->last_played_minute;
+      entry->last_played_second = record->last_played_second;
+      entry->runtime_status     = (enum playlist_runtime_status)record->runtime_status;
+
+      if (record->num_roms)
+      {
+         union string_list_elem_attr attr = {0};
+
+         if (!(entry->subsystem_roms = string_list_new()))
+            break;
+
+         for (j = 0; j < record->num_roms; j++)
+            string_list_append(entry->subsystem_roms,
+                  strings + roms[record->first_rom + j], attr);
+      }
+
+      RBUF_RESIZE(playlist->entries, i + 1);
+   }
+
+   if (i != header->num_entries)
+      goto error;
+
+   playlist->default_core_path             = playlist_image_strdup(strings,
+         header->meta[PLAYLIST_IMAGE_META_DEFAULT_CORE_PATH]);
+   playlist->default_core_name             = playlist_image_strdup(strings,
+         header->meta[PLAYLIST_IMAGE_META_DEFAULT_CORE_NAME]);
+   playlist->base_content_directory        = playlist_image_strdup(strings,
+         header->meta[PLAYLIST_IMAGE_META_BASE_CONTENT_DIRECTORY]);
+   playlist->scan_record.content_dir       = playlist_image_strdup(strings,
+         header->meta[PLAYLIST_IMAGE_META_SCAN_CONTENT_DIR]);
+   playlist->scan_record.file_exts         = playlist_image_strdup(strings,
+         header->meta[PLAYLIST_IMAGE_META_SCAN_FILE_EXTS]);
+   playlist->scan_record.dat_file_path     = playlist_image_strdup(strings,
+         header->meta[PLAYLIST_IMAGE_META_SCAN_DAT_FILE_PATH]);
+   playlist->label_display_mode            = (enum playlist_label_display_mode)header->label_display_mode;
+   playlist->right_thumbnail_mode          = (enum playlist_thumbnail_mode)header->right_thumbnail_mode;
+   playlist->left_thumbnail_mode           = (enum playlist_thumbnail_mode)header->left_thumbnail_mode;
+   playlist->sort_mode                     = (enum playlist_sort_mode)header->sort_mode;
+   playlist->old_format                    = !!(header->flags & PLAYLIST_IMAGE_FLAG_OLD_FORMAT);
+   playlist->compressed                    = !!(header->flags & PLAYLIST_IMAGE_FLAG_COMPRESSED);
+   playlist->scan_record.search_recursively = !!(header->flags & PLAYLIST_IMAGE_FLAG_SEARCH_RECURSIVELY);
+   playlist->scan_record.search_archives    = !!(header->flags & PLAYLIST_IMAGE_FLAG_SEARCH_ARCHIVES);
+   playlist->scan_record.filter_dat_content = !!(header->flags & PLAYLIST_IMAGE_FLAG_FILTER_DAT_CONTENT);
+   playlist->scan_record.overwrite_playlist = !!(header->flags & PLAYLIST_IMAGE_FLAG_OVERWRITE_PLAYLIST);
+
+   return true;
+
+error:
+   /* Entry strings point into the image, free
+    * the entries while it is still there */
+   playlist_clear(playlist);
+   RBUF_FREE(playlist->entries);
+   playlist_image_free(playlist);
+   return false;
+}
+
 void playlist_write_runtime_file(playlist_t *playlist)
 {
    size_t i, len;
@@ -1620,379 +2225,517 @@ void playlist_write_runtime_file(playlist_t *playlist)
 end:
    intfstream_close(file);
    free(file);
-}
 
-void playlist_write_file(playlist_t *playlist)
-{
-   size_t i, len;
-   intfstream_t *file = NULL;
-   bool compressed    = false;
+   if (!playlist->modified)
+      playlist_image_write(playlist);
+}
 
-   /* Playlist will be written if any of the
-    * following are true:
-    * > 'modified' flag is set
-    * > Current playlist format (old/new) does not
-    *   match requested
-    * > Current playlist compression status does
-    *   not match requested */
-   if (!playlist ||
-       !(playlist->modified ||
-#if defined(HAVE_ZLIB)
-        (playlist->compressed != playlist->config.compress) ||
+/* History and favourites playlists are rewritten every
+ * time an entry is pushed: these writes are deferred to
+ * a background task, so that the caller does not wait for
+ * the disk, and coalesced, so that a playlist modified
+ * several times within the delay is only written once */
+#define PLAYLIST_DEFERRED_WRITE_DELAY 2000000 /* usec */
+
+#ifdef HAVE_THREADS
+#define PLAYLIST_DEFERRED_LOCK(lock) \
+   if (playlist_deferred_st.lock) slock_lock(playlist_deferred_st.lock)
+#define PLAYLIST_DEFERRED_UNLOCK(lock) \
+   if (playlist_deferred_st.lock) slock_unlock(playlist_deferred_st.lock)
+#else
+#define PLAYLIST_DEFERRED_LOCK(lock)
+#define PLAYLIST_DEFERRED_UNLOCK(lock)
 #endif
-        (playlist->old_format != playlist->config.old_format)))
-      return;
 
-#if defined(HAVE_ZLIB)
-   if (playlist->config.compress)
-      file = intfstream_open_rzip_file(playlist->config.path,
-            RETRO_VFS_FILE_ACCESS_WRITE);
-   else
+typedef struct playlist_deferred_write
+{
+   char *path;
+   char *json;
+   uint8_t *image; /* May be NULL */
+   size_t json_len;
+   size_t image_len;
+} playlist_deferred_write_t;
+
+typedef struct playlist_deferred_state
+{
+   playlist_deferred_write_t **pending; /* RBUF */
+#ifdef HAVE_THREADS
+   slock_t *pending_lock;
+   /* Held while playlist files are written, so that
+    * a deferred write and a direct one never overlap */
+   slock_t *file_lock;
 #endif
-      file = intfstream_open_file(playlist->config.path,
-            RETRO_VFS_FILE_ACCESS_WRITE,
-            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   unsigned requested;
+   unsigned written;
+   bool inited;
+} playlist_deferred_state_t;
 
-   if (!file)
+static playlist_deferred_state_t playlist_deferred_st;
+
+static void playlist_deferred_write_free(playlist_deferred_write_t *item)
+{
+   free(item->path);
+   free(item->json);
+   free(item->image);
+   free(item);
+}
+
+/* Removes the pending write of 'path' from the queue */
+static playlist_deferred_write_t *playlist_deferred_take(const char *path)
+{
+   size_t i;
+   playlist_deferred_write_t *item = NULL;
+
+   PLAYLIST_DEFERRED_LOCK(pending_lock);
+   for (i = 0; i < RBUF_LEN(playlist_deferred_st.pending); i++)
    {
-      RARCH_ERR("Failed to write to playlist file: \"%s\".\n", playlist->config.path);
-      return;
+      if (string_is_equal(playlist_deferred_st.pending[i]->path, path))
+      {
+         item = playlist_deferred_st.pending[i];
+         RBUF_REMOVE(playlist_deferred_st.pending, i);
+         break;
+      }
    }
+   PLAYLIST_DEFERRED_UNLOCK(pending_lock);
 
-   /* Get current file compression state */
-   compressed = intfstream_is_compressed(file);
+   return item;
+}
 
-#ifdef RARCH_INTERNAL
-   if (playlist->config.old_format)
+/* Must be called with 'file_lock' held */
+static void playlist_deferred_commit(playlist_deferred_write_t *item)
+{
+   char image_path[PATH_MAX_LENGTH];
+
+   playlist_deferred_st.written++;
+
+   if (!playlist_replace_file(item->path, item->json,
+            (int64_t)item->json_len))
    {
-      for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-         intfstream_printf(file, "%s\n%s\n%s\n%s\n%s\n%s\n",
-               playlist->entries[i].path      ? playlist->entries[i].path      : "",
-               playlist->entries[i].label     ? playlist->entries[i].label     : "",
-               playlist->entries[i].core_path ? playlist->entries[i].core_path : "",
-               playlist->entries[i].core_name ? playlist->entries[i].core_name : "",
-               playlist->entries[i].crc32     ? playlist->entries[i].crc32     : "",
-               playlist->entries[i].db_name   ? playlist->entries[i].db_name   : ""
-               );
+      RARCH_ERR("Failed to write to playlist file: \"%s\".\n", item->path);
+      return;
+   }
 
-      /* Add metadata lines
-       * > We add these at the end of the file to prevent
-       *   breakage if the playlist is loaded with an older
-       *   version of RetroArch */
-      intfstream_printf(
-            file,
-            "default_core_path = \"%s\"\n"
-            "default_core_name = \"%s\"\n"
-            "label_display_mode = \"%d\"\n"
-            "thumbnail_mode = \"%d|%d\"\n"
-            "sort_mode = \"%d\"\n",
-            playlist->default_core_path ? playlist->default_core_path : "",
-            playlist->default_core_name ? playlist->default_core_name : "",
-            playlist->label_display_mode,
-            playlist->right_thumbnail_mode, playlist->left_thumbnail_mode,
-            playlist->sort_mode);
+   RARCH_LOG("[Playlist]: Written to playlist file: \"%s\".\n", item->path);
 
-      playlist->old_format = true;
+   if (item->image)
+      playlist_image_save(item->path, item->image, item->image_len);
+   else if (playlist_image_get_path(item->path,
+            image_path, sizeof(image_path)))
+      filestream_delete(image_path);
+}
+
+static void playlist_deferred_flush_path(const char *path)
+{
+   playlist_deferred_write_t *item = NULL;
+
+   if (!playlist_deferred_st.inited)
+      return;
+
+   PLAYLIST_DEFERRED_LOCK(file_lock);
+   if ((item = playlist_deferred_take(path)))
+   {
+      playlist_deferred_commit(item);
+      playlist_deferred_write_free(item);
    }
-   else
-#endif
+   PLAYLIST_DEFERRED_UNLOCK(file_lock);
+}
+
+static void task_playlist_deferred_write_handler(retro_task_t *task)
+{
+   if (task)
    {
-      rjsonwriter_t* writer = rjsonwriter_open_stream(file);
-      if (!writer)
-      {
-         RARCH_ERR("Failed to create JSON writer\n");
-         goto end;
-      }
-      /*  When compressing playlists, human readability
-       *   is not a factor - can skip all indentation
-       *   and new line characters */
-      if (compressed)
-         rjsonwriter_set_options(writer, RJSONWRITER_OPTION_SKIP_WHITESPACE);
+      if (task->state)
+         playlist_deferred_flush_path((const char*)task->state);
+      task_set_progress(task, 100);
+      task_set_finished(task, true);
+   }
+}
 
-      rjsonwriter_raw(writer, "{", 1);
-      rjsonwriter_raw(writer, "\n", 1);
+static void task_playlist_deferred_write_free(retro_task_t *task)
+{
+   if (task)
+      free(task->state);
+}
+
+static void playlist_write_json(playlist_t *playlist,
+      rjsonwriter_t *writer)
+{
+   size_t i, len;
+
+   rjsonwriter_raw(writer, "{", 1);
+   rjsonwriter_raw(writer, "\n", 1);
+
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "version");
+   rjsonwriter_raw(writer, ":", 1);
+   rjsonwriter_raw(writer, " ", 1);
+   rjsonwriter_add_string(writer, "1.5");
+   rjsonwriter_raw(writer, ",", 1);
+   rjsonwriter_raw(writer, "\n", 1);
+
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "default_core_path");
+   rjsonwriter_raw(writer, ":", 1);
+   rjsonwriter_raw(writer, " ", 1);
+   rjsonwriter_add_string(writer, playlist->default_core_path);
+   rjsonwriter_raw(writer, ",", 1);
+   rjsonwriter_raw(writer, "\n", 1);
+
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "default_core_name");
+   rjsonwriter_raw(writer, ":", 1);
+   rjsonwriter_raw(writer, " ", 1);
+   rjsonwriter_add_string(writer, playlist->default_core_name);
+   rjsonwriter_raw(writer, ",", 1);
+   rjsonwriter_raw(writer, "\n", 1);
 
+   if (!string_is_empty(playlist->base_content_directory))
+   {
       rjsonwriter_add_spaces(writer, 2);
-      rjsonwriter_add_string(writer, "version");
+      rjsonwriter_add_string(writer, "base_content_directory");
       rjsonwriter_raw(writer, ":", 1);
       rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, "1.5");
+      rjsonwriter_add_string(writer, playlist->base_content_directory);
       rjsonwriter_raw(writer, ",", 1);
       rjsonwriter_raw(writer, "\n", 1);
+   }
+
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "label_display_mode");
+   rjsonwriter_raw(writer, ":", 1);
+   rjsonwriter_raw(writer, " ", 1);
+   rjsonwriter_rawf(writer, "%d", (int)playlist->label_display_mode);
+   rjsonwriter_raw(writer, ",", 1);
+   rjsonwriter_raw(writer, "\n", 1);
+
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "right_thumbnail_mode");
+   rjsonwriter_raw(writer, ":", 1);
+   rjsonwriter_raw(writer, " ", 1);
+   rjsonwriter_rawf(writer, "%d", (int)playlist->right_thumbnail_mode);
+   rjsonwriter_raw(writer, ",", 1);
+   rjsonwriter_raw(writer, "\n", 1);
+
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "left_thumbnail_mode");
+   rjsonwriter_raw(writer, ":", 1);
+   rjsonwriter_raw(writer, " ", 1);
+   rjsonwriter_rawf(writer, "%d", (int)playlist->left_thumbnail_mode);
+   rjsonwriter_raw(writer, ",", 1);
+   rjsonwriter_raw(writer, "\n", 1);
+
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "sort_mode");
+   rjsonwriter_raw(writer, ":", 1);
+   rjsonwriter_raw(writer, " ", 1);
+   rjsonwriter_rawf(writer, "%d", (int)playlist->sort_mode);
+   rjsonwriter_raw(writer, ",", 1);
+   rjsonwriter_raw(writer, "\n", 1);
 
+   if (!string_is_empty(playlist->scan_record.content_dir))
+   {
       rjsonwriter_add_spaces(writer, 2);
-      rjsonwriter_add_string(writer, "default_core_path");
+      rjsonwriter_add_string(writer, "scan_content_dir");
       rjsonwriter_raw(writer, ":", 1);
       rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, playlist->default_core_path);
+      rjsonwriter_add_string(writer, playlist->scan_record.content_dir);
       rjsonwriter_raw(writer, ",", 1);
       rjsonwriter_raw(writer, "\n", 1);
 
       rjsonwriter_add_spaces(writer, 2);
-      rjsonwriter_add_string(writer, "default_core_name");
+      rjsonwriter_add_string(writer, "scan_file_exts");
       rjsonwriter_raw(writer, ":", 1);
       rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, playlist->default_core_name);
+      rjsonwriter_add_string(writer, playlist->scan_record.file_exts);
       rjsonwriter_raw(writer, ",", 1);
       rjsonwriter_raw(writer, "\n", 1);
 
-      if (!string_is_empty(playlist->base_content_directory))
-      {
-         rjsonwriter_add_spaces(writer, 2);
-         rjsonwriter_add_string(writer, "base_content_directory");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->base_content_directory);
-         rjsonwriter_raw(writer, ",", 1);
-         rjsonwriter_raw(writer, "\n", 1);
-      }
-
       rjsonwriter_add_spaces(writer, 2);
-      rjsonwriter_add_string(writer, "label_display_mode");
+      rjsonwriter_add_string(writer, "scan_dat_file_path");
       rjsonwriter_raw(writer, ":", 1);
       rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_rawf(writer, "%d", (int)playlist->label_display_mode);
+      rjsonwriter_add_string(writer, playlist->scan_record.dat_file_path);
       rjsonwriter_raw(writer, ",", 1);
       rjsonwriter_raw(writer, "\n", 1);
 
       rjsonwriter_add_spaces(writer, 2);
-      rjsonwriter_add_string(writer, "right_thumbnail_mode");
+      rjsonwriter_add_string(writer, "scan_search_recursively");
       rjsonwriter_raw(writer, ":", 1);
       rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_rawf(writer, "%d", (int)playlist->right_thumbnail_mode);
+      {
+         bool value = playlist->scan_record.search_recursively;
+         rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
+      }
       rjsonwriter_raw(writer, ",", 1);
       rjsonwriter_raw(writer, "\n", 1);
 
       rjsonwriter_add_spaces(writer, 2);
-      rjsonwriter_add_string(writer, "left_thumbnail_mode");
+      rjsonwriter_add_string(writer, "scan_search_archives");
       rjsonwriter_raw(writer, ":", 1);
       rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_rawf(writer, "%d", (int)playlist->left_thumbnail_mode);
+      {
+         bool value = playlist->scan_record.search_archives;
+         rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
+      }
       rjsonwriter_raw(writer, ",", 1);
       rjsonwriter_raw(writer, "\n", 1);
 
       rjsonwriter_add_spaces(writer, 2);
-      rjsonwriter_add_string(writer, "sort_mode");
+      rjsonwriter_add_string(writer, "scan_filter_dat_content");
       rjsonwriter_raw(writer, ":", 1);
       rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_rawf(writer, "%d", (int)playlist->sort_mode);
+      {
+         bool value = playlist->scan_record.filter_dat_content;
+         rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
+      }
       rjsonwriter_raw(writer, ",", 1);
       rjsonwriter_raw(writer, "\n", 1);
 
-      if (!string_is_empty(playlist->scan_record.content_dir))
+      rjsonwriter_add_spaces(writer, 2);
+      rjsonwriter_add_string(writer, "scan_overwrite_playlist");
+      rjsonwriter_raw(writer, ":", 1);
+      rjsonwriter_raw(writer, " ", 1);
       {
-         rjsonwriter_add_spaces(writer, 2);
-         rjsonwriter_add_string(writer, "scan_content_dir");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->scan_record.content_dir);
-         rjsonwriter_raw(writer, ",", 1);
-         rjsonwriter_raw(writer, "\n", 1);
-
-         rjsonwriter_add_spaces(writer, 2);
-         rjsonwriter_add_string(writer, "scan_file_exts");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->scan_record.file_exts);
-         rjsonwriter_raw(writer, ",", 1);
-         rjsonwriter_raw(writer, "\n", 1);
+         bool value = playlist->scan_record.overwrite_playlist;
+         rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
+      }
+      rjsonwriter_raw(writer, ",", 1);
+      rjsonwriter_raw(writer, "\n", 1);
+   }
 
-         rjsonwriter_add_spaces(writer, 2);
-         rjsonwriter_add_string(writer, "scan_dat_file_path");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->scan_record.dat_file_path);
-         rjsonwriter_raw(writer, ",", 1);
-         rjsonwriter_raw(writer, "\n", 1);
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "items");
+   rjsonwriter_raw(writer, ":", 1);
+   rjsonwriter_raw(writer, " ", 1);
+   rjsonwriter_raw(writer, "[", 1);
+   rjsonwriter_raw(writer, "\n", 1);
 
-         rjsonwriter_add_spaces(writer, 2);
-         rjsonwriter_add_string(writer, "scan_search_recursively");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         {
-            bool value = playlist->scan_record.search_recursively;
-            rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
-         }
-         rjsonwriter_raw(writer, ",", 1);
-         rjsonwriter_raw(writer, "\n", 1);
+   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+   {
+      rjsonwriter_add_spaces(writer, 4);
+      rjsonwriter_raw(writer, "{", 1);
 
-         rjsonwriter_add_spaces(writer, 2);
-         rjsonwriter_add_string(writer, "scan_search_archives");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         {
-            bool value = playlist->scan_record.search_archives;
-            rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
-         }
-         rjsonwriter_raw(writer, ",", 1);
-         rjsonwriter_raw(writer, "\n", 1);
+      rjsonwriter_raw(writer, "\n", 1);
+      rjsonwriter_add_spaces(writer, 6);
+      rjsonwriter_add_string(writer, "path");
+      rjsonwriter_raw(writer, ":", 1);
+      rjsonwriter_raw(writer, " ", 1);
+      rjsonwriter_add_string(writer, playlist->entries[i].path);
+      rjsonwriter_raw(writer, ",", 1);
 
-         rjsonwriter_add_spaces(writer, 2);
-         rjsonwriter_add_string(writer, "scan_filter_dat_content");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         {
-            bool value = playlist->scan_record.filter_dat_content;
-            rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
-         }
-         rjsonwriter_raw(writer, ",", 1);
+      if (playlist->entries[i].entry_slot)
+      {
          rjsonwriter_raw(writer, "\n", 1);
-
-         rjsonwriter_add_spaces(writer, 2);
-         rjsonwriter_add_string(writer, "scan_overwrite_playlist");
+         rjsonwriter_add_spaces(writer, 6);
+         rjsonwriter_add_string(writer, "entry_slot");
          rjsonwriter_raw(writer, ":", 1);
          rjsonwriter_raw(writer, " ", 1);
-         {
-            bool value = playlist->scan_record.overwrite_playlist;
-            rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
-         }
+         rjsonwriter_rawf(writer, "%d", (int)playlist->entries[i].entry_slot);
          rjsonwriter_raw(writer, ",", 1);
-         rjsonwriter_raw(writer, "\n", 1);
       }
 
-      rjsonwriter_add_spaces(writer, 2);
-      rjsonwriter_add_string(writer, "items");
+      rjsonwriter_raw(writer, "\n", 1);
+      rjsonwriter_add_spaces(writer, 6);
+      rjsonwriter_add_string(writer, "label");
       rjsonwriter_raw(writer, ":", 1);
       rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_raw(writer, "[", 1);
+      rjsonwriter_add_string(writer, playlist->entries[i].label);
+      rjsonwriter_raw(writer, ",", 1);
+
       rjsonwriter_raw(writer, "\n", 1);
+      rjsonwriter_add_spaces(writer, 6);
+      rjsonwriter_add_string(writer, "core_path");
+      rjsonwriter_raw(writer, ":", 1);
+      rjsonwriter_raw(writer, " ", 1);
+      rjsonwriter_add_string(writer, playlist->entries[i].core_path);
+      rjsonwriter_raw(writer, ",", 1);
 
-      for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-      {
-         rjsonwriter_add_spaces(writer, 4);
-         rjsonwriter_raw(writer, "{", 1);
+      rjsonwriter_raw(writer, "\n", 1);
+      rjsonwriter_add_spaces(writer, 6);
+      rjsonwriter_add_string(writer, "core_name");
+      rjsonwriter_raw(writer, ":", 1);
+      rjsonwriter_raw(writer, " ", 1);
+      rjsonwriter_add_string(writer, playlist->entries[i].core_name);
+      rjsonwriter_raw(writer, ",", 1);
 
-         rjsonwriter_raw(writer, "\n", 1);
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "path");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->entries[i].path);
-         rjsonwriter_raw(writer, ",", 1);
+      rjsonwriter_raw(writer, "\n", 1);
+      rjsonwriter_add_spaces(writer, 6);
+      rjsonwriter_add_string(writer, "crc32");
+      rjsonwriter_raw(writer, ":", 1);
+      rjsonwriter_raw(writer, " ", 1);
+      rjsonwriter_add_string(writer, playlist->entries[i].crc32);
+      rjsonwriter_raw(writer, ",", 1);
 
-         if (playlist->entries[i].entry_slot)
-         {
-            rjsonwriter_raw(writer, "\n", 1);
-            rjsonwriter_add_spaces(writer, 6);
-            rjsonwriter_add_string(writer, "entry_slot");
-            rjsonwriter_raw(writer, ":", 1);
-            rjsonwriter_raw(writer, " ", 1);
-            rjsonwriter_rawf(writer, "%d", (int)playlist->entries[i].entry_slot);
-            rjsonwriter_raw(writer, ",", 1);
-         }
+      rjsonwriter_raw(writer, "\n", 1);
+      rjsonwriter_add_spaces(writer, 6);
+      rjsonwriter_add_string(writer, "db_name");
+      rjsonwriter_raw(writer, ":", 1);
+      rjsonwriter_raw(writer, " ", 1);
+      rjsonwriter_add_string(writer, playlist->entries[i].db_name);
 
+      if (!string_is_empty(playlist->entries[i].subsystem_ident))
+      {
+         rjsonwriter_raw(writer, ",", 1);
          rjsonwriter_raw(writer, "\n", 1);
          rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "label");
+         rjsonwriter_add_string(writer, "subsystem_ident");
          rjsonwriter_raw(writer, ":", 1);
          rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->entries[i].label);
-         rjsonwriter_raw(writer, ",", 1);
+         rjsonwriter_add_string(writer, playlist->entries[i].subsystem_ident);
+      }
 
+      if (!string_is_empty(playlist->entries[i].subsystem_name))
+      {
+         rjsonwriter_raw(writer, ",", 1);
          rjsonwriter_raw(writer, "\n", 1);
          rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "core_path");
+         rjsonwriter_add_string(writer, "subsystem_name");
          rjsonwriter_raw(writer, ":", 1);
          rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->entries[i].core_path);
-         rjsonwriter_raw(writer, ",", 1);
+         rjsonwriter_add_string(writer, playlist->entries[i].subsystem_name);
+      }
 
+      if (  playlist->entries[i].subsystem_roms &&
+            playlist->entries[i].subsystem_roms->size > 0)
+      {
+         unsigned j;
+
+         rjsonwriter_raw(writer, ",", 1);
          rjsonwriter_raw(writer, "\n", 1);
          rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "core_name");
+         rjsonwriter_add_string(writer, "subsystem_roms");
          rjsonwriter_raw(writer, ":", 1);
          rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->entries[i].core_name);
-         rjsonwriter_raw(writer, ",", 1);
+         rjsonwriter_raw(writer, "[", 1);
+         rjsonwriter_raw(writer, "\n", 1);
+
+         for (j = 0; j < playlist->entries[i].subsystem_roms->size; j++)
+         {
+            const struct string_list *roms = playlist->entries[i].subsystem_roms;
+            rjsonwriter_add_spaces(writer, 8);
+            rjsonwriter_add_string(writer,
+                  !string_is_empty(roms->elems[j].data)
+                  ? roms->elems[j].data
+                  : "");
+
+            if (j < playlist->entries[i].subsystem_roms->size - 1)
+            {
+               rjsonwriter_raw(writer, ",", 1);
+               rjsonwriter_raw(writer, "\n", 1);
+            }
+         }
 
          rjsonwriter_raw(writer, "\n", 1);
          rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "crc32");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->entries[i].crc32);
+         rjsonwriter_raw(writer, "]", 1);
+      }
+
+      rjsonwriter_raw(writer, "\n", 1);
+
+      rjsonwriter_add_spaces(writer, 4);
+      rjsonwriter_raw(writer, "}", 1);
+
+      if (i < len - 1)
          rjsonwriter_raw(writer, ",", 1);
 
-         rjsonwriter_raw(writer, "\n", 1);
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "db_name");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_add_string(writer, playlist->entries[i].db_name);
+      rjsonwriter_raw(writer, "\n", 1);
+   }
 
-         if (!string_is_empty(playlist->entries[i].subsystem_ident))
-         {
-            rjsonwriter_raw(writer, ",", 1);
-            rjsonwriter_raw(writer, "\n", 1);
-            rjsonwriter_add_spaces(writer, 6);
-            rjsonwriter_add_string(writer, "subsystem_ident");
-            rjsonwriter_raw(writer, ":", 1);
-            rjsonwriter_raw(writer, " ", 1);
-            rjsonwriter_add_string(writer, playlist->entries[i].subsystem_ident);
-         }
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_raw(writer, "]", 1);
+   rjsonwriter_raw(writer, "\n", 1);
+   rjsonwriter_raw(writer, "}", 1);
+   rjsonwriter_raw(writer, "\n", 1);
+}
 
-         if (!string_is_empty(playlist->entries[i].subsystem_name))
-         {
-            rjsonwriter_raw(writer, ",", 1);
-            rjsonwriter_raw(writer, "\n", 1);
-            rjsonwriter_add_spaces(writer, 6);
-            rjsonwriter_add_string(writer, "subsystem_name");
-            rjsonwriter_raw(writer, ":", 1);
-            rjsonwriter_raw(writer, " ", 1);
-            rjsonwriter_add_string(writer, playlist->entries[i].subsystem_name);
-         }
+static void playlist_write_file_internal(playlist_t *playlist)
+{
+   size_t i, len;
+   intfstream_t *file = NULL;
+   bool compressed    = false;
 
-         if (  playlist->entries[i].subsystem_roms &&
-               playlist->entries[i].subsystem_roms->size > 0)
-         {
-            unsigned j;
-
-            rjsonwriter_raw(writer, ",", 1);
-            rjsonwriter_raw(writer, "\n", 1);
-            rjsonwriter_add_spaces(writer, 6);
-            rjsonwriter_add_string(writer, "subsystem_roms");
-            rjsonwriter_raw(writer, ":", 1);
-            rjsonwriter_raw(writer, " ", 1);
-            rjsonwriter_raw(writer, "[", 1);
-            rjsonwriter_raw(writer, "\n", 1);
-
-            for (j = 0; j < playlist->entries[i].subsystem_roms->size; j++)
-            {
-               const struct string_list *roms = playlist->entries[i].subsystem_roms;
-               rjsonwriter_add_spaces(writer, 8);
-               rjsonwriter_add_string(writer,
-                     !string_is_empty(roms->elems[j].data)
-                     ? roms->elems[j].data
-                     : "");
-
-               if (j < playlist->entries[i].subsystem_roms->size - 1)
-               {
-                  rjsonwriter_raw(writer, ",", 1);
-                  rjsonwriter_raw(writer, "\n", 1);
-               }
-            }
+   /* Playlist will be written if any of the
+    * following are true:
+    * > 'modified' flag is set
+    * > Current playlist format (old/new) does not
+    *   match requested
+    * > Current playlist compression status does
+    *   not match requested */
+   if (!playlist ||
+       !(playlist->modified ||
+#if defined(HAVE_ZLIB)
+        (playlist->compressed != playlist->config.compress) ||
+#endif
+        (playlist->old_format != playlist->config.old_format)))
+      return;
 
-            rjsonwriter_raw(writer, "\n", 1);
-            rjsonwriter_add_spaces(writer, 6);
-            rjsonwriter_raw(writer, "]", 1);
-         }
+#if defined(HAVE_ZLIB)
+   if (playlist->config.compress)
+      file = intfstream_open_rzip_file(playlist->config.path,
+            RETRO_VFS_FILE_ACCESS_WRITE);
+   else
+#endif
+      file = intfstream_open_file(playlist->config.path,
+            RETRO_VFS_FILE_ACCESS_WRITE,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
-         rjsonwriter_raw(writer, "\n", 1);
+   if (!file)
+   {
+      RARCH_ERR("Failed to write to playlist file: \"%s\".\n", playlist->config.path);
+      return;
+   }
 
-         rjsonwriter_add_spaces(writer, 4);
-         rjsonwriter_raw(writer, "}", 1);
+   /* Get current file compression state */
+   compressed = intfstream_is_compressed(file);
 
-         if (i < len - 1)
-            rjsonwriter_raw(writer, ",", 1);
+#ifdef RARCH_INTERNAL
+   if (playlist->config.old_format)
+   {
+      for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+         intfstream_printf(file, "%s\n%s\n%s\n%s\n%s\n%s\n",
+               playlist->entries[i].path      ? playlist->entries[i].path      : "",
+               playlist->entries[i].label     ? playlist->entries[i].label     : "",
+               playlist->entries[i].core_path ? playlist->entries[i].core_path : "",
+               playlist->entries[i].core_name ? playlist->entries[i].core_name : "",
+               playlist->entries[i].crc32     ? playlist->entries[i].crc32     : "",
+               playlist->entries[i].db_name   ? playlist->entries[i].db_name   : ""
+               );
 
-         rjsonwriter_raw(writer, "\n", 1);
+      /* Add metadata lines
+       * > We add these at the end of the file to prevent
+       *   breakage if the playlist is loaded with an older
+       *   version of RetroArch */
+      intfstream_printf(
+            file,
+            "default_core_path = \"%s\"\n"
+            "default_core_name = \"%s\"\n"
+            "label_display_mode = \"%d\"\n"
+            "thumbnail_mode = \"%d|%d\"\n"
+            "sort_mode = \"%d\"\n",
+            playlist->default_core_path ? playlist->default_core_path : "",
+            playlist->default_core_name ? playlist->default_core_name : "",
+            playlist->label_display_mode,
+            playlist->right_thumbnail_mode, playlist->left_thumbnail_mode,
+            playlist->sort_mode);
+
+      playlist->old_format = true;
+   }
+   else
+#endif
+   {
+      rjsonwriter_t* writer = rjsonwriter_open_stream(file);
+      if (!writer)
+      {
+         RARCH_ERR("Failed to create JSON writer\n");
+         goto end;
       }
+      /*  When compressing playlists, human readability
+       *   is not a factor - can skip all indentation
+       *   and new line characters */
+      if (compressed)
+         rjsonwriter_set_options(writer, RJSONWRITER_OPTION_SKIP_WHITESPACE);
 
-      rjsonwriter_add_spaces(writer, 2);
-      rjsonwriter_raw(writer, "]", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-      rjsonwriter_raw(writer, "}", 1);
-      rjsonwriter_raw(writer, "\n", 1);
+      playlist_write_json(playlist, writer);
 
       if (!rjsonwriter_free(writer))
       {
@@ -2009,6 +2752,187 @@ void playlist_write_file(playlist_t *playlist)
 end:
    intfstream_close(file);
    free(file);
+
+   if (!playlist->modified)
+      playlist_image_write(playlist);
+}
+
+void playlist_write_file(playlist_t *playlist)
+{
+   playlist_deferred_write_t *item = NULL;
+
+   if (!playlist)
+      return;
+
+   PLAYLIST_DEFERRED_LOCK(file_lock);
+
+   /* A pending deferred write is superseded by this
+    * one, unless there is nothing newer to write */
+   if ((item = playlist_deferred_take(playlist->config.path)))
+   {
+      if (!playlist->modified)
+         playlist_deferred_commit(item);
+      playlist_deferred_write_free(item);
+   }
+
+   playlist_write_file_internal(playlist);
+
+   PLAYLIST_DEFERRED_UNLOCK(file_lock);
+}
+
+void playlist_write_file_deferred(playlist_t *playlist)
+{
+   size_t i;
+   int len;
+   const char *json                = NULL;
+   rjsonwriter_t *writer           = NULL;
+   playlist_deferred_write_t *item = NULL;
+   retro_task_t *task              = NULL;
+
+   if (!playlist || !playlist->modified)
+      return;
+
+   /* Compressed and old format playlists are
+    * always written directly */
+   if (     !playlist_deferred_st.inited
+#if defined(HAVE_ZLIB)
+         || playlist->config.compress
+#endif
+         || playlist->config.old_format)
+   {
+      playlist_write_file(playlist);
+      return;
+   }
+
+   if (!(item = (playlist_deferred_write_t*)calloc(1, sizeof(*item))))
+   {
+      playlist_write_file(playlist);
+      return;
+   }
+
+   /* Serialise now, so that the playlist can keep
+    * being modified while the task waits */
+   if ((writer = rjsonwriter_open_memory()))
+   {
+      playlist_write_json(playlist, writer);
+      if ((json = rjsonwriter_get_memory_buffer(writer, &len))
+            && (item->json = (char*)malloc(len)))
+      {
+         memcpy(item->json, json, len);
+         item->json_len = (size_t)len;
+      }
+      rjsonwriter_free(writer);
+   }
+
+   if (!item->json || !(item->path = strdup(playlist->config.path)))
+   {
+      playlist_deferred_write_free(item);
+      playlist_write_file(playlist);
+      return;
+   }
+
+   item->image          = playlist_image_build(playlist, &item->image_len);
+
+   playlist->modified   = false;
+   playlist->old_format = false;
+   playlist->compressed = false;
+
+   PLAYLIST_DEFERRED_LOCK(pending_lock);
+   playlist_deferred_st.requested++;
+
+   /* Replace the data of a write still pending
+    * for the same file */
+   for (i = 0; i < RBUF_LEN(playlist_deferred_st.pending); i++)
+   {
+      if (string_is_equal(playlist_deferred_st.pending[i]->path, item->path))
+      {
+         playlist_deferred_write_free(playlist_deferred_st.pending[i]);
+         playlist_deferred_st.pending[i] = item;
+         item                            = NULL;
+         break;
+      }
+   }
+
+   if (item)
+      RBUF_PUSH(playlist_deferred_st.pending, item);
+   PLAYLIST_DEFERRED_UNLOCK(pending_lock);
+
+   if (!item)
+      return;
+
+   if (!(task = task_init()) || !(task->state = strdup(item->path)))
+   {
+      free(task);
+      playlist_deferred_flush_path(playlist->config.path);
+      return;
+   }
+
+   /* Configure task
+    * > Note: This is silent task, with no title
+    *   and no user notification messages */
+   task->handler  = task_playlist_deferred_write_handler;
+   task->cleanup  = task_playlist_deferred_write_free;
+   task->mute     = true;
+   task->title    = NULL;
+   task->progress = 0;
+   task->when     = cpu_features_get_time_usec()
+      + PLAYLIST_DEFERRED_WRITE_DELAY;
+
+   task_queue_push(task);
+}
+
+void playlist_deferred_writes_init(void)
+{
+   if (playlist_deferred_st.inited)
+      return;
+
+#ifdef HAVE_THREADS
+   if (     !(playlist_deferred_st.pending_lock = slock_new())
+         || !(playlist_deferred_st.file_lock    = slock_new()))
+   {
+      if (playlist_deferred_st.pending_lock)
+         slock_free(playlist_deferred_st.pending_lock);
+      playlist_deferred_st.pending_lock = NULL;
+      return;
+   }
+#endif
+
+   playlist_deferred_st.inited = true;
+}
+
+void playlist_deferred_writes_flush(void)
+{
+   size_t i;
+
+   if (!playlist_deferred_st.inited)
+      return;
+
+   for (i = 0; i < RBUF_LEN(playlist_deferred_st.pending); i++)
+   {
+      playlist_deferred_commit(playlist_deferred_st.pending[i]);
+      playlist_deferred_write_free(playlist_deferred_st.pending[i]);
+   }
+
+   RBUF_CLEAR(playlist_deferred_st.pending);
+}
+
+void playlist_deferred_writes_deinit(void)
+{
+   if (!playlist_deferred_st.inited)
+      return;
+
+   playlist_deferred_writes_flush();
+
+   if (playlist_deferred_st.requested)
+      RARCH_LOG("[Playlist]: Deferred writes: %u requested, %u performed.\n",
+            playlist_deferred_st.requested, playlist_deferred_st.written);
+
+   RBUF_FREE(playlist_deferred_st.pending);
+#ifdef HAVE_THREADS
+   slock_free(playlist_deferred_st.pending_lock);
+   slock_free(playlist_deferred_st.file_lock);
+#endif
+   memset(&playlist_deferred_st, 0, sizeof(playlist_deferred_st));
 }
 
 /**
@@ -2055,12 +2979,15 @@ void playlist_free(playlist_t *playlist)
          struct playlist_entry *entry = &playlist->entries[i];
 
          if (entry)
-            playlist_free_entry(entry);
+            playlist_free_entry(playlist, entry);
       }
 
       RBUF_FREE(playlist->entries);
    }
 
+   playlist_image_free(playlist);
+   string_pool_free(playlist->strings);
+
    free(playlist);
 }
 
@@ -2081,7 +3008,7 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
    RBUF_CLEAR(playlist->entries);
 }
@@ -2233,9 +3160,19 @@ static bool JSONStringHandler(void *context, const char *pValue, size_t length)
                && length 
                && !string_is_empty(pValue))
          {
+            struct playlist_entry *entry = pCtx->current_entry;
+
             if (*pCtx->current_string_val)
-                free(*pCtx->current_string_val);
-             *pCtx->current_string_val = strdup(pValue);
+               playlist_free_string(pCtx->playlist,
+                     *pCtx->current_string_val);
+
+            if (     pCtx->current_string_val == &entry->core_path
+                  || pCtx->current_string_val == &entry->core_name
+                  || pCtx->current_string_val == &entry->db_name)
+               *pCtx->current_string_val = playlist_intern_string(
+                     pCtx->playlist, pValue);
+            else
+               *pCtx->current_string_val = strdup(pValue);
          }
       }
    }
@@ -2476,15 +3413,20 @@ static bool playlist_read_file(playlist_t *playlist)
    unsigned i;
    int test_char;
    bool res             = true;
+   intfstream_t *file   = NULL;
+
+   /* A write of this playlist may still be pending */
+   playlist_deferred_flush_path(playlist->config.path);
+
 #if defined(HAVE_ZLIB)
-      /* Always use RZIP interface when reading playlists
-       * > this will automatically handle uncompressed
-       *   data */
-   intfstream_t *file   = intfstream_open_rzip_file(
+   /* Always use RZIP interface when reading playlists
+    * > this will automatically handle uncompressed
+    *   data */
+   file = intfstream_open_rzip_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ);
 #else
-   intfstream_t *file   = intfstream_open_file(
+   file = intfstream_open_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -2495,6 +3437,14 @@ static bool playlist_read_file(playlist_t *playlist)
    if (!file)
       return true;
 
+   /* Skip parsing if the binary image is up to date */
+   if (playlist_image_read(playlist))
+   {
+      intfstream_close(file);
+      free(file);
+      return true;
+   }
+
    playlist->compressed = intfstream_is_compressed(file);
 
    /* Detect format of playlist
@@ -2617,11 +3567,11 @@ static bool playlist_read_file(playlist_t *playlist)
 
             /* core_path */
             if (!string_is_empty(line_buf[2]))
-               entry->core_path = strdup(line_buf[2]);
+               entry->core_path = playlist_intern_string(playlist, line_buf[2]);
 
             /* core_name */
             if (!string_is_empty(line_buf[3]))
-               entry->core_name = strdup(line_buf[3]);
+               entry->core_name = playlist_intern_string(playlist, line_buf[3]);
 
             /* crc32 */
             if (!string_is_empty(line_buf[4]))
@@ -2629,7 +3579,7 @@ static bool playlist_read_file(playlist_t *playlist)
 
             /* db_name */
             if (!string_is_empty(line_buf[5]))
-               entry->db_name   = strdup(line_buf[5]);
+               entry->db_name   = playlist_intern_string(playlist, line_buf[5]);
          }
          /* If fewer than 'PLAYLIST_ENTRIES' lines were
           * read, then this is metadata */
@@ -2755,6 +3705,12 @@ static bool playlist_read_file(playlist_t *playlist)
 end:
    intfstream_close(file);
    free(file);
+
+   /* Entries discarded over capacity are only
+    * dropped from the JSON file on next write */
+   if (res && !playlist->modified)
+      playlist_image_write(playlist);
+
    return res;
 }
 
@@ -2815,6 +3771,10 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->default_core_path      = NULL;
    playlist->base_content_directory = NULL;
    playlist->entries                = NULL;
+   playlist->image                  = NULL;
+   playlist->image_size             = 0;
+   playlist->image_mapped           = false;
+   playlist->strings                = string_pool_new();
    playlist->label_display_mode     = LABEL_DISPLAY_MODE_DEFAULT;
    playlist->right_thumbnail_mode   = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
    playlist->left_thumbnail_mode    = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
@@ -2860,7 +3820,7 @@ playlist_t *playlist_init(const playlist_config_t *config)
                   playlist->base_content_directory, playlist->config.base_content_directory,
                   sizeof(tmp_entry_path));
 
-            free(entry->path);
+            playlist_free_string(playlist, entry->path);
             entry->path = strdup(tmp_entry_path);
 
             /* Fix subsystem roms paths*/
@@ -3043,7 +4003,7 @@ void command_playlist_push_write(
       const struct playlist_entry *entry)
 {
    if (playlist && playlist_push(playlist, entry))
-      playlist_write_file(playlist);
+      playlist_write_file_deferred(playlist);
 }
 
 void command_playlist_update_write(
@@ -3061,7 +4021,7 @@ void command_playlist_update_write(
          idx,
          entry);
 
-   playlist_write_file(playlist);
+   playlist_write_file_deferred(playlist);
 }
 
 bool playlist_index_is_valid(playlist_t *playlist, size_t idx,
@@ -299,6 +299,30 @@ void playlist_write_file(playlist_t *playlist);
 
 void playlist_write_runtime_file(playlist_t *playlist);
 
+/* Same as playlist_write_file(), but the file is written
+ * by a background task after a short delay, and only once
+ * if the playlist is modified again in the meantime.
+ * Falls back to playlist_write_file() for compressed and
+ * old format playlists */
+void playlist_write_file_deferred(playlist_t *playlist);
+
+/* Sets the cache directory, where binary images of
+ * the playlists are kept. Without one (empty path),
+ * playlists are only read from JSON */
+void playlist_set_cache_directory(const char *path);
+
+/* Deferred writes are only enabled between these calls.
+ * playlist_deferred_writes_deinit() writes the playlists
+ * still pending, and must be called once no task can run */
+void playlist_deferred_writes_init(void);
+void playlist_deferred_writes_deinit(void);
+
+/* Writes the playlists still pending right away.
+ * Must be called once no task can run, e.g. when the
+ * task queue - and the tasks that would write them -
+ * is torn down */
+void playlist_deferred_writes_flush(void);
+
 void playlist_qsort(playlist_t *playlist);
 
 void playlist_free_cached(void);
@@ -171,9 +171,11 @@ check_pkgconf LIBCHECK check 0.15
 
 if [ "$OS" = 'Linux' ]; then
    check_header '' CDROM sys/ioctl.h scsi/sg.h
+   check_header '' IO_URING linux/io_uring.h
 fi
 
 check_platform 'Linux Win32' CDROM 'CD-ROM is' user
+check_platform Linux IO_URING 'io_uring is' true
 
 if [ "$OS" = 'Win32' ]; then
    add_opt DYLIB yes
@@ -442,6 +444,7 @@ check_enabled 'OPENGL OPENGLES OPENGLES3' GLSL GLSL \
 check_enabled ZLIB BUILTINZLIB 'builtin zlib' 'zlib is' true
 
 check_val '' ZLIB '-lz' '' zlib '' '' false
+check_val '' ZSTD '-lzstd' '' libzstd 1.4.0 '' false
 check_val '' MPV -lmpv '' mpv '' '' false
 
 check_header '' DRMINGW exchndl.h
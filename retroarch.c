@@ -172,6 +172,14 @@
 #include <rthreads/rthreads.h>
 #endif
 
+#ifdef HAVE_LIBRETRODB
+#include "libretro-db/libretrodb.h"
+#endif
+
+#if defined(HAVE_COMPRESSION) && (defined(HAVE_ZLIB) || defined(HAVE_7ZIP))
+#include <file/archive_file.h>
+#endif
+
 #include "autosave.h"
 #include "config.features.h"
 #include "content.h"
@@ -5644,6 +5652,17 @@ void main_exit(void *args)
    retroarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
    global_free(p_rarch);
    task_queue_deinit();
+   task_image_cache_deinit();
+   playlist_deferred_writes_deinit();
+#ifdef HAVE_LIBRETRODB
+   libretrodb_index_cache_deinit();
+#endif
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   file_archive_zip_index_cache_deinit();
+#endif
+#if defined(HAVE_COMPRESSION) && defined(HAVE_7ZIP)
+   file_archive_7z_block_cache_deinit();
+#endif
 
    ui_companion_driver_deinit();
    retroarch_config_deinit();
@@ -7399,6 +7418,23 @@ bool retroarch_main_init(int argc, char *argv[])
    retroarch_validate_cpu_features();
    retroarch_init_task_queue();
 
+   /* These caches live for the whole session, and are
+    * only released by main_exit() - initialising them
+    * again on a later content load is a no-op */
+   task_image_cache_init();
+   playlist_set_cache_directory(settings->paths.directory_cache);
+   playlist_deferred_writes_init();
+#ifdef HAVE_LIBRETRODB
+   libretrodb_index_cache_init();
+   libretrodb_index_cache_set_directory(settings->paths.directory_cache);
+#endif
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   file_archive_zip_index_cache_init();
+#endif
+#if defined(HAVE_COMPRESSION) && defined(HAVE_7ZIP)
+   file_archive_7z_block_cache_init();
+#endif
+
    {
       const char    *fullpath  = path_get(RARCH_PATH_CONTENT);
 
@@ -7634,6 +7670,9 @@ void retroarch_init_task_queue(void)
 #endif
 
    task_queue_deinit();
+   /* The tasks of pending deferred playlist writes
+    * were dropped along with the queue */
+   playlist_deferred_writes_flush();
    task_queue_init(threaded_enable, runloop_task_msg_queue_push);
 }
 
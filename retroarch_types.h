@@ -313,6 +313,7 @@ typedef struct content_file_info
    char *meta; /* Unused at present */
    void *data;
    size_t data_size;
+   bool data_mapped; /* data is a file mapping */
    bool file_in_archive;
    bool persistent_data;
 } content_file_info_t;
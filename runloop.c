@@ -1402,6 +1402,16 @@ static void core_performance_counter_stop(struct retro_perf_counter *perf)
 }
 
 
+/* Files opened by the core through its VFS interface
+ * are the only ones whose reads are accounted for in
+ * the statistics logged when the core is unloaded */
+static struct retro_vfs_file_handle *runloop_vfs_file_open(
+      const char *path, unsigned mode, unsigned hints)
+{
+   return retro_vfs_file_open_impl(path, mode,
+         hints | RFILE_HINT_READ_STATS);
+}
+
 bool runloop_environment_cb(unsigned cmd, void *data)
 {
    unsigned p;
@@ -3034,7 +3044,7 @@ bool runloop_environment_cb(unsigned cmd, void *data)
          {
             /* VFS API v1 */
             retro_vfs_file_get_path_impl,
-            retro_vfs_file_open_impl,
+            runloop_vfs_file_open,
             retro_vfs_file_close_impl,
             retro_vfs_file_size_impl,
             retro_vfs_file_tell_impl,
@@ -4041,8 +4051,16 @@ void runloop_event_deinit_core(void)
 
    if (runloop_st->current_core.flags & RETRO_CORE_FLAG_INITED)
    {
+      struct retro_vfs_file_stats vfs_stats;
       RARCH_LOG("[Core]: Unloading core..\n");
       runloop_st->current_core.retro_deinit();
+
+      retro_vfs_get_read_stats(&vfs_stats);
+      if (vfs_stats.reads)
+         RARCH_LOG("[VFS]: Core made %llu reads (%llu bytes), which took %llu system calls.\n",
+               (unsigned long long)vfs_stats.reads,
+               (unsigned long long)vfs_stats.bytes,
+               (unsigned long long)vfs_stats.syscalls);
    }
 
    /* retro_deinit() may call
@@ -4729,6 +4747,10 @@ bool runloop_event_init_core(
 
    video_st->frame_cache_data              = NULL;
 
+   /* Read statistics of the core's own files
+    * are logged on unload */
+   retro_vfs_reset_read_stats();
+
    runloop_st->current_core.retro_init();
    runloop_st->current_core.flags         |= RETRO_CORE_FLAG_INITED;
 
@@ -48,6 +48,7 @@
 #include <boolean.h>
 
 #include <encodings/crc32.h>
+#include <lrc_hash.h>
 #include <compat/strl.h>
 #include <compat/posix_string.h>
 #include <file/file_path.h>
@@ -61,6 +62,14 @@
 
 #include <retro_miscellaneous.h>
 
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <memmap.h>
+#define CONTENT_FILE_MMAP
+#endif
+
 #ifdef HAVE_MENU
 #include "../menu/menu_driver.h"
 #endif
@@ -275,6 +284,23 @@ bool content_file_override_set(
    return true;
 }
 
+static void content_file_free_data(void *data, size_t data_size,
+      bool data_mapped)
+{
+   if (!data)
+      return;
+
+#ifdef CONTENT_FILE_MMAP
+   if (data_mapped)
+   {
+      munmap(data, data_size);
+      return;
+   }
+#endif
+
+   free(data);
+}
+
 /* Frees any content data that is not flagged
  * as 'persistent'. Should be called after
  * content_file_load() */
@@ -293,10 +319,12 @@ static void content_file_list_free_transient_data(
       if (file_info->data &&
           !file_info->persistent_data)
       {
-         free((void*)file_info->data);
+         content_file_free_data(file_info->data,
+               file_info->data_size, file_info->data_mapped);
 
-         file_info->data      = NULL;
-         file_info->data_size = 0;
+         file_info->data        = NULL;
+         file_info->data_size   = 0;
+         file_info->data_mapped = false;
       }
    }
 }
@@ -351,10 +379,12 @@ static void content_file_list_free_entry(
 
    if (file_info->data)
    {
-      free((void*)file_info->data);
+      content_file_free_data(file_info->data,
+            file_info->data_size, file_info->data_mapped);
       file_info->data = NULL;
    }
-   file_info->data_size = 0;
+   file_info->data_size   = 0;
+   file_info->data_mapped = false;
 
    file_info->file_in_archive = false;
    file_info->persistent_data = false;
@@ -481,6 +511,7 @@ static bool content_file_list_set_info(
       const char *path,
       void *data,
       size_t data_size,
+      bool data_mapped,
       bool persistent_data,
       size_t idx)
 {
@@ -528,6 +559,7 @@ static bool content_file_list_set_info(
 
    file_info->data            = data;
    file_info->data_size       = data_size;
+   file_info->data_mapped     = data_mapped;
    file_info->persistent_data = persistent_data;
 
    /* Assign paths
@@ -663,11 +695,309 @@ static bool content_file_list_set_info(
 #define CONTENT_FILE_ATTR_GET_REQUIRED(attr)      ((attr.i & 4) != 0)
 #define CONTENT_FILE_ATTR_GET_PERSISTENT(attr)    ((attr.i & 8) != 0)
 
+/* Content caches (extracted archive members, patched content)
+ * keep each entry in a directory of its own, named after its
+ * key, so that the cached file keeps its name. The index of a
+ * cache lists its entries from the least to the most recently
+ * used, with their size and modification time */
+#define CONTENT_CACHE_INDEX "index"
+
+typedef struct content_cache_item
+{
+   char key[32];
+   char name[NAME_MAX_LENGTH];
+   int64_t size;
+   int64_t mtime;
+} content_cache_item_t;
+
+/**
+ * content_cache_get_entry:
+ * @entry           : entry to fill in.
+ * @directory_cache : cache directory.
+ * @dir             : directory of the cache in @directory_cache.
+ * @hash            : hash of whatever the entry is derived from.
+ * @crc             : CRC32 of the source content.
+ * @name            : name of the cached file.
+ **/
+void content_cache_get_entry(content_cache_entry_t *entry,
+      const char *directory_cache, const char *dir,
+      uint32_t hash, uint32_t crc, const char *name)
+{
+   snprintf(entry->key, sizeof(entry->key), "%08x%08x",
+         (unsigned)hash, (unsigned)crc);
+   fill_pathname_join_special(entry->root, directory_cache,
+         dir, sizeof(entry->root));
+   fill_pathname_join_special(entry->dir, entry->root,
+         entry->key, sizeof(entry->dir));
+   fill_pathname_join_special(entry->path, entry->dir,
+         name, sizeof(entry->path));
+}
+
+static content_cache_item_t *content_cache_read_index(
+      const char *root)
+{
+   char index_path[PATH_MAX_LENGTH];
+   content_cache_item_t *items = NULL; /* RBUF */
+   char *line                  = NULL;
+   void *buf                   = NULL;
+   int64_t len                 = 0;
+
+   fill_pathname_join_special(index_path, root,
+         CONTENT_CACHE_INDEX, sizeof(index_path));
+
+   if (     !path_is_valid(index_path)
+         || !filestream_read_file(index_path, &buf, &len))
+      return NULL;
+
+   /* Lines are '<key> <size> <mtime> <name>' */
+   for (line = (char*)buf; *line; )
+   {
+      content_cache_item_t item;
+      char *end   = strchr(line, '\n');
+      char *size  = NULL;
+      char *mtime = NULL;
+      char *name  = NULL;
+
+      if (end)
+         *end = '\0';
+
+      if (     (size  = strchr(line, ' '))
+            && (mtime = strchr(size + 1, ' '))
+            && (name  = strchr(mtime + 1, ' ')))
+      {
+         *size++  = '\0';
+         *mtime++ = '\0';
+         *name++  = '\0';
+         strlcpy(item.key,  line, sizeof(item.key));
+         strlcpy(item.name, name, sizeof(item.name));
+         item.size  = strtoll(size,  NULL, 10);
+         item.mtime = strtoll(mtime, NULL, 10);
+         RBUF_PUSH(items, item);
+      }
+
+      if (!end)
+         break;
+      line = end + 1;
+   }
+
+   free(buf);
+   return items;
+}
+
+static void content_cache_write_index(const char *root,
+      content_cache_item_t *items)
+{
+   size_t i;
+   char index_path[PATH_MAX_LENGTH];
+   RFILE *file = NULL;
+
+   fill_pathname_join_special(index_path, root,
+         CONTENT_CACHE_INDEX, sizeof(index_path));
+
+   if (!(file = filestream_open(index_path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   for (i = 0; i < RBUF_LEN(items); i++)
+      filestream_printf(file, "%s %" PRId64 " %" PRId64 " %s\n",
+            items[i].key, items[i].size, items[i].mtime, items[i].name);
+
+   filestream_close(file);
+}
+
+static void content_cache_delete_item(const char *root,
+      const content_cache_item_t *item)
+{
+   char dir[PATH_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+
+   fill_pathname_join_special(dir, root, item->key, sizeof(dir));
+   fill_pathname_join_special(path, dir, item->name, sizeof(path));
+
+   filestream_delete(path);
+   filestream_delete(dir);
+}
+
+/**
+ * content_cache_touch:
+ * @entry    : entry of a content cache.
+ * @max_size : size limit of the cache, in bytes.
+ * @add      : whether to add the file of @entry if it
+ *             is not in the cache yet.
+ *
+ * Makes @entry the most recently used one, if it is in
+ * the cache (or @add is set), and evicts the least
+ * recently used ones beyond @max_size.
+ *
+ * Returns: true if @entry was in the cache.
+ **/
+bool content_cache_touch(const content_cache_entry_t *entry,
+      int64_t max_size, bool add)
+{
+   size_t i;
+   content_cache_item_t item;
+   content_cache_item_t *items =
+      content_cache_read_index(entry->root);
+   int64_t total               = 0;
+   bool found                  = false;
+
+   strlcpy(item.key,  entry->key, sizeof(item.key));
+   strlcpy(item.name, path_basename(entry->path), sizeof(item.name));
+   item.size  = path_get_size(entry->path);
+   item.mtime = path_get_mtime(entry->path);
+
+   for (i = 0; i < RBUF_LEN(items); i++)
+   {
+      if (!string_is_equal(items[i].key, item.key))
+         continue;
+
+      /* An entry is only valid if it was completely
+       * written before being added, and has not been
+       * modified since */
+      found = string_is_equal(items[i].name, item.name)
+           && items[i].size  == item.size
+           && items[i].mtime == item.mtime;
+      RBUF_REMOVE(items, i);
+      break;
+   }
+
+   if (found || (add && item.size > 0))
+      RBUF_PUSH(items, item);
+   else
+      filestream_delete(entry->path);
+
+   for (i = 0; i < RBUF_LEN(items); i++)
+      total += items[i].size;
+
+   while (RBUF_LEN(items) > 1 && total > max_size)
+   {
+      total -= items[0].size;
+      content_cache_delete_item(entry->root, &items[0]);
+      RBUF_REMOVE(items, 0);
+   }
+
+   content_cache_write_index(entry->root, items);
+   RBUF_FREE(items);
+
+   return found;
+}
+
+#ifdef HAVE_COMPRESSION
+/* Members extracted from archives are kept in the cache
+ * directory, so that relaunching recent content does not
+ * decompress it again. They are keyed by the archive path,
+ * modification time and size and the CRC of the member:
+ * cores that need the full path are handed the cached file
+ * itself, and one that was written to is extracted again */
+#define CONTENT_ARCHIVE_CACHE_DIR      "extracted"
+#define CONTENT_ARCHIVE_CACHE_MAX_SIZE (512 * 1024 * 1024)
+
+/* Returns false if the member cannot be cached */
+static bool content_archive_cache_get_entry(
+      content_information_ctx_t *content_ctx,
+      const char *path, content_cache_entry_t *entry)
+{
+   char archive_path[PATH_MAX_LENGTH];
+   const char *delim = path_get_archive_delim(path);
+   uint32_t hash     = FNV1A_INIT;
+   uint32_t crc      = 0;
+   int64_t mtime, size;
+
+   if (     !delim
+         || !delim[1]
+         || string_is_empty(content_ctx->directory_cache))
+      return false;
+
+   strlcpy(archive_path, path, sizeof(archive_path));
+   archive_path[delim - path] = '\0';
+
+   mtime = path_get_mtime(archive_path);
+   size  = path_get_size(archive_path);
+
+   /* The CRC is read from the archive directory */
+   if (     mtime <= 0
+         || size  <= 0
+         || !(crc = file_archive_get_file_crc32(path)))
+      return false;
+
+   hash = fnv1a_calculate(hash, path, strlen(path));
+   hash = fnv1a_calculate(hash, &mtime, sizeof(mtime));
+   hash = fnv1a_calculate(hash, &size, sizeof(size));
+
+   content_cache_get_entry(entry, content_ctx->directory_cache,
+         CONTENT_ARCHIVE_CACHE_DIR, hash, crc,
+         path_basename(delim + 1));
+
+   return true;
+}
+#endif
+
+#ifdef CONTENT_FILE_MMAP
+/* Uncompressed content at least this large is mapped
+ * instead of being read: pages are only loaded when the
+ * core accesses them, and are shared with the page cache
+ * until written to */
+#define CONTENT_FILE_MMAP_MIN_SIZE (4 * 1024 * 1024)
+
+static bool content_file_map(const char *path,
+      uint8_t **data, int64_t *size)
+{
+   struct stat st;
+   void *map = MAP_FAILED;
+   int fd    = open(path, O_RDONLY);
+
+   /* Paths only the VFS can open are read as usual */
+   if (fd < 0)
+      return false;
+
+   /* The mapping is private and writable, as some cores
+    * modify their content in place - the pages they write
+    * to are copied, the file is never modified */
+   if (     fstat(fd, &st) == 0
+         && S_ISREG(st.st_mode)
+         && st.st_size >= CONTENT_FILE_MMAP_MIN_SIZE
+         && (uint64_t)st.st_size <= SIZE_MAX)
+      map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE, fd, 0);
+
+   close(fd);
+
+   if (map == MAP_FAILED)
+      return false;
+
+   *data = (uint8_t*)map;
+   *size = (int64_t)st.st_size;
+   return true;
+}
+
+#ifdef HAVE_PATCH
+/* Returns true if a soft patch may be applied
+ * to the first content file */
+static bool content_file_may_patch(
+      content_information_ctx_t *content_ctx)
+{
+   if (content_ctx->flags & CONTENT_INFO_FLAG_PATCH_IS_BLOCKED)
+      return false;
+
+   return  (!string_is_empty(content_ctx->name_ips)
+               && path_is_valid(content_ctx->name_ips))
+        || (!string_is_empty(content_ctx->name_bps)
+               && path_is_valid(content_ctx->name_bps))
+        || (!string_is_empty(content_ctx->name_ups)
+               && path_is_valid(content_ctx->name_ups))
+        || (!string_is_empty(content_ctx->name_xdelta)
+               && path_is_valid(content_ctx->name_xdelta));
+}
+#endif
+#endif
+
 /**
  * content_file_load_into_memory:
  * @content_path : path of the content file.
  * @data         : buffer into which the content file will be read.
  * @data_size    : size of the resultant content buffer.
+ * @data_mapped  : set if the buffer is a mapping of the file.
  *
  * Reads the content file into memory. Also performs soft patching
  * (see patch_content function) if soft patching has not been
@@ -683,13 +1013,15 @@ static bool content_file_load_into_memory(
       size_t idx,
       enum rarch_content_type first_content_type,
       uint8_t **data,
-      size_t *data_size)
+      size_t *data_size,
+      bool *data_mapped)
 {
    uint8_t *content_data = NULL;
    int64_t content_size  = 0;
 
    *data                 = NULL;
    *data_size            = 0;
+   *data_mapped          = false;
 
    RARCH_LOG("[Content]: %s: \"%s\".\n",
          msg_hash_to_str(MSG_LOADING_CONTENT_FILE), content_path);
@@ -698,15 +1030,57 @@ static bool content_file_load_into_memory(
 #ifdef HAVE_COMPRESSION
    if (content_compressed)
    {
-      if (!file_archive_compressed_read(content_path,
-            (void**)&content_data, NULL, &content_size))
-         return false;
+      content_cache_entry_t entry;
+      bool cacheable = content_archive_cache_get_entry(content_ctx,
+            content_path, &entry);
+
+      if (     cacheable
+            && content_cache_touch(&entry,
+               CONTENT_ARCHIVE_CACHE_MAX_SIZE, false)
+            && filestream_read_file(entry.path,
+                  (void**)&content_data, &content_size))
+         RARCH_LOG("[Content]: Using extracted content from cache: \"%s\".\n",
+               entry.path);
+      else
+      {
+         if (!file_archive_compressed_read(content_path,
+               (void**)&content_data, NULL, &content_size))
+            return false;
+
+         if (     cacheable
+               && content_size > 0
+               && content_size <= CONTENT_ARCHIVE_CACHE_MAX_SIZE / 2
+               && path_mkdir(entry.dir)
+               && filestream_write_file(entry.path,
+                     content_data, content_size))
+            content_cache_touch(&entry,
+                  CONTENT_ARCHIVE_CACHE_MAX_SIZE, true);
+      }
    }
    else
+#endif
+   {
+#ifdef CONTENT_FILE_MMAP
+      /* Patched content must be a heap buffer */
+      bool may_patch = false;
+#ifdef HAVE_PATCH
+      may_patch      =    (idx == 0)
+                       && (first_content_type == RARCH_CONTENT_NONE)
+                       && content_file_may_patch(content_ctx);
+#endif
+      if (!may_patch && content_file_map(content_path,
+               &content_data, &content_size))
+      {
+         RARCH_LOG("[Content]: Mapped content file (%" PRId64 " bytes).\n",
+               content_size);
+         *data_mapped = true;
+      }
+      else
 #endif
       if (!filestream_read_file(content_path,
             (void**)&content_data, &content_size))
          return false;
+   }
 
    if (content_size < 0)
       return false;
@@ -733,6 +1107,7 @@ static bool content_file_load_into_memory(
                   content_ctx->name_bps,
                   content_ctx->name_ups,
                   content_ctx->name_xdelta,
+                  content_ctx->directory_cache,
                   (uint8_t**)&content_data,
                   (void*)&content_size);
 #endif
@@ -776,8 +1151,10 @@ static bool content_file_extract_from_archive(
       content_state_t *p_content,
       const char *valid_exts,
       const char **content_path,
+      char *cached_path, size_t cached_path_len,
       char **error_string)
 {
+   content_cache_entry_t entry;
    const char *tmp_path_ptr = NULL;
    char tmp_path[PATH_MAX_LENGTH];
    char msg[1024];
@@ -785,6 +1162,40 @@ static bool content_file_extract_from_archive(
    tmp_path[0]  = '\0';
    msg[0]       = '\0';
 
+   if (content_archive_cache_get_entry(content_ctx, *content_path, &entry))
+   {
+      if (content_cache_touch(&entry,
+            CONTENT_ARCHIVE_CACHE_MAX_SIZE, false))
+      {
+         RARCH_LOG("[Content]: Using extracted content from cache: \"%s\".\n",
+               entry.path);
+         strlcpy(cached_path, entry.path, cached_path_len);
+         *content_path = cached_path;
+         return true;
+      }
+
+      /* Extract straight into the cache, the file
+       * is then kept when the core is unloaded */
+      if (     path_mkdir(entry.dir)
+            && file_archive_extract_file(*content_path, valid_exts,
+               entry.dir, tmp_path, sizeof(tmp_path))
+            && string_is_equal(tmp_path, entry.path)
+            && path_get_size(tmp_path) <= CONTENT_ARCHIVE_CACHE_MAX_SIZE / 2
+            && content_cache_touch(&entry,
+               CONTENT_ARCHIVE_CACHE_MAX_SIZE, true))
+      {
+         RARCH_LOG("[Content]: Content successfully extracted to: \"%s\".\n",
+               tmp_path);
+         strlcpy(cached_path, tmp_path, cached_path_len);
+         *content_path = cached_path;
+         return true;
+      }
+
+      if (!string_is_empty(tmp_path))
+         filestream_delete(tmp_path);
+      tmp_path[0] = '\0';
+   }
+
    /* TODO/FIXME - localize */
    RARCH_LOG("[Content]: Core requires uncompressed content - "
          "extracting archive to temporary directory.\n");
@@ -959,9 +1370,13 @@ static bool content_file_load(
 
    for (i = 0; i < content->size; i++)
    {
+#ifdef HAVE_COMPRESSION
+      char cached_path[PATH_MAX_LENGTH];
+#endif
       const char *content_path = NULL;
       uint8_t *content_data    = NULL;
       size_t content_size      = 0;
+      bool content_mapped      = false;
       const char *valid_exts   = special
             ? special->roms[i].valid_extensions
             : content_ctx->valid_extensions;
@@ -1000,7 +1415,7 @@ static bool content_file_load(
             if (!content_file_load_into_memory(
                   content_ctx, p_content, content_path,
                   content_compressed, i, first_content_type,
-                  &content_data, &content_size))
+                  &content_data, &content_size, &content_mapped))
             {
                snprintf(msg, sizeof(msg), "%s \"%s\"\n",
                      msg_hash_to_str(MSG_COULD_NOT_READ_CONTENT_FILE),
@@ -1017,7 +1432,8 @@ static bool content_file_load(
             if (content_compressed &&
                 !CONTENT_FILE_ATTR_GET_BLOCK_EXTRACT(content->elems[i].attr) &&
                 !content_file_extract_from_archive(content_ctx, p_content,
-                     valid_exts, &content_path, error_string))
+                     valid_exts, &content_path,
+                     cached_path, sizeof(cached_path), error_string))
                return false;
 #endif
 #ifdef __WINRT__
@@ -1120,12 +1536,12 @@ static bool content_file_load(
       /* Add current entry to content file list */
       if (!content_file_list_set_info(
             p_content->content_list,
-            content_path, content_data, content_size,
+            content_path, content_data, content_size, content_mapped,
             CONTENT_FILE_ATTR_GET_PERSISTENT(content->elems[i].attr), i))
       {
          RARCH_LOG("[Content]: Failed to process content file: \"%s\".\n", content_path);
-         if (content_data)
-            free((void*)content_data);
+         content_file_free_data(content_data, content_size,
+               content_mapped);
          *error_enum = MSG_FAILED_TO_LOAD_CONTENT;
          return false;
       }
@@ -1328,6 +1744,11 @@ static bool content_file_init(
                error_enum, error_string, special);
 
          content_file_list_free_transient_data(p_content->content_list);
+#ifdef HAVE_7ZIP
+         /* All the content is loaded, the last
+          * decoded block is of no further use */
+         file_archive_7z_block_cache_clear();
+#endif
          return ret;
       }
    }
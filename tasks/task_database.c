@@ -31,6 +31,7 @@
 
 #include "../core_info.h"
 #include "../database_info.h"
+#include "../libretro-db/libretrodb.h"
 
 #include "../file_path_special.h"
 #include "../msg_hash.h"
@@ -954,6 +955,17 @@ static int task_database_iterate_crc_lookup(
          }
       }
 
+      /* Most databases cannot hold the CRC: skip
+       * them without reading them */
+      if (     !libretrodb_may_contain_crc(
+                  db_state->list->elems[db_state->list_index].data,
+                  db_state->crc)
+            && (  !db_state->archive_crc
+               || !libretrodb_may_contain_crc(
+                  db_state->list->elems[db_state->list_index].data,
+                  db_state->archive_crc)))
+         return database_info_list_iterate_next(db_state);
+
       snprintf(query, sizeof(query),
             "{crc:or(b\"%08lX\",b\"%08lX\")}",
             (unsigned long)db_state->crc, (unsigned long)db_state->archive_crc);
@@ -18,11 +18,20 @@
 #include <string.h>
 
 #include <file/nbio.h>
+#include <file/file_path.h>
 #include <formats/image.h>
 #include <compat/strl.h>
+#include <encodings/crc32.h>
+#include <streams/file_stream.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
+#include <lrc_hash.h>
+#include <lists/dir_list.h>
+#include <lists/string_list.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "task_file_transfer.h"
 #include "tasks_internal.h"
@@ -38,6 +47,50 @@ enum image_status_enum
    IMAGE_STATUS_PROCESS_TRANSFER_PARSE
 };
 
+/* Pre-scaled, pre-converted images are cached on disk
+ * as a small header followed by raw 32-bit pixels in
+ * the same layout that is uploaded to the GPU */
+#define IMAGE_CACHE_MAGIC   0x42485452 /* 'RTHB' */
+#define IMAGE_CACHE_VERSION 1
+
+/* The oldest entries are deleted once the cache grows
+ * past IMAGE_CACHE_MAX_SIZE, down to IMAGE_CACHE_TRIM_SIZE */
+#if defined(DINGUX) || defined(MIYOO) || defined(_3DS) || defined(PSP)
+#define IMAGE_CACHE_MAX_SIZE (32 * 1024 * 1024)
+#else
+#define IMAGE_CACHE_MAX_SIZE (256 * 1024 * 1024)
+#endif
+#define IMAGE_CACHE_TRIM_SIZE (IMAGE_CACHE_MAX_SIZE / 4 * 3)
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t width;
+   uint32_t height;
+   uint32_t supports_rgba;
+} image_cache_header_t;
+
+typedef struct
+{
+   char *path;
+   int64_t mtime;
+   int64_t size;
+} image_cache_entry_t;
+
+/* Total size of the on-disk cache. The directory is
+ * listed once, then each write adds to the total */
+struct image_cache_state
+{
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   int64_t size; /* -1: not counted yet */
+   char dir[PATH_MAX_LENGTH];
+};
+
+static struct image_cache_state image_cache_st;
+
 enum image_flags_enum
 {
    IMAGE_FLAG_IS_BLOCKING                = (1 << 0),
@@ -49,11 +102,14 @@ struct nbio_image_handle
 {
    void *handle;
    transfer_cb_t  cb;
+   char *cache_path;
    struct texture_image ti; /* ptr alignment */
    size_t size;
    int processing_final_state;
    unsigned frame_duration;
    unsigned upscale_threshold;
+   unsigned max_width;
+   unsigned max_height;
    enum image_type_enum type;
    enum image_status_enum status;
    uint8_t flags;
@@ -173,6 +229,8 @@ static void task_image_cleanup(nbio_handle_t *nbio)
    }
    if (!string_is_empty(nbio->path))
       free(nbio->path);
+   if (image && image->cache_path)
+      free(image->cache_path);
    if (nbio->data)
       free(nbio->data);
    nbio_free(nbio->handle);
@@ -212,6 +270,15 @@ static int cb_nbio_image_thumbnail(void *data, size_t len)
 
    image_transfer_set_buffer_ptr(image->handle, image->type, ptr, len);
 
+   /* The image is going to be shrunk to fit max_width x max_height,
+    * let the decoder skip the detail that would be thrown away.
+    * Not done when small images get upscaled first, since a reduced
+    * decode could then fall below the upscale threshold */
+   if (     ((image->max_width > 0) || (image->max_height > 0))
+         && (image->upscale_threshold == 0))
+      image_transfer_set_target_size(image->handle, image->type,
+            image->max_width, image->max_height);
+
    /* Set image size */
    image->size                     = len;
 
@@ -277,6 +344,348 @@ static bool upscale_image(
    return true;
 }
 
+/* Shrinks 'image_src' to fit within the specified
+ * dimensions, preserving aspect ratio. Each output
+ * pixel is the average of the source pixels it covers,
+ * applied per byte so that it works for any channel order */
+static bool downscale_image(
+      unsigned max_width, unsigned max_height,
+      struct texture_image *image_src,
+      struct texture_image *image_dst)
+{
+   unsigned x_dst, y_dst;
+   float scale_x, scale_y, scale;
+
+   /* Sanity check */
+   if (!image_src || !image_dst || !image_src->pixels ||
+       (image_src->width < 1) || (image_src->height < 1))
+      return false;
+
+   if (max_width < 1)
+      max_width  = image_src->width;
+   if (max_height < 1)
+      max_height = image_src->height;
+
+   scale_x = (float)max_width  / (float)image_src->width;
+   scale_y = (float)max_height / (float)image_src->height;
+   scale   = (scale_x < scale_y) ? scale_x : scale_y;
+
+   if (scale >= 1.0f)
+      return false;
+
+   /* Get output dimensions */
+   image_dst->width  = (unsigned)((float)image_src->width  * scale);
+   image_dst->height = (unsigned)((float)image_src->height * scale);
+
+   if (image_dst->width < 1)
+      image_dst->width  = 1;
+   if (image_dst->height < 1)
+      image_dst->height = 1;
+
+   /* Allocate pixel buffer */
+   if (!(image_dst->pixels = (uint32_t*)malloc(
+         image_dst->width * image_dst->height * sizeof(uint32_t))))
+      return false;
+
+   for (y_dst = 0; y_dst < image_dst->height; y_dst++)
+   {
+      unsigned y0 = (y_dst       * image_src->height) / image_dst->height;
+      unsigned y1 = ((y_dst + 1) * image_src->height) / image_dst->height;
+
+      if (y1 <= y0)
+         y1 = y0 + 1;
+
+      for (x_dst = 0; x_dst < image_dst->width; x_dst++)
+      {
+         unsigned x, y;
+         uint32_t sum[4] = {0};
+         uint32_t count  = 0;
+         unsigned x0     = (x_dst       * image_src->width) / image_dst->width;
+         unsigned x1     = ((x_dst + 1) * image_src->width) / image_dst->width;
+         uint8_t *dst    = (uint8_t*)&image_dst->pixels[
+               (y_dst * image_dst->width) + x_dst];
+
+         if (x1 <= x0)
+            x1 = x0 + 1;
+
+         for (y = y0; y < y1; y++)
+         {
+            const uint8_t *src = (const uint8_t*)&image_src->pixels[
+                  (y * image_src->width) + x0];
+
+            for (x = x0; x < x1; x++, src += 4)
+            {
+               sum[0] += src[0];
+               sum[1] += src[1];
+               sum[2] += src[2];
+               sum[3] += src[3];
+            }
+            count += x1 - x0;
+         }
+
+         dst[0] = (uint8_t)(sum[0] / count);
+         dst[1] = (uint8_t)(sum[1] / count);
+         dst[2] = (uint8_t)(sum[2] / count);
+         dst[3] = (uint8_t)(sum[3] / count);
+      }
+   }
+
+   return true;
+}
+
+static int task_image_cache_entry_cmp(const void *a, const void *b)
+{
+   const image_cache_entry_t *ea = (const image_cache_entry_t*)a;
+   const image_cache_entry_t *eb = (const image_cache_entry_t*)b;
+   if (ea->mtime < eb->mtime)
+      return -1;
+   return (ea->mtime > eb->mtime) ? 1 : 0;
+}
+
+/* Deletes the oldest entries in 'dir' once they take up
+ * more than IMAGE_CACHE_MAX_SIZE (or counts them only, if
+ * 'trim' is false). Returns the size left in the cache */
+static int64_t task_image_cache_trim(const char *dir, bool trim)
+{
+   size_t i;
+   int64_t total                = 0;
+   image_cache_entry_t *entries = NULL;
+   struct string_list *list     = dir_list_new(dir, "thb",
+         false, false, false, false);
+
+   if (!list)
+      return 0;
+
+   if (list->size && (entries = (image_cache_entry_t*)
+            malloc(list->size * sizeof(*entries))))
+   {
+      for (i = 0; i < list->size; i++)
+      {
+         entries[i].path  = list->elems[i].data;
+         entries[i].size  = path_get_size(entries[i].path);
+         entries[i].mtime = trim ? path_get_mtime(entries[i].path) : 0;
+         if (entries[i].size > 0)
+            total += entries[i].size;
+      }
+
+      if (trim && total > IMAGE_CACHE_MAX_SIZE)
+      {
+         qsort(entries, list->size, sizeof(*entries),
+               task_image_cache_entry_cmp);
+
+         for (i = 0; i < list->size && total > IMAGE_CACHE_TRIM_SIZE; i++)
+         {
+            if (entries[i].size > 0 && filestream_delete(entries[i].path) == 0)
+               total -= entries[i].size;
+         }
+      }
+
+      free(entries);
+   }
+
+   string_list_free(list);
+   return total;
+}
+
+/* Accounts for a new entry of 'size' bytes in 'dir',
+ * evicting old entries if the cache is now too large */
+static void task_image_cache_add(const char *dir, int64_t size)
+{
+#ifdef HAVE_THREADS
+   slock_lock(image_cache_st.lock);
+#endif
+   if (     image_cache_st.size < 0
+         || !string_is_equal(image_cache_st.dir, dir))
+   {
+      strlcpy(image_cache_st.dir, dir, sizeof(image_cache_st.dir));
+      image_cache_st.size  = task_image_cache_trim(dir, false);
+   }
+   else
+      image_cache_st.size += size;
+
+   if (image_cache_st.size > IMAGE_CACHE_MAX_SIZE)
+      image_cache_st.size  = task_image_cache_trim(dir, true);
+#ifdef HAVE_THREADS
+   slock_unlock(image_cache_st.lock);
+#endif
+}
+
+void task_image_cache_init(void)
+{
+#ifdef HAVE_THREADS
+   if (image_cache_st.lock)
+      return;
+   image_cache_st.lock    = slock_new();
+#endif
+   image_cache_st.size    = -1;
+   image_cache_st.dir[0]  = '\0';
+}
+
+void task_image_cache_deinit(void)
+{
+#ifdef HAVE_THREADS
+   if (image_cache_st.lock)
+      slock_free(image_cache_st.lock);
+   image_cache_st.lock    = NULL;
+#endif
+   image_cache_st.size    = -1;
+   image_cache_st.dir[0]  = '\0';
+}
+
+/* Writes a processed image to the on-disk cache.
+ * Data goes to a temporary file first, so an interrupted
+ * write can never leave a truncated cache entry behind */
+static void task_image_cache_write(const char *cache_path,
+      const struct texture_image *ti)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   char cache_dir[PATH_MAX_LENGTH];
+   image_cache_header_t header;
+   size_t _len, pixels_size;
+   uint8_t *buf;
+
+   if (!ti->pixels || (ti->width < 1) || (ti->height < 1))
+      return;
+
+   fill_pathname_basedir(cache_dir, cache_path, sizeof(cache_dir));
+   if (!path_is_directory(cache_dir) && !path_mkdir(cache_dir))
+      return;
+
+   pixels_size          = ti->width * ti->height * sizeof(uint32_t);
+   header.magic         = IMAGE_CACHE_MAGIC;
+   header.version       = IMAGE_CACHE_VERSION;
+   header.width         = ti->width;
+   header.height        = ti->height;
+   header.supports_rgba = ti->supports_rgba ? 1 : 0;
+
+   if (!(buf = (uint8_t*)malloc(sizeof(header) + pixels_size)))
+      return;
+
+   memcpy(buf, &header, sizeof(header));
+   memcpy(buf + sizeof(header), ti->pixels, pixels_size);
+
+   _len = strlcpy(tmp_path, cache_path, sizeof(tmp_path));
+   strlcpy(tmp_path + _len, ".tmp", sizeof(tmp_path) - _len);
+
+   if (     filestream_write_file(tmp_path, buf,
+            (int64_t)(sizeof(header) + pixels_size))
+         && filestream_replace(tmp_path, cache_path) == 0)
+      task_image_cache_add(cache_dir,
+            (int64_t)(sizeof(header) + pixels_size));
+
+   free(buf);
+}
+
+/* Reads an image previously written by
+ * task_image_cache_write(). Invalid entries are
+ * deleted, so that the image is decoded again
+ * next time it is requested */
+static bool task_image_cache_read(const char *cache_path,
+      struct texture_image *ti)
+{
+   void *buf              = NULL;
+   int64_t len            = 0;
+   image_cache_header_t *header;
+   size_t pixels_size;
+
+   if (!filestream_read_file(cache_path, &buf, &len))
+      return false;
+
+   header = (image_cache_header_t*)buf;
+
+   if (   ((size_t)len < sizeof(*header))
+       || (header->magic   != IMAGE_CACHE_MAGIC)
+       || (header->version != IMAGE_CACHE_VERSION)
+       || (header->width  < 1)
+       || (header->height < 1))
+      goto error;
+
+   pixels_size = header->width * header->height * sizeof(uint32_t);
+
+   if ((size_t)len != sizeof(*header) + pixels_size)
+      goto error;
+
+   if (!(ti->pixels = (uint32_t*)malloc(pixels_size)))
+      goto error;
+
+   memcpy(ti->pixels, (uint8_t*)buf + sizeof(*header), pixels_size);
+   ti->width         = header->width;
+   ti->height        = header->height;
+   ti->supports_rgba = (header->supports_rgba != 0);
+
+   free(buf);
+   return true;
+
+error:
+   free(buf);
+   filestream_delete(cache_path);
+   return false;
+}
+
+static void task_image_cache_load_handler(retro_task_t *task)
+{
+   char *cache_path          = (char*)task->state;
+   struct texture_image *img = NULL;
+
+   if (!task_get_cancelled(task))
+   {
+      if ((img = (struct texture_image*)calloc(1, sizeof(*img))))
+      {
+         if (!task_image_cache_read(cache_path, img))
+         {
+            free(img);
+            img = NULL;
+         }
+      }
+   }
+
+   task_set_data(task, img);
+   task_set_finished(task, true);
+}
+
+static void task_image_cache_load_free(retro_task_t *task)
+{
+   if (task && task->state)
+      free(task->state);
+}
+
+/* Builds the on-disk cache path for an image. The name
+ * covers everything that affects the cached pixels, so a
+ * changed source file (size/mtime) or target size simply
+ * maps to a new entry */
+static bool task_image_get_cache_path(char *s, size_t len,
+      const char *cache_dir, const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      unsigned max_width, unsigned max_height)
+{
+   char key[PATH_MAX_LENGTH + 64];
+   char file_name[64];
+   int64_t mtime;
+   int32_t size;
+   uint32_t crc;
+   size_t _len;
+
+   if (string_is_empty(cache_dir))
+      return false;
+
+   if ((size = path_get_size(fullpath)) < 0)
+      return false;
+   mtime = path_get_mtime(fullpath);
+
+   _len = snprintf(key, sizeof(key), "%s|%d|%lld|%u|%u|%u|%d",
+         fullpath, (int)size, (long long)mtime, upscale_threshold,
+         max_width, max_height, supports_rgba ? 1 : 0);
+   if (_len >= sizeof(key))
+      return false;
+
+   crc = encoding_crc32(0, (const uint8_t*)key, _len);
+   snprintf(file_name, sizeof(file_name), "%08x%08x.thb",
+         (unsigned)crc, (unsigned)djb2_calculate(key));
+
+   fill_pathname_join_special(s, cache_dir, file_name, len);
+   return true;
+}
+
 bool task_image_load_handler(retro_task_t *task)
 {
    nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
@@ -372,6 +781,31 @@ bool task_image_load_handler(retro_task_t *task)
             }
          }
 
+         /* Downscale image, if required */
+         if ((image->max_width > 0) || (image->max_height > 0))
+         {
+            struct texture_image img_resampled = {
+               NULL,
+               0,
+               0,
+               false
+            };
+
+            if (downscale_image(image->max_width, image->max_height,
+                     &image->ti, &img_resampled))
+            {
+               image->ti.width  = img_resampled.width;
+               image->ti.height = img_resampled.height;
+
+               if (image->ti.pixels)
+                  free(image->ti.pixels);
+               image->ti.pixels = img_resampled.pixels;
+            }
+         }
+
+         if (image->cache_path)
+            task_image_cache_write(image->cache_path, &image->ti);
+
          img->width         = image->ti.width;
          img->height        = image->ti.height;
          img->pixels        = image->ti.pixels;
@@ -390,13 +824,42 @@ bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *user_data)
 {
+   return task_push_image_load_scaled(fullpath, supports_rgba,
+         upscale_threshold, 0, 0, NULL, cb, user_data);
+}
+
+bool task_push_image_load_scaled(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      unsigned max_width, unsigned max_height,
+      const char *cache_dir,
+      retro_task_callback_t cb, void *user_data)
+{
+   char cache_path[PATH_MAX_LENGTH];
    nbio_handle_t             *nbio   = NULL;
    struct nbio_image_handle   *image = NULL;
-   retro_task_t                   *t = task_init();
+   retro_task_t                   *t = NULL;
+   bool has_cache_path               = task_image_get_cache_path(
+         cache_path, sizeof(cache_path), cache_dir, fullpath,
+         supports_rgba, upscale_threshold, max_width, max_height);
 
-   if (!t)
+   if (!(t = task_init()))
       return false;
 
+   /* Skip decoding entirely if a processed copy
+    * of this image is already cached */
+   if (has_cache_path && path_is_valid(cache_path))
+   {
+      t->state     = strdup(cache_path);
+      t->handler   = task_image_cache_load_handler;
+      t->cleanup   = task_image_cache_load_free;
+      t->callback  = cb;
+      t->user_data = user_data;
+
+      task_queue_push(t);
+
+      return true;
+   }
+
    if (!(nbio = (nbio_handle_t*)malloc(sizeof(*nbio))))
    {
       free(t);
@@ -430,6 +893,9 @@ bool task_push_image_load(const char *fullpath,
    image->frame_duration             = 0;
    image->size                       = 0;
    image->upscale_threshold          = upscale_threshold;
+   image->max_width                  = max_width;
+   image->max_height                 = max_height;
+   image->cache_path                 = has_cache_path ? strdup(cache_path) : NULL;
    image->handle                     = NULL;
 
    image->ti.width                   = 0;
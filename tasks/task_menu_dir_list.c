@@ -0,0 +1,405 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2021 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <retro_miscellaneous.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <string/stdstring.h>
+
+#include "tasks_internal.h"
+
+#include "../menu/menu_driver.h"
+
+/* Number of directories whose listing is kept */
+#define MENU_DIR_LIST_CACHE_SIZE 8
+
+/* The first batch of entries is read straight away,
+ * each following batch is read by a background task
+ * and is twice as large as the previous one, so that
+ * the menu only needs to be refreshed a few times */
+#define MENU_DIR_LIST_BATCH_MIN  64
+#define MENU_DIR_LIST_BATCH_MAX  4096
+
+typedef struct menu_dir_list_cache_entry
+{
+   struct string_list list; /* Sorted, directories first */
+   char *path;
+   char *exts;
+   int64_t mtime;
+   time_t read_start;
+   unsigned last_used;
+   bool include_hidden;
+   bool reading;
+   /* Set once the listing is complete, if the directory
+    * was not modified while it was being read */
+   bool valid;
+} menu_dir_list_cache_entry_t;
+
+typedef struct menu_dir_list_handle
+{
+   struct dir_list_iterator *iter;
+   struct string_list batch;
+   char *path;
+   char *exts;
+   size_t batch_size;
+   int status;
+   bool include_hidden;
+} menu_dir_list_handle_t;
+
+static menu_dir_list_cache_entry_t menu_dir_list_cache[MENU_DIR_LIST_CACHE_SIZE];
+static unsigned menu_dir_list_cache_counter = 0;
+
+/*********************/
+/* Utility Functions */
+/*********************/
+
+static void menu_dir_list_cache_entry_reset(
+      menu_dir_list_cache_entry_t *entry)
+{
+   if (entry->path)
+      string_list_deinitialize(&entry->list);
+   free(entry->path);
+   free(entry->exts);
+   memset(entry, 0, sizeof(*entry));
+}
+
+static menu_dir_list_cache_entry_t *menu_dir_list_cache_find(
+      const char *path, const char *exts, bool include_hidden)
+{
+   size_t i;
+
+   for (i = 0; i < MENU_DIR_LIST_CACHE_SIZE; i++)
+   {
+      menu_dir_list_cache_entry_t *entry = &menu_dir_list_cache[i];
+
+      if (     entry->path
+            && entry->include_hidden == include_hidden
+            && string_is_equal(entry->path, path)
+            && (entry->exts
+               ? (exts && string_is_equal(entry->exts, exts))
+               : !exts))
+         return entry;
+   }
+
+   return NULL;
+}
+
+/* Returns an unused entry, or the least recently used
+ * one not being read, or NULL */
+static menu_dir_list_cache_entry_t *menu_dir_list_cache_alloc(void)
+{
+   size_t i;
+   menu_dir_list_cache_entry_t *oldest = NULL;
+
+   for (i = 0; i < MENU_DIR_LIST_CACHE_SIZE; i++)
+   {
+      menu_dir_list_cache_entry_t *entry = &menu_dir_list_cache[i];
+
+      if (!entry->path)
+         return entry;
+
+      if (entry->reading)
+         continue;
+
+      if (     !oldest
+            || (menu_dir_list_cache_counter - entry->last_used) >
+               (menu_dir_list_cache_counter - oldest->last_used))
+         oldest = entry;
+   }
+
+   if (oldest)
+      menu_dir_list_cache_entry_reset(oldest);
+
+   return oldest;
+}
+
+static void menu_dir_list_cache_entry_finish(
+      menu_dir_list_cache_entry_t *entry, int status)
+{
+   entry->reading = false;
+   /* The modification time has a granularity of one
+    * second: a change made in the second the listing
+    * started would go unnoticed */
+   entry->valid   =    (status == 0)
+                    && (entry->mtime > 0)
+                    && (entry->mtime < (int64_t)entry->read_start)
+                    && (path_get_mtime(entry->path) == entry->mtime);
+}
+
+static bool menu_dir_list_copy(struct string_list *dst,
+      const struct string_list *src)
+{
+   size_t i;
+
+   if (!string_list_initialize(dst))
+      return false;
+
+   for (i = 0; i < src->size; i++)
+      if (!string_list_append(dst, src->elems[i].data, src->elems[i].attr))
+         return false;
+
+   return true;
+}
+
+static void free_menu_dir_list_handle(menu_dir_list_handle_t *handle)
+{
+   if (!handle)
+      return;
+
+   dir_list_iterator_free(handle->iter);
+   string_list_deinitialize(&handle->batch);
+   free(handle->path);
+   free(handle->exts);
+   free(handle);
+}
+
+static bool task_push_menu_dir_list(menu_dir_list_handle_t *handle);
+
+static void cb_task_menu_dir_list(
+      retro_task_t *task, void *task_data,
+      void *user_data, const char *err)
+{
+   size_t i, sorted_size;
+   const char *menu_path              = NULL;
+   menu_dir_list_handle_t *handle     = NULL;
+   menu_dir_list_handle_t *next       = NULL;
+   menu_dir_list_cache_entry_t *entry = NULL;
+   struct menu_state *menu_st         = menu_state_get_ptr();
+
+   if (!task || !(handle = (menu_dir_list_handle_t*)task->state))
+      return;
+
+   /* The cache may have been flushed in the meantime */
+   if (!(entry = menu_dir_list_cache_find(handle->path,
+               handle->exts, handle->include_hidden))
+         || !entry->reading)
+      return;
+
+   sorted_size = entry->list.size;
+
+   for (i = 0; i < handle->batch.size; i++)
+      if (!string_list_append(&entry->list,
+               handle->batch.elems[i].data, handle->batch.elems[i].attr))
+         break;
+
+   dir_list_sort_merge(&entry->list, sorted_size, true);
+
+   if (handle->status == 1)
+   {
+      /* Hand the open directory over to the next batch */
+      if ((next = (menu_dir_list_handle_t*)calloc(1, sizeof(*next))))
+      {
+         next->iter           = handle->iter;
+         next->path           = strdup(handle->path);
+         next->exts           = handle->exts ? strdup(handle->exts) : NULL;
+         next->include_hidden = handle->include_hidden;
+         next->batch_size     = MIN(handle->batch_size * 2,
+               MENU_DIR_LIST_BATCH_MAX);
+         handle->iter         = NULL;
+
+         if (!task_push_menu_dir_list(next))
+         {
+            free_menu_dir_list_handle(next);
+            next = NULL;
+         }
+      }
+
+      if (!next)
+         menu_dir_list_cache_entry_finish(entry, -1);
+   }
+   else
+      menu_dir_list_cache_entry_finish(entry, handle->status);
+
+   /* If the directory is currently displayed,
+    * it must be refreshed */
+   menu_entries_get_last_stack(&menu_path, NULL, NULL, NULL, NULL);
+
+   if (string_is_equal(menu_path, entry->path))
+      menu_st->flags |=  MENU_ST_FLAG_ENTRIES_NEED_REFRESH
+                      |  MENU_ST_FLAG_PREVENT_POPULATE;
+}
+
+static void task_menu_dir_list_free(retro_task_t *task)
+{
+   if (task)
+      free_menu_dir_list_handle((menu_dir_list_handle_t*)task->state);
+}
+
+/**************************/
+/* Directory Listing Task */
+/**************************/
+
+static void task_menu_dir_list_handler(retro_task_t *task)
+{
+   if (task)
+   {
+      menu_dir_list_handle_t *handle = NULL;
+      if ((handle = (menu_dir_list_handle_t*)task->state))
+      {
+         if (task_get_cancelled(task))
+            handle->status = -1;
+         else
+            handle->status = dir_list_iterator_read(handle->iter,
+                  &handle->batch, handle->batch_size);
+         task_set_progress(task, 100);
+      }
+
+      task_set_finished(task, true);
+   }
+}
+
+static bool task_push_menu_dir_list(menu_dir_list_handle_t *handle)
+{
+   retro_task_t *task = task_init();
+
+   if (!task)
+      return false;
+
+   if (!string_list_initialize(&handle->batch))
+   {
+      free(task);
+      return false;
+   }
+
+   /* Configure task
+    * > Note: This is silent task, with no title
+    *   and no user notification messages */
+   task->handler  = task_menu_dir_list_handler;
+   task->state    = handle;
+   task->mute     = true;
+   task->title    = NULL;
+   task->progress = 0;
+   task->callback = cb_task_menu_dir_list;
+   task->cleanup  = task_menu_dir_list_free;
+
+   task_queue_push(task);
+
+   return true;
+}
+
+/******************/
+/* Public Methods */
+/******************/
+
+bool menu_dir_list_get(struct string_list *list,
+      const char *path, const char *exts,
+      bool include_hidden, bool *complete)
+{
+   int status;
+   menu_dir_list_handle_t *handle     = NULL;
+   struct dir_list_iterator *iter     = NULL;
+   menu_dir_list_cache_entry_t *entry = menu_dir_list_cache_find(
+         path, exts, include_hidden);
+
+   *complete = true;
+
+   if (entry)
+   {
+      if (     entry->reading
+            || (entry->valid && path_get_mtime(path) == entry->mtime))
+      {
+         entry->last_used = ++menu_dir_list_cache_counter;
+         *complete        = !entry->reading;
+         return menu_dir_list_copy(list, &entry->list);
+      }
+
+      /* Directory was modified */
+      menu_dir_list_cache_entry_reset(entry);
+   }
+
+   if (!(iter = dir_list_iterator_new(path, exts,
+               true, include_hidden, true)))
+      return false;
+
+   /* Every slot is being read - just read the whole
+    * directory here */
+   if (!(entry = menu_dir_list_cache_alloc()))
+   {
+      status = string_list_initialize(list)
+         ? dir_list_iterator_read(iter, list, SIZE_MAX) : -1;
+      dir_list_iterator_free(iter);
+      dir_list_sort(list, true);
+      return status != -1;
+   }
+
+   if (!string_list_initialize(&entry->list))
+   {
+      dir_list_iterator_free(iter);
+      return false;
+   }
+
+   entry->path           = strdup(path);
+   entry->exts           = exts ? strdup(exts) : NULL;
+   entry->include_hidden = include_hidden;
+   entry->mtime          = path_get_mtime(path);
+   entry->read_start     = time(NULL);
+   entry->last_used      = ++menu_dir_list_cache_counter;
+   entry->reading        = true;
+
+   /* Show the first few entries right away */
+   status = dir_list_iterator_read(iter, &entry->list,
+         MENU_DIR_LIST_BATCH_MIN);
+   dir_list_sort(&entry->list, true);
+
+   if (status == 1)
+   {
+      if ((handle = (menu_dir_list_handle_t*)calloc(1, sizeof(*handle))))
+      {
+         handle->iter           = iter;
+         handle->path           = strdup(path);
+         handle->exts           = exts ? strdup(exts) : NULL;
+         handle->include_hidden = include_hidden;
+         handle->batch_size     = MENU_DIR_LIST_BATCH_MIN * 2;
+         iter                   = NULL;
+
+         if (!task_push_menu_dir_list(handle))
+         {
+            iter         = handle->iter;
+            handle->iter = NULL;
+            free_menu_dir_list_handle(handle);
+            handle       = NULL;
+         }
+      }
+
+      /* Could not go async - read the rest now */
+      if (!handle)
+      {
+         size_t sorted_size = entry->list.size;
+         status = dir_list_iterator_read(iter, &entry->list, SIZE_MAX);
+         dir_list_sort_merge(&entry->list, sorted_size, true);
+      }
+   }
+
+   dir_list_iterator_free(iter);
+
+   if (!handle)
+      menu_dir_list_cache_entry_finish(entry, status);
+
+   *complete = !entry->reading;
+   return menu_dir_list_copy(list, &entry->list);
+}
+
+void menu_dir_list_cache_free(void)
+{
+   size_t i;
+
+   for (i = 0; i < MENU_DIR_LIST_CACHE_SIZE; i++)
+      menu_dir_list_cache_entry_reset(&menu_dir_list_cache[i]);
+}
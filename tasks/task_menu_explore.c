@@ -31,6 +31,7 @@ typedef struct menu_explore_init_handle
    explore_state_t *state;
    char *directory_playlist;
    char *directory_database;
+   char *directory_cache;
 } menu_explore_init_handle_t;
 
 /*********************/
@@ -55,6 +56,12 @@ static void free_menu_explore_init_handle(
       menu_explore->directory_database = NULL;
    }
 
+   if (menu_explore->directory_cache)
+   {
+      free(menu_explore->directory_cache);
+      menu_explore->directory_cache = NULL;
+   }
+
    if (menu_explore->state)
    {
       menu_explore_free_state(menu_explore->state);
@@ -146,7 +153,8 @@ static void task_menu_explore_init_handler(retro_task_t *task)
              * initialisation on a background thread) */
             menu_explore->state = menu_explore_build_list(
                   menu_explore->directory_playlist,
-                  menu_explore->directory_database);
+                  menu_explore->directory_database,
+                  menu_explore->directory_cache);
 
             task_set_progress(task, 100);
          }
@@ -165,7 +173,7 @@ static bool task_menu_explore_init_finder(
 }
 
 bool task_push_menu_explore_init(const char *directory_playlist,
-      const char *directory_database)
+      const char *directory_database, const char *directory_cache)
 {
    task_finder_data_t find_data;
    retro_task_t *task                       = NULL;
@@ -194,6 +202,8 @@ bool task_push_menu_explore_init(const char *directory_playlist,
    menu_explore->state              = NULL;
    menu_explore->directory_playlist = strdup(directory_playlist);
    menu_explore->directory_database = strdup(directory_database);
+   menu_explore->directory_cache    = string_is_empty(directory_cache)
+         ? NULL : strdup(directory_cache);
 
    /* Configure task
     * > Note: This is silent task, with no title
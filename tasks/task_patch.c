@@ -28,14 +28,22 @@
 #include <file/file_path.h>
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
+#include <retro_miscellaneous.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include <encodings/crc32.h>
+#include <lrc_hash.h>
 
 #include "../runloop.h"
 #include "../msg_hash.h"
 #include "../verbosity.h"
 #include "../configuration.h"
 
+#include "tasks_internal.h"
+
 #ifdef HAVE_XDELTA
 #include "../deps/xdelta3/xdelta3.h"
 #endif
@@ -100,15 +108,87 @@ struct ups_data
    unsigned target_checksum;
 };
 
+/* On entry, '*buf' holds the source. On success, it is replaced
+ * by the target (which may be the same buffer), otherwise it is
+ * left untouched */
 typedef enum patch_error (*patch_func_t)(const uint8_t*, uint64_t,
-      const uint8_t*, uint64_t, uint8_t**, uint64_t*);
+      uint8_t**, uint64_t*);
+
+/* Same as patch_func_t, for patches read from the file at
+ * 'path' as they are applied */
+typedef enum patch_error (*patch_file_func_t)(const char*,
+      uint8_t**, uint64_t*);
+
+/* Buffers at least this large get their CRC32 computed on
+ * a worker thread, while the patch is being applied */
+#define PATCH_CRC_THREAD_MIN_SIZE (1024 * 1024)
+
+/* Patched content is kept in the cache directory, keyed by the
+ * CRC and size of the source and the CRC of every patch applied
+ * to it, so that relaunching patched content does not patch it
+ * again */
+#define PATCH_CACHE_DIR      "patched"
+#define PATCH_CACHE_FILE     "content"
+#define PATCH_CACHE_MAX_SIZE (256 * 1024 * 1024)
+
+/* A patch and its 'indexed' siblings (.ips1 ... .ips9) */
+#define PATCH_MAX_FILES      10
+
+typedef struct patch_crc_job
+{
+   const uint8_t *data;
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+#endif
+   size_t len;
+   uint32_t crc;
+} patch_crc_job_t;
+
+typedef struct patch_file
+{
+   char path[PATH_MAX_LENGTH];
+   const char *desc;
+   patch_func_t func;
+   patch_file_func_t file_func;
+} patch_file_t;
+
+static void patch_crc_job_run(void *data)
+{
+   patch_crc_job_t *job = (patch_crc_job_t*)data;
+   job->crc             = encoding_crc32(0, job->data, job->len);
+}
+
+static void patch_crc_job_start(patch_crc_job_t *job,
+      const uint8_t *data, size_t len)
+{
+   job->data   = data;
+   job->len    = len;
+   job->crc    = 0;
+#ifdef HAVE_THREADS
+   job->thread = NULL;
+
+   if (     len >= PATCH_CRC_THREAD_MIN_SIZE
+         && (job->thread = sthread_create(patch_crc_job_run, job)))
+      return;
+#endif
+   patch_crc_job_run(job);
+}
+
+static uint32_t patch_crc_job_finish(patch_crc_job_t *job)
+{
+#ifdef HAVE_THREADS
+   if (job->thread)
+   {
+      sthread_join(job->thread);
+      job->thread = NULL;
+   }
+#endif
+   return job->crc;
+}
 
 static uint8_t bps_read(struct bps_data *bps)
 {
-   uint8_t data         = bps->modify_data[bps->modify_offset++];
-   bps->modify_checksum = ~(encoding_crc32(
-         ~bps->modify_checksum, &data, 1));
-   return data;
+   return bps->modify_data[bps->modify_offset++];
 }
 
 static uint64_t bps_decode(struct bps_data *bps)
@@ -130,40 +210,41 @@ static uint64_t bps_decode(struct bps_data *bps)
 
 static void bps_write(struct bps_data *bps, uint8_t data)
 {
-   bps->target_data[bps->output_offset++] = data;
-   bps->target_checksum = ~(encoding_crc32(~bps->target_checksum, &data, 1));
+   if (bps->output_offset < bps->target_length)
+      bps->target_data[bps->output_offset] = data;
+   bps->output_offset++;
 }
 
 static enum patch_error bps_apply_patch(
       const uint8_t *modify_data, uint64_t modify_length,
-      const uint8_t *source_data, uint64_t source_length,
-      uint8_t **target_data, uint64_t *target_length)
+      uint8_t **buf, uint64_t *size)
 {
    size_t i;
    struct bps_data bps;
-   uint32_t checksum               = 0;
+   patch_crc_job_t source_crc;
    size_t modify_source_size       = 0;
    size_t modify_target_size       = 0;
    size_t modify_markup_size       = 0;
    uint32_t modify_source_checksum = 0;
    uint32_t modify_target_checksum = 0;
    uint32_t modify_modify_checksum = 0;
+   enum patch_error err            = PATCH_SUCCESS;
 
    if (modify_length < 19)
       return PATCH_PATCH_TOO_SMALL;
 
    bps.modify_data            = modify_data;
-   bps.source_data            = source_data;
-   bps.target_data            = *target_data;
+   bps.source_data            = *buf;
+   bps.target_data            = NULL;
    bps.modify_length          = modify_length;
-   bps.source_length          = source_length;
-   bps.target_length          = *target_length;
+   bps.source_length          = *size;
+   bps.target_length          = 0;
    bps.modify_offset          = 0;
    bps.source_offset          = 0;
    bps.target_offset          = 0;
-   bps.modify_checksum        = ~0;
+   bps.modify_checksum        = 0;
    bps.source_checksum        = 0;
-   bps.target_checksum        = ~0;
+   bps.target_checksum        = 0;
    bps.source_relative_offset = 0;
    bps.target_relative_offset = 0;
    bps.output_offset          = 0;
@@ -184,18 +265,14 @@ static enum patch_error bps_apply_patch(
    if (modify_source_size > bps.source_length)
       return PATCH_SOURCE_TOO_SMALL;
 
-   if (modify_target_size > bps.target_length)
-   {
-      uint8_t *prov=(uint8_t*)malloc((size_t)modify_target_size);
+   if (!(bps.target_data = (uint8_t*)malloc(MAX(modify_target_size, 1))))
+      return PATCH_TARGET_ALLOC_FAILED;
 
-      if (!prov)
-         return PATCH_TARGET_ALLOC_FAILED;
+   bps.target_length = modify_target_size;
 
-      free(*target_data);
-      bps.target_data   = prov;
-      *target_data      = prov;
-      bps.target_length = modify_target_size;
-   }
+   /* The source is only read from, so its checksum
+    * can be computed while the target is written */
+   patch_crc_job_start(&source_crc, bps.source_data, bps.source_length);
 
    while (bps.modify_offset < bps.modify_length - 12)
    {
@@ -249,25 +326,33 @@ static enum patch_error bps_apply_patch(
       modify_source_checksum |= bps_read(&bps) << i;
    for (i = 0; i < 32; i += 8)
       modify_target_checksum |= bps_read(&bps) << i;
-
-   checksum = ~bps.modify_checksum;
    for (i = 0; i < 32; i += 8)
       modify_modify_checksum |= bps_read(&bps) << i;
 
-   bps.source_checksum = encoding_crc32(0,
-         bps.source_data, bps.source_length);
-   bps.target_checksum = ~bps.target_checksum;
+   /* Checksums cover the whole buffers, computing them
+    * in one go is much faster than byte per byte */
+   bps.modify_checksum = encoding_crc32(0,
+         bps.modify_data, bps.modify_length - 4);
+   bps.target_checksum = encoding_crc32(0,
+         bps.target_data, MIN(bps.output_offset, bps.target_length));
+   bps.source_checksum = patch_crc_job_finish(&source_crc);
 
    if (bps.source_checksum != modify_source_checksum)
-      return PATCH_SOURCE_CHECKSUM_INVALID;
-
-   if (bps.target_checksum != modify_target_checksum)
-      return PATCH_TARGET_CHECKSUM_INVALID;
+      err = PATCH_SOURCE_CHECKSUM_INVALID;
+   else if (bps.target_checksum != modify_target_checksum)
+      err = PATCH_TARGET_CHECKSUM_INVALID;
+   else if (bps.modify_checksum != modify_modify_checksum)
+      err = PATCH_PATCH_CHECKSUM_INVALID;
 
-   if (checksum != modify_modify_checksum)
-      return PATCH_PATCH_CHECKSUM_INVALID;
+   if (err != PATCH_SUCCESS)
+   {
+      free(bps.target_data);
+      return err;
+   }
 
-   *target_length = modify_target_size;
+   free(*buf);
+   *buf  = bps.target_data;
+   *size = modify_target_size;
 
    return PATCH_SUCCESS;
 }
@@ -275,36 +360,21 @@ static enum patch_error bps_apply_patch(
 static uint8_t ups_patch_read(struct ups_data *data)
 {
    if (data && data->patch_offset < data->patch_length)
-   {
-      uint8_t n = data->patch_data[data->patch_offset++];
-      data->patch_checksum =
-         ~(encoding_crc32(~data->patch_checksum, &n, 1));
-      return n;
-   }
+      return data->patch_data[data->patch_offset++];
    return 0x00;
 }
 
 static uint8_t ups_source_read(struct ups_data *data)
 {
    if (data && data->source_offset < data->source_length)
-   {
-      uint8_t n = data->source_data[data->source_offset++];
-      data->source_checksum =
-         ~(encoding_crc32(~data->source_checksum, &n, 1));
-      return n;
-   }
+      return data->source_data[data->source_offset++];
    return 0x00;
 }
 
 static void ups_target_write(struct ups_data *data, uint8_t n)
 {
-
    if (data && data->target_offset < data->target_length)
-   {
       data->target_data[data->target_offset] = n;
-      data->target_checksum =
-         ~(encoding_crc32(~data->target_checksum, &n, 1));
-   }
 
    if (data)
       data->target_offset++;
@@ -329,30 +399,31 @@ static uint64_t ups_decode(struct ups_data *data)
 
 static enum patch_error ups_apply_patch(
       const uint8_t *patchdata, uint64_t patchlength,
-      const uint8_t *sourcedata, uint64_t sourcelength,
-      uint8_t **targetdata, uint64_t *targetlength)
+      uint8_t **buf, uint64_t *size)
 {
    size_t i;
    struct ups_data data;
+   patch_crc_job_t source_crc;
    unsigned source_read_length;
    unsigned target_read_length;
-   uint32_t patch_result_checksum = 0;
+   unsigned target_length;
    uint32_t patch_read_checksum   = 0;
    uint32_t source_read_checksum  = 0;
    uint32_t target_read_checksum  = 0;
+   enum patch_error err           = PATCH_SOURCE_INVALID;
 
    data.patch_data      = patchdata;
-   data.source_data     = sourcedata;
-   data.target_data     = *targetdata;
+   data.source_data     = *buf;
+   data.target_data     = NULL;
    data.patch_length    = (unsigned)patchlength;
-   data.source_length   = (unsigned)sourcelength;
-   data.target_length   = (unsigned)*targetlength;
+   data.source_length   = (unsigned)*size;
+   data.target_length   = 0;
    data.patch_offset    = 0;
    data.source_offset   = 0;
    data.target_offset   = 0;
-   data.patch_checksum  = ~0;
-   data.source_checksum = ~0;
-   data.target_checksum = ~0;
+   data.patch_checksum  = 0;
+   data.source_checksum = 0;
+   data.target_checksum = 0;
 
    if (data.patch_length < 18)
       return PATCH_PATCH_INVALID;
@@ -372,20 +443,17 @@ static enum patch_error ups_apply_patch(
          && (data.source_length != target_read_length))
       return PATCH_SOURCE_INVALID;
 
-   *targetlength = (data.source_length == source_read_length ?
+   target_length = (data.source_length == source_read_length ?
          target_read_length : source_read_length);
 
-   if (data.target_length < *targetlength)
-   {
-      uint8_t *prov=(uint8_t*)malloc((size_t)*targetlength);
-      if (!prov)
-         return PATCH_TARGET_ALLOC_FAILED;
-      free(*targetdata);
-      *targetdata      = prov;
-      data.target_data = prov;
-   }
+   if (!(data.target_data = (uint8_t*)malloc(MAX(target_length, 1))))
+      return PATCH_TARGET_ALLOC_FAILED;
 
-   data.target_length = (unsigned)*targetlength;
+   data.target_length = target_length;
+
+   /* The source is only read from, so its checksum
+    * can be computed while the target is written */
+   patch_crc_job_start(&source_crc, data.source_data, data.source_length);
 
    while (data.patch_offset < data.patch_length - 12)
    {
@@ -411,119 +479,163 @@ static enum patch_error ups_apply_patch(
       source_read_checksum |= ups_patch_read(&data) << (i * 8);
    for (i = 0; i < 4; i++)
       target_read_checksum |= ups_patch_read(&data) << (i * 8);
-
-   patch_result_checksum = ~data.patch_checksum;
-   data.source_checksum  = ~data.source_checksum;
-   data.target_checksum  = ~data.target_checksum;
-
    for (i = 0; i < 4; i++)
       patch_read_checksum |= ups_patch_read(&data) << (i * 8);
 
-   if (patch_result_checksum != patch_read_checksum)
-      return PATCH_PATCH_INVALID;
-
-   if (     data.source_checksum == source_read_checksum
+   /* Every byte of the source and target has been
+    * visited, so the checksums cover whole buffers */
+   data.patch_checksum  = encoding_crc32(0,
+         data.patch_data, data.patch_length - 4);
+   data.target_checksum = encoding_crc32(0,
+         data.target_data, data.target_length);
+   data.source_checksum = patch_crc_job_finish(&source_crc);
+
+   if (data.patch_checksum != patch_read_checksum)
+      err = PATCH_PATCH_INVALID;
+   else if (data.source_checksum == source_read_checksum
          && data.source_length   == source_read_length)
    {
       if (     data.target_checksum == target_read_checksum
             && data.target_length   == target_read_length)
-         return PATCH_SUCCESS;
-      return PATCH_TARGET_INVALID;
+         err = PATCH_SUCCESS;
+      else
+         err = PATCH_TARGET_INVALID;
    }
    else if (data.source_checksum == target_read_checksum
          && data.source_length   == target_read_length)
    {
       if (     data.target_checksum == source_read_checksum
             && data.target_length   == source_read_length)
-         return PATCH_SUCCESS;
-      return PATCH_TARGET_INVALID;
+         err = PATCH_SUCCESS;
+      else
+         err = PATCH_TARGET_INVALID;
    }
 
-   return PATCH_SOURCE_INVALID;
+   if (err != PATCH_SUCCESS)
+   {
+      free(data.target_data);
+      return err;
+   }
+
+   free(*buf);
+   *buf  = data.target_data;
+   *size = target_length;
+
+   return PATCH_SUCCESS;
 }
 
-static enum patch_error ips_alloc_targetdata(
-      const uint8_t *patchdata, uint64_t patchlen,
-      uint64_t sourcelength,
-      uint8_t **targetdata, uint64_t *targetlength)
+/* IPS patches are read from the file a record at a time, instead
+ * of being loaded whole. Records are applied in place and the
+ * data of copy records is read straight into the target, so the
+ * content is the only buffer a patch needs */
+typedef struct ips_stream
 {
-   uint8_t *prov_alloc;
-   uint32_t offset = 5;
-   *targetlength   = sourcelength;
+   RFILE *file;
+   uint64_t offset;
+   uint64_t length;
+} ips_stream_t;
+
+static bool ips_stream_read(ips_stream_t *ips, uint8_t *data,
+      unsigned len)
+{
+   if (     ips->length - ips->offset < len
+         || filestream_read(ips->file, data, len) != (int64_t)len)
+      return false;
+
+   ips->offset += len;
+   return true;
+}
+
+static bool ips_stream_skip(ips_stream_t *ips, unsigned len)
+{
+   if (     ips->length - ips->offset < len
+         || filestream_seek(ips->file, len,
+               RETRO_VFS_SEEK_POSITION_CURRENT) != 0)
+      return false;
+
+   ips->offset += len;
+   return true;
+}
+
+/* Goes through the records of the patch. Without 'targetdata',
+ * the patch is only validated; either way, the size of the
+ * target is determined, as well as the size of the buffer the
+ * records are applied to, since they may extend past a
+ * truncated target */
+static enum patch_error ips_stream_records(ips_stream_t *ips,
+      uint8_t *targetdata,
+      uint64_t *targetlength, uint64_t *bufferlength)
+{
+   uint8_t bytes[3];
 
    for (;;)
    {
       uint32_t address;
       unsigned length;
 
-      if (offset > patchlen - 3)
+      if (!ips_stream_read(ips, bytes, 3))
          break;
 
-      address  = patchdata[offset++] << 16;
-      address |= patchdata[offset++] << 8;
-      address |= patchdata[offset++] << 0;
+      address  = bytes[0] << 16;
+      address |= bytes[1] << 8;
+      address |= bytes[2] << 0;
 
       if (address == 0x454f46) /* EOF */
       {
-         if (offset == patchlen)
+         if (ips->offset == ips->length)
          {
-            prov_alloc     = (uint8_t*)malloc((size_t)*targetlength);
-            if (!prov_alloc)
-               return PATCH_TARGET_ALLOC_FAILED;
-            free(*targetdata);
-            *targetdata    = prov_alloc;
+            *bufferlength  = *targetlength;
             return PATCH_SUCCESS;
          }
-         else if (offset == patchlen - 3)
+         else if (ips->offset == ips->length - 3)
          {
-            uint32_t size  = patchdata[offset++] << 16;
-            size          |= patchdata[offset++] << 8;
-            size          |= patchdata[offset++] << 0;
-            *targetlength  = size;
-            prov_alloc     = (uint8_t*)malloc((size_t)*targetlength);
+            uint32_t size;
+
+            if (!ips_stream_read(ips, bytes, 3))
+               break;
 
-            if (!prov_alloc)
-               return PATCH_TARGET_ALLOC_FAILED;
-            free(*targetdata);
-            *targetdata    = prov_alloc;
+            size           = bytes[0] << 16;
+            size          |= bytes[1] << 8;
+            size          |= bytes[2] << 0;
+            *bufferlength  = MAX(*targetlength, size);
+            *targetlength  = size;
             return PATCH_SUCCESS;
          }
       }
 
-      if (offset > patchlen - 2)
+      if (!ips_stream_read(ips, bytes, 2))
          break;
 
-      length  = patchdata[offset++] << 8;
-      length |= patchdata[offset++] << 0;
+      length  = bytes[0] << 8;
+      length |= bytes[1] << 0;
 
       if (length) /* Copy */
       {
-         if (offset > patchlen - length)
-            break;
-
-         while (length--)
+         if (targetdata)
          {
-            address++;
-            offset++;
+            if (!ips_stream_read(ips, targetdata + address, length))
+               break;
          }
+         else if (!ips_stream_skip(ips, length))
+            break;
       }
       else /* RLE */
       {
-         if (offset > patchlen - 3)
+         if (!ips_stream_read(ips, bytes, 3))
             break;
 
-         length  = patchdata[offset++] << 8;
-         length |= patchdata[offset++] << 0;
+         length  = bytes[0] << 8;
+         length |= bytes[1] << 0;
 
          if (length == 0) /* Illegal */
             break;
 
-         while (length--)
-            address++;
-
-         offset++;
+         if (targetdata)
+            memset(targetdata + address, bytes[2], length);
       }
 
+      address += length;
+
       if (address > *targetlength)
          *targetlength = address;
    }
@@ -531,95 +643,67 @@ static enum patch_error ips_alloc_targetdata(
    return PATCH_PATCH_INVALID;
 }
 
-static enum patch_error ips_apply_patch(
-      const uint8_t *patchdata, uint64_t patchlen,
-      const uint8_t *sourcedata, uint64_t sourcelength,
-      uint8_t **targetdata, uint64_t *targetlength)
+static enum patch_error ips_apply_patch_file(const char *path,
+      uint8_t **buf, uint64_t *size)
 {
-   uint32_t offset = 5;
-   enum patch_error error_patch = PATCH_UNKNOWN;
-   if (  patchlen      < 8   ||
-         patchdata[0] != 'P' ||
-         patchdata[1] != 'A' ||
-         patchdata[2] != 'T' ||
-         patchdata[3] != 'C' ||
-         patchdata[4] != 'H')
-      return PATCH_PATCH_INVALID;
-
-   if ((error_patch = ips_alloc_targetdata(
-               patchdata, patchlen, sourcelength,
-               targetdata, targetlength)) != PATCH_SUCCESS)
-      return error_patch;
-
-   memcpy(*targetdata, sourcedata, (size_t)sourcelength);
-
-   for (;;)
-   {
-      uint32_t address;
-      unsigned length;
-
-      if (offset > patchlen - 3)
-         break;
+   ips_stream_t ips;
+   uint8_t header[5];
+   uint64_t target_length       = *size;
+   uint64_t buffer_length       = 0;
+   uint8_t *targetdata          = *buf;
+   enum patch_error error_patch = PATCH_PATCH_INVALID;
+
+   if (!(ips.file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return PATCH_UNKNOWN;
 
-      address  = patchdata[offset++] << 16;
-      address |= patchdata[offset++] << 8;
-      address |= patchdata[offset++] << 0;
+   ips.offset = 0;
+   ips.length = (uint64_t)filestream_get_size(ips.file);
 
-      if (address == 0x454f46) /* EOF */
-      {
-         if (offset == patchlen)
-            return PATCH_SUCCESS;
+   if (     ips.length < 8
+         || !ips_stream_read(&ips, header, sizeof(header))
+         || memcmp(header, "PATCH", sizeof(header)))
+      goto end;
 
-         if (offset == patchlen - 3)
-         {
-#if 0
-            uint32_t size  = patchdata[offset++] << 16;
-            size          |= patchdata[offset++] << 8;
-            size          |= patchdata[offset++] << 0;
-#endif
-            return PATCH_SUCCESS;
-         }
-      }
+   if ((error_patch = ips_stream_records(&ips, NULL,
+               &target_length, &buffer_length)) != PATCH_SUCCESS)
+      goto end;
 
-      if (offset > patchlen - 2)
-         break;
-
-      length  = patchdata[offset++] << 8;
-      length |= patchdata[offset++] << 0;
-
-      if (length) /* Copy */
+   /* The whole patch has been validated, so the records
+    * can be applied in place rather than to a copy of
+    * the source */
+   if (buffer_length > *size)
+   {
+      if (!(targetdata = (uint8_t*)realloc(*buf, (size_t)buffer_length)))
       {
-         if (offset > patchlen - length)
-            break;
-
-         while (length--)
-            (*targetdata)[address++] = patchdata[offset++];
+         error_patch = PATCH_TARGET_ALLOC_FAILED;
+         goto end;
       }
-      else /* RLE */
-      {
-         if (offset > patchlen - 3)
-            break;
-
-         length  = patchdata[offset++] << 8;
-         length |= patchdata[offset++] << 0;
-
-         if (length == 0) /* Illegal */
-            break;
+      memset(targetdata + *size, 0, (size_t)(buffer_length - *size));
+      *buf = targetdata;
+   }
 
-         while (length--)
-            (*targetdata)[address++] = patchdata[offset];
+   /* Only a read error can fail this pass, which leaves
+    * the content partially patched */
+   target_length = *size;
+   ips.offset    = sizeof(header);
 
-         offset++;
-      }
-   }
+   if (filestream_seek(ips.file, ips.offset,
+         RETRO_VFS_SEEK_POSITION_START) != 0)
+      error_patch = PATCH_UNKNOWN;
+   else if ((error_patch = ips_stream_records(&ips, targetdata,
+               &target_length, &buffer_length)) == PATCH_SUCCESS)
+      *size = target_length;
 
-   return PATCH_PATCH_INVALID;
+end:
+   filestream_close(ips.file);
+   return error_patch;
 }
 
 static enum patch_error xdelta_apply_patch(
         const uint8_t *patchdata, uint64_t patchlen,
-        const uint8_t *sourcedata, uint64_t sourcelength,
-        uint8_t **targetdata, uint64_t *targetlength)
+        uint8_t **buf, uint64_t *size)
 {
 #if defined(HAVE_PATCH) && defined(HAVE_XDELTA)
    int ret;
@@ -627,6 +711,10 @@ static enum patch_error xdelta_apply_patch(
    xd3_stream stream;
    xd3_config config;
    xd3_source source;
+   const uint8_t *sourcedata    = *buf;
+   uint64_t sourcelength        = *size;
+   uint8_t *targetdata          = NULL;
+   uint64_t targetlength        = 0;
 
    /* Validate the magic number, as given by RFC 3284 section 4.1 */
    if (patchlen      < 8    ||
@@ -665,8 +753,8 @@ static enum patch_error xdelta_apply_patch(
             break;
          case XD3_GOTHEADER:
          case XD3_WINSTART:
-            *targetlength += stream.winsize;
-            RARCH_DBG("[xdelta] Discovered a window of %lu bytes (target filesize is %lu bytes)\n", stream.winsize, *targetlength);
+            targetlength += stream.winsize;
+            RARCH_DBG("[xdelta] Discovered a window of %lu bytes (target filesize is %lu bytes)\n", stream.winsize, targetlength);
             /* xdelta updates the active stream window in the GOTHEADER and WINSTART states */
             break;
          case XD3_OUTPUT:
@@ -688,21 +776,29 @@ static enum patch_error xdelta_apply_patch(
       }
    } while (stream.avail_in);
 
-   *targetdata = malloc(*targetlength);
+   if (!(targetdata = (uint8_t*)malloc(MAX(targetlength, 1))))
+   {
+      error_patch = PATCH_TARGET_ALLOC_FAILED;
+      goto cleanup_stream;
+   }
+
    switch (ret = xd3_decode_memory(
            patchdata, patchlen,
            sourcedata, sourcelength,
-           *targetdata, targetlength, *targetlength, 0))
+           targetdata, &targetlength, targetlength, 0))
    {
       case 0: /* Success */
+         free(*buf);
+         *buf  = targetdata;
+         *size = targetlength;
          break;
       case ENOSPC:
          error_patch = PATCH_TARGET_ALLOC_FAILED;
-         free(*targetdata);
+         free(targetdata);
          goto cleanup_stream;
       default:
          error_patch = PATCH_UNKNOWN;
-         free(*targetdata);
+         free(targetdata);
          goto cleanup_stream;
    }
 
@@ -715,165 +811,231 @@ cleanup_stream:
 #endif
 }
 
-static bool apply_patch_content(uint8_t **buf,
-      ssize_t *size, const char *patch_desc, const char *patch_path,
-      patch_func_t func, void *patch_data, int64_t patch_size)
+static void patch_content_notify(const char *patch_path)
 {
-   settings_t *settings     = config_get_ptr();
-   bool show_notification   = settings ?
-         settings->bools.notification_show_patch_applied : false;
-   enum patch_error err     = PATCH_UNKNOWN;
-   ssize_t ret_size         = *size;
-   uint8_t *ret_buf         = *buf;
-   uint64_t target_size     = 0;
-   uint8_t *patched_content = NULL;
-
-   RARCH_LOG("Found %s file in \"%s\", attempting to patch ...\n",
-         patch_desc, patch_path);
-
-   if ((err = func((const uint8_t*)patch_data, patch_size, ret_buf,
-         ret_size, &patched_content, &target_size)) == PATCH_SUCCESS)
-   {
-      free(ret_buf);
-      *buf  = patched_content;
-      *size = target_size;
-
-      /* Show an OSD message */
-      if (show_notification)
-      {
-         const char *patch_filename = path_basename_nocompression(patch_path);
-         char msg[256];
+   settings_t *settings       = config_get_ptr();
+   const char *patch_filename = NULL;
+   char msg[256];
 
-         msg[0] = '\0';
+   if (!settings || !settings->bools.notification_show_patch_applied)
+      return;
 
-         snprintf(msg, sizeof(msg), msg_hash_to_str(MSG_APPLYING_PATCH),
-               patch_filename ? patch_filename :
-                     msg_hash_to_str(MENU_ENUM_LABEL_VALUE_UNKNOWN));
-         runloop_msg_queue_push(msg, 1, 180, false, NULL,
-               MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-      }
-   }
-   else
-      RARCH_ERR("%s %s: %s #%u\n",
-            msg_hash_to_str(MSG_FAILED_TO_PATCH),
-            patch_desc,
-            msg_hash_to_str(MSG_ERROR),
-            (unsigned)err);
+   patch_filename = path_basename_nocompression(patch_path);
+   msg[0]         = '\0';
 
-   return true;
+   snprintf(msg, sizeof(msg), msg_hash_to_str(MSG_APPLYING_PATCH),
+         patch_filename ? patch_filename :
+               msg_hash_to_str(MENU_ENUM_LABEL_VALUE_UNKNOWN));
+   runloop_msg_queue_push(msg, 1, 180, false, NULL,
+         MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
 }
 
-static bool try_bps_patch(bool allow_bps, const char *name_bps,
+static bool patch_content_apply_file(const patch_file_t *file,
       uint8_t **buf, ssize_t *size)
 {
-   if (     allow_bps
-         && !string_is_empty(name_bps)
-         && path_is_valid(name_bps)
-      )
+   enum patch_error err     = PATCH_UNKNOWN;
+   uint64_t target_size     = (uint64_t)*size;
+
+   RARCH_LOG("Found %s file in \"%s\", attempting to patch ...\n",
+         file->desc, file->path);
+
+   if (file->file_func)
+      err = file->file_func(file->path, buf, &target_size);
+   else
    {
       int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
+      void *patch_data      = NULL;
 
-      if (!filestream_read_file(name_bps, &patch_data, &patch_size))
+      if (!filestream_read_file(file->path, &patch_data, &patch_size))
          return false;
 
       if (patch_size >= 0)
-         ret = apply_patch_content(buf, size, "BPS", name_bps,
-               bps_apply_patch, patch_data, patch_size);
+         err = file->func((const uint8_t*)patch_data, patch_size, buf,
+               &target_size);
 
       if (patch_data)
          free(patch_data);
-      return ret;
    }
 
+   if (err == PATCH_SUCCESS)
+   {
+      *size = target_size;
+
+      /* Show an OSD message */
+      patch_content_notify(file->path);
+      return true;
+   }
+
+   RARCH_ERR("%s %s: %s #%u\n",
+         msg_hash_to_str(MSG_FAILED_TO_PATCH),
+         file->desc,
+         msg_hash_to_str(MSG_ERROR),
+         (unsigned)err);
+
    return false;
 }
 
-static bool try_ups_patch(bool allow_ups, const char *name_ups,
-      uint8_t **buf, ssize_t *size)
+static bool patch_content_find_file(patch_file_t *file, bool allow,
+      const char *path, const char *desc, patch_func_t func,
+      patch_file_func_t file_func)
 {
-   if (     allow_ups
-         && !string_is_empty(name_ups)
-         && path_is_valid(name_ups)
+   if (     allow
+         && !string_is_empty(path)
+         && path_is_valid(path)
       )
    {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
-
-      if (!filestream_read_file(name_ups, &patch_data, &patch_size))
-         return false;
-
-      if (patch_size >= 0)
-         ret = apply_patch_content(buf, size, "UPS", name_ups,
-               ups_apply_patch, patch_data, patch_size);
-
-      if (patch_data)
-         free(patch_data);
-      return ret;
+      strlcpy(file->path, path, sizeof(file->path));
+      file->desc      = desc;
+      file->func      = func;
+      file->file_func = file_func;
+      return true;
    }
+
    return false;
 }
 
-static bool try_ips_patch(bool allow_ips,
-      const char *name_ips, uint8_t **buf, ssize_t *size)
+/* Lists the patches to apply: the first (non-indexed) one
+ * found, followed by any additional 'indexed' patch files */
+static size_t patch_content_find_files(patch_file_t *files,
+      bool allow_ips, bool allow_bps, bool allow_ups, bool allow_xdelta,
+      const char *name_ips, const char *name_bps,
+      const char *name_ups, const char *name_xdelta)
 {
-   if (     allow_ips
-         && !string_is_empty(name_ips)
-         && path_is_valid(name_ips)
-      )
+   size_t name_ips_len       = strlen(name_ips);
+   size_t name_bps_len       = strlen(name_bps);
+   size_t name_ups_len       = strlen(name_ups);
+   size_t name_xdelta_len    = strlen(name_xdelta);
+   char *name_ips_indexed    = (char*)malloc((name_ips_len + 2) * sizeof(char));
+   char *name_bps_indexed    = (char*)malloc((name_bps_len + 2) * sizeof(char));
+   char *name_ups_indexed    = (char*)malloc((name_ups_len + 2) * sizeof(char));
+   char *name_xdelta_indexed = (char*)malloc((name_xdelta_len + 2) * sizeof(char));
+   size_t patch_index        = 0;
+
+   if (     !name_ips_indexed
+         || !name_bps_indexed
+         || !name_ups_indexed
+         || !name_xdelta_indexed)
+      goto end;
+
+   strlcpy(name_ips_indexed, name_ips, (name_ips_len + 1) * sizeof(char));
+   strlcpy(name_bps_indexed, name_bps, (name_bps_len + 1) * sizeof(char));
+   strlcpy(name_ups_indexed, name_ups, (name_ups_len + 1) * sizeof(char));
+   strlcpy(name_xdelta_indexed, name_xdelta, (name_xdelta_len + 1) * sizeof(char));
+
+   /* Ensure that we NUL terminate *after* the
+    * index character */
+   name_ips_indexed[name_ips_len + 1] = '\0';
+   name_bps_indexed[name_bps_len + 1] = '\0';
+   name_ups_indexed[name_ups_len + 1] = '\0';
+   name_xdelta_indexed[name_xdelta_len + 1] = '\0';
+
+   while (patch_index < PATCH_MAX_FILES)
    {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
+      patch_file_t *file = &files[patch_index];
+
+      /* Add index character to end of patch
+       * file path string (the first patch has
+       * no index)
+       * > Note: This technique only works for
+       *   index values up to 9 (i.e. single
+       *   digit numbers)
+       * > If we want to support more than 10
+       *   patches in total, will have to replace
+       *   this with an snprintf() implementation
+       *   (which will have significantly higher
+       *   performance overheads) */
+      if (patch_index > 0)
+      {
+         char index_char = '0' + patch_index;
 
-      if (!filestream_read_file(name_ips, &patch_data, &patch_size))
-         return false;
+         name_ips_indexed[name_ips_len] = index_char;
+         name_bps_indexed[name_bps_len] = index_char;
+         name_ups_indexed[name_ups_len] = index_char;
+         name_xdelta_indexed[name_xdelta_len] = index_char;
+      }
 
-      if (patch_size >= 0)
-         ret = apply_patch_content(buf, size, "IPS", name_ips,
-               ips_apply_patch, patch_data, patch_size);
+      if (     !patch_content_find_file(file, allow_ips,
+                  name_ips_indexed, "IPS", NULL, ips_apply_patch_file)
+            && !patch_content_find_file(file, allow_bps,
+                  name_bps_indexed, "BPS", bps_apply_patch, NULL)
+            && !patch_content_find_file(file, allow_ups,
+                  name_ups_indexed, "UPS", ups_apply_patch, NULL)
+            && !patch_content_find_file(file, allow_xdelta,
+                  name_xdelta_indexed, "Xdelta", xdelta_apply_patch, NULL))
+         break;
 
-      if (patch_data)
-         free(patch_data);
-      return ret;
+      patch_index++;
    }
-   return false;
+
+end:
+   free(name_ips_indexed);
+   free(name_bps_indexed);
+   free(name_ups_indexed);
+   free(name_xdelta_indexed);
+
+   return patch_index;
 }
 
-static bool try_xdelta_patch(bool allow_xdelta,
-                          const char *name_xdelta, uint8_t **buf, ssize_t *size)
+/* Patches are read in chunks, as IPS patches are never
+ * loaded whole */
+static bool patch_cache_file_crc32(const char *path, uint32_t *crc)
 {
-#if defined(HAVE_PATCH) && defined(HAVE_XDELTA)
-   if (     allow_xdelta
-            && !string_is_empty(name_xdelta)
-            && path_is_valid(name_xdelta)
-           )
+   uint8_t buf[4096];
+   int64_t nread;
+   RFILE *file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   *crc = 0;
+
+   while ((nread = filestream_read(file, buf, sizeof(buf))) > 0)
+      *crc = encoding_crc32(*crc, buf, (size_t)nread);
+
+   filestream_close(file);
+   return nread == 0;
+}
+
+/* Returns false if the patched content cannot be cached */
+static bool patch_cache_get_entry(const char *directory_cache,
+      const patch_file_t *files, size_t num_files,
+      const uint8_t *buf, ssize_t size,
+      content_cache_entry_t *entry)
+{
+   size_t i;
+   uint32_t hash       = FNV1A_INIT;
+   int64_t source_size = size;
+
+   if (string_is_empty(directory_cache) || size <= 0)
+      return false;
+
+   for (i = 0; i < num_files; i++)
    {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
+      uint32_t crc;
 
-      if (!filestream_read_file(name_xdelta, &patch_data, &patch_size))
+      if (!patch_cache_file_crc32(files[i].path, &crc))
          return false;
 
-      if (patch_size >= 0)
-         ret = apply_patch_content(buf, size, "Xdelta", name_xdelta,
-                                   xdelta_apply_patch, patch_data, patch_size);
+      hash = fnv1a_calculate(hash, files[i].desc, strlen(files[i].desc));
+      hash = fnv1a_calculate(hash, &crc, sizeof(crc));
+   }
 
-      if (patch_data)
-         free(patch_data);
-      return ret;
-    }
-#endif
-    return false;
+   hash = fnv1a_calculate(hash, &source_size, sizeof(source_size));
+
+   content_cache_get_entry(entry, directory_cache, PATCH_CACHE_DIR,
+         hash, encoding_crc32(0, buf, (size_t)size), PATCH_CACHE_FILE);
+
+   return true;
 }
 
 /**
  * patch_content:
- * @buf          : buffer of the content file.
- * @size         : size   of the content file.
+ * @directory_cache : cache directory, where patched content
+ *                    is kept. May be NULL.
+ * @buf             : buffer of the content file.
+ * @size            : size   of the content file.
  *
  * Apply patch to the content file in-memory.
  *
@@ -887,14 +1049,23 @@ bool patch_content(
       const char *name_bps,
       const char *name_ups,
       const char *name_xdelta,
+      const char *directory_cache,
       uint8_t **buf,
       void *data)
 {
-   ssize_t *size     = (ssize_t*)data;
-   bool allow_ups    = !is_bps_pref && !is_ips_pref && !is_xdelta_pref;
-   bool allow_ips    = !is_ups_pref && !is_bps_pref && !is_xdelta_pref;
-   bool allow_bps    = !is_ups_pref && !is_ips_pref && !is_xdelta_pref;
-   bool allow_xdelta = !is_bps_pref && !is_ups_pref && !is_ips_pref;
+   size_t i;
+   content_cache_entry_t entry;
+   ssize_t *size       = (ssize_t*)data;
+   bool allow_ups      = !is_bps_pref && !is_ips_pref && !is_xdelta_pref;
+   bool allow_ips      = !is_ups_pref && !is_bps_pref && !is_xdelta_pref;
+   bool allow_bps      = !is_ups_pref && !is_ips_pref && !is_xdelta_pref;
+   bool allow_xdelta   = !is_bps_pref && !is_ups_pref && !is_ips_pref;
+   patch_file_t *files = NULL;
+   size_t num_files    = 0;
+   bool cacheable      = false;
+   bool patched        = true;
+   void *cached_data   = NULL;
+   int64_t cached_size = 0;
 
    if (    (unsigned)is_ips_pref
          + (unsigned)is_bps_pref
@@ -906,74 +1077,54 @@ bool patch_content(
       return false;
    }
 
-   /* Attempt to apply first (non-indexed) patch */
-   if (     try_ips_patch(allow_ips, name_ips, buf, size)
-         || try_bps_patch(allow_bps, name_bps, buf, size)
-         || try_ups_patch(allow_ups, name_ups, buf, size)
-         || try_xdelta_patch(allow_xdelta, name_xdelta, buf, size))
-   {
-      /* A patch has been found. Now attempt to apply
-       * any additional 'indexed' patch files */
-      size_t name_ips_len       = strlen(name_ips);
-      size_t name_bps_len       = strlen(name_bps);
-      size_t name_ups_len       = strlen(name_ups);
-      size_t name_xdelta_len    = strlen(name_xdelta);
-      char *name_ips_indexed    = (char*)malloc((name_ips_len + 2) * sizeof(char));
-      char *name_bps_indexed    = (char*)malloc((name_bps_len + 2) * sizeof(char));
-      char *name_ups_indexed    = (char*)malloc((name_ups_len + 2) * sizeof(char));
-      char *name_xdelta_indexed = (char*)malloc((name_xdelta_len + 2) * sizeof(char));
-      /* First patch already applied -> index
-       * for subsequent patches starts at 1 */
-      size_t patch_index     = 1;
-
-      strlcpy(name_ips_indexed, name_ips, (name_ips_len + 1) * sizeof(char));
-      strlcpy(name_bps_indexed, name_bps, (name_bps_len + 1) * sizeof(char));
-      strlcpy(name_ups_indexed, name_ups, (name_ups_len + 1) * sizeof(char));
-      strlcpy(name_xdelta_indexed, name_xdelta, (name_xdelta_len + 1) * sizeof(char));
-
-      /* Ensure that we NUL terminate *after* the
-       * index character */
-      name_ips_indexed[name_ips_len + 1] = '\0';
-      name_bps_indexed[name_bps_len + 1] = '\0';
-      name_ups_indexed[name_ups_len + 1] = '\0';
-      name_xdelta_indexed[name_xdelta_len + 1] = '\0';
-
-      /* try to patch "*.ipsX" */
-      while (patch_index < 10)
-      {
-         /* Add index character to end of patch
-          * file path string
-          * > Note: This technique only works for
-          *   index values up to 9 (i.e. single
-          *   digit numbers)
-          * > If we want to support more than 10
-          *   patches in total, will have to replace
-          *   this with an snprintf() implementation
-          *   (which will have significantly higher
-          *   performance overheads) */
-         char index_char = '0' + patch_index;
+#if !defined(HAVE_PATCH) || !defined(HAVE_XDELTA)
+   allow_xdelta        = false;
+#endif
 
-         name_ips_indexed[name_ips_len] = index_char;
-         name_bps_indexed[name_bps_len] = index_char;
-         name_ups_indexed[name_ups_len] = index_char;
-         name_xdelta_indexed[name_xdelta_len] = index_char;
+   if (!(files = (patch_file_t*)calloc(PATCH_MAX_FILES, sizeof(*files))))
+      return false;
 
-         if (     !try_ips_patch(allow_ips, name_ips_indexed, buf, size)
-               && !try_bps_patch(allow_bps, name_bps_indexed, buf, size)
-               && !try_ups_patch(allow_ups, name_ups_indexed, buf, size)
-               && !try_xdelta_patch(allow_xdelta, name_xdelta_indexed, buf, size))
-            break;
+   if (!(num_files = patch_content_find_files(files,
+               allow_ips, allow_bps, allow_ups, allow_xdelta,
+               name_ips, name_bps, name_ups, name_xdelta)))
+   {
+      free(files);
+      return false;
+   }
 
-         patch_index++;
-      }
+   cacheable = patch_cache_get_entry(directory_cache, files, num_files,
+         *buf, *size, &entry);
 
-      free(name_ips_indexed);
-      free(name_bps_indexed);
-      free(name_ups_indexed);
-      free(name_xdelta_indexed);
+   if (     cacheable
+         && content_cache_touch(&entry, PATCH_CACHE_MAX_SIZE, false)
+         && filestream_read_file(entry.path, &cached_data, &cached_size))
+   {
+      RARCH_LOG("Using patched content from cache: \"%s\".\n",
+            entry.path);
 
-      return true;
+      free(*buf);
+      *buf  = (uint8_t*)cached_data;
+      *size = (ssize_t)cached_size;
+
+      for (i = 0; i < num_files; i++)
+         patch_content_notify(files[i].path);
+   }
+   else
+   {
+      for (i = 0; i < num_files; i++)
+         if (!patch_content_apply_file(&files[i], buf, size))
+            patched = false;
+
+      /* Only content every patch applied to is cached */
+      if (     cacheable
+            && patched
+            && *size > 0
+            && *size <= PATCH_CACHE_MAX_SIZE / 2
+            && path_mkdir(entry.dir)
+            && filestream_write_file(entry.path, *buf, *size))
+         content_cache_touch(&entry, PATCH_CACHE_MAX_SIZE, true);
    }
 
-   return false;
+   free(files);
+   return true;
 }
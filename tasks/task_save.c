@@ -26,6 +26,7 @@
 #endif
 
 #include <compat/strl.h>
+#include <encodings/crc32.h>
 #include <lists/string_list.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
@@ -78,6 +79,9 @@
 #define RASTATE_REPLAY_BLOCK "RPLY"
 #define RASTATE_END_BLOCK "END "
 
+/* SRAM changes are tracked per block of this size */
+#define SAVE_BLOCK_SIZE 4096
+
 struct ram_type
 {
    const char *path;
@@ -104,6 +108,25 @@ struct sram_block
    unsigned type;
 };
 
+/* Hash of each block of a SRAM buffer */
+typedef struct save_block_hashes
+{
+   uint32_t *hashes;
+   size_t size;
+   size_t num_blocks;
+} save_block_hashes_t;
+
+/* Hashes of what the file of each save slot holds,
+ * so unchanged SRAM is never written back */
+struct save_hashes_st
+{
+   save_block_hashes_t *list;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   unsigned num;
+};
+
 enum save_task_state_flags
 {
    SAVE_TASK_FLAG_LOAD_TO_BACKUP_BUFF   = (1 << 0),
@@ -155,8 +178,10 @@ struct autosave
    slock_t *cond_lock;
    scond_t *cond;
    sthread_t *thread;
+   save_block_hashes_t hashes;
    size_t bufsize;
    unsigned interval;
+   unsigned slot;
    uint8_t flags;
 };
 #endif
@@ -179,6 +204,8 @@ static struct ram_save_state_buf ram_buf;
 static struct autosave_st autosave_state;
 #endif
 
+static struct save_hashes_st save_hashes_state;
+
 static bool save_state_in_background       = false;
 static struct string_list *task_save_files = NULL;
 
@@ -194,6 +221,243 @@ typedef struct rastate_size_info
 #endif
 } rastate_size_info_t;
 
+/**
+ * save_block_hashes_update:
+ * @h               : block hashes of the previous contents
+ * @data            : SRAM buffer
+ * @size            : size of @data
+ * @copy            : buffer receiving the blocks that changed, or NULL
+ *
+ * Hashes @data block by block and brings @h up to date,
+ * copying every block that changed over to @copy.
+ *
+ * @return true if any block changed.
+ **/
+static bool save_block_hashes_update(save_block_hashes_t *h,
+      const void *data, size_t size, void *copy)
+{
+   size_t i;
+   const uint8_t *src = (const uint8_t*)data;
+   size_t num_blocks  = (size + SAVE_BLOCK_SIZE - 1) / SAVE_BLOCK_SIZE;
+   bool changed       = false;
+   bool all           = (h->size != size);
+
+   if (h->num_blocks != num_blocks)
+   {
+      uint32_t *hashes = (uint32_t*)realloc(h->hashes,
+            num_blocks * sizeof(*hashes));
+      if (!hashes)
+      {
+         free(h->hashes);
+         h->hashes     = NULL;
+         h->size       = 0;
+         h->num_blocks = 0;
+         if (copy)
+            memcpy(copy, data, size);
+         return true;
+      }
+      h->hashes        = hashes;
+      h->num_blocks    = num_blocks;
+      all              = true;
+   }
+
+   h->size             = size;
+
+   for (i = 0; i < num_blocks; i++)
+   {
+      size_t   offset  = i * SAVE_BLOCK_SIZE;
+      size_t   len     = MIN(SAVE_BLOCK_SIZE, size - offset);
+      uint32_t hash    = encoding_crc32(0, src + offset, len);
+
+      if (all || hash != h->hashes[i])
+      {
+         h->hashes[i]  = hash;
+         changed       = true;
+         if (copy)
+            memcpy((uint8_t*)copy + offset, src + offset, len);
+      }
+   }
+
+   return changed;
+}
+
+static void save_block_hashes_free(save_block_hashes_t *h)
+{
+   if (h->hashes)
+      free(h->hashes);
+   h->hashes     = NULL;
+   h->size       = 0;
+   h->num_blocks = 0;
+}
+
+/* Must be called with the save hashes lock held */
+static save_block_hashes_t *save_hashes_get(unsigned slot)
+{
+   if (slot >= save_hashes_state.num)
+   {
+      save_block_hashes_t *list = (save_block_hashes_t*)
+         realloc(save_hashes_state.list, (slot + 1) * sizeof(*list));
+      if (!list)
+         return NULL;
+      memset(list + save_hashes_state.num, 0,
+            (slot + 1 - save_hashes_state.num) * sizeof(*list));
+      save_hashes_state.list = list;
+      save_hashes_state.num  = slot + 1;
+   }
+   return &save_hashes_state.list[slot];
+}
+
+/**
+ * save_hashes_update:
+ * @slot            : save slot
+ * @data            : SRAM buffer
+ * @size            : size of @data
+ *
+ * Records @data as the contents of the file of @slot.
+ *
+ * @return true if it differs from what was recorded before.
+ **/
+static bool save_hashes_update(unsigned slot, const void *data, size_t size)
+{
+   save_block_hashes_t *h = NULL;
+   bool changed           = true;
+#ifdef HAVE_THREADS
+   slock_lock(save_hashes_state.lock);
+#endif
+   if ((h = save_hashes_get(slot)))
+      changed = save_block_hashes_update(h, data, size, NULL);
+#ifdef HAVE_THREADS
+   slock_unlock(save_hashes_state.lock);
+#endif
+   return changed;
+}
+
+/**
+ * save_hashes_match:
+ * @slot            : save slot
+ * @h               : block hashes of a SRAM buffer
+ *
+ * @return true if the file of @slot already holds the
+ * buffer hashed in @h.
+ **/
+static bool save_hashes_match(unsigned slot, const save_block_hashes_t *h)
+{
+   bool match = false;
+#ifdef HAVE_THREADS
+   slock_lock(save_hashes_state.lock);
+#endif
+   if (     slot < save_hashes_state.num
+         && save_hashes_state.list[slot].size       == h->size
+         && save_hashes_state.list[slot].num_blocks == h->num_blocks
+         && h->num_blocks > 0)
+      match = memcmp(save_hashes_state.list[slot].hashes, h->hashes,
+            h->num_blocks * sizeof(*h->hashes)) == 0;
+#ifdef HAVE_THREADS
+   slock_unlock(save_hashes_state.lock);
+#endif
+   return match;
+}
+
+/* Records @h as what the file of @slot holds */
+static void save_hashes_set(unsigned slot, const save_block_hashes_t *h)
+{
+   save_block_hashes_t *dst = NULL;
+#ifdef HAVE_THREADS
+   slock_lock(save_hashes_state.lock);
+#endif
+   if ((dst = save_hashes_get(slot)))
+   {
+      uint32_t *hashes = (uint32_t*)realloc(dst->hashes,
+            h->num_blocks * sizeof(*hashes));
+      if (hashes)
+      {
+         memcpy(hashes, h->hashes, h->num_blocks * sizeof(*hashes));
+         dst->hashes     = hashes;
+         dst->size       = h->size;
+         dst->num_blocks = h->num_blocks;
+      }
+      else
+         save_block_hashes_free(dst);
+   }
+#ifdef HAVE_THREADS
+   slock_unlock(save_hashes_state.lock);
+#endif
+}
+
+/* Forgets what the file of @slot holds, so it is
+ * written again next time */
+static void save_hashes_reset(unsigned slot)
+{
+#ifdef HAVE_THREADS
+   slock_lock(save_hashes_state.lock);
+#endif
+   if (slot < save_hashes_state.num)
+      save_block_hashes_free(&save_hashes_state.list[slot]);
+#ifdef HAVE_THREADS
+   slock_unlock(save_hashes_state.lock);
+#endif
+}
+
+static void save_hashes_deinit(void)
+{
+   unsigned i;
+#ifdef HAVE_THREADS
+   slock_lock(save_hashes_state.lock);
+#endif
+   for (i = 0; i < save_hashes_state.num; i++)
+      save_block_hashes_free(&save_hashes_state.list[i]);
+   free(save_hashes_state.list);
+   save_hashes_state.list = NULL;
+   save_hashes_state.num  = 0;
+#ifdef HAVE_THREADS
+   slock_unlock(save_hashes_state.lock);
+#endif
+}
+
+/**
+ * save_file_commit:
+ * @tmp_path        : fully written temporary file
+ * @path            : destination
+ *
+ * Syncs @tmp_path to the storage device and renames it
+ * over @path, so that @path always holds either the old
+ * or the new save in full. Where @path has to be deleted
+ * first (Windows) and the rename still fails, @tmp_path
+ * is kept so that the new save can be recovered.
+ *
+ * @return true if successful, otherwise false.
+ **/
+static bool save_file_commit(const char *tmp_path, const char *path)
+{
+   RFILE *file = filestream_open(tmp_path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if (filestream_sync(file) != 0)
+   {
+      filestream_close(file);
+      filestream_delete(tmp_path);
+      return false;
+   }
+
+   filestream_close(file);
+
+   if (filestream_replace(tmp_path, path) == 0)
+      return true;
+
+   /* The old save is gone, the new one is only left
+    * in @tmp_path - it is kept to be recovered */
+   if (path_is_valid(tmp_path))
+      RARCH_ERR("[SRAM]: Failed to rename \"%s\" to \"%s\".\n",
+            tmp_path, path);
+
+   return false;
+}
+
 #ifdef HAVE_THREADS
 /**
  * autosave_thread:
@@ -205,36 +469,53 @@ static void autosave_thread(void *data)
 {
    autosave_t *save = (autosave_t*)data;
 
+   char tmp_path[PATH_MAX_LENGTH];
+
+   strlcpy(tmp_path, save->path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
    for (;;)
    {
       bool differ;
 
+      /* Only the blocks that changed are copied */
       slock_lock(save->lock);
-      differ = memcmp(save->buffer, save->retro_buffer,
-            save->bufsize) != 0;
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
+      differ = save_block_hashes_update(&save->hashes,
+            save->retro_buffer, save->bufsize, save->buffer);
       slock_unlock(save->lock);
 
-      if (differ)
+      /* SRAM loaded from the file after the autosave
+       * was set up needs no writing back */
+      if (differ && !save_hashes_match(save->slot, &save->hashes))
       {
+         bool written       = false;
          intfstream_t *file = NULL;
 
          /* Should probably deal with this more elegantly. */
          if (save->flags & AUTOSAVE_FLAG_COMPRESS_FILES)
-            file = intfstream_open_rzip_file(save->path,
+            file = intfstream_open_rzip_file(tmp_path,
                   RETRO_VFS_FILE_ACCESS_WRITE);
          else
-            file = intfstream_open_file(save->path,
+            file = intfstream_open_file(tmp_path,
                   RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
          if (file)
          {
-            intfstream_write(file, save->buffer, save->bufsize);
+            written = intfstream_write(file, save->buffer,
+                  save->bufsize) == (int64_t)save->bufsize;
             intfstream_flush(file);
             intfstream_close(file);
             free(file);
          }
+
+         if (written && save_file_commit(tmp_path, save->path))
+            save_hashes_set(save->slot, &save->hashes);
+         else
+         {
+            /* Try again with the whole buffer next time */
+            save_block_hashes_free(&save->hashes);
+            save_hashes_reset(save->slot);
+         }
       }
 
       slock_lock(save->cond_lock);
@@ -264,6 +545,7 @@ static void autosave_thread(void *data)
  * @data            : pointer to buffer
  * @size            : size of @data buffer
  * @interval        : interval at which saves should be performed.
+ * @slot            : save slot of @path
  *
  * Create and initialize autosave object.
  *
@@ -272,7 +554,7 @@ static void autosave_thread(void *data)
  **/
 static autosave_t *autosave_new(const char *path,
       const void *data, size_t size,
-      unsigned interval, bool compress)
+      unsigned interval, unsigned slot, bool compress)
 {
    void       *buf               = NULL;
    autosave_t *handle            = (autosave_t*)malloc(sizeof(*handle));
@@ -282,6 +564,10 @@ static autosave_t *autosave_new(const char *path,
    handle->flags                 = 0;
    handle->bufsize               = size;
    handle->interval              = interval;
+   handle->slot                  = slot;
+   handle->hashes.hashes         = NULL;
+   handle->hashes.size           = 0;
+   handle->hashes.num_blocks     = 0;
    if (compress)
       handle->flags             |= AUTOSAVE_FLAG_COMPRESS_FILES;
    handle->retro_buffer          = data;
@@ -296,6 +582,8 @@ static autosave_t *autosave_new(const char *path,
    handle->buffer                = buf;
 
    memcpy(handle->buffer, handle->retro_buffer, handle->bufsize);
+   save_block_hashes_update(&handle->hashes,
+         handle->buffer, handle->bufsize, NULL);
 
    handle->lock                  = slock_new();
    handle->cond_lock             = slock_new();
@@ -326,6 +614,7 @@ static void autosave_free(autosave_t *handle)
    if (handle->buffer)
       free(handle->buffer);
    handle->buffer = NULL;
+   save_block_hashes_free(&handle->hashes);
 }
 
 bool autosave_init(void)
@@ -369,6 +658,7 @@ bool autosave_init(void)
             mem_info.data,
             mem_info.size,
             autosave_interval,
+            i,
             compress_files)))
       {
          RARCH_WARN("%s\n", msg_hash_to_str(MSG_AUTOSAVE_FAILED));
@@ -1937,6 +2227,10 @@ bool content_load_ram_file(unsigned slot)
          rc = mem_info.size;
       }
       memcpy(mem_info.data, buf, (size_t)rc);
+
+      /* A short file still has to be written back in full */
+      if (rc == (int64_t)mem_info.size)
+         save_hashes_update(slot, mem_info.data, mem_info.size);
    }
 
    if (buf)
@@ -2158,20 +2452,34 @@ success:
 }
 
 /**
- * content_save_ram_file:
- * @path             : path of RAM state that shall be written to.
- * @type             : type of memory
+ * content_save_ram_tmp_file:
+ * @slot             : save slot
+ * @compress         : whether to write a compressed file
+ * @tmp_path         : receives the path of the written file
+ * @len              : size of @tmp_path
  *
- * Save a RAM state from memory to disk.
+ * Writes a RAM state from memory to a temporary file next
+ * to its save file, unless the save file is already up to
+ * date. On failure the RAM is dumped elsewhere instead.
  *
+ * @return 1 if @tmp_path was written, 0 if there is nothing
+ * to write, -1 on failure.
  */
-bool content_save_ram_file(unsigned slot, bool compress)
+static int content_save_ram_tmp_file(unsigned slot, bool compress,
+      char *tmp_path, size_t len)
 {
    struct ram_type ram;
    retro_ctx_memory_info_t mem_info;
 
    if (!content_get_memory(&mem_info, &ram, slot))
-      return false;
+      return -1;
+
+   if (!save_hashes_update(slot, mem_info.data, mem_info.size))
+   {
+      RARCH_LOG("[SRAM]: #%u \"%s\" is unchanged, not saving.\n",
+            ram.type, ram.path);
+      return 0;
+   }
 
    RARCH_LOG("[SRAM]: %s #%u %s \"%s\".\n",
          msg_hash_to_str(MSG_SAVING_RAM_TYPE),
@@ -2179,28 +2487,29 @@ bool content_save_ram_file(unsigned slot, bool compress)
          msg_hash_to_str(MSG_TO),
          ram.path);
 
+   strlcpy(tmp_path, ram.path, len);
+   strlcat(tmp_path, ".tmp", len);
+
 #if defined(HAVE_ZLIB)
    if (compress)
    {
       if (!rzipstream_write_file(
-            ram.path, mem_info.data, mem_info.size))
+            tmp_path, mem_info.data, mem_info.size))
          goto fail;
    }
    else
 #endif
    {
       if (!filestream_write_file(
-            ram.path, mem_info.data, mem_info.size))
+            tmp_path, mem_info.data, mem_info.size))
          goto fail;
    }
 
-   RARCH_LOG("[SRAM]: %s \"%s\".\n",
-         msg_hash_to_str(MSG_SAVED_SUCCESSFULLY_TO),
-         ram.path);
-
-   return true;
+   return 1;
 
 fail:
+   save_hashes_reset(slot);
+
    RARCH_ERR("[SRAM]: %s.\n",
          msg_hash_to_str(MSG_FAILED_TO_SAVE_SRAM));
    RARCH_WARN("[SRAM]: Attempting to recover ...\n");
@@ -2208,21 +2517,87 @@ fail:
    /* In case the file could not be written to,
     * the fallback function 'dump_to_file_desperate'
     * will be called. */
+   if (!dump_to_file_desperate(
+            mem_info.data, mem_info.size, ram.type))
+      RARCH_WARN("[SRAM]: Failed ... Cannot recover save file.\n");
+   return -1;
+}
+
+/**
+ * content_commit_ram_file:
+ * @slot             : save slot
+ * @tmp_path         : file written by content_save_ram_tmp_file()
+ *
+ * Replaces the save file of @slot with @tmp_path.
+ *
+ * @return true if successful, otherwise false.
+ */
+static bool content_commit_ram_file(unsigned slot, const char *tmp_path)
+{
+   struct ram_type ram;
+   retro_ctx_memory_info_t mem_info;
+
+   if (!content_get_memory(&mem_info, &ram, slot))
+      return false;
+
+   if (save_file_commit(tmp_path, ram.path))
+   {
+      RARCH_LOG("[SRAM]: %s \"%s\".\n",
+            msg_hash_to_str(MSG_SAVED_SUCCESSFULLY_TO),
+            ram.path);
+      return true;
+   }
+
+   save_hashes_reset(slot);
+
+   RARCH_ERR("[SRAM]: %s.\n",
+         msg_hash_to_str(MSG_FAILED_TO_SAVE_SRAM));
+   RARCH_WARN("[SRAM]: Attempting to recover ...\n");
+
    if (!dump_to_file_desperate(
             mem_info.data, mem_info.size, ram.type))
       RARCH_WARN("[SRAM]: Failed ... Cannot recover save file.\n");
    return false;
 }
 
+/**
+ * content_save_ram_file:
+ * @path             : path of RAM state that shall be written to.
+ * @type             : type of memory
+ *
+ * Save a RAM state from memory to disk.
+ *
+ */
+bool content_save_ram_file(unsigned slot, bool compress)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+
+   switch (content_save_ram_tmp_file(slot, compress,
+            tmp_path, sizeof(tmp_path)))
+   {
+      case 0:
+         return true;
+      case 1:
+         return content_commit_ram_file(slot, tmp_path);
+      default:
+         break;
+   }
+
+   return false;
+}
+
 bool event_save_files(bool is_sram_used)
 {
    unsigned i;
+   char (*tmp_paths)[PATH_MAX_LENGTH] = NULL;
    settings_t *settings            = config_get_ptr();
 #ifdef HAVE_CHEATS
    const char *path_cheat_database = settings->paths.path_cheat_database;
 #endif
 #if defined(HAVE_ZLIB)
    bool compress_files             = settings->bools.save_file_compression;
+#else
+   bool compress_files             = false;
 #endif
 
 #ifdef HAVE_CHEATS
@@ -2232,15 +2607,28 @@ bool event_save_files(bool is_sram_used)
    if (!task_save_files || !is_sram_used)
       return false;
 
-   for (i = 0; i < task_save_files->size; i++)
+   /* Write every changed file first and sync them
+    * afterwards, so the storage device gets to flush
+    * them together instead of one at a time */
+   if (!(tmp_paths = (char (*)[PATH_MAX_LENGTH])calloc(
+         task_save_files->size, sizeof(*tmp_paths))))
    {
-#if defined(HAVE_ZLIB)
-      content_save_ram_file(i, compress_files);
-#else
-      content_save_ram_file(i, false);
-#endif
+      for (i = 0; i < task_save_files->size; i++)
+         content_save_ram_file(i, compress_files);
+      return true;
    }
 
+   for (i = 0; i < task_save_files->size; i++)
+      if (content_save_ram_tmp_file(i, compress_files,
+            tmp_paths[i], sizeof(tmp_paths[i])) != 1)
+         tmp_paths[i][0] = '\0';
+
+   for (i = 0; i < task_save_files->size; i++)
+      if (tmp_paths[i][0])
+         content_commit_ram_file(i, tmp_paths[i]);
+
+   free(tmp_paths);
+
    return true;
 }
 
@@ -2282,11 +2670,22 @@ void path_deinit_savefile(void)
    if (task_save_files)
       string_list_free(task_save_files);
    task_save_files = NULL;
+
+   save_hashes_deinit();
+#ifdef HAVE_THREADS
+   if (save_hashes_state.lock)
+      slock_free(save_hashes_state.lock);
+   save_hashes_state.lock = NULL;
+#endif
 }
 
 void path_init_savefile_new(void)
 {
    task_save_files = string_list_new();
+#ifdef HAVE_THREADS
+   if (!save_hashes_state.lock)
+      save_hashes_state.lock = slock_new();
+#endif
 }
 
 void *savefile_ptr_get(void)
@@ -215,6 +215,23 @@ bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *userdata);
 
+/* Same as task_push_image_load(), but images larger than
+ * 'max_width' x 'max_height' are downscaled (0 means
+ * unbounded). If 'cache_dir' is set, the processed pixels
+ * are cached there and reused on subsequent requests,
+ * skipping the decode altogether */
+bool task_push_image_load_scaled(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      unsigned max_width, unsigned max_height,
+      const char *cache_dir,
+      retro_task_callback_t cb, void *userdata);
+
+/* Set up and release the accounting that keeps the
+ * on-disk image cache of task_push_image_load_scaled()
+ * within its size limit */
+void task_image_cache_init(void);
+void task_image_cache_deinit(void);
+
 #ifdef HAVE_LIBRETRODB
 bool task_push_dbscan(
       const char *playlist_directory,
@@ -236,6 +253,21 @@ bool task_push_overlay_load_default(
       void *user_data);
 #endif
 
+typedef struct content_cache_entry
+{
+   char root[PATH_MAX_LENGTH];
+   char dir[PATH_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+   char key[32];
+} content_cache_entry_t;
+
+void content_cache_get_entry(content_cache_entry_t *entry,
+      const char *directory_cache, const char *dir,
+      uint32_t hash, uint32_t crc, const char *name);
+
+bool content_cache_touch(const content_cache_entry_t *entry,
+      int64_t max_size, bool add);
+
 bool patch_content(
       bool is_ips_pref,
       bool is_bps_pref,
@@ -245,6 +277,7 @@ bool patch_content(
       const char *name_bps,
       const char *name_ups,
       const char *name_xdelta,
+      const char *directory_cache,
       uint8_t **buf,
       void *data);
 
@@ -300,11 +333,19 @@ void task_push_cdrom_dump(const char *drive);
 /* Menu explore tasks */
 #if defined(HAVE_MENU) && defined(HAVE_LIBRETRODB)
 bool task_push_menu_explore_init(const char *directory_playlist,
-      const char *directory_database);
+      const char *directory_database, const char *directory_cache);
 bool menu_explore_init_in_progress(void *data);
 void menu_explore_wait_for_init_task(void);
 #endif
 
+/* Menu directory listing tasks */
+#if defined(HAVE_MENU)
+bool menu_dir_list_get(struct string_list *list,
+      const char *path, const char *exts,
+      bool include_hidden, bool *complete);
+void menu_dir_list_cache_free(void);
+#endif
+
 extern const char* const input_builtin_autoconfs[];
 
 /* cloud sync tasks */